@@ -1,4 +1,4 @@
-import React, { useState, useEffect } from 'react';
+import React, { useState, useEffect, useRef } from 'react';
 import { initializeApp } from 'firebase/app';
 import { getAuth, signInAnonymously, signInWithCustomToken, onAuthStateChanged } from 'firebase/auth';
 import { getFirestore, doc, getDoc, setDoc, collection, query, where, getDocs } from 'firebase/firestore';
@@ -8,6 +8,8 @@ import { getFirestore, doc, getDoc, setDoc, collection, query, where, getDocs }
 const appId = typeof __app_id !== 'undefined' ? __app_id : 'default-app-id';
 const firebaseConfig = typeof __firebase_config !== 'undefined' ? JSON.parse(__firebase_config) : {};
 const initialAuthToken = typeof __initial_auth_token !== 'undefined' ? __initial_auth_token : null;
+// ReBMS の WASM モジュール（Emscripten が提供。未ロードならキャリブレーションは使えない）
+const rebmsModule = typeof Module !== 'undefined' ? Module : null;
 
 // Firebaseサービスの初期化
 const app = initializeApp(firebaseConfig);
@@ -24,8 +26,17 @@ const DEFAULT_CONFIG = {
     scrollSpeed: 3.5, // ハイスピード設定 (3.5x)
     gaugeMode: 'NORMAL', // ゲージの種類 (NORMAL, HARD, EASY)
     judgeOffset: 0, // 判定オフセット (ms)
+    visualOffset: 0, // 表示オフセット (ms、キャリブレーションで設定)
 };
 
+// 遅延キャリブレーション (LatencyCalibrator)
+//  AUDIO : WebAudio のクリックに合わせてタップ → VISUAL : 画面のフラッシュに合わせてタップ
+//  結果の judge_offset_ms / visual_offset_ms を設定の judgeOffset / visualOffset に書き込む
+const CALIBRATION_BPM = 120;
+const CALIBRATION_BEATS = 16;
+const CALIBRATION_LEAD_MS = 500; // 開始からカウントインの 1 拍目までの猶予
+const JUDGE_OFFSET_RANGE = 100;  // 判定オフセットのスライダーの範囲 (±ms)
+
 const MOCK_MUSIC_ID = "MOCK_BMS_001"; // モック用楽曲ID
 
 // デフォルトの7キーバインド (キーコード: JavaScriptの key.code または key.keyCode を想定)
@@ -76,6 +87,9 @@ const App = () => {
     const [userId, setUserId] = useState(null);
     const [keybinds, setKeybinds] = useState(DEFAULT_KEYBINDS);
     const [isBinding, setIsBinding] = useState(null); // どのレーンをバインド中か (例: 11)
+    const [calibPhase, setCalibPhase] = useState('IDLE'); // キャリブレーションのフェーズ (IDLE, AUDIO, VISUAL)
+    const [isFlashOn, setIsFlashOn] = useState(false);
+    const calibRef = useRef(null); // { calibrator, audioContext, originMs }
     
     // --------------------------------------------------------
     // A. Firebase 初期化と認証
@@ -285,6 +299,110 @@ const App = () => {
 
     const handleSaveClick = () => saveConfig(config);
 
+    // --------------------------------------------------------
+    // G. 遅延キャリブレーション
+    // --------------------------------------------------------
+
+    // AUDIO フェーズ : 全拍のクリックを WebAudio に先にスケジュールする (originMs = カウントインの 1 拍目)
+    const startAudioPhase = (calibrator) => {
+        const audioContext = new AudioContext();
+        const lead = CALIBRATION_LEAD_MS / 1000;
+        const originAudio = audioContext.currentTime + lead;
+        const countIn = rebmsModule.LatencyCalibrator.getCountInBeats();
+
+        for (let beat = -countIn; beat < calibrator.getBeatCount(); beat++) {
+            const t = originAudio + calibrator.getBeatTime(beat) / 1000;
+            const osc = audioContext.createOscillator();
+            const gain = audioContext.createGain();
+            osc.frequency.value = 1000;
+            gain.gain.setValueAtTime(0.8, t);
+            gain.gain.exponentialRampToValueAtTime(0.001, t + 0.02);
+            osc.connect(gain).connect(audioContext.destination);
+            osc.start(t);
+            osc.stop(t + 0.02);
+        }
+
+        calibrator.start(rebmsModule.CalibrationPhase.AUDIO);
+        calibRef.current = { calibrator, audioContext, originMs: performance.now() + CALIBRATION_LEAD_MS };
+        setCalibPhase('AUDIO');
+        setStatus("クリック音に合わせて任意のキーを押してください (最初の 4 拍はカウントイン)");
+    };
+
+    const startVisualPhase = () => {
+        const calib = calibRef.current;
+        calib.audioContext.close();
+        calib.audioContext = null;
+        calib.calibrator.start(rebmsModule.CalibrationPhase.VISUAL);
+        calib.originMs = performance.now() + CALIBRATION_LEAD_MS;
+        setCalibPhase('VISUAL');
+        setStatus("画面のフラッシュに合わせて任意のキーを押してください (音は鳴りません)");
+    };
+
+    const finishCalibration = () => {
+        const { calibrator } = calibRef.current;
+        const result = calibrator.compute();
+        calibrator.delete();
+        calibRef.current = null;
+        setIsFlashOn(false);
+        setCalibPhase('IDLE');
+
+        if (!result.valid) {
+            setStatus("タップが足りないため、キャリブレーションをやり直してください。");
+            return;
+        }
+        const judgeOffset = Math.max(-JUDGE_OFFSET_RANGE, Math.min(JUDGE_OFFSET_RANGE, Math.round(result.judge_offset_ms)));
+        const visualOffset = Math.round(result.visual_offset_ms);
+        setConfig(prev => ({ ...prev, judgeOffset, visualOffset }));
+        setStatus(`判定オフセット ${judgeOffset} ms / 表示オフセット ${visualOffset} ms を設定しました (保存で反映)`);
+    };
+
+    const startCalibration = () => {
+        if (!rebmsModule || !rebmsModule.LatencyCalibrator) {
+            setStatus("WASM モジュールが読み込まれていないため、キャリブレーションできません。");
+            return;
+        }
+        const calibrator = new rebmsModule.LatencyCalibrator();
+        calibrator.setBPM(CALIBRATION_BPM);
+        calibrator.setBeatCount(CALIBRATION_BEATS);
+        startAudioPhase(calibrator);
+    };
+
+    // タップの記録と、フェーズの進行 / フラッシュの表示 (毎フレーム)
+    useEffect(() => {
+        if (calibPhase === 'IDLE') return;
+
+        const handleTap = (e) => {
+            e.preventDefault();
+            if (e.repeat || !calibRef.current) return;
+            calibRef.current.calibrator.onTap(e.timeStamp - calibRef.current.originMs);
+        };
+
+        let frameId = 0;
+        let flash = false;
+        const onFrame = () => {
+            const calib = calibRef.current;
+            const now = performance.now() - calib.originMs;
+            if (calib.calibrator.isPhaseFinished(now)) {
+                if (calibPhase === 'AUDIO') startVisualPhase();
+                else finishCalibration();
+                return;
+            }
+            const nextFlash = calib.calibrator.isFlashOn(now);
+            if (nextFlash !== flash) {
+                flash = nextFlash;
+                setIsFlashOn(flash);
+            }
+            frameId = requestAnimationFrame(onFrame);
+        };
+
+        window.addEventListener('keydown', handleTap);
+        frameId = requestAnimationFrame(onFrame);
+        return () => {
+            window.removeEventListener('keydown', handleTap);
+            cancelAnimationFrame(frameId);
+        };
+    }, [calibPhase]);
+
 
     // --------------------------------------------------------
     // F. UI 要素
@@ -350,6 +468,22 @@ const App = () => {
                         <p className="text-xs text-gray-500 mt-1">正の値: 早く判定 (音源を遅く聞く/映像を早く見る場合)</p>
                     </div>
 
+                    {/* 遅延キャリブレーション */}
+                    <div className="mb-4">
+                        <label className="block text-gray-700 font-semibold mb-2">遅延キャリブレーション (表示オフセット: {(config.visualOffset || 0).toFixed(0)} ms)</label>
+                        <button
+                            onClick={startCalibration}
+                            className="w-full px-4 py-2 bg-purple-500 text-white font-bold rounded-lg hover:bg-purple-600 transition"
+                            disabled={isLoading || isBinding !== null || calibPhase !== 'IDLE'}
+                        >
+                            {calibPhase === 'IDLE' ? 'キャリブレーション開始' : (calibPhase === 'AUDIO' ? '音に合わせてタップ...' : 'フラッシュに合わせてタップ...')}
+                        </button>
+                        {calibPhase === 'VISUAL' && (
+                            <div className={`mt-2 h-16 rounded-lg ${isFlashOn ? 'bg-white border-4 border-purple-500' : 'bg-gray-800'}`}></div>
+                        )}
+                        <p className="text-xs text-gray-500 mt-1">クリック音 → フラッシュの順にタップし、判定オフセットと表示オフセットを自動で設定します</p>
+                    </div>
+
                     {/* ★ キーバインド設定パネル (新規) */}
                     <h3 className="text-xl font-semibold text-gray-700 mt-6 mb-3 border-t pt-4">キーバインド設定 (7KEY)</h3>
                     <div className="space-y-2">
@@ -0,0 +1,414 @@
+#include "AudioMixer.h"
+
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <iostream>
+
+namespace {
+
+// リサンプル時の作業バッファ（素材フレーム数）
+constexpr int RESAMPLE_SCRATCH_FRAMES = 2048;
+constexpr int RESAMPLE_MARGIN = RESAMPLER_TAPS + 2;
+
+// [a, b) の素材をステレオ float に展開する（範囲外・readable 以降は 0）
+void DecodeRange(const SampleBuffer& buf, int64_t a, int64_t b, int readable, float* out)
+{
+    std::fill(out, out + (size_t)(b - a) * 2, 0.0f);
+    const int64_t lo = std::max<int64_t>(a, 0);
+    const int64_t hi = std::min<int64_t>(b, std::min(readable, buf.frames));
+    if (hi > lo)
+        MixSampleFrames(buf, (int)lo, (int)(hi - lo), 1.0f, 1.0f, out + (lo - a) * 2);
+}
+
+} // namespace
+
+// --------------------------------------------------------
+// コンストラクタ
+// --------------------------------------------------------
+AudioMixer::AudioMixer(int max_voices)
+    : resample_scratch((size_t)RESAMPLE_SCRATCH_FRAMES * 2),
+      voices(std::max(1, max_voices))
+{
+}
+
+// --------------------------------------------------------
+// ゲームスレッド側
+// --------------------------------------------------------
+bool AudioMixer::Play(const SampleBuffer* sample, float gain)
+{
+    if (!sample) return false;
+
+    Command cmd;
+    cmd.type = CommandType::PLAY;
+    cmd.sample = sample;
+    cmd.gain = gain;
+    return commands.Push(cmd);
+}
+
+bool AudioMixer::Schedule(const SampleBuffer* sample, int64_t frame, float gain)
+{
+    if (!sample) return false;
+
+    Command cmd;
+    cmd.type = CommandType::SCHEDULE;
+    cmd.sample = sample;
+    cmd.frame = frame;
+    cmd.gain = gain;
+    return commands.Push(cmd);
+}
+
+void AudioMixer::StopAll()
+{
+    Command cmd;
+    cmd.type = CommandType::STOP_ALL;
+    commands.Push(cmd);
+}
+
+void AudioMixer::SetPlaybackRate(double rate, bool keep_pitch, int64_t anchor_frame)
+{
+    Command cmd;
+    cmd.type = CommandType::SET_RATE;
+    cmd.frame = anchor_frame;
+    cmd.rate = std::clamp(rate, MIN_PLAYBACK_RATE, MAX_PLAYBACK_RATE);
+    cmd.preserve_pitch = keep_pitch;
+    commands.Push(cmd);
+}
+
+void AudioMixer::ArmLane(int lane, const SampleBuffer* sample, float gain)
+{
+    if (lane < 0 || lane >= MIXER_LANE_COUNT) return;
+
+    // 全区間無音のサンプルはアームしない（打鍵しても何も鳴らない）
+    if (sample && sample->frames == 0) sample = nullptr;
+
+    lanes[lane].armed_gain.store(gain, std::memory_order_relaxed);
+    lanes[lane].armed.store(sample, std::memory_order_relaxed);
+}
+
+void AudioMixer::TriggerLane(int lane, int64_t stream_frame)
+{
+    if (lane < 0 || lane >= MIXER_LANE_COUNT) return;
+
+    LaneSlot& slot = lanes[lane];
+    const uint32_t seq = slot.trigger_seq.load(std::memory_order_relaxed);
+
+    // 未消化の打鍵が溢れる場合は捨てる（1 ブロック内で PENDING 回を超える連打）
+    if (seq - slot.consumed_seq.load(std::memory_order_acquire) >= LaneSlot::PENDING) return;
+
+    slot.pending[seq % LaneSlot::PENDING] = slot.armed.load(std::memory_order_relaxed);
+    slot.pending_gain[seq % LaneSlot::PENDING] = slot.armed_gain.load(std::memory_order_relaxed);
+    slot.pending_frame[seq % LaneSlot::PENDING] = stream_frame;
+    slot.trigger_seq.store(seq + 1, std::memory_order_release);
+}
+
+void AudioMixer::PlayStem(const BGMStem* bgm_stem, int64_t origin_stream_frame)
+{
+    Command cmd;
+    cmd.type = CommandType::PLAY_STEM;
+    cmd.stem = bgm_stem;
+    cmd.frame = origin_stream_frame;
+    commands.Push(cmd);
+}
+
+void AudioMixer::StopStem()
+{
+    Command cmd;
+    cmd.type = CommandType::STOP_STEM;
+    commands.Push(cmd);
+}
+
+// --------------------------------------------------------
+// オーディオスレッド側
+// --------------------------------------------------------
+void AudioMixer::ApplyCommands()
+{
+    Command cmd;
+    while (commands.Pop(cmd))
+    {
+        if (cmd.type == CommandType::STOP_ALL)
+        {
+            for (auto& v : voices) v.active = false;
+            for (auto& slot : lanes)
+                for (auto& v : slot.voices) v.active = false;
+            stem = nullptr;
+            continue;
+        }
+
+        if (cmd.type == CommandType::PLAY_STEM)
+        {
+            stem = cmd.stem;
+            stem_origin = cmd.frame;
+            stem_src_origin = 0.0;
+            continue;
+        }
+
+        if (cmd.type == CommandType::STOP_STEM)
+        {
+            stem = nullptr;
+            continue;
+        }
+
+        if (cmd.type == CommandType::SET_RATE)
+        {
+            // 鳴り始めたステムは切り替え位置を起点に付け替える（新しい速度を先頭から掛け直すと位置が飛ぶ）
+            // 切り替え位置はゲームクロックと共有するアンカー。このブロックより前なら、その差の分だけ
+            // ステムが詰まる／戻るが、チャート時刻との対応は保たれる
+            const int64_t anchor = cmd.frame >= 0 ? cmd.frame : stream_frame;
+            if (anchor > stem_origin)
+            {
+                stem_src_origin += (double)(anchor - stem_origin) * playback_rate;
+                stem_origin = anchor;
+            }
+            playback_rate = cmd.rate;
+            preserve_pitch = cmd.preserve_pitch;
+            continue;
+        }
+
+        // 全区間無音のサンプルはボイスを消費しない
+        if (cmd.sample->frames == 0)
+            continue;
+
+        // バッファ先頭からの遅延分だけ負の位置から始める（無音区間として扱われる）
+        int64_t delay = 0;
+        if (cmd.type == CommandType::SCHEDULE)
+        {
+            delay = cmd.frame - stream_frame;
+            if (delay < 0)
+            {
+                late_schedule_count.fetch_add(1, std::memory_order_relaxed);
+                delay = 0;
+            }
+        }
+
+        StartVoice(AllocateVoice(), cmd.sample, cmd.gain, delay);
+    }
+}
+
+// --------------------------------------------------------
+// レーン打鍵 : アーム時点で解決済みのサンプルを予約ボイスで鳴らす
+//  打鍵のストリームフレームが分かっていれば、ブロック内のその位置から鳴らす
+//  （ブロック先頭に揃えると、打鍵から発音までがブロック長の分だけばらつく）
+// --------------------------------------------------------
+void AudioMixer::ApplyLaneTriggers()
+{
+    for (LaneSlot& slot : lanes)
+    {
+        const uint32_t seq = slot.trigger_seq.load(std::memory_order_acquire);
+        uint32_t consumed = slot.consumed_seq.load(std::memory_order_relaxed);
+
+        while (consumed != seq)
+        {
+            const uint32_t i = consumed % LaneSlot::PENDING;
+            if (slot.pending[i])
+            {
+                const int64_t at = slot.pending_frame[i];
+                const int64_t delay = at < 0 ? 0 : std::max<int64_t>(0, at - stream_frame);
+                StartVoice(slot.voices[slot.next_voice], slot.pending[i], slot.pending_gain[i], delay);
+                slot.next_voice = (slot.next_voice + 1) % MIXER_LANE_VOICES;
+            }
+            ++consumed;
+        }
+
+        slot.consumed_seq.store(consumed, std::memory_order_release);
+    }
+}
+
+void AudioMixer::StartVoice(MixerVoice& v, const SampleBuffer* sample, float gain, int64_t delay)
+{
+    v.sample = sample;
+    v.position = -sample->head_offset - (int)std::min<int64_t>(delay, INT32_MAX / 2);
+    v.gain_l = gain;
+    v.gain_r = gain;
+    v.serial = next_serial++;
+    v.active = true;
+
+    // 速度変更中、または出力とレートが異なる素材はリサンプル再生
+    const double rate_ratio = (double)sample->sample_rate / MIX_SAMPLE_RATE;
+    v.resampled = playback_rate != 1.0 || sample->sample_rate != MIX_SAMPLE_RATE;
+    if (v.resampled)
+    {
+        v.step = rate_ratio * playback_rate;
+        v.pitch_step = preserve_pitch ? rate_ratio : v.step;
+
+        // 先頭トリム分は出力フレームに換算して待機し、端数は素材位置で吸収する
+        const int64_t wait = (int64_t)std::ceil(sample->head_offset / v.step);
+        v.out_pos = -(delay + wait);
+        v.src_origin = wait * v.step - sample->head_offset;
+    }
+}
+
+// 空きボイスが無ければ最も古いボイスを奪う
+MixerVoice& AudioMixer::AllocateVoice()
+{
+    MixerVoice* oldest = &voices[0];
+    for (auto& v : voices)
+    {
+        if (!v.active) return v;
+        if ((int32_t)(v.serial - oldest->serial) < 0) oldest = &v;
+    }
+    return *oldest;
+}
+
+void AudioMixer::Mix(float* out, int frames)
+{
+    ApplyCommands();
+    ApplyLaneTriggers();
+
+    std::fill(out, out + (size_t)frames * MIX_CHANNELS, 0.0f);
+
+    int active = 0;
+    for (auto& v : voices)
+        if (v.active && MixVoice(v, out, frames)) ++active;
+
+    for (auto& slot : lanes)
+        for (auto& v : slot.voices)
+            if (v.active && MixVoice(v, out, frames)) ++active;
+
+    // BGM ステムは 1 ストリームとして加算する
+    if (stem && playback_rate == 1.0)
+    {
+        const int64_t pos = std::llround(stem_src_origin) + (stream_frame - stem_origin);
+        int underrun = stem->MixInto(pos, frames, 1.0f, out);
+        if (underrun > 0)
+            stem_underrun_frames.fetch_add(underrun, std::memory_order_relaxed);
+    }
+    else if (stem)
+    {
+        // 速度変更中はステムもボイスと同じリサンプラで鳴らす
+        int64_t pos = stream_frame - stem_origin;
+        MixResampled(stem->GetBuffer(), stem->GetRenderedFrames(), pos, stem_src_origin, playback_rate,
+                     preserve_pitch ? 1.0 : playback_rate, preserve_pitch, 1.0f, 1.0f, out, frames);
+    }
+
+    stream_frame += frames;
+    stream_frame_published.store(stream_frame, std::memory_order_release);
+    active_voice_count.store(active, std::memory_order_relaxed);
+}
+
+bool AudioMixer::MixVoice(MixerVoice& v, float* out, int frames)
+{
+    if (v.resampled)
+    {
+        const bool granular = v.pitch_step != v.step;
+        if (MixResampled(*v.sample, v.sample->frames, v.out_pos, v.src_origin, v.step, v.pitch_step,
+                         granular, v.gain_l, v.gain_r, out, frames))
+            v.active = false;
+        return v.active;
+    }
+
+    int out_offset = 0;
+    int remaining = frames;
+
+    // 先頭トリム分の無音区間はスキップするだけ
+    if (v.position < 0)
+    {
+        int skip = std::min(-v.position, remaining);
+        v.position += skip;
+        out_offset += skip;
+        remaining -= skip;
+    }
+
+    int n = std::min(remaining, v.sample->frames - v.position);
+    if (n > 0)
+    {
+        MixSampleFrames(*v.sample, v.position, n, v.gain_l, v.gain_r,
+                        out + (size_t)out_offset * MIX_CHANNELS);
+        v.position += n;
+    }
+
+    if (v.position >= v.sample->frames)
+        v.active = false;
+    return v.active;
+}
+
+// --------------------------------------------------------
+// リサンプル再生
+//  ・通常: 素材位置 = src_origin + out_pos * step
+//  ・音程維持: ホップ毎に開始するグレイン j を、素材位置
+//    src_origin + j * HOP * step から pitch_step で読み出し、Hann 窓で重ねる
+//    （グレイン 0 の前半は窓を掛けずアタックを保つ）
+// --------------------------------------------------------
+void AudioMixer::ResampleSegment(const SampleBuffer& buf, int readable, double pos, double step, int count,
+                                 const float* window, float gain_l, float gain_r, float* out)
+{
+    const int64_t a = (int64_t)std::floor(pos) - (RESAMPLER_TAPS / 2 - 1);
+    const int64_t b = (int64_t)std::floor(pos + (count - 1) * step) + RESAMPLER_TAPS / 2 + 1;
+
+    DecodeRange(buf, a, b, readable, resample_scratch.data());
+    ResampleMix(resampler.Select(step), resample_scratch.data(), pos - a, step, count,
+                window, gain_l, gain_r, out);
+}
+
+bool AudioMixer::MixResampled(const SampleBuffer& buf, int readable, int64_t& out_pos, double src_origin,
+                              double step, double pitch_step, bool granular,
+                              float gain_l, float gain_r, float* out, int frames)
+{
+    int i = 0;
+
+    // 発音前の待機区間
+    if (out_pos < 0)
+    {
+        const int skip = (int)std::min<int64_t>(-out_pos, frames);
+        out_pos += skip;
+        i += skip;
+    }
+
+    const double read_step = granular ? pitch_step : step;
+    const int max_chunk = std::max(1, (int)((RESAMPLE_SCRATCH_FRAMES - RESAMPLE_MARGIN) / read_step));
+
+    while (i < frames)
+    {
+        int n = std::min(frames - i, max_chunk);
+        float* dst = out + (size_t)i * MIX_CHANNELS;
+
+        if (!granular)
+        {
+            const double pos = src_origin + out_pos * step;
+            if (pos >= buf.frames + RESAMPLER_TAPS / 2)
+                return true;
+
+            ResampleSegment(buf, readable, pos, step, n, nullptr, gain_l, gain_r, dst);
+        }
+        else
+        {
+            const int64_t j = out_pos / RESAMPLER_GRAIN_HOP;
+            const int off = (int)(out_pos - j * RESAMPLER_GRAIN_HOP);
+            n = std::min(n, RESAMPLER_GRAIN_HOP - off);
+
+            // 直前のグレインの読み出し開始位置が終端を越えたら終了
+            if (j >= 1 && src_origin + (j - 1) * RESAMPLER_GRAIN_HOP * step >= buf.frames)
+                return true;
+
+            const float* window = resampler.GrainWindow();
+
+            // グレイン j（立ち上がり側）
+            const double pos_a = src_origin + j * RESAMPLER_GRAIN_HOP * step + off * pitch_step;
+            ResampleSegment(buf, readable, pos_a, pitch_step, n, j == 0 ? nullptr : window + off,
+                            gain_l, gain_r, dst);
+
+            // グレイン j-1（減衰側）
+            if (j >= 1)
+            {
+                const double pos_b = src_origin + (j - 1) * RESAMPLER_GRAIN_HOP * step
+                                   + (off + RESAMPLER_GRAIN_HOP) * pitch_step;
+                ResampleSegment(buf, readable, pos_b, pitch_step, n, window + off + RESAMPLER_GRAIN_HOP,
+                                gain_l, gain_r, dst);
+            }
+        }
+
+        out_pos += n;
+        i += n;
+    }
+
+    return false;
+}
+
+void ConvertMixToS16(const float* in, int16_t* out, int samples)
+{
+    for (int i = 0; i < samples; ++i)
+    {
+        float v = std::clamp(in[i], -1.0f, 1.0f);
+        out[i] = (int16_t)std::lrint(v * 32767.0f);
+    }
+}
@@ -0,0 +1,202 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <vector>
+#include "SampleStore.h"
+#include "BGMStem.h"
+#include "Resampler.h"
+#include "SPSCQueue.h"
+
+// ------------------------------------------------------------
+// ソフトウェアミキサー
+//  ・Play() はゲームスレッドから、Mix() はオーディオコールバックから呼ぶ
+//  ・スレッド間はロックフリーのコマンドキューでのみ受け渡す
+//  ・サンプルは SampleStore の形式（PCM / BLOCK_I16）のまま直接加算する
+//  ・時間軸は「ストリームフレーム」（Mix() が出力した累計フレーム数）
+//    Schedule() は指定フレームちょうどから発音する（バッファ内オフセット単位）
+//  ・再生速度（練習モード 0.5〜1.5 倍）やレートの異なる素材は
+//    ポリフェーズリサンプラで補間しながら加算する
+// ------------------------------------------------------------
+
+// 発音中のボイス
+struct MixerVoice {
+    const SampleBuffer* sample = nullptr;
+    int position = 0;          // 負値は先頭トリム分の無音区間
+    float gain_l = 1.0f;
+    float gain_r = 1.0f;
+    uint32_t serial = 0;       // 発音順（ボイススチール用）
+    bool active = false;
+
+    // リサンプル再生（速度変更 / 素材レート != 出力レート）
+    bool resampled = false;
+    int64_t out_pos = 0;       // 発音からの出力フレーム数（負値は待機）
+    double src_origin = 0.0;   // out_pos = 0 に対応する素材位置
+    double step = 1.0;         // 出力 1 フレームあたりの素材の進み（時間方向）
+    double pitch_step = 1.0;   // 音程維持モードでのグレイン内の読み出し速度
+};
+
+// 事前準備（アーム）できるレーン数（1P/2P 各 9 レーン）
+constexpr int MIXER_LANE_COUNT = 18;
+
+// 1 レーンで同時に鳴らせる打鍵音の数（連打時に直前の音を切らないため）
+constexpr int MIXER_LANE_VOICES = 2;
+
+class AudioMixer
+{
+public:
+    explicit AudioMixer(int max_voices = 128);
+
+    // -------------------------------------
+    // ゲームスレッド側 API
+    // -------------------------------------
+
+    /**
+     * サンプルを即時発音する（次の Mix() の先頭から）
+     * @return キューに積めた場合 true
+     */
+    bool Play(const SampleBuffer* sample, float gain = 1.0f);
+
+    /**
+     * サンプルを指定ストリームフレームから発音する
+     * 既に過ぎたフレームを指定した場合は次の Mix() 先頭から鳴らす
+     * @return キューに積めた場合 true
+     */
+    bool Schedule(const SampleBuffer* sample, int64_t stream_frame, float gain = 1.0f);
+
+    /**
+     * 全ボイスを停止する
+     */
+    void StopAll();
+
+    /**
+     * 再生速度を設定する（次に発音するボイスから適用。再生中のステムは anchor_frame から速度が変わる）
+     * チャート時刻 t のイベントはストリーム上では t / rate の位置で鳴る
+     * @param preserve_pitch true ならグレイン重ね合わせで音程を保ったまま伸縮する
+     * @param anchor_frame   ステムの速度を切り替えるストリームフレーム（-1 なら適用したブロックの先頭）
+     *                       ゲームクロック・スケジューラと同じフレームを渡すと、ステムとチャート時刻がずれない
+     */
+    void SetPlaybackRate(double rate, bool preserve_pitch = false, int64_t anchor_frame = -1);
+
+    /**
+     * 事前ミックス済み BGM ステムの再生を開始する（ボイスは消費しない）
+     * @param origin_stream_frame ステム先頭（チャート 0ms）を鳴らすストリームフレーム
+     */
+    void PlayStem(const BGMStem* stem, int64_t origin_stream_frame);
+
+    /**
+     * BGM ステムの再生を停止する
+     */
+    void StopStem();
+
+    /**
+     * レーンの次の打鍵音をアームする（ゲームスレッドから。キューを通さない）
+     * @param sample nullptr ならそのレーンの打鍵では何も鳴らさない
+     */
+    void ArmLane(int lane, const SampleBuffer* sample, float gain = 1.0f);
+
+    /**
+     * アーム済みの打鍵音を鳴らす
+     * 検索もボイス確保も行わず、レーン専用スロットへの書き込みとアトミック加算のみ
+     * @param stream_frame 発音するストリームフレーム（打鍵時刻から換算したもの）
+     *                     Mix() はブロック内のその位置から鳴らす。負値・過ぎたフレームならブロックの先頭から
+     */
+    void TriggerLane(int lane, int64_t stream_frame = -1);
+
+    int GetActiveVoiceCount() const { return active_voice_count.load(std::memory_order_relaxed); }
+
+    // これまでに Mix() が出力した累計フレーム数
+    int64_t GetStreamFrame() const { return stream_frame_published.load(std::memory_order_acquire); }
+
+    // 予定時刻を過ぎてから届いた Schedule() の数
+    int GetLateScheduleCount() const { return late_schedule_count.load(std::memory_order_relaxed); }
+
+    // ステムのレンダリングが追いつかず無音になった累計フレーム数
+    int64_t GetStemUnderrunFrames() const { return stem_underrun_frames.load(std::memory_order_relaxed); }
+
+    // -------------------------------------
+    // オーディオスレッド側 API
+    // -------------------------------------
+
+    /**
+     * frames 分をミックスして out（ステレオ float・インターリーブ）に上書きする
+     */
+    void Mix(float* out, int frames);
+
+private:
+    enum class CommandType { PLAY, SCHEDULE, STOP_ALL, PLAY_STEM, STOP_STEM, SET_RATE };
+
+    struct Command {
+        CommandType type = CommandType::PLAY;
+        const SampleBuffer* sample = nullptr;
+        const BGMStem* stem = nullptr;
+        int64_t frame = 0;
+        float gain = 1.0f;
+        double rate = 1.0;
+        bool preserve_pitch = false;
+    };
+
+    // レーン毎の打鍵スロット（ゲームスレッドが書き、オーディオスレッドが読む）
+    struct LaneSlot {
+        static constexpr uint32_t PENDING = 4;          // 1 ブロック内で受け付ける打鍵数
+
+        std::atomic<const SampleBuffer*> armed{nullptr};
+        std::atomic<float> armed_gain{1.0f};
+        const SampleBuffer* pending[PENDING] = {};      // 打鍵時点のアーム内容
+        float pending_gain[PENDING] = {};
+        int64_t pending_frame[PENDING] = {};            // 発音するストリームフレーム（負値は即時）
+        std::atomic<uint32_t> trigger_seq{0};
+        std::atomic<uint32_t> consumed_seq{0};
+        MixerVoice voices[MIXER_LANE_VOICES];           // 予約済みボイス（オーディオスレッドのみ）
+        int next_voice = 0;
+    };
+
+    void ApplyCommands();
+    void ApplyLaneTriggers();
+    MixerVoice& AllocateVoice();
+
+    // ボイスを sample の先頭（delay フレーム後）から鳴るよう初期化する
+    void StartVoice(MixerVoice& v, const SampleBuffer* sample, float gain, int64_t delay);
+
+    // ボイス 1 つを frames 分加算する。鳴り終えたら false
+    bool MixVoice(MixerVoice& v, float* out, int frames);
+
+    /**
+     * リサンプル再生で frames 分を out に加算する
+     * @param readable 読み出してよい素材フレーム数（ステムのレンダリング済み位置など）
+     * @return 素材の終端まで鳴らし終えたら true
+     */
+    bool MixResampled(const SampleBuffer& buf, int readable, int64_t& out_pos, double src_origin,
+                      double step, double pitch_step, bool granular,
+                      float gain_l, float gain_r, float* out, int frames);
+
+    // pos から step 刻みで count フレームを補間して加算（窓は任意）
+    void ResampleSegment(const SampleBuffer& buf, int readable, double pos, double step, int count,
+                         const float* window, float gain_l, float gain_r, float* out);
+
+    ResamplerBank resampler;
+    std::vector<float> resample_scratch;
+    double playback_rate = 1.0;
+    bool preserve_pitch = false;
+
+    std::vector<MixerVoice> voices;
+    LaneSlot lanes[MIXER_LANE_COUNT];
+    SPSCQueue<Command, 1024> commands;
+    uint32_t next_serial = 0;
+    std::atomic<int> active_voice_count{0};
+
+    // ストリーム位置（stream_frame はオーディオスレッドのみが触る）
+    int64_t stream_frame = 0;
+    std::atomic<int64_t> stream_frame_published{0};
+    std::atomic<int> late_schedule_count{0};
+
+    // BGM ステム（オーディオスレッドのみが触る）
+    //  ステムの位置 = stem_src_origin + (stream_frame - stem_origin) * playback_rate
+    //  速度変更時は現在位置で付け替えて連続させる
+    const BGMStem* stem = nullptr;
+    int64_t stem_origin = 0;
+    double stem_src_origin = 0.0;
+    std::atomic<int64_t> stem_underrun_frames{0};
+};
+
+// float ミックス結果を 16bit にクリップ変換する（SDL の S16 デバイス向け）
+void ConvertMixToS16(const float* in, int16_t* out, int samples);
@@ -0,0 +1,223 @@
+#include "BGACompositor.h"
+
+#include <algorithm>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define REBMS_SSE2 1
+#endif
+
+namespace {
+
+constexpr uint32_t RGB_MASK = 0x00FFFFFFu;
+constexpr uint32_t OPAQUE_BLACK = 0xFF000000u;
+
+BGARect Union(const BGARect& a, const BGARect& b)
+{
+    if (a.Empty()) return b;
+    if (b.Empty()) return a;
+    return { std::min(a.x0, b.x0), std::min(a.y0, b.y0), std::max(a.x1, b.x1), std::max(a.y1, b.y1) };
+}
+
+// (s*a + d*(255-a)) / 255 を 8bit 精度で丸める
+inline uint32_t BlendChannel(uint32_t s, uint32_t d, uint32_t a)
+{
+    uint32_t t = s * a + d * (255 - a) + 128;
+    return (t + (t >> 8)) >> 8;
+}
+
+} // namespace
+
+// --------------------------------------------------------
+// 行カーネル（スカラー）
+// --------------------------------------------------------
+void CompositeKeyRowScalar(uint32_t* dst, const uint32_t* src, int count)
+{
+    for (int i = 0; i < count; ++i)
+        if (src[i] & RGB_MASK) dst[i] = src[i] | OPAQUE_BLACK;
+}
+
+void CompositeKeyAlphaRowScalar(uint32_t* dst, const uint32_t* src, int count)
+{
+    for (int i = 0; i < count; ++i)
+    {
+        const uint32_t s = src[i];
+        const uint32_t a = (s & RGB_MASK) ? (s >> 24) : 0;
+        const uint32_t d = dst[i];
+
+        const uint32_t r = BlendChannel(s & 0xFF, d & 0xFF, a);
+        const uint32_t g = BlendChannel((s >> 8) & 0xFF, (d >> 8) & 0xFF, a);
+        const uint32_t b = BlendChannel((s >> 16) & 0xFF, (d >> 16) & 0xFF, a);
+        dst[i] = r | (g << 8) | (b << 16) | OPAQUE_BLACK;
+    }
+}
+
+// --------------------------------------------------------
+// 行カーネル（SSE2 : 4 ピクセル単位）
+// --------------------------------------------------------
+void CompositeKeyRow(uint32_t* dst, const uint32_t* src, int count)
+{
+    int i = 0;
+#ifdef REBMS_SSE2
+    const __m128i rgb_mask = _mm_set1_epi32((int)RGB_MASK);
+    const __m128i opaque = _mm_set1_epi32((int)OPAQUE_BLACK);
+    const __m128i zero = _mm_setzero_si128();
+
+    for (; i + 4 <= count; i += 4)
+    {
+        const __m128i s = _mm_loadu_si128((const __m128i*)(src + i));
+        const __m128i d = _mm_loadu_si128((const __m128i*)(dst + i));
+
+        // 透過ピクセルは 1
+        const __m128i key = _mm_cmpeq_epi32(_mm_and_si128(s, rgb_mask), zero);
+        const __m128i out = _mm_or_si128(_mm_and_si128(key, d),
+                                         _mm_andnot_si128(key, _mm_or_si128(s, opaque)));
+        _mm_storeu_si128((__m128i*)(dst + i), out);
+    }
+#endif
+    CompositeKeyRowScalar(dst + i, src + i, count - i);
+}
+
+void CompositeKeyAlphaRow(uint32_t* dst, const uint32_t* src, int count)
+{
+    int i = 0;
+#ifdef REBMS_SSE2
+    const __m128i rgb_mask = _mm_set1_epi32((int)RGB_MASK);
+    const __m128i opaque = _mm_set1_epi32((int)OPAQUE_BLACK);
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i c255 = _mm_set1_epi16(255);
+    const __m128i c128 = _mm_set1_epi16(128);
+
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128i s = _mm_loadu_si128((const __m128i*)(src + i));
+        const __m128i d = _mm_loadu_si128((const __m128i*)(dst + i));
+
+        // 透過色はアルファ 0 として扱う
+        const __m128i key = _mm_cmpeq_epi32(_mm_and_si128(s, rgb_mask), zero);
+        s = _mm_andnot_si128(key, s);
+
+        // アルファを各チャンネルへ複製（16bit x 8）
+        __m128i a = _mm_srli_epi32(s, 24);
+        a = _mm_or_si128(a, _mm_slli_epi32(a, 16));
+        const __m128i a_lo = _mm_unpacklo_epi32(a, a);
+        const __m128i a_hi = _mm_unpackhi_epi32(a, a);
+
+        auto blend = [&](__m128i s16, __m128i d16, __m128i a16) {
+            __m128i t = _mm_add_epi16(_mm_mullo_epi16(s16, a16),
+                                      _mm_mullo_epi16(d16, _mm_sub_epi16(c255, a16)));
+            t = _mm_add_epi16(t, c128);
+            return _mm_srli_epi16(_mm_add_epi16(t, _mm_srli_epi16(t, 8)), 8);
+        };
+
+        const __m128i lo = blend(_mm_unpacklo_epi8(s, zero), _mm_unpacklo_epi8(d, zero), a_lo);
+        const __m128i hi = blend(_mm_unpackhi_epi8(s, zero), _mm_unpackhi_epi8(d, zero), a_hi);
+
+        _mm_storeu_si128((__m128i*)(dst + i), _mm_or_si128(_mm_packus_epi16(lo, hi), opaque));
+    }
+#endif
+    CompositeKeyAlphaRowScalar(dst + i, src + i, count - i);
+}
+
+// --------------------------------------------------------
+// BGACompositor
+// --------------------------------------------------------
+BGACompositor::BGACompositor(int width, int height)
+{
+    output.width = width;
+    output.height = height;
+    output.pixels.assign((size_t)width * height, OPAQUE_BLACK);
+}
+
+BGARect BGACompositor::Extent(const BGAImage* img) const
+{
+    if (!img || img->pixels.empty()) return {};
+    return { 0, 0, std::min(img->width, output.width), std::min(img->height, output.height) };
+}
+
+bool BGACompositor::Compose(const BGAImage* base, const BGAImage* layer, const BGAImage* poor, bool show_poor)
+{
+    const InputKey kb = KeyOf(base), kl = KeyOf(layer), kp = KeyOf(poor);
+    const bool poor_visible = show_poor && poor;
+    const bool last_poor_visible = last_show_poor && last_poor.image;
+
+    dirty = {};
+
+    if (!valid)
+    {
+        dirty = { 0, 0, output.width, output.height };
+    }
+    else
+    {
+        // 見えている入力が変わった場合のみ、新旧の範囲を作り直す
+        auto touch = [this](const InputKey& before, const InputKey& after) {
+            if (before != after)
+                dirty = Union(dirty, Union(Extent(before.image), Extent(after.image)));
+        };
+
+        if (poor_visible != last_poor_visible)
+        {
+            dirty = Union(Extent(poor_visible ? poor : last_poor.image),
+                          Union(Union(Extent(base), Extent(layer)),
+                                Union(Extent(last_base.image), Extent(last_layer.image))));
+        }
+        else if (poor_visible)
+        {
+            touch(last_poor, kp);
+        }
+        else
+        {
+            touch(last_base, kb);
+            touch(last_layer, kl);
+        }
+    }
+
+    last_base = kb;
+    last_layer = kl;
+    last_poor = kp;
+    last_show_poor = show_poor;
+    valid = true;
+
+    if (dirty.Empty())
+    {
+        ++skip_count;
+        return false;
+    }
+
+    ComposeRect(dirty, base, layer, poor, show_poor);
+    ++compose_count;
+    return true;
+}
+
+void BGACompositor::ComposeRect(const BGARect& r, const BGAImage* base, const BGAImage* layer,
+                                const BGAImage* poor, bool show_poor)
+{
+    const BGAImage* bottom = (show_poor && poor) ? poor : base;
+    const BGAImage* top    = (show_poor && poor) ? nullptr : layer;
+
+    for (int y = r.y0; y < r.y1; ++y)
+    {
+        uint32_t* dst = &output.pixels[(size_t)y * output.width + r.x0];
+        const int n = r.x1 - r.x0;
+
+        // 下地 : BASE（画像外は黒）
+        int copied = 0;
+        if (bottom && y < bottom->height)
+        {
+            copied = std::max(0, std::min(n, bottom->width - r.x0));
+            const uint32_t* src = &bottom->pixels[(size_t)y * bottom->width + r.x0];
+            if (copied > 0) std::memcpy(dst, src, (size_t)copied * sizeof(uint32_t));
+        }
+        std::fill(dst + copied, dst + n, OPAQUE_BLACK);
+
+        // LAYER : 黒を透過して重ねる
+        if (top && y < top->height)
+        {
+            const int m = std::max(0, std::min(n, top->width - r.x0));
+            const uint32_t* src = &top->pixels[(size_t)y * top->width + r.x0];
+            if (top->has_alpha) CompositeKeyAlphaRow(dst, src, m);
+            else                CompositeKeyRow(dst, src, m);
+        }
+    }
+}
@@ -0,0 +1,81 @@
+#pragma once
+#include <cstdint>
+#include "BGAScheduler.h"
+
+// ------------------------------------------------------------
+// BGA 合成（CPU）
+//  ・BASE(04) の上に LAYER(07) を黒（RGB=0）を透過色として重ね、
+//    ミス時は POOR(06) に差し替えた 1 枚の出力画像を作る
+//  ・LAYER が半透明ピクセルを持つ場合はアルファブレンドする
+//  ・入力（画像と version）が前回と同じなら何もしない。変化した場合も
+//    変化した画像が覆う範囲（ダーティ領域）だけを作り直す
+//  ・行単位のカーネルは SSE2 版とスカラー版があり、結果は一致する
+// ------------------------------------------------------------
+
+constexpr int BGA_OUTPUT_SIZE = 256;
+
+struct BGARect {
+    int x0 = 0, y0 = 0, x1 = 0, y1 = 0;    // [x0, x1) × [y0, y1)
+    bool Empty() const { return x1 <= x0 || y1 <= y0; }
+};
+
+class BGACompositor
+{
+public:
+    explicit BGACompositor(int width = BGA_OUTPUT_SIZE, int height = BGA_OUTPUT_SIZE);
+
+    /**
+     * 現在の BGA を合成する
+     * @param show_poor ミス表示中（poor があれば BASE/LAYER の代わりに表示）
+     * @return 出力が更新された場合 true
+     */
+    bool Compose(const BGAImage* base, const BGAImage* layer, const BGAImage* poor, bool show_poor);
+
+    // 次の Compose で全面を作り直す
+    void Invalidate() { valid = false; }
+
+    const BGAImage& GetOutput() const { return output; }
+
+    // 直前の Compose で書き換えた範囲（更新なしなら空）
+    const BGARect& GetDirtyRect() const { return dirty; }
+
+    int GetComposeCount() const { return compose_count; }
+    int GetSkipCount() const { return skip_count; }
+
+private:
+    struct InputKey {
+        const BGAImage* image = nullptr;
+        uint64_t version = 0;
+        bool operator==(const InputKey& o) const { return image == o.image && version == o.version; }
+        bool operator!=(const InputKey& o) const { return !(*this == o); }
+    };
+
+    static InputKey KeyOf(const BGAImage* img) { return { img, img ? img->version : 0 }; }
+
+    // 画像が出力上で覆う範囲
+    BGARect Extent(const BGAImage* img) const;
+
+    void ComposeRect(const BGARect& r, const BGAImage* base, const BGAImage* layer, const BGAImage* poor, bool show_poor);
+
+    BGAImage output;
+    BGARect dirty;
+    bool valid = false;
+
+    InputKey last_base, last_layer, last_poor;
+    bool last_show_poor = false;
+
+    int compose_count = 0;
+    int skip_count = 0;
+};
+
+// ------------------------------------------------------------
+// 行カーネル（RGBA8, A は最上位バイト）
+// ------------------------------------------------------------
+
+// 透過色（RGB=0）以外の src を dst へコピー
+void CompositeKeyRow(uint32_t* dst, const uint32_t* src, int count);
+void CompositeKeyRowScalar(uint32_t* dst, const uint32_t* src, int count);
+
+// 透過色は無視し、それ以外は src のアルファで dst へ重ねる（出力は不透明）
+void CompositeKeyAlphaRow(uint32_t* dst, const uint32_t* src, int count);
+void CompositeKeyAlphaRowScalar(uint32_t* dst, const uint32_t* src, int count);
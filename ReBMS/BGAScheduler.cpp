@@ -0,0 +1,281 @@
+#include "BGAScheduler.h"
+
+#include <iostream>
+
+namespace {
+
+std::atomic<uint64_t> g_image_version{0};
+
+} // namespace
+
+// --------------------------------------------------------
+// 既定のデコーダ : 拡張子ではなく中身で BMP / PNG を判別する
+// --------------------------------------------------------
+bool DecodeBMPFile(const std::string& path, BGAImage& out)
+{
+    return DecodeImageFile(path, out);
+}
+
+// --------------------------------------------------------
+// コンストラクタ / 終了
+// --------------------------------------------------------
+BGAScheduler::BGAScheduler()
+    : decoder(DecodeBMPFile)
+{
+    for (int i = 0; i < (int)BGALayer::COUNT; ++i)
+    {
+        shown_slot[i] = -1;
+        pending_slot[i] = -1;
+    }
+}
+
+BGAScheduler::~BGAScheduler()
+{
+    Stop();
+}
+
+void BGAScheduler::Stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(job_mutex);
+        stopping = true;
+        jobs.clear();
+    }
+    job_cv.notify_all();
+
+    for (auto& t : workers)
+        if (t.joinable()) t.join();
+    workers.clear();
+
+    slots.clear();
+    slot_of.clear();
+}
+
+// --------------------------------------------------------
+// Load : BGA イベントの抽出
+// --------------------------------------------------------
+void BGAScheduler::Load(const BMSData& data, const std::string& base_dir)
+{
+    Stop();
+    events.clear();
+    paths.clear();
+
+    for (const auto& kv : data.bmp_files)
+        paths[kv.first] = base_dir + kv.second;
+
+    for (const auto& n : data.notes)
+    {
+        BGALayer layer;
+        if (n.channel == 0x04)      layer = BGALayer::BASE;
+        else if (n.channel == 0x07) layer = BGALayer::LAYER;
+        else if (n.channel == 0x06) layer = BGALayer::POOR;
+        else continue;
+
+        if (paths.find(n.wav_id) == paths.end()) continue;
+        events.push_back({ n.time_ms, layer, n.wav_id });
+    }
+
+    std::stable_sort(events.begin(), events.end(),
+        [](const BGAEvent& a, const BGAEvent& b){ return a.time_ms < b.time_ms; });
+
+    std::cout << "[BGA] Timeline: " << events.size() << " events, "
+              << paths.size() << " images" << std::endl;
+}
+
+void BGAScheduler::Start(double from_ms, int worker_count)
+{
+    Stop();
+    stopping = false;
+    late_frames = 0;
+    skipped_frames = 0;
+    start_ms = from_ms;
+    decoded_count.store(0);
+
+    slots.clear();
+    for (int i = 0; i < ring_slots; ++i)
+        slots.push_back(std::make_unique<Slot>());
+
+    for (int i = 0; i < (int)BGALayer::COUNT; ++i)
+    {
+        shown_slot[i] = -1;
+        pending_slot[i] = -1;
+        shown_id[i].clear();
+    }
+
+    // 開始位置の直前に切り替わった画像から先読みする（各レイヤーの現在画像を含める）
+    display_cursor = std::lower_bound(events.begin(), events.end(), from_ms,
+        [](const BGAEvent& e, double t){ return e.time_ms < t; }) - events.begin();
+    prefetch_cursor = display_cursor;
+
+    bool seen[(int)BGALayer::COUNT] = {};
+    for (size_t k = display_cursor; k-- > 0;)
+    {
+        const int layer = (int)events[k].layer;
+        if (seen[layer]) continue;
+        seen[layer] = true;
+        prefetch_cursor = display_cursor = k;
+    }
+
+    for (int i = 0; i < std::max(1, worker_count); ++i)
+        workers.emplace_back(&BGAScheduler::Worker, this);
+}
+
+// --------------------------------------------------------
+// Worker : 要求されたスロットをデコードする
+// --------------------------------------------------------
+void BGAScheduler::Worker()
+{
+    for (;;)
+    {
+        int index;
+        {
+            std::unique_lock<std::mutex> lock(job_mutex);
+            job_cv.wait(lock, [this]{ return stopping || !jobs.empty(); });
+            if (stopping) return;
+            index = jobs.front();
+            jobs.pop_front();
+        }
+
+        Slot& slot = *slots[index];
+        const bool ok = decoder && decoder(slot.path, slot.image);
+        slot.image.version = ++g_image_version;
+        if (ok) decoded_count.fetch_add(1, std::memory_order_relaxed);
+        slot.state.store(ok ? SLOT_READY : SLOT_FAILED, std::memory_order_release);
+    }
+}
+
+bool BGAScheduler::IsShown(int slot) const
+{
+    for (int i = 0; i < (int)BGALayer::COUNT; ++i)
+        if (shown_slot[i] == slot || pending_slot[i] == slot) return true;
+    return false;
+}
+
+// 空き、または使い終わった（デコード中でも表示中でもない）スロット
+// 表示カーソル以降のイベント（時刻は過ぎていても、この Update でまだ表示していないもの）の画像は残す
+int BGAScheduler::FindReusableSlot(double current_time_ms) const
+{
+    double limit = current_time_ms;
+    if (display_cursor < events.size())
+        limit = std::min(limit, events[display_cursor].time_ms);
+
+    int best = -1;
+    for (int i = 0; i < (int)slots.size(); ++i)
+    {
+        const Slot& s = *slots[i];
+        const int state = s.state.load(std::memory_order_acquire);
+        if (state == SLOT_EMPTY) return i;
+        if (state == SLOT_DECODING || IsShown(i)) continue;
+        if (s.needed_until_ms >= limit) continue;
+
+        if (best < 0 || s.needed_until_ms < slots[best]->needed_until_ms)
+            best = i;
+    }
+    return best;
+}
+
+// --------------------------------------------------------
+// Update : 先読み → 表示切り替え
+// --------------------------------------------------------
+void BGAScheduler::Update(double current_time_ms)
+{
+    if (slots.empty()) return;
+
+    // 1. 先読み幅に入ったイベントのデコードを要求（スロットが尽きたら次フレームへ）
+    while (prefetch_cursor < events.size() &&
+           events[prefetch_cursor].time_ms <= current_time_ms + prefetch_ms)
+    {
+        const BGAEvent& e = events[prefetch_cursor];
+
+        auto it = slot_of.find(e.bmp_id);
+        if (decode_paused && it == slot_of.end())
+        {
+            // 停止中は新しいデコードを出さない。表示時刻を過ぎたものだけ飛ばす
+            if (e.time_ms > current_time_ms) break;
+            ++skipped_frames;
+            ++prefetch_cursor;
+            continue;
+        }
+
+        if (it != slot_of.end())
+        {
+            Slot& s = *slots[it->second];
+            s.needed_until_ms = std::max(s.needed_until_ms, e.time_ms);
+            ++prefetch_cursor;
+            continue;
+        }
+
+        const int index = FindReusableSlot(current_time_ms);
+        if (index < 0) break;
+
+        Slot& s = *slots[index];
+        if (!s.bmp_id.empty()) slot_of.erase(s.bmp_id);
+
+        s.bmp_id = e.bmp_id;
+        s.path = paths[e.bmp_id];
+        s.needed_until_ms = e.time_ms;
+        s.state.store(SLOT_DECODING, std::memory_order_release);
+        slot_of[e.bmp_id] = index;
+
+        {
+            std::lock_guard<std::mutex> lock(job_mutex);
+            jobs.push_back(index);
+        }
+        job_cv.notify_one();
+        ++prefetch_cursor;
+    }
+
+    // 2. 表示時刻に達したイベントを反映
+    while (display_cursor < events.size() && events[display_cursor].time_ms <= current_time_ms)
+    {
+        const BGAEvent& e = events[display_cursor];
+        const int layer = (int)e.layer;
+
+        auto it = slot_of.find(e.bmp_id);
+        const int index = it != slot_of.end() ? it->second : -1;
+        shown_id[layer] = e.bmp_id;
+
+        if (index >= 0 && slots[index]->state.load(std::memory_order_acquire) == SLOT_READY)
+        {
+            shown_slot[layer] = index;
+            pending_slot[layer] = -1;
+        }
+        else
+        {
+            // 間に合わなかった。直前の画像を出したまま準備を待つ
+            // （開始位置以前の画像は先読みの機会がないため遅延に数えない）
+            if (e.time_ms > start_ms && !decode_paused) ++late_frames;
+            pending_slot[layer] = index;
+        }
+        ++display_cursor;
+    }
+
+    // 3. 遅れていた画像が準備できたら切り替える
+    for (int i = 0; i < (int)BGALayer::COUNT; ++i)
+    {
+        const int p = pending_slot[i];
+        if (p < 0) continue;
+
+        const int state = slots[p]->state.load(std::memory_order_acquire);
+        if (state == SLOT_READY)        { shown_slot[i] = p; pending_slot[i] = -1; }
+        else if (state == SLOT_FAILED)  { pending_slot[i] = -1; }
+    }
+}
+
+const BGAImage* BGAScheduler::GetFrame(BGALayer layer) const
+{
+    const int index = shown_slot[(int)layer];
+    if (index < 0) return nullptr;
+
+    const Slot& s = *slots[index];
+    return s.state.load(std::memory_order_acquire) == SLOT_READY ? &s.image : nullptr;
+}
+
+size_t BGAScheduler::GetResidentBytes() const
+{
+    size_t bytes = 0;
+    for (const auto& s : slots)
+        if (s->state.load(std::memory_order_acquire) == SLOT_READY)
+            bytes += s->image.pixels.size() * sizeof(uint32_t);
+    return bytes;
+}
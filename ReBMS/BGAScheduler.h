@@ -0,0 +1,152 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "data.h"
+#include "ImageDecoder.h"
+
+// ------------------------------------------------------------
+// BGA 先読みスケジューラ
+//  ・タイムラインからチャンネル 04(BGA) / 06(POOR) / 07(LAYER) を読み、
+//    一定時間（先読み幅）先までの画像をワーカースレッドでデコードする
+//  ・デコード済み画像は固定数のスロット（リング）にだけ置き、
+//    表示し終えたものから再利用する（常駐は小さな窓に限られる）
+//  ・表示時刻になっても準備できていない場合は遅延としてカウントし、
+//    直前の画像を表示し続ける（準備でき次第切り替える）
+// ------------------------------------------------------------
+
+constexpr double BGA_PREFETCH_MS = 1000.0;
+constexpr int BGA_RING_SLOTS = 32;
+
+// 表示レイヤー
+enum class BGALayer {
+    BASE,   // 04
+    LAYER,  // 07
+    POOR,   // 06
+    COUNT
+};
+
+// パス → 画像。失敗時は false
+using BGADecodeFunc = std::function<bool(const std::string& path, BGAImage& out)>;
+
+class BGAScheduler
+{
+public:
+    BGAScheduler();
+    ~BGAScheduler();
+
+    BGAScheduler(const BGAScheduler&) = delete;
+    BGAScheduler& operator=(const BGAScheduler&) = delete;
+
+    /**
+     * タイムラインを構築する（パスは base_dir + #BMPxx）
+     */
+    void Load(const BMSData& data, const std::string& base_dir);
+
+    /**
+     * ワーカーを起動し、from_ms から表示を始める
+     * @param worker_count デコードスレッド数
+     */
+    void Start(double from_ms = 0.0, int worker_count = 2);
+
+    /**
+     * ワーカーを停止して常駐画像を解放する
+     */
+    void Stop();
+
+    /**
+     * 先読み要求の発行と表示状態の更新（ゲームスレッドから毎フレーム）
+     */
+    void Update(double current_time_ms);
+
+    // ------------------- 設定（Start 前） -------------------
+    void SetPrefetchMs(double ms) { prefetch_ms = ms; }
+    void SetRingSlots(int slots) { ring_slots = std::max(2, slots); }
+    void SetDecoder(BGADecodeFunc func) { decoder = std::move(func); }
+
+    /**
+     * 新規デコード要求の一時停止（FrameWatchdog の品質切り下げ用）
+     * 停止中に表示時刻を過ぎた画像は読まずに飛ばし、直前の画像を出し続ける
+     */
+    void SetDecodePaused(bool paused) { decode_paused = paused; }
+
+    // ------------------- 表示 -------------------
+    /**
+     * 現在表示すべき画像（未設定・未準備なら nullptr）
+     * 返したポインタは次の Update() まで有効
+     */
+    const BGAImage* GetFrame(BGALayer layer) const;
+
+    // 現在表示中の BMP ID（"" なら未設定）
+    const std::string& GetFrameId(BGALayer layer) const { return shown_id[(int)layer]; }
+
+    // ------------------- 統計 -------------------
+    int GetEventCount() const { return (int)events.size(); }
+    int GetLateFrameCount() const { return late_frames; }
+    int GetSkippedFrameCount() const { return skipped_frames; }
+    int GetDecodedCount() const { return decoded_count.load(std::memory_order_relaxed); }
+    size_t GetResidentBytes() const;
+
+private:
+    enum SlotState { SLOT_EMPTY, SLOT_DECODING, SLOT_READY, SLOT_FAILED };
+
+    struct BGAEvent {
+        double time_ms;
+        BGALayer layer;
+        std::string bmp_id;
+    };
+
+    struct Slot {
+        std::string bmp_id;
+        std::string path;
+        BGAImage image;
+        std::atomic<int> state{SLOT_EMPTY};
+        double needed_until_ms = 0.0;   // この時刻まではタイムライン上で使われる
+    };
+
+    void Worker();
+    int FindReusableSlot(double current_time_ms) const;
+    bool IsShown(int slot) const;
+
+    std::vector<BGAEvent> events;                   // time_ms 昇順
+    std::map<std::string, std::string> paths;       // BMP ID → パス
+    size_t prefetch_cursor = 0;
+    size_t display_cursor = 0;
+
+    std::vector<std::unique_ptr<Slot>> slots;
+    std::map<std::string, int> slot_of;             // BMP ID → スロット（ゲームスレッドのみ）
+
+    int shown_slot[(int)BGALayer::COUNT];
+    int pending_slot[(int)BGALayer::COUNT];         // 表示時刻を過ぎたが未準備
+    std::string shown_id[(int)BGALayer::COUNT];
+
+    // デコード要求キュー
+    std::deque<int> jobs;
+    std::mutex job_mutex;
+    std::condition_variable job_cv;
+    std::vector<std::thread> workers;
+    bool stopping = false;
+
+    BGADecodeFunc decoder;
+    double prefetch_ms = BGA_PREFETCH_MS;
+    int ring_slots = BGA_RING_SLOTS;
+    int late_frames = 0;
+    int skipped_frames = 0;
+    bool decode_paused = false;
+    double start_ms = 0.0;
+    std::atomic<int> decoded_count{0};
+};
+
+/**
+ * 既定のデコーダ（DecodeImageFile で BMP / PNG を RGBA8 へ。スロットのバッファを再利用する）
+ */
+bool DecodeBMPFile(const std::string& path, BGAImage& out);
@@ -0,0 +1,156 @@
+#include "BGMStem.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+BGMStem::~BGMStem()
+{
+    Cancel();
+}
+
+void BGMStem::Cancel()
+{
+    cancel_requested.store(true);
+    if (worker.joinable())
+        worker.join();
+}
+
+// --------------------------------------------------------
+// Build : BGM イベントの解決とワーカー起動
+// --------------------------------------------------------
+bool BGMStem::Build(const BMSData& data, const SampleStore& store)
+{
+    Cancel();
+    cancel_requested.store(false);
+    rendered_frames.store(0);
+    events.clear();
+
+    int64_t total = 0;
+    for (const auto& n : data.notes)
+    {
+        if (n.channel != 0x01) continue;
+
+        auto it = data.loaded_wavs.find(n.wav_id);
+        if (it == data.loaded_wavs.end()) continue;
+
+        const SampleBuffer* sample = store.Get(it->second);
+        if (!sample || sample->frames == 0) continue;
+
+        StemEvent ev;
+        ev.start_frame = std::llround(n.time_ms * MIX_SAMPLE_RATE / 1000.0) + sample->head_offset;
+        ev.sample = sample;
+        events.push_back(ev);
+
+        total = std::max(total, ev.start_frame + sample->frames);
+    }
+
+    std::stable_sort(events.begin(), events.end(),
+        [](const StemEvent& a, const StemEvent& b){ return a.start_frame < b.start_frame; });
+
+    if (events.empty())
+    {
+        stem = SampleBuffer();
+        return false;
+    }
+
+    // 再生中に読み出されるため、バッファは先に全長分確保しておく
+    stem = SampleBuffer();
+    stem.encoding = SampleEncoding::BLOCK_I16;
+    stem.channels = 2;
+    stem.frames = (int)total;
+    stem.blocks.assign((size_t)total * 2, 0);
+    stem.block_scales.assign((total + SAMPLE_BLOCK_FRAMES - 1) / SAMPLE_BLOCK_FRAMES, 0.0f);
+
+    std::cout << "[BGM] Stem: " << events.size() << " events, "
+              << (total * 1000 / MIX_SAMPLE_RATE) << "ms" << std::endl;
+
+    worker = std::thread(&BGMStem::RenderWorker, this);
+    return true;
+}
+
+// --------------------------------------------------------
+// RenderWorker : チャンク単位で先頭から順にミックスする
+// --------------------------------------------------------
+void BGMStem::RenderWorker()
+{
+    std::vector<float> scratch((size_t)STEM_CHUNK_FRAMES * 2);
+    std::vector<size_t> active;
+    size_t next_event = 0;
+
+    for (int64_t c0 = 0; c0 < stem.frames; c0 += STEM_CHUNK_FRAMES)
+    {
+        if (cancel_requested.load(std::memory_order_relaxed))
+            return;
+
+        const int64_t c1 = std::min<int64_t>(c0 + STEM_CHUNK_FRAMES, stem.frames);
+        std::fill(scratch.begin(), scratch.end(), 0.0f);
+
+        // このチャンクで鳴り始めるイベントを追加
+        while (next_event < events.size() && events[next_event].start_frame < c1)
+            active.push_back(next_event++);
+
+        for (size_t idx : active)
+        {
+            const StemEvent& ev = events[idx];
+            const int64_t s = std::max(c0, ev.start_frame);
+            const int64_t e = std::min(c1, ev.start_frame + ev.sample->frames);
+            if (e <= s) continue;
+
+            MixSampleFrames(*ev.sample, (int)(s - ev.start_frame), (int)(e - s), 1.0f, 1.0f,
+                            scratch.data() + (s - c0) * 2);
+        }
+
+        active.erase(std::remove_if(active.begin(), active.end(),
+            [&](size_t idx){ return events[idx].start_frame + events[idx].sample->frames <= c1; }),
+            active.end());
+
+        // BLOCK_I16 へ量子化（ブロック毎スケールなのでクリップしない）
+        for (int64_t b0 = c0; b0 < c1; b0 += SAMPLE_BLOCK_FRAMES)
+        {
+            const int64_t b1 = std::min<int64_t>(b0 + SAMPLE_BLOCK_FRAMES, c1);
+            const float* src = scratch.data() + (b0 - c0) * 2;
+            const size_t n = (size_t)(b1 - b0) * 2;
+
+            float peak = 0.0f;
+            for (size_t i = 0; i < n; ++i)
+                peak = std::max(peak, std::fabs(src[i]));
+
+            const float scale = peak / 32767.0f;
+            const float inv = scale > 0.0f ? 1.0f / scale : 0.0f;
+            int16_t* dst = stem.blocks.data() + b0 * 2;
+            for (size_t i = 0; i < n; ++i)
+                dst[i] = (int16_t)std::lrint(src[i] * inv);
+
+            stem.block_scales[b0 / SAMPLE_BLOCK_FRAMES] = scale;
+        }
+
+        rendered_frames.store((int)c1, std::memory_order_release);
+    }
+}
+
+// --------------------------------------------------------
+// MixInto : ミキサーから呼ばれる
+// --------------------------------------------------------
+int BGMStem::MixInto(int64_t frame, int count, float gain, float* out) const
+{
+    if (stem.frames == 0) return 0;
+
+    // 負の位置（曲開始前）は無音
+    if (frame < 0)
+    {
+        const int skip = (int)std::min<int64_t>(-frame, count);
+        frame += skip;
+        count -= skip;
+        out += (size_t)skip * 2;
+    }
+
+    const int64_t end = std::min<int64_t>(frame + count, stem.frames);
+    if (end <= frame) return 0;
+
+    const int64_t ready = std::min<int64_t>(end, GetRenderedFrames());
+    if (ready > frame)
+        MixSampleFrames(stem, (int)frame, (int)(ready - frame), gain, gain, out);
+
+    return (int)(end - std::max(ready, frame));
+}
@@ -0,0 +1,71 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+#include "data.h"
+#include "SampleStore.h"
+
+// ------------------------------------------------------------
+// BGM ステム（チャンネル 01 の事前ミックス）
+//  ・BGM チャンネルはプレイヤー入力に依存しないため、
+//    ロード時にバックグラウンドで 1 本のストリームへミックスしておく
+//  ・先頭から STEM_CHUNK_FRAMES 単位で順にレンダリングし、
+//    GetRenderedFrames() までの区間は再生中でも読み出せる
+//  ・ワーカーは何も出力しない。完了はゲームスレッドが IsComplete() を見て報告する
+//  ・保持形式は SampleBuffer の BLOCK_I16（ミキサーの既存カーネルで再生）
+// ------------------------------------------------------------
+
+// レンダリング単位（SAMPLE_BLOCK_FRAMES の倍数）
+constexpr int STEM_CHUNK_FRAMES = SAMPLE_BLOCK_FRAMES * 64;
+
+class BGMStem
+{
+public:
+    BGMStem() = default;
+    ~BGMStem();
+
+    BGMStem(const BGMStem&) = delete;
+    BGMStem& operator=(const BGMStem&) = delete;
+
+    /**
+     * data のチャンネル 01 イベントからステムのレンダリングを開始する
+     * サンプルの解決は呼び出しスレッドで行い、ミックスはワーカースレッドで行う
+     * @return BGM イベントが 1 つ以上あれば true
+     */
+    bool Build(const BMSData& data, const SampleStore& store);
+
+    /**
+     * レンダリングを中断してワーカーを終了させる
+     */
+    void Cancel();
+
+    // レンダリング済みフレーム数（この位置までは再生可能）
+    int GetRenderedFrames() const { return rendered_frames.load(std::memory_order_acquire); }
+    int GetTotalFrames() const { return stem.frames; }
+    bool IsComplete() const { return GetTotalFrames() > 0 && GetRenderedFrames() >= GetTotalFrames(); }
+    int GetEventCount() const { return (int)events.size(); }
+
+    // レンダリング先バッファ（GetRenderedFrames() までが有効）
+    const SampleBuffer& GetBuffer() const { return stem; }
+
+    /**
+     * [frame, frame + count) のうちレンダリング済みの区間を out へ加算する
+     * @return 未レンダリングで鳴らせなかったフレーム数（アンダーラン）
+     */
+    int MixInto(int64_t frame, int count, float gain, float* out) const;
+
+private:
+    struct StemEvent {
+        int64_t start_frame;        // 発音開始フレーム（トリム済み先頭を考慮済み）
+        const SampleBuffer* sample;
+    };
+
+    void RenderWorker();
+
+    std::vector<StemEvent> events;   // start_frame 昇順
+    SampleBuffer stem;               // BLOCK_I16, 事前に全長分確保
+    std::atomic<int> rendered_frames{0};
+    std::atomic<bool> cancel_requested{false};
+    std::thread worker;
+};
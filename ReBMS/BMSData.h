@@ -1,8 +1,4 @@
 #pragma once
-#include <vector>
-#include "Note.h"
 
-// BMS の全データ
-struct BMSData {
-    std::vector<Note> notes;
-};
+// BMS の全データ（定義は Data.h に一本化）
+#include "data.h"
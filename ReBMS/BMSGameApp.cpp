@@ -1,23 +1,20 @@
 #include "BMSGameApp.h"
+#include "LatencyCalibrator.h"
 #include <emscripten/bind.h>
+#include <emscripten/val.h>
 #include <memory>
 #include <iostream>
 
-// グローバルなBMSGameAppインスタンス
-// JavaScriptからアクセスできるようにする
-std::unique_ptr<BMSGameApp> g_app = nullptr;
-
 /**
  * ゲームアプリケーションの初期化
  * JavaScriptから最初に呼び出される
+ * 呼ぶ度に新しいインスタンスを返す（状態はインスタンス毎。不要になったら JS 側で .delete() する）
+ * new Module.BMSGameApp() でも同じ
  */
 BMSGameApp* initialize_app() {
-    // 既に初期化されていれば既存のインスタンスを返す
-    if (!g_app) {
-        g_app = std::make_unique<BMSGameApp>();
-    }
+    BMSGameApp* app = new BMSGameApp();
     std::cout << "BMSGameApp instance created and ready." << std::endl;
-    return g_app.get();
+    return app;
 }
 
 /**
@@ -32,6 +29,119 @@ int hex_to_int(const std::string& hex) {
     }
 }
 
+// ============================================================
+// 描画用共有バッファのビュー
+//  WASM ヒープ上の配列をそのまま Float32Array / Int32Array として見せる（コピーなし）
+//  JS 側は取得したビューを保持して毎フレーム読み、length が 0 になったら
+//  （メモリ拡張でヒープが差し替わったら）取り直す
+// ============================================================
+
+emscripten::val visible_note_view(BMSGameApp& app) {
+    const RenderViews& v = app.GetRenderViews();
+    return emscripten::val(emscripten::typed_memory_view(v.GetNoteCapacity(), v.GetNoteData()));
+}
+
+emscripten::val layer_view(BMSGameApp& app) {
+    const RenderViews& v = app.GetRenderViews();
+    return emscripten::val(emscripten::typed_memory_view(v.GetLayerCapacity(), v.GetLayerData()));
+}
+
+emscripten::val hud_view(BMSGameApp& app) {
+    const RenderViews& v = app.GetRenderViews();
+    return emscripten::val(emscripten::typed_memory_view(v.GetHudSize(), v.GetHudData()));
+}
+
+// ============================================================
+// tick API
+//  JS は getTickInputPtr() の位置（または任意の WASM ヒープ上）に入力を書き、
+//  毎フレーム tick(time_ms, ptr, count) を 1 回だけ呼ぶ
+//  結果は getTickStateView()（Int32Array）/ getTickStateFloatView()（Float32Array）で読む
+// ============================================================
+
+void tick(BMSGameApp& app, double time_ms, uintptr_t events_ptr, int count) {
+    app.Tick(time_ms, reinterpret_cast<const TickInputEvent*>(events_ptr), count);
+}
+
+uintptr_t tick_input_ptr(BMSGameApp& app) {
+    return reinterpret_cast<uintptr_t>(app.GetTickInputBuffer());
+}
+
+emscripten::val tick_state_view(BMSGameApp& app) {
+    const TickState& st = app.GetTickState();
+    return emscripten::val(emscripten::typed_memory_view(sizeof(TickState) / 4, reinterpret_cast<const int32_t*>(&st)));
+}
+
+emscripten::val tick_state_float_view(BMSGameApp& app) {
+    const TickState& st = app.GetTickState();
+    return emscripten::val(emscripten::typed_memory_view(sizeof(TickState) / 4, reinterpret_cast<const float*>(&st)));
+}
+
+// ============================================================
+// 譜面のロード（C++ 側でパース）
+//  JS はファイルのバイト列を 1 度だけヒープへ置く:
+//    const ptr = app.allocChartBuffer(bytes.length);
+//    HEAPU8.set(bytes, ptr);
+//    app.loadBMSFromMemory(ptr, bytes.length);
+//  ノーツ配列を JS で組み立てて loadBMS へ渡す経路より速い
+// ============================================================
+
+uintptr_t alloc_chart_buffer(BMSGameApp& app, size_t size) {
+    return reinterpret_cast<uintptr_t>(app.AllocateChartBuffer(size));
+}
+
+bool load_bms_from_memory(BMSGameApp& app, uintptr_t data_ptr, size_t size) {
+    return app.LoadBMSFromMemory(reinterpret_cast<const char*>(data_ptr), size);
+}
+
+// ============================================================
+// リプレイ
+//  startReplayRecording(offset, seed) をプレイ開始前に呼び、終わったら
+//  finishReplayRecording() の Uint8Array を保存する（ビューなので次の記録までにコピーすること）
+//  照合は allocReplayBuffer → HEAPU8.set → verifyReplay(ptr, size)
+// ============================================================
+
+void start_replay_recording(BMSGameApp& app, double judge_offset_ms, uint32_t seed) {
+    ReplayOptions options;
+    options.judge_offset_ms = judge_offset_ms;
+    options.random_seed = seed;
+    app.StartReplayRecording(options);
+}
+
+emscripten::val finish_replay_recording(BMSGameApp& app) {
+    const std::vector<uint8_t>& bytes = app.FinishReplayRecording();
+    return emscripten::val(emscripten::typed_memory_view(bytes.size(), bytes.data()));
+}
+
+uintptr_t alloc_replay_buffer(BMSGameApp& app, size_t size) {
+    return reinterpret_cast<uintptr_t>(app.AllocateReplayBuffer(size));
+}
+
+// 記録時の結果と一致すれば true（譜面が違う / データが壊れている場合も false）
+bool verify_replay(BMSGameApp& app, uintptr_t data_ptr, size_t size) {
+    Replay replay;
+    if (!DecodeReplay(reinterpret_cast<const uint8_t*>(data_ptr), size, replay)) return false;
+    ReplayResult result;
+    return app.SimulateReplay(replay, result) && result == replay.result;
+}
+
+// ============================================================
+// 遅延キャリブレーション
+//  WASM にはオーディオ出力がないので、クリックは JS が WebAudio で鳴らす
+//  （クリック音なしで作り、getBeatTime(beat) の時刻にスケジュールする）
+//  時刻はすべてカウントインの 1 拍目を 0 とした ms（JS が performance.now() から換算する）
+//  結果の judge_offset_ms / visual_offset_ms を setJudgeOffset / setVisualOffset と設定へ書き戻す
+// ============================================================
+
+LatencyCalibrator* create_latency_calibrator() {
+    // クリックを渡さないのでミキサーには何も積まれない（全インスタンスで共有）
+    static AudioMixer silent_mixer(1);
+    return new LatencyCalibrator(silent_mixer, nullptr);
+}
+
+void calibration_start(LatencyCalibrator& calibrator, CalibrationPhase phase) {
+    calibrator.Start(phase, 0);
+}
+
 // ============================================================
 // Emscripten Binding (JavaScriptへの公開インターフェース)
 // ============================================================
@@ -41,11 +151,12 @@ EMSCRIPTEN_BINDINGS(BMSGameApp_bindings) {
     // 構造体 (JavaScriptへ公開)
     // --------------------------------------------------------
     
-    // Note 構造体 (BMSPlayerのノーツデータ)
-    emscripten::value_object<Note>("Note")
-        .field("time_ms", &Note::time_ms)
-        .field("channel", &Note::channel)
-        .field("value", &Note::value);
+    // PlayerNote 構造体 (BMSPlayerのノーツデータ。JS 側の名前は従来どおり Note)
+    emscripten::value_object<PlayerNote>("Note")
+        .field("time_ms", &PlayerNote::time_ms)
+        .field("channel", &PlayerNote::channel)
+        .field("value", &PlayerNote::value)
+        .field("is_long_note_end", &PlayerNote::is_long_note_end);
         
     // RenderNote 構造体 (レンダリング用ノーツデータ)
     emscripten::value_object<RenderNote>("RenderNote")
@@ -55,21 +166,72 @@ EMSCRIPTEN_BINDINGS(BMSGameApp_bindings) {
         .field("is_long_note", &RenderNote::is_long_note)
         .field("is_ln_end", &RenderNote::is_ln_end);
 
+    // キャリブレーション結果
+    emscripten::value_object<CalibrationResult>("CalibrationResult")
+        .field("valid", &CalibrationResult::valid)
+        .field("audio_tap_offset_ms", &CalibrationResult::audio_tap_offset_ms)
+        .field("visual_tap_offset_ms", &CalibrationResult::visual_tap_offset_ms)
+        .field("input_latency_ms", &CalibrationResult::input_latency_ms)
+        .field("audio_latency_ms", &CalibrationResult::audio_latency_ms)
+        .field("judge_offset_ms", &CalibrationResult::judge_offset_ms)
+        .field("visual_offset_ms", &CalibrationResult::visual_offset_ms)
+        .field("audio_taps_used", &CalibrationResult::audio_taps_used)
+        .field("visual_taps_used", &CalibrationResult::visual_taps_used)
+        .field("audio_spread_ms", &CalibrationResult::audio_spread_ms)
+        .field("visual_spread_ms", &CalibrationResult::visual_spread_ms);
+
+    emscripten::enum_<CalibrationPhase>("CalibrationPhase")
+        .value("IDLE", CalibrationPhase::IDLE)
+        .value("AUDIO", CalibrationPhase::AUDIO)
+        .value("VISUAL", CalibrationPhase::VISUAL);
+
     // --------------------------------------------------------
     // BMSGameApp クラス (JavaScriptへ公開)
     // --------------------------------------------------------
     emscripten::class_<BMSGameApp>("BMSGameApp")
+        .constructor<>()
+
         // メソッド
         .function("loadBMS", &BMSGameApp::LoadBMS)
+        .function("allocChartBuffer", &alloc_chart_buffer)
+        .function("loadBMSFromMemory", &load_bms_from_memory)
         .function("setCurrentTime", &BMSGameApp::SetCurrentTime)
         .function("update", &BMSGameApp::Update)
         .function("keyDown", &BMSGameApp::KeyDown)
         .function("keyUp", &BMSGameApp::KeyUp)
         .function("setJudgeOffset", &BMSGameApp::SetJudgeOffset)
+        .function("setVisualOffset", &BMSGameApp::SetVisualOffset)
         .function("setAutoPlayMode", &BMSGameApp::SetAutoPlayMode)
+        .function("setHiSpeed", &BMSGameApp::SetHiSpeed)
+        .function("setConstantGreen", &BMSGameApp::SetConstantGreen)
+        .function("updateRenderViews", &BMSGameApp::UpdateRenderViews)
+
+        // 1 フレーム 1 回の API（setCurrentTime / keyDown / keyUp / update / 各 getter の代わり）
+        .function("tick", &tick)
+        .function("getTickInputPtr", &tick_input_ptr)
+        .function("getTickStateView", &tick_state_view)
+        .function("getTickStateFloatView", &tick_state_float_view)
+
+        // リプレイ
+        .function("startReplayRecording", &start_replay_recording)
+        .function("finishReplayRecording", &finish_replay_recording)
+        .function("allocReplayBuffer", &alloc_replay_buffer)
+        .function("verifyReplay", &verify_replay)
+
+        // 毎フレーム読むもの : コピーなしのビュー（updateRenderViews の後に読む）
+        //  notes  : Float32Array [lane, offset_px, length_px, flags] x hud[NOTE_COUNT]
+        //           offset_px は判定ラインからの距離（BPM / STOP / #SCROLL / #SPEED / ハイスピード反映済み）
+        //  layers : Int32Array [layer, bmp_id] x hud[LAYER_COUNT]
+        //  hud    : Int32Array [score, combo, bga_id, note_count, layer_count, frame]
+        .function("getVisibleNoteView", &visible_note_view)
+        .function("getLayerView", &layer_view)
+        .function("getHudView", &hud_view)
 
         // ゲッター (プロパティとしてアクセス可能)
+        // getRenderNotes / getWAVs / getBMPs / getCurrentLayerIds は呼ぶ度に JS オブジェクトへ
+        // 変換されるため、ロード時や単発の確認用にのみ使う
         .function("getCurrentTime", &BMSGameApp::GetCurrentTime)
+        .function("getVisualTime", &BMSGameApp::GetVisualTime)
         .function("getScore", &BMSGameApp::GetScore)
         .function("getCombo", &BMSGameApp::GetCombo)
         .function("getTitle", &BMSGameApp::GetTitle)
@@ -78,14 +240,60 @@ EMSCRIPTEN_BINDINGS(BMSGameApp_bindings) {
         .function("getWAVs", &BMSGameApp::GetWAVs)
         .function("getBMPs", &BMSGameApp::GetBMPs)
         .function("getCurrentBgaId", &BMSGameApp::GetCurrentBgaId)
+        .function("getCurrentPoorId", &BMSGameApp::GetCurrentPoorId)
         .function("getCurrentLayerIds", &BMSGameApp::GetCurrentLayerIds)
         ;
 
+    // --------------------------------------------------------
+    // LatencyCalibrator クラス (new Module.LatencyCalibrator()。使い終わったら .delete())
+    // --------------------------------------------------------
+    emscripten::class_<LatencyCalibrator>("LatencyCalibrator")
+        .constructor(&create_latency_calibrator, emscripten::allow_raw_pointers())
+        .function("setBPM", &LatencyCalibrator::SetBPM)
+        .function("setBeatCount", &LatencyCalibrator::SetBeatCount)
+        .function("setDisplayLatencyMs", &LatencyCalibrator::SetDisplayLatencyMs)
+        .function("start", &calibration_start)
+        .function("onTap", &LatencyCalibrator::OnTap)
+        .function("isFlashOn", &LatencyCalibrator::IsFlashOn)
+        .function("isPhaseFinished", &LatencyCalibrator::IsPhaseFinished)
+        .function("getPhase", &LatencyCalibrator::GetPhase)
+        .function("getBeatTime", &LatencyCalibrator::GetBeatTimeMs)
+        .function("getBeatCount", &LatencyCalibrator::GetBeatCount)
+        .class_function("getCountInBeats", &LatencyCalibrator::GetCountInBeats)
+        .function("compute", &LatencyCalibrator::Compute)
+        ;
+
     // --------------------------------------------------------
     // グローバル関数 (JavaScriptへ公開)
     // --------------------------------------------------------
-    emscripten::function("initializeApp", &initializeApp, emscripten::allow_raw_pointers());
+    emscripten::function("initializeApp", &initialize_app, emscripten::allow_raw_pointers());
     emscripten::function("hexToInt", &hex_to_int);
+
+    // 共有バッファの配置（JS 側で添字を直書きしないよう定数として出す）
+    emscripten::constant("VIEW_NOTE_STRIDE", VIEW_NOTE_STRIDE);
+    emscripten::constant("VIEW_LAYER_STRIDE", VIEW_LAYER_STRIDE);
+    emscripten::constant("VIEW_HUD_SCORE", (int)VIEW_HUD_SCORE);
+    emscripten::constant("VIEW_HUD_COMBO", (int)VIEW_HUD_COMBO);
+    emscripten::constant("VIEW_HUD_BGA_ID", (int)VIEW_HUD_BGA_ID);
+    emscripten::constant("VIEW_HUD_NOTE_COUNT", (int)VIEW_HUD_NOTE_COUNT);
+    emscripten::constant("VIEW_HUD_LAYER_COUNT", (int)VIEW_HUD_LAYER_COUNT);
+    emscripten::constant("VIEW_HUD_FRAME", (int)VIEW_HUD_FRAME);
+
+    emscripten::constant("TICK_MAX_INPUT_EVENTS", TICK_MAX_INPUT_EVENTS);
+    emscripten::constant("TICK_INPUT_STRIDE_BYTES", (int)sizeof(TickInputEvent));
+    emscripten::constant("TICK_FRAME", (int)TICK_FRAME);
+    emscripten::constant("TICK_SCORE", (int)TICK_SCORE);
+    emscripten::constant("TICK_COMBO", (int)TICK_COMBO);
+    emscripten::constant("TICK_MAX_COMBO", (int)TICK_MAX_COMBO);
+    emscripten::constant("TICK_GAUGE", (int)TICK_GAUGE);
+    emscripten::constant("TICK_BGA_ID", (int)TICK_BGA_ID);
+    emscripten::constant("TICK_LAYER_ID", (int)TICK_LAYER_ID);
+    emscripten::constant("TICK_VISIBLE_NOTES", (int)TICK_VISIBLE_NOTES);
+    emscripten::constant("TICK_INPUTS_APPLIED", (int)TICK_INPUTS_APPLIED);
+    emscripten::constant("TICK_JUDGE_COUNT", (int)TICK_JUDGE_COUNT);
+    emscripten::constant("TICK_JUDGE_DROPPED", (int)TICK_JUDGE_DROPPED);
+    emscripten::constant("TICK_HEADER_FIELDS", (int)TICK_HEADER_FIELDS);
+    emscripten::constant("TICK_JUDGE_STRIDE", TICK_JUDGE_STRIDE);
 }
 
 // main関数はEmscripten環境では通常使用されないが、慣例として残す
@@ -1,6 +1,11 @@
 #pragma once
 
 #include "BMSPlayer.h"
+#include "RenderViews.h"
+#include "ScrollMap.h"
+#include "TickState.h"
+#include "Replay.h"
+#include "EventLog.h"
 #include <map>
 #include <vector>
 #include <string>
@@ -11,7 +16,7 @@
 // 定義と構造体
 // ============================================================
 
-// ノーツレンダリング用の情報 (BMSPlayer::Noteとは異なる、描画に特化した構造体)
+// ノーツレンダリング用の情報 (BMSPlayer の PlayerNote とは異なる、描画に特化した構造体)
 struct RenderNote {
     int lane;           // レーン番号 (1-9)
     double time_ms;     // ノーツの絶対時間 (ms)
@@ -33,6 +38,16 @@ private:
     // ゲーム内時間 (BMSPlayerと同期される)
     double game_time_ms = 0.0; 
 
+    // 描画用の時刻補正 (表示遅延の補償。LatencyCalibrator の visual_offset_ms)
+    double visual_offset_ms = 0.0;
+
+    // 判定の設定 (ロード前に設定されても、LoadBMS で作る BMSPlayer へ引き継ぐ)
+    double judge_offset_ms = 0.0;
+    bool is_auto_play = false;
+
+    // 生成・ロード・設定変更の表示 (std::cout) を出さない (BMSPlayer にも引き継ぐ)
+    bool is_quiet = false;
+
     // 読み込まれたBMSファイルのデータ
     std::string title = "Untitled BMS";
     std::string artist = "Unknown Artist";
@@ -42,9 +57,37 @@ private:
     // レンダリング用のノーツデータ (プレイ中に消費されない静的なノーツ情報)
     std::vector<RenderNote> render_notes; 
 
+    // JS 側へ typed_memory_view で見せる描画用バッファ（表示範囲のノーツ / レイヤー / HUD）
+    RenderViews render_views;
+
+    // BPM / STOP / #SCROLL / #SPEED のスクロール位置（C++ でパースした譜面のみ。LoadBMS では使わない）
+    ScrollMap scroll_map;
+
+    // loadBMSFromMemory 用に JS がファイルのバイト列を書き込む領域（パース後に解放する）
+    std::vector<char> chart_bytes;
+
+    // tick API の入出力ブロック（JS はポインタ / ビューで直接読み書きする）
+    TickInputEvent tick_inputs[TICK_MAX_INPUT_EVENTS] = {};
+    TickState tick_state;
+    double last_tick_ms = 0.0;
+    bool has_ticked = false;
+
+    // 判定 / イベントのログ（BMSPlayer が積む。インスタンス毎に持つので、別々の BMSGameApp は
+    // 別スレッドで同時に動かせる）
+    EventLog event_log;
+
+    // リプレイ（Tick で適用した入力を記録する）
+    uint64_t chart_hash = 0;            // LoadBMSFromMemory で読んだ譜面のハッシュ
+    ReplayRecorder replay_recorder;
+    std::vector<uint8_t> replay_bytes;  // 最後に FinishReplayRecording で符号化したリプレイ
+
 public:
     // ------------------- 初期化と時間管理 ----------------------
-    BMSGameApp();
+    /**
+     * @param quiet true なら生成・ロード・設定変更の表示を出さない（ReplayVerifier のように
+     *              多数のインスタンスを別スレッドで動かす場合。エラーは std::cerr に出る）
+     */
+    explicit BMSGameApp(bool quiet = false);
     ~BMSGameApp() = default;
 
     /**
@@ -55,7 +98,7 @@ public:
      * @param initial_bpm 楽曲の初期BPM
      */
     void LoadBMS(
-        const std::vector<Note>& initial_notes, 
+        const std::vector<PlayerNote>& initial_notes, 
         const std::vector<RenderNote>& render_data, 
         double initial_bpm,
         const std::map<std::string, std::string>& wavs,
@@ -64,6 +107,25 @@ public:
         const std::string& artist
     );
 
+    /**
+     * BMS ファイルの中身（バイト列）を C++ の BMSParser で解析してロードする
+     * JS 側でのパースと、ノーツ配列の embind 変換を行わない
+     * 解析結果から BMSPlayer 用のノーツと RenderNote を組み立てて LoadBMS に渡す
+     * @param data BMS ファイルの中身（AllocateChartBuffer の領域でもよい）
+     * @return 解析に失敗したら false（ロード済みの譜面はそのまま）
+     */
+    bool LoadBMSFromMemory(const char* data, size_t size);
+
+    /**
+     * JS がファイルのバイト列を書き込むための size バイトの領域を確保して返す
+     * （HEAPU8.set(bytes, ptr) の後に LoadBMSFromMemory(ptr, size)。ロード後に解放される）
+     */
+    char* AllocateChartBuffer(size_t size)
+    {
+        chart_bytes.assign(size, 0);
+        return chart_bytes.data();
+    }
+
     /**
      * ゲーム時間を設定する (WebAudioの現在再生時間と同期)
      * @param time_ms 設定するゲーム絶対時間 (ms)
@@ -89,35 +151,132 @@ public:
      */
     void KeyUp(int lane_channel);
 
+    // ------------------- 1 フレーム 1 回の API ----------------------
+    /**
+     * 1 フレーム分の処理をまとめて行う（JS からの呼び出しをこれ 1 回にする）
+     *  1. 入力を並び順に、それぞれの時刻で KeyDown / KeyUp として適用する
+     *     （各入力の前にその時刻まで Update するので、判定の順序はフレームの区切り方に依らない）
+     *  2. time_ms まで時間を進めて Update する
+     *  3. RenderViews と TickState を埋める（判定イベントは前回の Tick 以降の分）
+     * @param events 時刻順の入力（count 件。TICK_MAX_INPUT_EVENTS を超えた分は捨てる）
+     */
+    void Tick(double time_ms, const TickInputEvent* events, int count);
+
+    // 入力の書き込み先として使える固定バッファ（JS 側で毎フレーム確保しなくてよい）
+    TickInputEvent* GetTickInputBuffer() { return tick_inputs; }
+    const TickState& GetTickState() const { return tick_state; }
+
+    // ------------------- リプレイ ----------------------
+    /**
+     * Tick で適用する入力の記録を始める（ロード後、プレイ開始前）
+     * options は実際にプレイに使う設定を渡す（判定オフセットなどはここで設定もする）
+     */
+    void StartReplayRecording(const ReplayOptions& options);
+
+    /**
+     * 記録を終えて符号化したリプレイを返す（次の記録開始まで有効）
+     */
+    const std::vector<uint8_t>& FinishReplayRecording();
+
+    /**
+     * リプレイを再シミュレーションする（ロード直後の、まだ Tick していない状態で呼ぶ）
+     * 入力を記録された時刻で Tick に渡すだけなので、実時間より十分速く終わる
+     * @param out 再シミュレーションの結果（replay.result と比較して照合する）
+     * @return 譜面ハッシュが一致しない・未ロードなら false
+     */
+    bool SimulateReplay(const Replay& replay, ReplayResult& out);
+
+    // 現時点の結果（スコア・最大コンボ・判定数・判定列のダイジェスト）
+    ReplayResult GetReplayResult() const;
+
+    /**
+     * JS がリプレイのバイト列を書き込むための領域（照合用。次の記録で上書きされる）
+     */
+    uint8_t* AllocateReplayBuffer(size_t size)
+    {
+        replay_bytes.assign(size, 0);
+        return replay_bytes.data();
+    }
+
+    uint64_t GetChartHash() const { return chart_hash; }
+    const std::vector<uint8_t>& GetReplayBytes() const { return replay_bytes; }
+
+    // ログの整形・出力はゲームループの外で GetEventLog().Flush(os) を呼ぶ
+    EventLog& GetEventLog() { return event_log; }
+
     // ------------------- 設定変更 ----------------------
     /**
      * 判定オフセットを設定する
      */
     void SetJudgeOffset(double offset_ms); 
+
+    /**
+     * 描画オフセットを設定する (判定には影響しない)
+     */
+    void SetVisualOffset(double offset_ms) { visual_offset_ms = offset_ms; }
     
     /**
      * オートプレイモードを設定する
      */
     void SetAutoPlayMode(bool is_auto);
 
+    /**
+     * ハイスピード（1.0 で初期 BPM の基準速度）。プレイ中に変更してよい
+     */
+    void SetHiSpeed(double hs) { render_views.SetHiSpeed(hs); }
+
+    /**
+     * 緑数字固定モード : ノーツが表示範囲を visible_ms で通過するよう倍率を決める（0 以下で無効）
+     */
+    void SetConstantGreen(double visible_ms) { render_views.SetConstantGreen(visible_ms); }
+
     // ------------------- Getters (React/Renderer用) --------------------------
     
     // ゲーム情報
     double GetCurrentTime() const { return game_time_ms; }
+    double GetVisualTime() const { return game_time_ms + visual_offset_ms; } // ノーツ描画はこの時刻を使う
     int GetScore() const { return player ? player->GetScore() : 0; }
     int GetCombo() const { return player ? player->GetCombo() : 0; }
     std::string GetTitle() const { return title; }
     std::string GetArtist() const { return artist; }
     
-    // レンダリング用データ
+    // レンダリング用データ（ロード時に 1 度だけ取る想定。毎フレームは RenderViews を読む）
     const std::vector<RenderNote>& GetRenderNotes() const { return render_notes; }
     const std::map<std::string, std::string>& GetWAVs() const { return wav_map; }
     const std::map<std::string, std::string>& GetBMPs() const { return bmp_map; }
     
     // BGA/Layer情報
     int GetCurrentBgaId() const { return player ? player->GetCurrentBgaId() : 0; }
+    int GetCurrentPoorId() const { return player ? player->GetCurrentPoorId() : 0; }
     const std::map<int, int>& GetCurrentLayerIds() const { return player ? player->GetCurrentLayerIds() : empty_layer_map; }
 
+    // ------------------- 描画用共有バッファ --------------------------
+    /**
+     * 表示時刻で RenderViews を更新する（毎フレーム、Update の後に 1 回）
+     * ノーツの索引は LoadBMS で作り直している
+     */
+    void UpdateRenderViews()
+    {
+        render_views.BuildNotes(GetVisualTime());
+        render_views.SetLayers(GetCurrentLayerIds());
+        render_views.SetHud(GetScore(), GetCombo(), GetCurrentBgaId());
+    }
+
+    RenderViews& GetRenderViews() { return render_views; }
+    const RenderViews& GetRenderViews() const { return render_views; }
+
 private:
+    // LoadBMS / LoadBMSFromMemory の共通部分（scroll が nullptr なら ms 単位で等速に流す）
+    void LoadPlayData(
+        const std::vector<PlayerNote>& initial_notes,
+        const std::vector<RenderNote>& render_data,
+        double initial_bpm,
+        const std::map<std::string, std::string>& wavs,
+        const std::map<std::string, std::string>& bmps,
+        const std::string& title,
+        const std::string& artist,
+        const ScrollMap* scroll
+    );
+
     const std::map<int, int> empty_layer_map; // GetCurrentLayerIdsのフォールバック用
 };
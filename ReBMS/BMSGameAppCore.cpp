@@ -0,0 +1,97 @@
+#include "BMSGameApp.h"
+
+#include <iostream>
+
+// --------------------------------------------------------
+// 初期化とロード
+// --------------------------------------------------------
+BMSGameApp::BMSGameApp(bool quiet)
+    : is_quiet(quiet)
+{
+    if (!is_quiet) std::cout << "BMSGameApp created." << std::endl;
+}
+
+void BMSGameApp::LoadBMS(
+    const std::vector<PlayerNote>& initial_notes,
+    const std::vector<RenderNote>& render_data,
+    double initial_bpm,
+    const std::map<std::string, std::string>& wavs,
+    const std::map<std::string, std::string>& bmps,
+    const std::string& title,
+    const std::string& artist)
+{
+    // JS から渡されたノーツには BPM 変化などの定義がないので、時刻で等速に流す
+    LoadPlayData(initial_notes, render_data, initial_bpm, wavs, bmps, title, artist, nullptr);
+}
+
+void BMSGameApp::LoadPlayData(
+    const std::vector<PlayerNote>& initial_notes,
+    const std::vector<RenderNote>& render_data,
+    double initial_bpm,
+    const std::map<std::string, std::string>& wavs,
+    const std::map<std::string, std::string>& bmps,
+    const std::string& title,
+    const std::string& artist,
+    const ScrollMap* scroll)
+{
+    this->title = title;
+    this->artist = artist;
+    wav_map = wavs;
+    bmp_map = bmps;
+    render_notes = render_data;
+    render_views.Reset(render_notes, scroll);   // 同じ件数の譜面でも索引を作り直す
+
+    // プレイ状態はロード毎に作り直す（設定値はアプリ側に持っているものを引き継ぐ）
+    player = std::make_unique<BMSPlayer>(initial_notes, initial_bpm, is_quiet);
+    player->SetEventLog(&event_log);
+    player->SetJudgeOffset(judge_offset_ms);
+    player->SetAutoPlayMode(is_auto_play);
+
+    game_time_ms = 0.0;
+    last_tick_ms = 0.0;
+    has_ticked = false;
+    tick_state = TickState();
+
+    if (!is_quiet)
+        std::cout << "[LOAD] " << this->title << " / " << this->artist << ": "
+                  << initial_notes.size() << " notes/events, " << render_notes.size() << " render notes" << std::endl;
+}
+
+// --------------------------------------------------------
+// 時間と入力
+// --------------------------------------------------------
+void BMSGameApp::SetCurrentTime(double time_ms)
+{
+    game_time_ms = time_ms;
+    if (player) player->SetCurrentTime(time_ms);
+}
+
+void BMSGameApp::Update(double delta_time_ms)
+{
+    if (player) player->Update(delta_time_ms);
+}
+
+void BMSGameApp::KeyDown(int lane_channel)
+{
+    if (player) player->Judge(lane_channel);
+}
+
+void BMSGameApp::KeyUp(int lane_channel)
+{
+    if (player) player->JudgeKeyRelease(lane_channel);
+}
+
+// --------------------------------------------------------
+// 設定
+// --------------------------------------------------------
+void BMSGameApp::SetJudgeOffset(double offset_ms)
+{
+    judge_offset_ms = offset_ms;
+    if (player) player->SetJudgeOffset(offset_ms);
+}
+
+void BMSGameApp::SetAutoPlayMode(bool is_auto)
+{
+    is_auto_play = is_auto;
+    if (player) player->SetAutoPlayMode(is_auto);
+}
@@ -0,0 +1,124 @@
+#include "Parser.h"
+#include "BMSGameApp.h"
+#include "LaneKeysounds.h"
+#include "ContentHash.h"
+
+#include <cstdio>
+#include <iostream>
+#include <vector>
+
+// --------------------------------------------------------
+// 解析結果（BMSData）→ BMSPlayer / 描画用の配列
+// --------------------------------------------------------
+namespace {
+
+bool IsKeyChannel(int channel)
+{
+    return (channel >= 0x11 && channel <= 0x19) || (channel >= 0x21 && channel <= 0x29);
+}
+
+bool IsLNStartChannel(int channel)
+{
+    return channel >= 0x51 && channel <= 0x59;
+}
+
+// BMSPlayer::ProcessEvents が扱うイベント（BGM / BPM / BGA / Layer）
+bool IsPlayerEventChannel(int channel)
+{
+    return channel == 0x01 || channel == 0x03 || channel == 0x04 || channel == 0x06 || channel == 0x07;
+}
+
+RenderNote MakeRenderNote(int channel, double time_ms, double duration_ms, bool is_long_note, bool is_ln_end)
+{
+    RenderNote r;
+    r.lane = LaneKeysounds::LaneIndex(channel) + 1;
+    r.time_ms = time_ms;
+    r.duration_ms = duration_ms;
+    r.is_long_note = is_long_note;
+    r.is_ln_end = is_ln_end;
+    return r;
+}
+
+void BuildPlayData(const BMSData& data, std::vector<PlayerNote>& notes, std::vector<RenderNote>& render)
+{
+    notes.clear();
+    render.clear();
+    notes.reserve(data.notes.size() + data.notes.size() / 8);   // LN は終点の分だけ増える
+    render.reserve(data.notes.size());
+
+    for (const Note& n : data.notes)
+    {
+        if (IsKeyChannel(n.channel))
+        {
+            notes.push_back({ n.time_ms, n.channel, n.wav_id });
+            render.push_back(MakeRenderNote(n.channel, n.time_ms, 0.0, false, false));
+        }
+        else if (IsLNStartChannel(n.channel))
+        {
+            // LN は始点・終点とも物理レーンのチャンネルで持つ（BMSPlayer::JudgeKeyRelease が終点を探す）
+            const int lane_channel = n.channel - 0x40;
+            const double length = n.end_time_ms - n.time_ms;
+
+            notes.push_back({ n.time_ms, lane_channel, n.wav_id });
+            PlayerNote end{ n.end_time_ms, lane_channel, n.wav_id };
+            end.is_long_note_end = true;
+            notes.push_back(end);
+
+            render.push_back(MakeRenderNote(n.channel, n.time_ms, length, true, false));
+            render.push_back(MakeRenderNote(n.channel, n.end_time_ms, 0.0, false, true));
+        }
+        else if (n.channel == 0x03)
+        {
+            // BPM(03) は def_id を bpm_table で引いた値を 10 進で渡す（パーサーの時刻計算と同じ扱い。
+            // 表にない ID はパーサーでも BPM が変わらないので渡さない）
+            const auto it = data.bpm_table.find(n.def_id);
+            if (it == data.bpm_table.end()) continue;
+            char bpm[32];
+            std::snprintf(bpm, sizeof(bpm), "%.17g", it->second);
+            notes.push_back({ n.time_ms, n.channel, bpm });
+        }
+        else if (IsPlayerEventChannel(n.channel))
+        {
+            // WAV / BMP の ID
+            notes.push_back({ n.time_ms, n.channel, n.wav_id });
+        }
+    }
+}
+
+} // namespace
+
+// --------------------------------------------------------
+// LoadBMSFromMemory
+// --------------------------------------------------------
+bool BMSGameApp::LoadBMSFromMemory(const char* data, size_t size)
+{
+    BMSData parsed;
+    const bool ok = BMSParser::ParseMemory(data, size, parsed);
+    const uint64_t hash = ok ? HashContent(data, size) : 0;   // リプレイの照合用
+
+    // AllocateChartBuffer の領域はパースが済んだら不要
+    if (data == chart_bytes.data()) std::vector<char>().swap(chart_bytes);
+
+    if (!ok)
+    {
+        std::cerr << "[ERROR] Failed to parse BMS from memory (" << size << " bytes)" << std::endl;
+        return false;
+    }
+    chart_hash = hash;
+
+    std::vector<PlayerNote> notes;
+    std::vector<RenderNote> render;
+    BuildPlayData(parsed, notes, render);
+    scroll_map.Build(parsed);
+
+    if (!is_quiet)
+        std::cout << "[LOAD] BMS from memory: " << size << " bytes, "
+                  << notes.size() << " notes/events, " << render.size() << " render notes, "
+                  << scroll_map.GetSegmentCount() << " scroll segments" << std::endl;
+
+    LoadPlayData(notes, render, parsed.initial_bpm, parsed.wav_files, parsed.bmp_files,
+                 parsed.title.empty() ? std::string("Untitled BMS") : parsed.title,
+                 parsed.artist.empty() ? std::string("Unknown Artist") : parsed.artist,
+                 &scroll_map);
+    return true;
+}
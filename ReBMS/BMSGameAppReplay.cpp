@@ -0,0 +1,77 @@
+#include "BMSGameApp.h"
+
+#include <algorithm>
+#include <iostream>
+
+// --------------------------------------------------------
+// 記録
+// --------------------------------------------------------
+void BMSGameApp::StartReplayRecording(const ReplayOptions& options)
+{
+    SetJudgeOffset(options.judge_offset_ms);
+    SetAutoPlayMode(options.autoplay);
+
+    // 押下と離鍵で 1 ノーツ 2 入力。空打ちの分を足して先に確保しておく
+    replay_recorder.Begin(chart_hash, options, render_notes.size() * 2 + 256);
+}
+
+const std::vector<uint8_t>& BMSGameApp::FinishReplayRecording()
+{
+    if (replay_recorder.IsActive())
+        replay_recorder.Finish(last_tick_ms, GetReplayResult(), replay_bytes);
+    return replay_bytes;
+}
+
+ReplayResult BMSGameApp::GetReplayResult() const
+{
+    ReplayResult r;
+    if (!player) return r;
+
+    r.score = player->GetScore();
+    r.max_combo = player->GetMaxCombo();
+    for (int k = 0; k < REPLAY_JUDGE_KINDS; ++k)
+        r.judges[k] = player->GetJudgeTotal((JudgeResult)k);
+    r.judge_digest = player->GetJudgeDigest();
+    return r;
+}
+
+// --------------------------------------------------------
+// 再シミュレーション
+//  記録された入力を TICK_MAX_INPUT_EVENTS 件ずつ、まとまりの最後の入力時刻で Tick に渡す
+//  Tick は各入力の前にその時刻まで Update するので、プレイ時とフレームの区切りが違っても
+//  同じ順序で同じ判定になる（オートプレイはノーツ時刻で判定するので、入力 0 件で Tick 1 回でも同じ）
+// --------------------------------------------------------
+bool BMSGameApp::SimulateReplay(const Replay& replay, ReplayResult& out)
+{
+    if (!player)
+    {
+        std::cerr << "[REPLAY] No chart loaded" << std::endl;
+        return false;
+    }
+    if (replay.chart_hash != chart_hash)
+    {
+        std::cerr << "[REPLAY] Chart hash mismatch" << std::endl;
+        return false;
+    }
+
+    SetJudgeOffset(replay.options.judge_offset_ms);
+    SetAutoPlayMode(replay.options.autoplay);
+
+    const size_t total = replay.edges.size();
+    size_t next = 0;
+    while (next < total)
+    {
+        const int n = (int)std::min(total - next, (size_t)TICK_MAX_INPUT_EVENTS);
+        for (int i = 0; i < n; ++i)
+        {
+            const ReplayEdge& e = replay.edges[next + i];
+            tick_inputs[i] = { ReplayUnitsToMs(e.time_units), e.channel, e.down };
+        }
+        next += n;
+        Tick(tick_inputs[n - 1].time_ms, tick_inputs, n);
+    }
+    Tick(ReplayUnitsToMs(replay.end_time_units), nullptr, 0);
+
+    out = GetReplayResult();
+    return true;
+}
@@ -0,0 +1,70 @@
+#include "BMSGameApp.h"
+
+#include <algorithm>
+#include <limits>
+
+// --------------------------------------------------------
+// Tick : 入力適用 → 更新 → 状態ブロックの書き出しを 1 回の呼び出しで行う
+// --------------------------------------------------------
+void BMSGameApp::Tick(double time_ms, const TickInputEvent* events, int count)
+{
+    count = events ? std::clamp(count, 0, TICK_MAX_INPUT_EVENTS) : 0;
+
+    // 時刻はリプレイの記録単位に丸めたものを判定に使う（再生時に同じ値で判定できるように）
+    time_ms = QuantizeReplayTime(time_ms);
+
+    // 1. 入力（各入力はその時刻で判定する。時刻の巻き戻りは直前の入力時刻に揃える）
+    //    入力の前にその時刻まで Update しておき、先に期限を迎えたノーツの MISS を
+    //    入力の判定より前に確定させる（結果がフレームの区切り方に依らない）
+    bool advanced = has_ticked;
+    double updated_to = last_tick_ms;
+    auto advance_to = [&](double t)
+    {
+        SetCurrentTime(t);
+        Update(advanced ? t - updated_to : 0.0);
+        updated_to = t;
+        advanced = true;
+    };
+
+    double input_time = has_ticked ? last_tick_ms : std::numeric_limits<double>::lowest();
+    for (int i = 0; i < count; ++i)
+    {
+        const TickInputEvent& e = events[i];
+        input_time = std::min(std::max(QuantizeReplayTime(e.time_ms), input_time), time_ms);
+
+        advance_to(input_time);
+        if (e.down) KeyDown(e.channel);
+        else        KeyUp(e.channel);
+        replay_recorder.Record(input_time, e.channel, e.down != 0);
+    }
+
+    // 2. フレーム時刻まで進める
+    advance_to(time_ms);
+    last_tick_ms = time_ms;
+    has_ticked = true;
+
+    UpdateRenderViews();
+
+    // 3. 状態ブロック
+    TickState& st = tick_state;
+    ++st.frame;
+    st.score = GetScore();
+    st.combo = GetCombo();
+    st.max_combo = player ? player->GetMaxCombo() : 0;
+    st.gauge = player ? (float)player->GetGauge() : 0.0f;
+    st.bga_id = GetCurrentBgaId();
+    st.layer_id = render_views.GetHudData()[VIEW_HUD_LAYER_COUNT] > 0 ? render_views.GetLayerData()[1] : 0;
+    st.visible_notes = (int32_t)render_views.GetNoteCount();
+    st.inputs_applied = count;
+
+    st.judge_count = 0;
+    st.judge_dropped = 0;
+    if (player)
+    {
+        const int n = std::min(player->GetJudgeEventCount(), TICK_MAX_JUDGE_EVENTS);
+        std::copy(player->GetJudgeEvents(), player->GetJudgeEvents() + n, st.judges);
+        st.judge_count = n;
+        st.judge_dropped = player->GetDroppedJudgeEventCount();
+        player->ClearJudgeEvents();
+    }
+}
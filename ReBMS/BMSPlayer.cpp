@@ -1,8 +1,13 @@
 #include "BMSPlayer.h"
+#include "LaneKeysounds.h"
+#include "Resampler.h"
+#include "EventLog.h"
+#include "ContentHash.h"
 #include <iostream>
 #include <cmath>
 #include <algorithm>
 #include <iomanip>
+#include <cstdlib>
 
 // --------------------------------------------------------
 // 定数
@@ -13,22 +18,60 @@ constexpr double JUDGE_RANGE_WONDERFUL = 20.0;
 constexpr double JUDGE_RANGE_GREAT = 40.0;
 constexpr double JUDGE_RANGE_GOOD = 80.0;
 
+// ゲージ (ノーマルゲージ相当)
+constexpr double GAUGE_INITIAL = 20.0;
+constexpr double GAUGE_TOTAL = 300.0;      // 全ノーツを GREAT 以上で取ったときの総増分 (%)
+constexpr double GAUGE_BAD_DAMAGE = 2.0;
+constexpr double GAUGE_MISS_DAMAGE = 6.0;
+constexpr double GAUGE_MIN = 2.0;
+constexpr double GAUGE_MAX = 100.0;
+
+// 判定対象のレーン (1P / 2P の鍵盤と皿。LN は始点・終点ともこのチャンネル)
+static bool IsLaneChannel(int channel)
+{
+    return channel >= 0x11 && channel <= 0x29;
+}
+
+// イベント値 (16 進の ID) を int に (不正な値は 0)
+static int ParseEventId(const std::string& value)
+{
+    char* end = nullptr;
+    const long v = std::strtol(value.c_str(), &end, 16);
+    return (end && *end == '\0') ? (int)v : 0;
+}
+
+// BPM イベントの値 (10 進の BPM) を double に (不正な値・0 以下は 0)
+static double ParseEventBPM(const std::string& value)
+{
+    char* end = nullptr;
+    const double v = std::strtod(value.c_str(), &end);
+    return (end != value.c_str() && *end == '\0' && v > 0.0) ? v : 0.0;
+}
+
 // --------------------------------------------------------
 // コンストラクタ
 // --------------------------------------------------------
-BMSPlayer::BMSPlayer(const std::vector<Note>& initial_notes, double initial_bpm)
-    : notes(initial_notes), bpm(initial_bpm), score(0), combo(0), max_combo(0), judge_offset_ms(0.0), is_auto_play(false)
+BMSPlayer::BMSPlayer(const std::vector<PlayerNote>& initial_notes, double initial_bpm, bool quiet)
+    : notes(initial_notes), bpm(initial_bpm), is_quiet(quiet)
 {
     // 初期化時にノーツを時間順にソートしておく
-    std::sort(notes.begin(), notes.end(), [](const Note& a, const Note& b) {
+    std::sort(notes.begin(), notes.end(), [](const PlayerNote& a, const PlayerNote& b) {
         return a.time_ms < b.time_ms;
     });
 
+    // ゲージの増分はプレイ可能なノーツ数で割る (LN は始点・終点の 2 つで持つが 1 ノーツと数える)
+    int playable = 0;
+    for (const PlayerNote& n : notes) {
+        if (IsLaneChannel(n.channel) && !n.is_long_note_end) ++playable;
+    }
+    gauge = GAUGE_INITIAL;
+    gauge_gain = GAUGE_TOTAL / std::max(1, playable);
+
     // 初期BPMイベントを生成
     // 最初のノーツが始まる前の時間 0ms に初期BPMを設定
     ProcessBPMEvent(0.0, initial_bpm);
     
-    std::cout << "BMSPlayer initialized. Total notes: " << notes.size() << std::endl;
+    if (!is_quiet) std::cout << "BMSPlayer initialized. Total notes: " << notes.size() << std::endl;
 }
 
 // --------------------------------------------------------
@@ -36,15 +79,22 @@ BMSPlayer::BMSPlayer(const std::vector<Note>& initial_notes, double initial_bpm)
 // --------------------------------------------------------
 void BMSPlayer::Update(double delta_time_ms)
 {
-    // 1. ノーツのミス判定とオートプレイ処理
+    (void)delta_time_ms; // 時刻は SetCurrentTime で絶対時間として渡される
+
+    // 1. オートプレイ時のノーツ自動処理 (ミス判定より先に、到達したノーツをすべて取る)
+    if (is_auto_play) {
+        AutoPlayJudge();
+    }
+
+    // 2. ノーツのミス判定
     ProcessMissedNotes();
 
-    // 2. BGA/BPM イベントの処理 (時間同期は BMSGameApp::SetCurrentTime で行われる)
+    // 3. BGA/BPM イベントの処理 (時間同期は BMSGameApp::SetCurrentTime で行われる)
     ProcessEvents();
 
-    // 3. オートプレイ時のノーツ自動処理
-    if (is_auto_play) {
-        AutoPlayJudge();
+    // 4. 見逃したノーツの打鍵音を次のノーツへ差し替える
+    if (lane_keysounds && !is_auto_play) {
+        lane_keysounds->Update(game_time_ms + judge_offset_ms * playback_rate);
     }
 }
 
@@ -57,7 +107,12 @@ void BMSPlayer::Judge(int lane_channel)
 
     // 1. 現在時間
     // game_time_ms は BMSGameApp::SetCurrentTime で設定されている
-    double current_time = game_time_ms + judge_offset_ms;
+    double current_time = game_time_ms + judge_offset_ms * playback_rate;
+
+    // 打鍵音はアーム済みのものを即座に鳴らす (検索・確保は事前に済んでいる)
+    if (lane_keysounds) {
+        lane_keysounds->Trigger(lane_channel, current_time, game_time_ms);
+    }
 
     // 2. 判定対象のノーツを検索
     // 未処理で、現在の時間に近いノーツを探す
@@ -65,7 +120,7 @@ void BMSPlayer::Judge(int lane_channel)
     // ここでは単純な線形探索で、未処理のノーツの先頭から最も近いものを探す。
     
     int best_note_index = -1;
-    double min_time_diff = JUDGE_RANGE_GOOD; // 最もゆるい判定範囲で初期化
+    double min_time_diff = ScaledWindow(JUDGE_RANGE_GOOD); // 最もゆるい判定範囲で初期化
 
     for (size_t i = 0; i < notes.size(); ++i) {
         if (!notes[i].is_judged && notes[i].channel == lane_channel) {
@@ -90,13 +145,15 @@ void BMSPlayer::Judge(int lane_channel)
 
     // 3. 判定実行
     if (best_note_index != -1) {
-        Note& judged_note = notes[best_note_index];
+        PlayerNote& judged_note = notes[best_note_index];
         PerformJudge(judged_note, current_time);
 
         // WAVイベントの処理 (実際のオーディオ再生をシミュレート)
-        ProcessWAVEvent(judged_note.channel, judged_note.value);
+        if (!lane_keysounds) {
+            ProcessWAVEvent(judged_note.channel, judged_note.value);
+        }
     } else {
-        std::cout << "Input: Miss (No note found in range for channel " << std::hex << lane_channel << std::dec << " at " << current_time << "ms)" << std::endl;
+        PushLog(LogEvent::INPUT_MISS, lane_channel, 0, current_time);
         // 実際にはBADとして扱うか、無視する
     }
 }
@@ -109,13 +166,13 @@ void BMSPlayer::JudgeKeyRelease(int lane_channel)
     if (is_auto_play) return;
     
     // キーダウンと同様に、未処理のLN終点ノーツを検索し、判定する
-    double current_time = game_time_ms + judge_offset_ms;
+    double current_time = game_time_ms + judge_offset_ms * playback_rate;
     
     // LN終点ノーツは channel + 1 のチャンネルに格納されている場合があるが、
     // ここでは簡略化のため、通常のノーツリスト内で is_long_note_end が true のものを探す。
 
     int best_ln_end_index = -1;
-    double min_time_diff = JUDGE_RANGE_GOOD;
+    double min_time_diff = ScaledWindow(JUDGE_RANGE_GOOD);
 
     for (size_t i = 0; i < notes.size(); ++i) {
         if (!notes[i].is_judged && notes[i].is_long_note_end && notes[i].channel == lane_channel) {
@@ -131,7 +188,7 @@ void BMSPlayer::JudgeKeyRelease(int lane_channel)
     }
 
     if (best_ln_end_index != -1) {
-        Note& judged_note = notes[best_ln_end_index];
+        PlayerNote& judged_note = notes[best_ln_end_index];
         PerformJudge(judged_note, current_time);
     }
 }
@@ -139,35 +196,79 @@ void BMSPlayer::JudgeKeyRelease(int lane_channel)
 // --------------------------------------------------------
 // 内部判定ロジック
 // --------------------------------------------------------
-void BMSPlayer::PerformJudge(Note& note, double current_time)
+void BMSPlayer::PerformJudge(PlayerNote& note, double current_time)
 {
     double diff = std::abs(note.time_ms - current_time);
-    std::string judgment;
+    const char* judgment; // 文字列リテラルのみ（毎打鍵の確保を避ける）
+    JudgeResult result;
 
-    if (diff <= JUDGE_RANGE_WONDERFUL) {
+    if (diff <= ScaledWindow(JUDGE_RANGE_WONDERFUL)) {
         judgment = "WONDERFUL";
+        result = JudgeResult::P_GREAT;
         score += 1000;
         combo++;
-    } else if (diff <= JUDGE_RANGE_GREAT) {
+    } else if (diff <= ScaledWindow(JUDGE_RANGE_GREAT)) {
         judgment = "GREAT";
+        result = JudgeResult::GREAT;
         score += 800;
         combo++;
-    } else if (diff <= JUDGE_RANGE_GOOD) {
+    } else if (diff <= ScaledWindow(JUDGE_RANGE_GOOD)) {
         judgment = "GOOD";
+        result = JudgeResult::GOOD;
         score += 500;
         combo++;
     } else {
         // 判定範囲外だが、最も近いノーツとして処理された
         judgment = "BAD/POOR (Too Far)";
+        result = JudgeResult::BAD;
         combo = 0;
         score -= 200; // ペナルティ
     }
+    RecordJudge(result, note.channel, note.time_ms - current_time, note.time_ms, note.is_long_note_end);
 
     // 判定済みとしてマーク
     note.is_judged = true;
     max_combo = std::max(max_combo, combo);
     
-    std::cout << "Judge: " << judgment << " (Diff: " << std::fixed << std::setprecision(2) << diff << "ms) - Combo: " << combo << std::endl;
+    // ログはリングバッファに積むだけ（整形・出力はゲームループの外で BMSGameApp::GetEventLog().Flush）
+    PushLog(LogEvent::JUDGE, note.channel, combo, note.time_ms, diff, judgment);
+}
+
+// --------------------------------------------------------
+// 判定イベントの記録とゲージ
+// --------------------------------------------------------
+void BMSPlayer::RecordJudge(JudgeResult result, int channel, double diff_ms, double note_time_ms, bool is_ln_end)
+{
+    const double gain = is_ln_end ? 0.0 : gauge_gain;
+    switch (result) {
+    case JudgeResult::P_GREAT:
+    case JudgeResult::GREAT: gauge += gain; break;
+    case JudgeResult::GOOD:  gauge += gain * 0.5; break;
+    case JudgeResult::BAD:   gauge -= GAUGE_BAD_DAMAGE; break;
+    case JudgeResult::POOR:
+    case JudgeResult::MISS:  gauge -= GAUGE_MISS_DAMAGE; break;
+    default: break;
+    }
+    gauge = std::clamp(gauge, GAUGE_MIN, GAUGE_MAX);
+
+    // 判定列のダイジェスト (時刻は 1us 単位に丸めて浮動小数の表現差を吸収する)
+    if (result < JudgeResult::NONE) ++judge_totals[(int)result];
+    const int64_t key[3] = {
+        ((int64_t)result << 16) | (channel & 0xFFFF),
+        (int64_t)std::llround(diff_ms * 1000.0),
+        (int64_t)std::llround(note_time_ms * 1000.0),
+    };
+    judge_digest = HashContent(key, sizeof(key), judge_digest);
+
+    if (judge_event_count >= TICK_MAX_JUDGE_EVENTS) {
+        ++judge_events_dropped;
+        return;
+    }
+    TickJudgeEvent& e = judge_events[judge_event_count++];
+    e.result = (int32_t)result;
+    e.channel = channel;
+    e.diff_ms = (float)diff_ms;
+    e.time_ms = (float)note_time_ms;
 }
 
 // --------------------------------------------------------
@@ -176,19 +277,20 @@ void BMSPlayer::PerformJudge(Note& note, double current_time)
 void BMSPlayer::ProcessMissedNotes()
 {
     // game_time_ms は BMSGameApp::SetCurrentTime で設定されている
-    double current_time = game_time_ms + judge_offset_ms; 
+    double current_time = game_time_ms + judge_offset_ms * playback_rate; 
 
-    // 判定許容範囲を過ぎたノーツを POOR/MISS として処理
-    for (Note& note : notes) {
-        if (!note.is_judged) {
+    // 判定許容範囲を過ぎたノーツを POOR/MISS として処理 (BGM / BGA などのイベントは判定しない)
+    for (PlayerNote& note : notes) {
+        if (!note.is_judged && IsLaneChannel(note.channel)) {
             // ノーツの時間が現在の時間より十分に過去（GOOD範囲+α）ならミス
-            if (note.time_ms < current_time - JUDGE_RANGE_GOOD) {
+            if (note.time_ms < current_time - ScaledWindow(JUDGE_RANGE_GOOD)) {
                 // POOR/MISS 判定
                 note.is_judged = true;
                 combo = 0;
                 score -= 500; // 大きなペナルティ
                 
-                std::cout << "Judge: POOR/MISS (Time out at " << note.time_ms << "ms)" << std::endl;
+                PushLog(LogEvent::MISS, note.channel, 0, note.time_ms);
+                RecordJudge(JudgeResult::MISS, note.channel, 0.0, note.time_ms, note.is_long_note_end);
                 
                 // WAV/BGMノーツの場合は、ここで音を鳴らさないようにする
                 // (WAVは本来、イベントで発火するため、タイムアウトで鳴らす必要はない)
@@ -211,27 +313,29 @@ void BMSPlayer::ProcessEvents()
     double current_time = game_time_ms;
 
     // 未処理のイベントをチェック
-    for (Note& note : notes) {
+    for (PlayerNote& note : notes) {
         if (!note.is_processed) {
             // イベント処理のタイミングは、判定とは異なり、ノーツの**絶対時間**を基準とする
             if (note.time_ms <= current_time) {
                 note.is_processed = true;
+
+                // BGMノーツ: スケジューラで先行発音済み
+                if (note.channel == 0x01 && is_keysound_scheduled) {
+                    continue;
+                }
                 
-                // WAVノーツ
-                if (note.channel >= 0x01 && note.channel <= 0x07) {
-                    ProcessWAVEvent(note.channel, note.value);
-                } 
-                // BGMノーツ (BGMは WAV 0x01として処理することが多いが、BMSの仕様次第)
-                else if (note.channel == 0x01) {
+                // BGMノーツ (WAV)
+                if (note.channel == 0x01) {
                     ProcessWAVEvent(note.channel, note.value);
                 }
                 // BPM/STOP イベント
                 else if (note.channel == 0x03) {
-                    ProcessBPMEvent(note.time_ms, hex_to_int(note.value));
+                    const double new_bpm = ParseEventBPM(note.value);
+                    if (new_bpm > 0.0) ProcessBPMEvent(note.time_ms, new_bpm);
                 }
                 // BGA イベント
-                else if (note.channel >= 0x04 && note.channel <= 0x06) {
-                    ProcessBGAEvent(note.channel, hex_to_int(note.value));
+                else if (note.channel >= 0x04 && note.channel <= 0x07) {
+                    ProcessBGAEvent(note.channel, ParseEventId(note.value));
                 }
                 // レイヤーイベント (LN始点など)
                 else if (note.channel == 0x1A || note.channel == 0x2A) {
@@ -245,25 +349,31 @@ void BMSPlayer::ProcessEvents()
     }
 }
 
-// BGA/Layer 処理
+// BGA/POOR/Layer 処理 (04 / 06 / 07)
 void BMSPlayer::ProcessBGAEvent(int channel, int value_id)
 {
     if (channel == 0x04) {
         // BGA (メインアニメーション)
         current_bga_id = value_id;
-        std::cout << "BGA Change: ID " << value_id << std::endl;
+        PushLog(LogEvent::BGA, channel, value_id, game_time_ms);
     } else if (channel == 0x06) {
+        // POOR (ミス時に表示する画像。BGAScheduler / BGACompositor と同じく 06)
+        // 表示するかどうかは判定側が決めるので、ここでは ID を差し替えるだけ
+        current_poor_id = value_id;
+        PushLog(LogEvent::POOR, channel, value_id, game_time_ms);
+    } else if (channel == 0x07) {
         // LAYER (レイヤーアニメーション)
         // レイヤーは重ねて表示されるため、マップに保存する
         // ID 0 の場合はレイヤーをクリアする
-        if (value_id == 0) {
-            current_layer_ids.clear();
-            std::cout << "Layer Clear" << std::endl;
-        } else {
-            // 簡略化のため、キー値は常に 1 とする (実際には複数のレイヤーを持つ)
+        // (ノードを消すと次の設定で確保が走るため、エントリは残して ID 0 = 非表示とする)
+        // 簡略化のため、キー値は常に 1 とする (実際には複数のレイヤーを持つ)
+        for (auto& kv : current_layer_ids) {
+            kv.second = 0;
+        }
+        if (value_id != 0) {
             current_layer_ids[1] = value_id;
-            std::cout << "Layer Set: ID " << value_id << std::endl;
         }
+        PushLog(LogEvent::LAYER, channel, value_id, game_time_ms);
     }
 }
 
@@ -274,7 +384,7 @@ void BMSPlayer::ProcessBPMEvent(double time_ms, double new_bpm)
     // 簡易実装のため、ここではBPM値を保存するに留める。
     // (BMSParserが事前に絶対時間に変換していることを前提とする)
     bpm = new_bpm;
-    std::cout << "BPM Change: " << new_bpm << " at " << time_ms << "ms" << std::endl;
+    PushLog(LogEvent::BPM, 0x03, 0, time_ms, new_bpm);
 }
 
 // WAV 処理 (ネイティブ環境では実際のオーディオ再生に置き換える必要があります)
@@ -282,7 +392,7 @@ void BMSPlayer::ProcessWAVEvent(int channel, const std::string& value_id)
 {
     // TODO: ネイティブ化では、ここでオーディオライブラリ（例: OpenAL, SDL_mixer）を使って
     // 該当するWAVファイル（value_idに対応）を再生する処理を実装する
-    std::cout << "WAV Play: Channel " << std::hex << channel << " (Value: " << value_id << std::dec << ")" << std::endl;
+    PushLog(LogEvent::WAV, channel, EventLog::PackId(value_id.data(), value_id.size()), game_time_ms);
 }
 
 
@@ -294,22 +404,23 @@ void BMSPlayer::AutoPlayJudge()
     // game_time_ms は BMSGameApp::SetCurrentTime で設定されている
     double current_time = game_time_ms;
 
-    for (Note& note : notes) {
+    // 現在時刻までに到達したノーツを、ノーツ自身の時刻で判定する
+    // (フレームがどこで区切られても、1 回の Update で大きく進めても同じ判定列になる)
+    for (PlayerNote& note : notes) {
         // 未処理のノーツであり、プレイチャンネルのノーツ（BGM/BGA/BPM以外）
-        if (!note.is_judged && note.channel >= 0x11 && note.channel <= 0x19) {
-            
-            // 判定時間に近いノーツを探す（±5ms などの許容範囲）
-            if (std::abs(note.time_ms - current_time) < 5.0) {
-                // 自動判定実行
-                PerformJudge(note, current_time);
-                
-                // WAVイベントの処理 (実際のオーディオ再生をシミュレート)
-                ProcessWAVEvent(note.channel, note.value);
+        if (note.is_judged || !IsLaneChannel(note.channel)) continue;
 
-            } else if (note.time_ms > current_time + 5.0) {
-                // ノーツが時間的にまだ未来にあるため、これ以上探す必要はない
-                break;
-            }
+        if (note.time_ms > current_time) {
+            // ノーツが時間的にまだ未来にあるため、これ以上探す必要はない
+            break;
+        }
+
+        // 自動判定実行
+        PerformJudge(note, note.time_ms);
+
+        // WAVイベントの処理 (スケジューラ使用時は先行発音済み)
+        if (!is_keysound_scheduled && !note.is_long_note_end) {
+            ProcessWAVEvent(note.channel, note.value);
         }
     }
 }
@@ -322,13 +433,38 @@ void BMSPlayer::AutoPlayJudge()
 void BMSPlayer::SetJudgeOffset(double offset_ms)
 {
     judge_offset_ms = offset_ms;
-    std::cout << "Judge Offset set to: " << offset_ms << "ms" << std::endl;
+    if (!is_quiet) std::cout << "Judge Offset set to: " << offset_ms << "ms" << std::endl;
 }
 
 void BMSPlayer::SetAutoPlayMode(bool is_auto)
 {
     is_auto_play = is_auto;
-    std::cout << "Auto Play Mode: " << (is_auto ? "ON" : "OFF") << std::endl;
+    if (!is_quiet) std::cout << "Auto Play Mode: " << (is_auto ? "ON" : "OFF") << std::endl;
+}
+
+void BMSPlayer::SetPlaybackRate(double rate)
+{
+    // 判定幅・オフセットは実時間で一定に保つため、チャート時間では速度倍になる
+    playback_rate = std::clamp(rate, MIN_PLAYBACK_RATE, MAX_PLAYBACK_RATE);
+    if (lane_keysounds) {
+        lane_keysounds->SetWindowMs(ScaledWindow(JUDGE_RANGE_GOOD));
+    }
+    if (!is_quiet) std::cout << "Playback Rate: " << playback_rate << "x" << std::endl;
+}
+
+void BMSPlayer::SetLaneKeysounds(LaneKeysounds* lanes)
+{
+    lane_keysounds = lanes;
+    if (lane_keysounds) {
+        lane_keysounds->SetWindowMs(ScaledWindow(JUDGE_RANGE_GOOD));
+    }
+    if (!is_quiet) std::cout << "Lane Keysound Arming: " << (lanes ? "ON" : "OFF") << std::endl;
+}
+
+void BMSPlayer::SetKeysoundsScheduled(bool enabled)
+{
+    is_keysound_scheduled = enabled;
+    if (!is_quiet) std::cout << "Keysound Scheduling: " << (enabled ? "ON" : "OFF") << std::endl;
 }
 
 int BMSPlayer::GetScore() const {
@@ -347,6 +483,10 @@ int BMSPlayer::GetCurrentBgaId() const {
     return current_bga_id;
 }
 
+int BMSPlayer::GetCurrentPoorId() const {
+    return current_poor_id;
+}
+
 const std::map<int, int>& BMSPlayer::GetCurrentLayerIds() const {
     return current_layer_ids;
 }
@@ -6,6 +6,10 @@
 #include <algorithm>
 #include <memory>
 #include <iostream>
+#include "TickState.h"
+#include "EventLog.h"
+
+class LaneKeysounds;
 
 // ============================================================
 // 定義と構造体
@@ -16,19 +20,16 @@ enum class JudgeResult {
 };
 
 // BMSファイルから読み込まれたノーツやイベントのデータ構造
-struct Note {
+// （パーサ側の Note（Note.h）とは別物。WASM ビルドで両方を同じ翻訳単位に入れられるよう名前を分ける）
+struct PlayerNote {
     double time_ms; // ノーツやイベントの発生絶対時間 (ms)
-    int channel;    // チャンネルID (11-17: 鍵盤, 51-57: LN開始, 61-67: LN終点, 01-09: WAV/BGA/Layer)
-    std::string value; // WAV/BGAイベントの場合はID、ノーツの場合は未使用
-};
+    int channel;    // チャンネルID (11-19, 21-29: 鍵盤。LN は始点・終点ともレーンのチャンネル, 01-09: WAV/BGA/Layer)
+    std::string value; // WAV/BGAイベントの場合はID、BPM(03) は 10 進の BPM 値、ノーツの場合はキー音の WAV ID
+    bool is_long_note_end = false; // LN終点ノーツかどうか
 
-// ロングノーツの状態管理
-struct LNState {
-    int lane_channel;          // LNが発生しているレーンチャンネル
-    double start_time_ms;      // LN開始時刻
-    double end_time_ms;        // LN終点時刻
-    bool is_active;            // 現在キーが押されているか (押下判定成功後)
-    bool is_released_naturally; // プレイヤーによる正常な解放があったか
+    // 進行状態（プレイ中に BMSPlayer が立てる）
+    bool is_judged = false;
+    bool is_processed = false;
 };
 
 // ============================================================
@@ -38,34 +39,49 @@ struct LNState {
 class BMSPlayer
 {
 private:
-    double current_time_ms = 0.0; // 現在のゲーム内時間 (ms)
-    
+    double game_time_ms = 0.0;          // 現在のゲーム内時間 (ms。BMSGameApp::SetCurrentTime で設定される)
+
     // BMS Data
-    std::vector<Note> notes;            // 処理待ちの残りのノーツ (プレイ中に削除される)
-    std::map<double, double> bpm_changes; // BPM変化ポイント (time_ms -> new_bpm)
-    double initial_bpm;                 // 楽曲の初期BPM
+    std::vector<PlayerNote> notes;      // ノーツとイベント (時間順。判定 / 処理済みはフラグで持つ)
+    double bpm = 0.0;                   // 現在の BPM
 
     // Game State
     int score = 0;
     int combo = 0;
     int max_combo = 0;
-    std::map<JudgeResult, int> judge_counts; // 判定結果のカウント
-    std::map<int, LNState> ln_states;        // 現在アクティブなロングノーツの状態
+
+    // ゲージ (0〜100%)。ノーマルゲージ相当で、全ノーツ GREAT 以上で GAUGE_TOTAL% 増える
+    double gauge = 20.0;
+    double gauge_gain = 0.0;                 // GREAT 1 回あたりの増分 (ノーツ数から決める)
+
+    // 前回 ClearJudgeEvents 以降の判定 (tick API で JS へ渡す。固定長で溢れた分は数える)
+    TickJudgeEvent judge_events[TICK_MAX_JUDGE_EVENTS] = {};
+    int judge_event_count = 0;
+    int judge_events_dropped = 0;
+
+    // 全判定の累計と判定列のダイジェスト (リプレイの照合用。ClearJudgeEvents では消えない)
+    int judge_totals[(int)JudgeResult::NONE] = {};
+    uint64_t judge_digest = 0;
 
     // ★ 設定値 (Reactから渡される)
     double judge_offset_ms = 0.0;       // 判定オフセット (ms)
-    bool is_auto_play_mode = false;     // オートプレイモードが有効か
+    bool is_auto_play = false;          // オートプレイモードが有効か
+    bool is_keysound_scheduled = false; // BGM/オートプレイのキー音を KeysoundScheduler が先行発音するか
+    double playback_rate = 1.0;         // 練習モードの再生速度 (0.5〜1.5)
+    LaneKeysounds* lane_keysounds = nullptr; // 打鍵音の事前アーム (nullptr なら判定後に ProcessWAVEvent)
+    EventLog* event_log = nullptr;      // ログの積み先 (BMSGameApp が持つ。nullptr なら積まない)
+    bool is_quiet = false;              // 初期化・設定変更の表示を出さない (一括検証などで同時に多数動かす用)
 
     // ★ BGA/Layer 表示状態 (レンダリング用)
-    int current_bga_bmp_id = 0;                 // 現在表示中のBGAのBMP ID
-    std::map<int, int> current_layer_bmp_ids;   // 現在表示中のLayerのBMP ID (Layer Channel -> BMP ID)
-
-    // BGA/Layerイベント管理用
-    std::vector<Note> event_queue;      // BGA/WAVなどのイベントキュー
-    std::map<int, bool> auto_processed_notes; // オートプレイで処理済みのノーツを追跡（今回は未使用だが将来拡張用）
+    int current_bga_id = 0;                 // 現在表示中のBGAのBMP ID
+    int current_poor_id = 0;                // ミス時に表示するPOORのBMP ID (06)
+    std::map<int, int> current_layer_ids;   // 現在表示中のLayerのBMP ID (Layer Channel -> BMP ID)
 
 public:
-    BMSPlayer(const std::vector<Note>& initial_notes, double initial_bpm);
+    /**
+     * @param quiet true なら初期化・設定変更の表示 (std::cout) を出さない
+     */
+    BMSPlayer(const std::vector<PlayerNote>& initial_notes, double initial_bpm, bool quiet = false);
     ~BMSPlayer() = default;
 
     // ------------------- API for App ----------------------
@@ -87,20 +103,43 @@ public:
      */
     void JudgeKeyRelease(int lane_channel);
 
+    /**
+     * ゲーム時間を設定する (BMSGameApp::SetCurrentTime から。判定・イベントはこの時刻で行う)
+     */
+    void SetCurrentTime(double time_ms) { game_time_ms = time_ms; }
+
     // ------------------- Getters --------------------------
-    int GetScore() const { return score; }
-    int GetCombo() const { return combo; }
-    bool IsAutoPlayMode() const { return is_auto_play_mode; }
+    int GetScore() const;
+    int GetCombo() const;
+    int GetMaxCombo() const { return max_combo; }
+    double GetGauge() const { return gauge; }
+
+    // 前回 ClearJudgeEvents 以降の判定イベント
+    const TickJudgeEvent* GetJudgeEvents() const { return judge_events; }
+    int GetJudgeEventCount() const { return judge_event_count; }
+    int GetDroppedJudgeEventCount() const { return judge_events_dropped; }
+    void ClearJudgeEvents() { judge_event_count = 0; judge_events_dropped = 0; }
+
+    // プレイ開始からの判定数と判定列のダイジェスト
+    int GetJudgeTotal(JudgeResult result) const { return result < JudgeResult::NONE ? judge_totals[(int)result] : 0; }
+    uint64_t GetJudgeDigest() const { return judge_digest; }
+    bool IsAutoPlayMode() const { return is_auto_play; }
+    double GetCurrentBPM() const;
     
     /**
      * 現在表示すべきBGAのBMP IDを取得
      */
-    int GetCurrentBgaId() const { return current_bga_bmp_id; }
+    int GetCurrentBgaId() const;
+
+    /**
+     * ミス時に表示すべきPOORのBMP IDを取得 (0 なら未設定)
+     */
+    int GetCurrentPoorId() const;
     
     /**
      * 現在表示すべきLayerのBMP IDマップを取得
      */
-    const std::map<int, int>& GetCurrentLayerIds() const { return current_layer_bmp_ids; }
+    const std::map<int, int>& GetCurrentLayerIds() const;
     
     // ------------------- Setters --------------------------
     /**
@@ -113,17 +152,58 @@ public:
      */
     void SetAutoPlayMode(bool is_auto);
 
+    /**
+     * 練習モードの再生速度を設定する (0.5〜1.5)
+     * ゲーム時間はチャート時間で渡されるため、判定幅とオフセットを速度倍して
+     * 実時間での判定の厳しさを等速時と揃える
+     */
+    void SetPlaybackRate(double rate);
+
+    /**
+     * BGM とオートプレイのキー音を KeysoundScheduler で先行発音するかを設定する
+     * 有効な間、フレーム処理側（ProcessEvents / AutoPlayJudge）では発音しない
+     */
+    void SetKeysoundsScheduled(bool enabled);
+
+    /**
+     * 打鍵音をレーン毎に事前アームする LaneKeysounds を設定する
+     * 設定中は Judge がノーツ検索より先にアーム済みの音を鳴らし、判定後の発音は行わない
+     */
+    void SetLaneKeysounds(LaneKeysounds* lanes);
+
+    /**
+     * 判定 / イベントのログを積む EventLog を設定する (nullptr でログなし)
+     * プレイ毎に別の EventLog を渡せば、複数の BMSPlayer を別スレッドで同時に動かせる
+     */
+    void SetEventLog(EventLog* log) { event_log = log; }
+
 private:
     // ------------------- Internal Logic -------------------
     /**
-     * ノーツの理想時間からの時間差に基づいて判定結果を計算
+     * ノーツの理想時間との差から判定し、スコア・コンボを更新する
      */
-    JudgeResult CalculateJudgment(double diff_ms) const;
-    
+    void PerformJudge(PlayerNote& note, double current_time);
+
     /**
-     * 判定結果に対応する時間ウィンドウの大きさを取得
+     * 判定をイベント列に記録し、ゲージを増減する
+     * @param diff_ms ノーツ時刻 - 押した時刻 (正なら早押し)
+     * @param is_ln_end LN 終点の判定か (LN は始点で 1 ノーツ分増えるので、終点は減るだけ)
      */
-    double GetJudgeWindow(JudgeResult result) const;
+    void RecordJudge(JudgeResult result, int channel, double diff_ms, double note_time_ms, bool is_ln_end);
+
+    /**
+     * event_log にログを積む (未設定なら何もしない)
+     */
+    void PushLog(LogEvent type, int channel, int value, double time_ms,
+                 double detail = 0.0, const char* label = nullptr)
+    {
+        if (event_log) event_log->Push(type, channel, value, time_ms, detail, label);
+    }
+
+    /**
+     * 実時間の判定幅をチャート時間に換算する（再生速度倍）
+     */
+    double ScaledWindow(double window_ms) const { return window_ms * playback_rate; }
     
     /**
      * BGA/WAV/BPMなどのイベントを処理する
@@ -133,20 +213,25 @@ private:
     /**
      * BGAまたはLayerイベントを処理し、表示状態を更新する
      */
-    void ProcessBGAEvent(const Note& event);
-    
+    void ProcessBGAEvent(int channel, int value_id);
+
+    /**
+     * BPM 変化を記録する (ノーツ時刻はパーサで絶対時間に変換済み)
+     */
+    void ProcessBPMEvent(double time_ms, double new_bpm);
+
     /**
-     * 判定期限切れのノーツをMISSとして処理し、ノーツリストから削除する
+     * WAV の発音 (現状はログのみ。発音は LaneKeysounds / KeysoundScheduler 側)
      */
-    void ProcessScrollOutMisses();
+    void ProcessWAVEvent(int channel, const std::string& value_id);
     
     /**
-     * LNの終点判定時間を過ぎたアクティブなLNを強制MISSとして処理する
+     * 判定期限切れのノーツを MISS として処理する
      */
-    void ProcessLNEnds();
+    void ProcessMissedNotes();
     
     /**
      * ★ オートプレイが有効な場合、ノーツを自動で判定する
      */
-    void ProcessAutoPlay(); 
+    void AutoPlayJudge(); 
 };
@@ -0,0 +1,441 @@
+#include "BatchRenderer.h"
+#include "LaneKeysounds.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+namespace {
+
+constexpr int ATLAS_SIZE = 128;
+
+// アトラス上の配置（ピクセル）
+const SDL_Rect ATLAS_LAYOUT[(int)AtlasRegion::COUNT] = {
+    {  0,  0,  4,  4 },     // SOLID
+    {  0, 16, 32, 16 },     // NOTE
+    { 32,  0,  8,  8 },     // LN_BODY
+    { 32, 32, 32, 32 },     // GLOW
+};
+
+// 文字は 8x8 のセルに 1 つずつ、アトラス下半分に 16 文字 x 4 段で並べる
+// （セルの余白は透明なので隣の文字がにじまない）
+constexpr int GLYPH_CELL = 8;
+constexpr int GLYPH_COLUMNS = 16;
+constexpr int GLYPH_ORIGIN_Y = 64;
+
+// 5x7 フォント（1 行 5bit、bit4 が左端）
+const uint8_t GLYPH_ROWS[GLYPH_COUNT][GLYPH_HEIGHT] = {
+    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },  // ' '
+    { 0x04, 0x04, 0x04, 0x04, 0x04, 0x00, 0x04 },  // !
+    { 0x0A, 0x0A, 0x0A, 0x00, 0x00, 0x00, 0x00 },  // "
+    { 0x0A, 0x0A, 0x1F, 0x0A, 0x1F, 0x0A, 0x0A },  // #
+    { 0x04, 0x0F, 0x14, 0x0E, 0x05, 0x1E, 0x04 },  // $
+    { 0x18, 0x19, 0x02, 0x04, 0x08, 0x13, 0x03 },  // %
+    { 0x0C, 0x12, 0x14, 0x08, 0x15, 0x12, 0x0D },  // &
+    { 0x0C, 0x04, 0x08, 0x00, 0x00, 0x00, 0x00 },  // '
+    { 0x02, 0x04, 0x08, 0x08, 0x08, 0x04, 0x02 },  // (
+    { 0x08, 0x04, 0x02, 0x02, 0x02, 0x04, 0x08 },  // )
+    { 0x00, 0x04, 0x15, 0x0E, 0x15, 0x04, 0x00 },  // *
+    { 0x00, 0x04, 0x04, 0x1F, 0x04, 0x04, 0x00 },  // +
+    { 0x00, 0x00, 0x00, 0x00, 0x0C, 0x04, 0x08 },  // ,
+    { 0x00, 0x00, 0x00, 0x1F, 0x00, 0x00, 0x00 },  // -
+    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x0C, 0x0C },  // .
+    { 0x00, 0x01, 0x02, 0x04, 0x08, 0x10, 0x00 },  // /
+    { 0x0E, 0x11, 0x13, 0x15, 0x19, 0x11, 0x0E },  // 0
+    { 0x04, 0x0C, 0x04, 0x04, 0x04, 0x04, 0x0E },  // 1
+    { 0x0E, 0x11, 0x01, 0x02, 0x04, 0x08, 0x1F },  // 2
+    { 0x1F, 0x02, 0x04, 0x02, 0x01, 0x11, 0x0E },  // 3
+    { 0x02, 0x06, 0x0A, 0x12, 0x1F, 0x02, 0x02 },  // 4
+    { 0x1F, 0x10, 0x1E, 0x01, 0x01, 0x11, 0x0E },  // 5
+    { 0x06, 0x08, 0x10, 0x1E, 0x11, 0x11, 0x0E },  // 6
+    { 0x1F, 0x01, 0x02, 0x04, 0x08, 0x08, 0x08 },  // 7
+    { 0x0E, 0x11, 0x11, 0x0E, 0x11, 0x11, 0x0E },  // 8
+    { 0x0E, 0x11, 0x11, 0x0F, 0x01, 0x02, 0x0C },  // 9
+    { 0x00, 0x0C, 0x0C, 0x00, 0x0C, 0x0C, 0x00 },  // :
+    { 0x00, 0x0C, 0x0C, 0x00, 0x0C, 0x04, 0x08 },  // ;
+    { 0x02, 0x04, 0x08, 0x10, 0x08, 0x04, 0x02 },  // <
+    { 0x00, 0x00, 0x1F, 0x00, 0x1F, 0x00, 0x00 },  // =
+    { 0x08, 0x04, 0x02, 0x01, 0x02, 0x04, 0x08 },  // >
+    { 0x0E, 0x11, 0x01, 0x02, 0x04, 0x00, 0x04 },  // ?
+    { 0x0E, 0x11, 0x01, 0x0D, 0x15, 0x15, 0x0E },  // @
+    { 0x0E, 0x11, 0x11, 0x11, 0x1F, 0x11, 0x11 },  // A
+    { 0x1E, 0x11, 0x11, 0x1E, 0x11, 0x11, 0x1E },  // B
+    { 0x0E, 0x11, 0x10, 0x10, 0x10, 0x11, 0x0E },  // C
+    { 0x1C, 0x12, 0x11, 0x11, 0x11, 0x12, 0x1C },  // D
+    { 0x1F, 0x10, 0x10, 0x1E, 0x10, 0x10, 0x1F },  // E
+    { 0x1F, 0x10, 0x10, 0x1E, 0x10, 0x10, 0x10 },  // F
+    { 0x0E, 0x11, 0x10, 0x17, 0x11, 0x11, 0x0F },  // G
+    { 0x11, 0x11, 0x11, 0x1F, 0x11, 0x11, 0x11 },  // H
+    { 0x0E, 0x04, 0x04, 0x04, 0x04, 0x04, 0x0E },  // I
+    { 0x07, 0x02, 0x02, 0x02, 0x02, 0x12, 0x0C },  // J
+    { 0x11, 0x12, 0x14, 0x18, 0x14, 0x12, 0x11 },  // K
+    { 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x1F },  // L
+    { 0x11, 0x1B, 0x15, 0x15, 0x11, 0x11, 0x11 },  // M
+    { 0x11, 0x11, 0x19, 0x15, 0x13, 0x11, 0x11 },  // N
+    { 0x0E, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0E },  // O
+    { 0x1E, 0x11, 0x11, 0x1E, 0x10, 0x10, 0x10 },  // P
+    { 0x0E, 0x11, 0x11, 0x11, 0x15, 0x12, 0x0D },  // Q
+    { 0x1E, 0x11, 0x11, 0x1E, 0x14, 0x12, 0x11 },  // R
+    { 0x0F, 0x10, 0x10, 0x0E, 0x01, 0x01, 0x1E },  // S
+    { 0x1F, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04 },  // T
+    { 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0E },  // U
+    { 0x11, 0x11, 0x11, 0x11, 0x11, 0x0A, 0x04 },  // V
+    { 0x11, 0x11, 0x11, 0x15, 0x15, 0x15, 0x0A },  // W
+    { 0x11, 0x11, 0x0A, 0x04, 0x0A, 0x11, 0x11 },  // X
+    { 0x11, 0x11, 0x11, 0x0A, 0x04, 0x04, 0x04 },  // Y
+    { 0x1F, 0x01, 0x02, 0x04, 0x08, 0x10, 0x1F },  // Z
+};
+
+uint32_t PackRGBA(int r, int g, int b, int a)
+{
+    return (uint32_t)r | ((uint32_t)g << 8) | ((uint32_t)b << 16) | ((uint32_t)a << 24);
+}
+
+} // namespace
+
+BatchRenderer::~BatchRenderer()
+{
+    Shutdown();
+}
+
+// --------------------------------------------------------
+// 初期化 / 終了
+// --------------------------------------------------------
+bool BatchRenderer::Init(SDL_Renderer* r, int max_quads)
+{
+    Shutdown();
+    renderer = r;
+    geometry_error_logged = false;
+
+    if (!CreateAtlas())
+        return false;
+
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+    vertices.reserve((size_t)max_quads * 4);
+    indices.reserve((size_t)max_quads * 6);
+#else
+    quads.reserve(max_quads);
+    std::cout << "[RENDER] SDL_RenderGeometry unavailable, falling back to SDL_RenderCopy" << std::endl;
+#endif
+    return true;
+}
+
+void BatchRenderer::Shutdown()
+{
+    if (atlas)
+    {
+        SDL_DestroyTexture(atlas);
+        atlas = nullptr;
+    }
+    renderer = nullptr;
+}
+
+// 白を基調にしたアトラスを生成（色は頂点カラーで付ける）
+bool BatchRenderer::CreateAtlas()
+{
+    std::vector<uint32_t> pixels((size_t)ATLAS_SIZE * ATLAS_SIZE, 0);
+    auto put = [&pixels](int x, int y, uint32_t c) { pixels[(size_t)y * ATLAS_SIZE + x] = c; };
+
+    for (int i = 0; i < (int)AtlasRegion::COUNT; ++i)
+    {
+        const SDL_Rect& rc = ATLAS_LAYOUT[i];
+        for (int y = 0; y < rc.h; ++y)
+        {
+            for (int x = 0; x < rc.w; ++x)
+            {
+                uint32_t c = PackRGBA(255, 255, 255, 255);
+                switch ((AtlasRegion)i)
+                {
+                case AtlasRegion::NOTE: {
+                    // 上下の縁を明るく、中央をやや暗く
+                    const float t = std::fabs((y + 0.5f) / rc.h - 0.5f) * 2.0f;
+                    const int v = (int)(190 + 65 * t);
+                    c = PackRGBA(v, v, v, 255);
+                    break;
+                }
+                case AtlasRegion::LN_BODY:
+                    c = PackRGBA(255, 255, 255, 170);
+                    break;
+                case AtlasRegion::GLOW: {
+                    const float dx = (x + 0.5f) / rc.w - 0.5f;
+                    const float dy = (y + 0.5f) / rc.h - 0.5f;
+                    const float d = std::min(1.0f, std::sqrt(dx * dx + dy * dy) * 2.0f);
+                    c = PackRGBA(255, 255, 255, (int)(255 * (1.0f - d) * (1.0f - d)));
+                    break;
+                }
+                default:
+                    break;
+                }
+                put(rc.x + x, rc.y + y, c);
+            }
+        }
+
+        // テクセル中心で切り取り、隣の領域がにじまないようにする
+        src_rect[i] = rc;
+        uv[i] = { (rc.x + 0.5f) / ATLAS_SIZE, (rc.y + 0.5f) / ATLAS_SIZE,
+                  (rc.x + rc.w - 0.5f) / ATLAS_SIZE, (rc.y + rc.h - 0.5f) / ATLAS_SIZE };
+    }
+
+    // フォントの焼き込み（文字はセルの余白が透明なので端まで切り取ってよい）
+    for (int g = 0; g < GLYPH_COUNT; ++g)
+    {
+        const int gx = (g % GLYPH_COLUMNS) * GLYPH_CELL;
+        const int gy = GLYPH_ORIGIN_Y + (g / GLYPH_COLUMNS) * GLYPH_CELL;
+
+        for (int y = 0; y < GLYPH_HEIGHT; ++y)
+            for (int x = 0; x < GLYPH_WIDTH; ++x)
+                if (GLYPH_ROWS[g][y] & (0x10 >> x))
+                    put(gx + x, gy + y, PackRGBA(255, 255, 255, 255));
+
+        glyph_rect[g] = { gx, gy, GLYPH_WIDTH, GLYPH_HEIGHT };
+        glyph_uv[g] = { (float)gx / ATLAS_SIZE, (float)gy / ATLAS_SIZE,
+                        (float)(gx + GLYPH_WIDTH) / ATLAS_SIZE, (float)(gy + GLYPH_HEIGHT) / ATLAS_SIZE };
+    }
+
+    atlas = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ABGR8888, SDL_TEXTUREACCESS_STATIC,
+                              ATLAS_SIZE, ATLAS_SIZE);
+    if (!atlas)
+    {
+        std::cerr << "[RENDER] Failed to create atlas: " << SDL_GetError() << std::endl;
+        return false;
+    }
+
+    SDL_UpdateTexture(atlas, nullptr, pixels.data(), ATLAS_SIZE * (int)sizeof(uint32_t));
+    SDL_SetTextureBlendMode(atlas, SDL_BLENDMODE_BLEND);
+    return true;
+}
+
+// --------------------------------------------------------
+// 積み込み
+// --------------------------------------------------------
+void BatchRenderer::Begin()
+{
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+    vertices.clear();
+    indices.clear();
+#else
+    quads.clear();
+#endif
+    stats = BatchStats{};
+}
+
+void BatchRenderer::AddQuad(float x, float y, float w, float h, AtlasRegion region, SDL_Color color)
+{
+    PushQuad(x, y, w, h, uv[(int)region], src_rect[(int)region], color);
+}
+
+void BatchRenderer::PushQuad(float x, float y, float w, float h, const UVRect& t, const SDL_Rect& src, SDL_Color color)
+{
+    ++stats.quads;
+
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+    (void)src;
+    const int base = (int)vertices.size();
+
+    vertices.push_back({ { x,     y     }, color, { t.u0, t.v0 } });
+    vertices.push_back({ { x + w, y     }, color, { t.u1, t.v0 } });
+    vertices.push_back({ { x + w, y + h }, color, { t.u1, t.v1 } });
+    vertices.push_back({ { x,     y + h }, color, { t.u0, t.v1 } });
+
+    indices.push_back(base);
+    indices.push_back(base + 1);
+    indices.push_back(base + 2);
+    indices.push_back(base);
+    indices.push_back(base + 2);
+    indices.push_back(base + 3);
+#else
+    (void)t;
+    quads.push_back({ { x, y, w, h }, src, color });
+#endif
+}
+
+int BatchRenderer::GlyphIndex(char c)
+{
+    if (c >= 'a' && c <= 'z') c = (char)(c - 'a' + 'A');
+    if (c < GLYPH_FIRST || c > GLYPH_LAST) return -1;
+    return c - GLYPH_FIRST;
+}
+
+void BatchRenderer::AddGlyph(char c, float x, float y, float scale, SDL_Color color)
+{
+    const int g = GlyphIndex(c);
+    if (g <= 0) return;     // 空白・範囲外
+
+    PushQuad(x, y, GLYPH_WIDTH * scale, GLYPH_HEIGHT * scale, glyph_uv[g], glyph_rect[g], color);
+}
+
+void BatchRenderer::AddHLine(float x0, float x1, float y, float thickness, SDL_Color color)
+{
+    AddQuad(x0, y - thickness * 0.5f, x1 - x0, thickness, AtlasRegion::SOLID, color);
+}
+
+void BatchRenderer::AddVLine(float x, float y0, float y1, float thickness, SDL_Color color)
+{
+    AddQuad(x - thickness * 0.5f, y0, thickness, y1 - y0, AtlasRegion::SOLID, color);
+}
+
+// --------------------------------------------------------
+// 送信
+// --------------------------------------------------------
+void BatchRenderer::Flush()
+{
+    if (!renderer || !atlas) return;
+
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+    if (indices.empty()) return;
+
+    if (SDL_RenderGeometry(renderer, atlas, vertices.data(), (int)vertices.size(),
+                           indices.data(), (int)indices.size()) != 0)
+    {
+        ++stats.failed_calls;
+        if (!geometry_error_logged)
+        {
+            std::cerr << "[RENDER] SDL_RenderGeometry failed: " << SDL_GetError() << std::endl;
+            geometry_error_logged = true;
+        }
+    }
+    ++stats.draw_calls;
+
+    vertices.clear();
+    indices.clear();
+#else
+    for (const PendingQuad& q : quads)
+    {
+        SDL_SetTextureColorMod(atlas, q.color.r, q.color.g, q.color.b);
+        SDL_SetTextureAlphaMod(atlas, q.color.a);
+        SDL_RenderCopyF(renderer, atlas, &q.src, &q.dst);
+        ++stats.draw_calls;
+    }
+    quads.clear();
+#endif
+}
+
+// --------------------------------------------------------
+// ヘッドレス : サーフェスへ描くソフトウェアレンダラー
+// --------------------------------------------------------
+SDL_Renderer* BatchRenderer::CreateHeadless(int width, int height, SDL_Surface** out_surface)
+{
+    SDL_Surface* surface = SDL_CreateRGBSurfaceWithFormat(0, width, height, 32, SDL_PIXELFORMAT_ARGB8888);
+    if (!surface)
+    {
+        std::cerr << "[RENDER] Failed to create headless surface: " << SDL_GetError() << std::endl;
+        return nullptr;
+    }
+
+    SDL_Renderer* r = SDL_CreateSoftwareRenderer(surface);
+    if (!r)
+    {
+        std::cerr << "[RENDER] Failed to create software renderer: " << SDL_GetError() << std::endl;
+        SDL_FreeSurface(surface);
+        return nullptr;
+    }
+
+    if (out_surface) *out_surface = surface;
+    return r;
+}
+
+// --------------------------------------------------------
+// ノーツフィールド
+// --------------------------------------------------------
+FieldLayout FieldLayout::Make14Key(float start_x, float key_w, float scratch_w, float side_gap,
+                                   float field_top, float field_bottom)
+{
+    FieldLayout l;
+    l.top = field_top;
+    l.bottom = field_bottom;
+
+    const SDL_Color white   = { 0xEE, 0xEE, 0xEE, 0xFF };
+    const SDL_Color blue    = { 0x40, 0x90, 0xFF, 0xFF };
+    const SDL_Color scratch = { 0xFF, 0x40, 0x40, 0xFF };
+
+    // 各サイドの鍵盤順（チャンネル下位桁）: 1 2 3 4 5 8 9、皿は 6
+    const int keys[7] = { 1, 2, 3, 4, 5, 8, 9 };
+
+    float x = start_x;
+    for (int side = 0; side < 2; ++side)
+    {
+        const int base = side == 0 ? 0x10 : 0x20;
+
+        auto place = [&l](int channel, float lx, float w, SDL_Color c) {
+            const int lane = LaneKeysounds::LaneIndex(channel);
+            l.lane_x[lane] = lx;
+            l.lane_w[lane] = w;
+            l.lane_color[lane] = c;
+            l.lane_used[lane] = true;
+        };
+
+        if (side == 0) { place(base + 6, x, scratch_w, scratch); x += scratch_w; }
+        for (int k = 0; k < 7; ++k)
+        {
+            place(base + keys[k], x, key_w, (k % 2 == 0) ? white : blue);
+            x += key_w;
+        }
+        if (side == 1) { place(base + 6, x, scratch_w, scratch); x += scratch_w; }
+
+        x += side_gap;
+    }
+    return l;
+}
+
+void BatchDrawNotes(BatchRenderer& batch, const std::vector<DrawNote>& notes, const FieldLayout& layout,
+                    float judgeline_y)
+{
+    const float h = layout.note_height;
+
+    for (const DrawNote& dn : notes)
+    {
+        const int lane = LaneKeysounds::LaneIndex(dn.source->channel);
+        if (lane < 0 || !layout.lane_used[lane]) continue;
+
+        const float x = layout.lane_x[lane];
+        const float w = layout.lane_w[lane];
+        const float y = (float)dn.y_position;
+        const float len = (float)dn.length;
+        const SDL_Color c = layout.lane_color[lane];
+
+        // 範囲外（LN は本体が掛かっていれば描く）
+        if (y - len > layout.bottom + h || y < layout.top - h) continue;
+
+        if (len > 0.0f)
+        {
+            // 始点が判定ラインを過ぎた LN は、本体を判定ラインまで描き、始点を判定ラインに留める
+            const float head_y = std::min(y, judgeline_y);
+            if (head_y > y - len)
+                batch.AddQuad(x + 2.0f, y - len, w - 4.0f, head_y - (y - len), AtlasRegion::LN_BODY, c);
+            batch.AddQuad(x, y - len - h * 0.5f, w, h, AtlasRegion::NOTE, c);
+            batch.AddQuad(x, head_y - h * 0.5f, w, h, AtlasRegion::NOTE, c);
+            continue;
+        }
+
+        if (y <= layout.bottom + h)
+            batch.AddQuad(x, y - h * 0.5f, w, h, AtlasRegion::NOTE, c);
+    }
+}
+
+void BatchDrawField(BatchRenderer& batch, const FieldLayout& layout, float judgeline_y)
+{
+    const SDL_Color bg        = { 0x10, 0x10, 0x10, 0xFF };
+    const SDL_Color divider   = { 0x33, 0x33, 0x33, 0xFF };
+    const SDL_Color judgeline = { 0x00, 0xAA, 0xFF, 0xFF };
+
+    for (int i = 0; i < FIELD_LANE_COUNT; ++i)
+    {
+        if (!layout.lane_used[i]) continue;
+
+        const float x = layout.lane_x[i];
+        const float w = layout.lane_w[i];
+        batch.AddRect(x, layout.top, w, layout.bottom - layout.top, bg);
+        batch.AddVLine(x, layout.top, layout.bottom, 1.0f, divider);
+        batch.AddVLine(x + w, layout.top, layout.bottom, 1.0f, divider);
+        batch.AddHLine(x, x + w, judgeline_y, 3.0f, judgeline);
+    }
+}
+
+void BatchDrawJudgeEffect(BatchRenderer& batch, float center_x, float center_y, float size, float progress, SDL_Color color)
+{
+    if (progress < 0.0f || progress >= 1.0f) return;
+
+    const float s = size * (0.6f + 0.8f * progress);
+    color.a = (Uint8)(color.a * (1.0f - progress));
+    batch.AddQuad(center_x - s * 0.5f, center_y - s * 0.5f, s, s, AtlasRegion::GLOW, color);
+}
@@ -0,0 +1,156 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include <SDL.h>
+#include "Renderer.h"
+
+// ------------------------------------------------------------
+// バッチ描画バックエンド（SDL2）
+//  ・ノーツ / LN 本体 / 小節線 / レーン / 判定エフェクトを
+//    使い回しの頂点バッファに積み、アトラステクスチャ 1 枚につき
+//    SDL_RenderGeometry 1 回で送る
+//  ・アトラスは起動時に手続き生成する（外部画像なし）
+//    HUD 用の 5x7 ビットマップフォントも同じアトラスに焼き込むので、
+//    文字もノーツと同じ 1 回の描画で送れる
+//  ・SDL 2.0.18 未満では SDL_RenderCopy にフォールバックする
+//  ・CreateHeadless() はウィンドウもビデオドライバも使わない
+//    ソフトウェアレンダラーを作る（ベンチマーク / CI 用）
+// ------------------------------------------------------------
+
+// アトラス内の領域
+enum class AtlasRegion {
+    SOLID,      // 単色（線・矩形）
+    NOTE,       // ノーツ
+    LN_BODY,    // LN 本体
+    GLOW,       // 判定エフェクト
+    COUNT
+};
+
+// HUD 用ビットマップフォント（ASCII 0x20〜0x5A。小文字は大文字で描く）
+constexpr int GLYPH_WIDTH   = 5;
+constexpr int GLYPH_HEIGHT  = 7;
+constexpr int GLYPH_ADVANCE = 6;    // 文字送り（1px の字間を含む）
+constexpr char GLYPH_FIRST  = ' ';
+constexpr char GLYPH_LAST   = 'Z';
+constexpr int GLYPH_COUNT   = GLYPH_LAST - GLYPH_FIRST + 1;
+
+struct BatchStats {
+    int quads = 0;
+    int draw_calls = 0;
+    int failed_calls = 0;       // SDL_RenderGeometry が失敗した回数
+};
+
+class BatchRenderer
+{
+public:
+    BatchRenderer() = default;
+    ~BatchRenderer();
+
+    BatchRenderer(const BatchRenderer&) = delete;
+    BatchRenderer& operator=(const BatchRenderer&) = delete;
+
+    /**
+     * アトラスを生成して初期化する
+     * @param max_quads 事前確保する矩形数（超えた場合のみ伸長する）
+     */
+    bool Init(SDL_Renderer* renderer, int max_quads = 4096);
+
+    void Shutdown();
+
+    // フレーム開始（バッファをクリアするだけで解放しない）
+    void Begin();
+
+    /**
+     * 矩形を 1 つ積む（色はアトラスの白に乗算される）
+     */
+    void AddQuad(float x, float y, float w, float h, AtlasRegion region, SDL_Color color);
+
+    // よく使う形の糖衣
+    void AddRect(float x, float y, float w, float h, SDL_Color color) { AddQuad(x, y, w, h, AtlasRegion::SOLID, color); }
+    void AddHLine(float x0, float x1, float y, float thickness, SDL_Color color);
+    void AddVLine(float x, float y0, float y1, float thickness, SDL_Color color);
+
+    /**
+     * 文字を 1 つ積む（GLYPH_WIDTH x GLYPH_HEIGHT の scale 倍。空白・範囲外の文字は何も積まない）
+     */
+    void AddGlyph(char c, float x, float y, float scale, SDL_Color color);
+
+    // アトラス内の文字番号（描けない文字は -1）
+    static int GlyphIndex(char c);
+
+    /**
+     * 積んだ内容を送る（アトラス 1 枚なので SDL_RenderGeometry 1 回）
+     */
+    void Flush();
+
+    const BatchStats& GetStats() const { return stats; }
+
+    /**
+     * ウィンドウなしのソフトウェアレンダラーを作る
+     * @param out_surface 描画先サーフェス（呼び出し側で SDL_FreeSurface する）
+     */
+    static SDL_Renderer* CreateHeadless(int width, int height, SDL_Surface** out_surface);
+
+private:
+    struct UVRect { float u0, v0, u1, v1; };
+
+    bool CreateAtlas();
+    void PushQuad(float x, float y, float w, float h, const UVRect& t, const SDL_Rect& src, SDL_Color color);
+
+    SDL_Renderer* renderer = nullptr;
+    SDL_Texture* atlas = nullptr;
+    UVRect uv[(int)AtlasRegion::COUNT] = {};
+    SDL_Rect src_rect[(int)AtlasRegion::COUNT] = {};
+    UVRect glyph_uv[GLYPH_COUNT] = {};
+    SDL_Rect glyph_rect[GLYPH_COUNT] = {};
+
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+    std::vector<SDL_Vertex> vertices;
+    std::vector<int> indices;
+#else
+    struct PendingQuad { SDL_FRect dst; SDL_Rect src; SDL_Color color; };
+    std::vector<PendingQuad> quads;
+#endif
+
+    BatchStats stats;
+    bool geometry_error_logged = false;     // 失敗し続ける場合に毎フレーム出さない
+};
+
+// ------------------------------------------------------------
+// ノーツフィールドの配置（レーン番号は LaneKeysounds::LaneIndex と共通）
+// ------------------------------------------------------------
+constexpr int FIELD_LANE_COUNT = 18;
+
+struct FieldLayout {
+    float lane_x[FIELD_LANE_COUNT] = {};
+    float lane_w[FIELD_LANE_COUNT] = {};
+    SDL_Color lane_color[FIELD_LANE_COUNT] = {};
+    bool lane_used[FIELD_LANE_COUNT] = {};
+
+    float top = 0.0f;            // 描画範囲の上端
+    float bottom = 0.0f;         // 描画範囲の下端
+    float note_height = 12.0f;
+
+    /**
+     * 14 鍵（1P: 皿 + 7 鍵 / 2P: 7 鍵 + 皿）の標準配置を作る
+     */
+    static FieldLayout Make14Key(float start_x, float key_w, float scratch_w, float side_gap,
+                                 float top, float bottom);
+};
+
+/**
+ * RenderListBuilder の出力（LN 本体を含む）をバッチに積む
+ * 始点が判定ラインを過ぎた LN は、本体を judgeline_y まで描く
+ */
+void BatchDrawNotes(BatchRenderer& batch, const std::vector<DrawNote>& notes, const FieldLayout& layout,
+                    float judgeline_y);
+
+/**
+ * レーン背景・区切り線・判定ラインを積む
+ */
+void BatchDrawField(BatchRenderer& batch, const FieldLayout& layout, float judgeline_y);
+
+/**
+ * 判定エフェクト（progress 0→1 で広がりながら消える）
+ */
+void BatchDrawJudgeEffect(BatchRenderer& batch, float center_x, float center_y, float size, float progress, SDL_Color color);
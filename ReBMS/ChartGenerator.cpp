@@ -0,0 +1,241 @@
+#include "ChartGenerator.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <numeric>
+#include <vector>
+
+namespace {
+
+// 1P 側の 8 レーン（皿 16 を含む 7 鍵）
+constexpr int LANES[] = { 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x18, 0x19 };
+constexpr int LANE_COUNT = (int)(sizeof(LANES) / sizeof(LANES[0]));
+
+constexpr int MIN_NOTES_PER_MEASURE = 32;
+constexpr int BGM_PER_MEASURE = 4;
+
+struct Random {
+    uint32_t state;
+    explicit Random(uint32_t seed) : state(seed ? seed : 0x12345678u) {}
+    uint32_t Next() { state ^= state << 13; state ^= state >> 17; state ^= state << 5; return state; }
+    int Range(int n) { return (int)(Next() % (uint32_t)n); }
+    double Unit() { return (Next() >> 8) * (1.0 / 16777216.0); }
+};
+
+// 全 count 個を measures 小節に均等に割ったときの m 小節目の数
+int Share(int count, int measures, int m)
+{
+    return count / measures + (m < count % measures ? 1 : 0);
+}
+
+void AppendChannelHead(std::string& out, int measure, const char* channel)
+{
+    char head[16];
+    std::snprintf(head, sizeof(head), "#%03d%s:", measure, channel);
+    out += head;
+}
+
+void AppendHexChannelHead(std::string& out, int measure, int channel)
+{
+    char ch[4];
+    std::snprintf(ch, sizeof(ch), "%02X", channel);
+    AppendChannelHead(out, measure, ch);
+}
+
+// 1 つだけ置く行（位置 slot / division を約分して短くする）
+void AppendSingleObjectLine(std::string& out, int measure, int channel, int slot, int division, const std::string& id)
+{
+    const int g = std::gcd(slot, division);
+    const int n = division / g;
+    const int i = slot / g;
+
+    AppendHexChannelHead(out, measure, channel);
+    for (int k = 0; k < n; ++k) out += (k == i) ? id : "00";
+    out += '\n';
+}
+
+} // namespace
+
+std::string Base36Id(int n)
+{
+    static const char digits[] = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ";
+    n = std::clamp(n, 0, 36 * 36 - 1);
+    return std::string{ digits[n / 36], digits[n % 36] };
+}
+
+// --------------------------------------------------------
+// GenerateChart
+// --------------------------------------------------------
+std::string GenerateChart(const ChartGenConfig& config, ChartGenStats* stats)
+{
+    const int notes = std::clamp(config.notes, 0, CHART_GEN_MAX_NOTES);
+    const int keysounds = std::clamp(config.keysounds, 1, CHART_GEN_MAX_KEYSOUNDS);
+    const int bpm_changes = std::max(0, config.bpm_changes);
+    const int stops = std::max(0, config.stops);
+    const int random_blocks = std::max(0, config.random_blocks);
+    const int branches = std::max(1, config.random_branches);
+    const double ln_ratio = std::clamp(config.ln_ratio, 0.0, 1.0);
+
+    // 999 小節に収まるよう 1 小節あたりのノーツ数を決める（小節 000 は空けておく）
+    const int per_measure = std::max(MIN_NOTES_PER_MEASURE,
+        (notes + CHART_GEN_MAX_MEASURES - 2) / (CHART_GEN_MAX_MEASURES - 1));
+    const int measures = std::max(1, (notes + per_measure - 1) / per_measure);
+
+    const int bpm_defs = std::min(bpm_changes, CHART_GEN_MAX_KEYSOUNDS);
+    const int stop_defs = std::min(stops, CHART_GEN_MAX_KEYSOUNDS);
+
+    // LN 終端の計算は LN 毎に全オブジェクトを走査するので、指定があれば LN 数 × オブジェクト数で抑える
+    const double objects = (double)notes + (double)measures * BGM_PER_MEASURE + bpm_changes + stops
+                         + (double)random_blocks * branches;
+    const int max_long_notes = config.cap_ln
+        ? (int)std::min<double>(notes, CHART_GEN_MAX_LN_PARSE_STEPS / std::max(1.0, objects))
+        : notes;
+
+    Random rng(config.seed);
+    ChartGenStats st;
+    st.measures = measures;
+    st.max_long_notes = max_long_notes;
+
+    std::string out;
+    out.reserve((size_t)notes * 8 + (size_t)keysounds * 20 + 4096);
+
+    // -----------------------------
+    // ヘッダ
+    // -----------------------------
+    char line[128];
+    out += "#PLAYER 1\n#GENRE STRESS\n";
+    std::snprintf(line, sizeof(line), "#TITLE stress %d notes (seed %u)\n", notes, (unsigned)config.seed);
+    out += line;
+    out += "#ARTIST ChartGenerator\n";
+    std::snprintf(line, sizeof(line), "#BPM %.2f\n", config.initial_bpm);
+    out += line;
+
+    for (int i = 0; i < keysounds; ++i)
+    {
+        std::snprintf(line, sizeof(line), "#WAV%s k%04d.wav\n", Base36Id(i + 1).c_str(), i + 1);
+        out += line;
+    }
+    for (int i = 0; i < bpm_defs; ++i)
+    {
+        std::snprintf(line, sizeof(line), "#BPM%s %.1f\n", Base36Id(i + 1).c_str(), 90.0 + rng.Range(321) * 0.5);
+        out += line;
+    }
+    for (int i = 0; i < stop_defs; ++i)
+    {
+        std::snprintf(line, sizeof(line), "#STOP%s %.2f\n", Base36Id(i + 1).c_str(), 0.25 * (1 + rng.Range(4)));
+        out += line;
+    }
+
+    // -----------------------------
+    // 小節毎のデータ
+    // -----------------------------
+    int note_serial = 0;
+    int bpm_serial = 0;
+    int stop_serial = 0;
+    std::string data;
+    std::vector<int> ln_slots;
+    std::vector<int> ln_keysounds;
+
+    for (int m = 0; m < measures; ++m)
+    {
+        const int measure = m + 1;
+
+        // BGM
+        AppendChannelHead(out, measure, "01");
+        for (int i = 0; i < BGM_PER_MEASURE; ++i) out += Base36Id((m * BGM_PER_MEASURE + i) % keysounds + 1);
+        out += '\n';
+
+        // BPM 変化（偶数位置）と STOP（奇数位置）
+        const int bpm_here = bpm_defs > 0 ? Share(bpm_changes, measures, m) : 0;
+        if (bpm_here > 0)
+        {
+            AppendChannelHead(out, measure, "03");
+            for (int i = 0; i < bpm_here; ++i) out += Base36Id(bpm_serial++ % bpm_defs + 1) + "00";
+            out += '\n';
+            st.bpm_changes += bpm_here;
+        }
+
+        const int stop_here = stop_defs > 0 ? Share(stops, measures, m) : 0;
+        if (stop_here > 0)
+        {
+            AppendChannelHead(out, measure, "08");
+            for (int i = 0; i < stop_here; ++i) out += "00" + Base36Id(stop_serial++ % stop_defs + 1);
+            out += '\n';
+            st.stops += stop_here;
+        }
+
+        // 鍵盤ノーツ : レーン毎に等間隔。LN は次のノーツとの中間で終わる
+        const int notes_here = (m < measures - 1) ? per_measure : notes - per_measure * (measures - 1);
+        for (int l = 0; l < LANE_COUNT; ++l)
+        {
+            const int count = Share(notes_here, LANE_COUNT, l);
+            if (count <= 0) continue;
+
+            const int division = 192 * std::max(1, (count * 2 + 191) / 192);
+            const int step = division / count;
+
+            data.assign((size_t)division * 2, '0');
+            ln_slots.clear();
+            ln_keysounds.clear();
+            bool has_normal = false;
+
+            for (int k = 0; k < count; ++k)
+            {
+                const int slot = k * step;
+                const int keysound = (note_serial++ * 7 + l) % keysounds + 1;
+
+                const bool want_ln = ln_ratio > 0.0 && rng.Unit() < ln_ratio;
+                if (want_ln && st.long_notes + (int)ln_slots.size() >= max_long_notes) st.ln_capped = true;
+                else if (want_ln)
+                {
+                    ln_slots.push_back(slot);
+                    ln_keysounds.push_back(keysound);
+                    continue;
+                }
+                const std::string id = Base36Id(keysound);
+                data[(size_t)slot * 2]     = id[0];
+                data[(size_t)slot * 2 + 1] = id[1];
+                has_normal = true;
+            }
+
+            if (has_normal)
+            {
+                AppendHexChannelHead(out, measure, LANES[l]);
+                out += data;
+                out += '\n';
+            }
+
+            for (size_t i = 0; i < ln_slots.size(); ++i)
+            {
+                const std::string id = Base36Id(ln_keysounds[i]);
+                AppendSingleObjectLine(out, measure, LANES[l] + 0x40, ln_slots[i], division, id);
+                AppendSingleObjectLine(out, measure, LANES[l] + 0x50, ln_slots[i] + step / 2, division, id);
+            }
+
+            st.notes += count;
+            st.long_notes += (int)ln_slots.size();
+        }
+
+        // #RANDOM（全分岐が BGM を 1 行ずつ持つ）
+        const int random_here = Share(random_blocks, measures, m);
+        for (int b = 0; b < random_here; ++b)
+        {
+            std::snprintf(line, sizeof(line), "#RANDOM %d\n", branches);
+            out += line;
+            for (int i = 1; i <= branches; ++i)
+            {
+                std::snprintf(line, sizeof(line), "#IF %d\n", i);
+                out += line;
+                AppendChannelHead(out, measure, "01");
+                out += Base36Id(rng.Range(keysounds) + 1);
+                out += "00\n#ENDIF\n";
+            }
+            out += "#ENDRANDOM\n";
+        }
+        st.random_blocks += random_here;
+    }
+
+    st.bytes = out.size();
+    if (stats) *stats = st;
+    return out;
+}
@@ -0,0 +1,60 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// ------------------------------------------------------------
+// 負荷試験用の合成 BMS 譜面ジェネレータ
+//  ・鍵盤ノーツ数 / キー音定義数 / BPM 変化 / STOP / LN の割合 / #RANDOM ブロック数を指定して
+//    BMS のテキストを作る（BMSParser::ParseMemory にそのまま渡せる）
+//  ・チャンネルの意味はこのリポジトリの BMSParser に合わせる
+//    （03 : #BPMxx 参照の BPM 変化, 08 : #STOPxx 参照の STOP（拍数）, 51-59 / 61-69 : LN 始点 / 終点）
+//  ・小節番号は 3 桁なので最大 999 小節。ノーツが多いほど 1 小節の密度を上げる
+//  ・LN はパーサがチャンネル毎に 1 本ずつしか対応付けないため、始点 / 終点を 1 本ずつの行で書く
+//  ・#RANDOM / #IF はパーサが解釈しないので、全分岐の BGM がそのまま読まれる（行数の負荷として使う）
+//  ・パーサの LN 終端時刻の計算（BMSParser::CalculateLNEndTimes）は LN 1 本毎に譜面の先頭から走査するので、
+//    解析は O(LN 数 × オブジェクト数) になる。cap_ln を立てたときだけ、LN の数をその積が
+//    CHART_GEN_MAX_LN_PARSE_STEPS を超えないように抑える（ln_ratio より少なくなる。100 万ノーツなら数百本）
+//    既定では抑えず、ln_ratio のとおりに作る
+//  ・同じ設定とシードからは常に同じ譜面ができる
+// ------------------------------------------------------------
+
+constexpr int CHART_GEN_MAX_NOTES = 1000000;
+constexpr int CHART_GEN_MAX_KEYSOUNDS = 1295;    // 01〜ZZ（00 は休符）
+constexpr int CHART_GEN_MAX_MEASURES = 999;
+constexpr double CHART_GEN_MAX_LN_PARSE_STEPS = 5e8;   // LN 数 × オブジェクト数の上限（解析が数秒で終わる目安）
+
+struct ChartGenConfig {
+    int notes = 100000;             // 鍵盤ノーツ数（LN は 1 本を 1 と数える）
+    int keysounds = CHART_GEN_MAX_KEYSOUNDS;
+    int bpm_changes = 2000;
+    int stops = 1000;
+    double ln_ratio = 0.3;          // LN にするノーツの割合（0〜1）
+    bool cap_ln = false;            // 解析時間の上限に収まるよう LN 数を抑える（ln_ratio より少なくなる）
+    int random_blocks = 200;        // #RANDOM ブロック数
+    int random_branches = 4;        // 1 ブロックあたりの #IF 分岐数
+    double initial_bpm = 150.0;
+    uint32_t seed = 1;
+};
+
+// 生成結果の集計
+struct ChartGenStats {
+    int measures = 0;
+    int notes = 0;
+    int long_notes = 0;
+    int max_long_notes = 0;         // LN 数の上限（cap_ln なら解析の上限から決めた値、でなければノーツ数）
+    bool ln_capped = false;         // 上限のために ln_ratio より LN を減らしたか
+    int bpm_changes = 0;
+    int stops = 0;
+    int random_blocks = 0;
+    size_t bytes = 0;
+};
+
+/**
+ * 設定に従って BMS のテキストを作る（範囲外の値は上限 / 下限に丸める）
+ * @param stats 非 nullptr なら実際に書いた数を返す
+ */
+std::string GenerateChart(const ChartGenConfig& config, ChartGenStats* stats = nullptr);
+
+// 0〜1295 → "00"〜"ZZ"
+std::string Base36Id(int n);
@@ -0,0 +1,40 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+// ------------------------------------------------------------
+// 内容ハッシュ（64bit）
+//  ・ファイル内容の同一性判定用（暗号学的強度は不要）
+//  ・8byte 単位で乗算ミックスするため FNV より十分速い
+// ------------------------------------------------------------
+inline uint64_t HashContent(const void* data, size_t size, uint64_t seed = 0)
+{
+    const uint64_t K = 0x9E3779B97F4A7C15ULL;
+    const uint8_t* p = static_cast<const uint8_t*>(data);
+
+    uint64_t h = seed ^ (size * K);
+
+    auto mix = [&](uint64_t v) {
+        v *= 0xBF58476D1CE4E5B9ULL;
+        v ^= v >> 31;
+        h = (h ^ v) * K;
+        h ^= h >> 29;
+    };
+
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8)
+    {
+        uint64_t v;
+        std::memcpy(&v, p + i, 8);
+        mix(v);
+    }
+
+    uint64_t tail = 0;
+    for (size_t s = 0; i < size; ++i, s += 8)
+        tail |= (uint64_t)p[i] << s;
+    mix(tail);
+
+    h ^= h >> 32;
+    return h;
+}
@@ -0,0 +1,86 @@
+#include "EventLog.h"
+
+#include <algorithm>
+#include <iomanip>
+
+EventLog::EventLog(size_t capacity)
+    : records(std::max<size_t>(1, capacity))
+{
+}
+
+int EventLog::PackId(const char* id, size_t length)
+{
+    int v = 0;
+    for (size_t i = 0; i < length && i < 2; ++i)
+        v = (v << 8) | (unsigned char)id[i];
+    return v;
+}
+
+// --------------------------------------------------------
+// Flush : ここで初めて文字列に整形する
+// --------------------------------------------------------
+void EventLog::Flush(std::ostream& os)
+{
+    if (count == 0 && dropped == 0) return;
+
+    const std::ios::fmtflags flags = os.flags();
+    const std::streamsize precision = os.precision();
+    os << std::fixed << std::setprecision(2);
+
+    size_t index = (head + records.size() - count) % records.size();
+    for (size_t k = 0; k < count; ++k, index = (index + 1) % records.size())
+    {
+        const LogRecord& r = records[index];
+        switch (r.type)
+        {
+        case LogEvent::JUDGE:
+            os << "Judge: " << (r.label ? r.label : "?") << " (Diff: " << r.detail
+               << "ms) - Combo: " << r.value << "\n";
+            break;
+        case LogEvent::MISS:
+            os << "[MISS] lane=" << r.channel << " time=" << r.time_ms << "\n";
+            break;
+        case LogEvent::INPUT_MISS:
+            os << "Input: Miss (No note found in range for channel " << std::hex << r.channel << std::dec
+               << " at " << r.time_ms << "ms)\n";
+            break;
+        case LogEvent::LN_RESULT:
+            os << "[LN] lane " << r.channel << " -> " << (r.label ? r.label : "NONE") << "\n";
+            break;
+        case LogEvent::BGA:
+            os << "BGA Change: ID " << r.value << "\n";
+            break;
+        case LogEvent::LAYER:
+            if (r.value == 0) os << "Layer Clear\n";
+            else              os << "Layer Set: ID " << r.value << "\n";
+            break;
+        case LogEvent::POOR:
+            os << "Poor Image: ID " << r.value << "\n";
+            break;
+        case LogEvent::BPM:
+            os << "BPM Change: " << r.detail << " at " << r.time_ms << "ms\n";
+            break;
+        case LogEvent::QUALITY:
+            os << "[PERF] Quality -> " << (r.label ? r.label : "?") << " (frame " << r.value
+               << ", work " << r.detail << "ms)\n";
+            break;
+        case LogEvent::WAV:
+        {
+            const char id[3] = { (char)((r.value >> 8) & 0xFF), (char)(r.value & 0xFF), 0 };
+            os << "WAV Play: Channel " << std::hex << r.channel << std::dec
+               << " (Value: " << (id[0] ? id : id + 1) << ")\n";
+            break;
+        }
+        }
+    }
+
+    if (dropped > 0)
+        os << "[LOG] " << dropped << " events dropped (buffer full)\n";
+
+    os.flush();
+    os.flags(flags);
+    os.precision(precision);
+
+    count = 0;
+    dropped = 0;
+}
@@ -0,0 +1,81 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+// ------------------------------------------------------------
+// ゲームループ用のイベントログ
+//  ・判定 / MISS / LN / BGA / BPM / WAV などのログを、文字列にせず
+//    固定長レコードとしてリングバッファに積む（確保はコンストラクタで一度だけ）
+//  ・整形と出力は Flush でまとめて行う（ゲームループの外、デバッグ表示の頻度で呼ぶ）
+//  ・満杯になったら古いものから上書きし、失った件数を数える
+//  ・ゲームスレッド専用（ロックなし）。グローバルには置かず、プレイ毎（BMSGameApp / JudgeContext）に持つ
+// ------------------------------------------------------------
+
+enum class LogEvent : uint8_t {
+    JUDGE,          // label=判定名, time=ノーツ時刻, detail=ずれ(ms), value=コンボ
+    MISS,           // 見逃し
+    INPUT_MISS,     // 判定幅内にノーツがない空打ち
+    LN_RESULT,      // label=結果
+    BGA,            // value=BMP ID
+    LAYER,          // value=BMP ID（0 でクリア）
+    POOR,           // value=BMP ID（ミス時に表示する画像）
+    BPM,            // detail=新しい BPM
+    WAV,            // value=WAV ID の 2 文字を詰めたもの
+    QUALITY,        // label=新しい品質段階（FrameWatchdog）, value=フレーム番号, detail=作業時間(ms)
+};
+
+struct LogRecord {
+    LogEvent type;
+    int channel;
+    int value;
+    double time_ms;
+    double detail;
+    const char* label;  // 文字列リテラルのみ（寿命を持たないため）
+};
+
+class EventLog
+{
+public:
+    explicit EventLog(size_t capacity = 4096);
+
+    void Push(LogEvent type, int channel, int value, double time_ms,
+              double detail = 0.0, const char* label = nullptr) noexcept
+    {
+        if (!enabled) return;
+        LogRecord& r = records[head];
+        r.type = type;
+        r.channel = channel;
+        r.value = value;
+        r.time_ms = time_ms;
+        r.detail = detail;
+        r.label = label;
+
+        head = (head + 1) % records.size();
+        if (count < records.size()) ++count;
+        else ++dropped;
+    }
+
+    /**
+     * 溜まったレコードを整形して出力し、空にする
+     */
+    void Flush(std::ostream& os);
+
+    // 無効にすると Push は何もしない（ベンチマーク用）
+    void SetEnabled(bool on) { enabled = on; }
+
+    size_t GetPendingCount() const { return count; }
+    size_t GetCapacity() const { return records.size(); }
+    size_t GetDroppedCount() const { return dropped; }
+
+    // 2 文字の ID（"0A" など）を int に詰める（確保なし）
+    static int PackId(const char* id, size_t length);
+
+private:
+    std::vector<LogRecord> records;
+    size_t head = 0;
+    size_t count = 0;
+    size_t dropped = 0;
+    bool enabled = true;
+};
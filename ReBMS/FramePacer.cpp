@@ -0,0 +1,169 @@
+#include "FramePacer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <string>
+#include <thread>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#define REBMS_CPU_RELAX() _mm_pause()
+#elif defined(__x86_64__) || defined(__i386__)
+#define REBMS_CPU_RELAX() __builtin_ia32_pause()
+#else
+#define REBMS_CPU_RELAX() std::this_thread::yield()
+#endif
+
+namespace {
+
+constexpr int DEFAULT_STATS_WINDOW = 600;
+
+// 寝過ごし推定の範囲と追従速度
+constexpr double MIN_SPIN_MARGIN_MS = 0.2;
+constexpr double MAX_SPIN_MARGIN_MS = 4.0;
+constexpr double MARGIN_DECAY = 0.02;   // 寝過ごしが小さい状態が続いたら少しずつ縮める
+
+double ToMs(FramePacer::Clock::duration d)
+{
+    return std::chrono::duration<double, std::milli>(d).count();
+}
+
+} // namespace
+
+FramePacer::FramePacer()
+{
+    SetTargetHz(target_hz);
+    SetStatsWindow(DEFAULT_STATS_WINDOW);
+    Reset();
+}
+
+void FramePacer::SetTargetHz(double hz)
+{
+    target_hz = std::max(0.0, hz);
+    period = target_hz > 0.0
+        ? std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / target_hz))
+        : Clock::duration::zero();
+}
+
+void FramePacer::SetStatsWindow(int frames)
+{
+    intervals.assign(std::max(1, frames), 0.0);
+    interval_pos = 0;
+    interval_count = 0;
+}
+
+void FramePacer::Reset()
+{
+    last_frame = Clock::now();
+    deadline = last_frame + period;
+}
+
+// --------------------------------------------------------
+// SleepUntil : スリープで手前まで寝てから、締め切りまでスピンする
+// --------------------------------------------------------
+void FramePacer::SleepUntil(Clock::time_point target)
+{
+    const auto margin = std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double, std::milli>(spin_margin_ms));
+
+    const auto wake = target - margin;
+    auto now = Clock::now();
+    if (now < wake)
+    {
+        std::this_thread::sleep_until(wake);
+        now = Clock::now();
+
+        // 寝過ごし量を観測してマージンを調整する（大きくは即座に、小さくはゆっくり）
+        const double overshoot_ms = ToMs(now - wake);
+        if (overshoot_ms > spin_margin_ms)
+            spin_margin_ms = std::min(MAX_SPIN_MARGIN_MS, overshoot_ms * 1.25);
+        else
+            spin_margin_ms = std::max(MIN_SPIN_MARGIN_MS, spin_margin_ms - (spin_margin_ms - overshoot_ms) * MARGIN_DECAY);
+    }
+
+    while (Clock::now() < target)
+        REBMS_CPU_RELAX();
+}
+
+// --------------------------------------------------------
+// WaitForNextFrame
+// --------------------------------------------------------
+double FramePacer::WaitForNextFrame()
+{
+    if (period > Clock::duration::zero())
+    {
+        const auto now = Clock::now();
+        if (now < deadline)
+        {
+            SleepUntil(deadline);
+            deadline += period;
+        }
+        else
+        {
+            // 間に合わなかった。1 周期以上遅れていれば位相を取り直す
+            ++missed;
+            deadline += period;
+            if (deadline <= now) deadline = now + period;
+        }
+    }
+
+    const auto now = Clock::now();
+    const double interval_ms = ToMs(now - last_frame);
+    last_frame = now;
+
+    intervals[interval_pos] = interval_ms;
+    interval_pos = (interval_pos + 1) % intervals.size();
+    interval_count = std::min(interval_count + 1, (int)intervals.size());
+
+    return interval_ms;
+}
+
+// --------------------------------------------------------
+// 統計
+// --------------------------------------------------------
+FramePacerStats FramePacer::GetStats() const
+{
+    FramePacerStats s;
+    s.missed = missed;
+    s.spin_margin_ms = spin_margin_ms;
+    s.frames = interval_count;
+    if (interval_count == 0) return s;
+
+    std::vector<double> sorted(intervals.begin(), intervals.begin() + interval_count);
+    std::sort(sorted.begin(), sorted.end());
+
+    double sum = 0.0;
+    for (double v : sorted) sum += v;
+    s.avg_ms = sum / interval_count;
+
+    double var = 0.0;
+    for (double v : sorted) var += (v - s.avg_ms) * (v - s.avg_ms);
+    s.stddev_ms = std::sqrt(var / interval_count);
+
+    s.min_ms = sorted.front();
+    s.max_ms = sorted.back();
+    s.p99_ms = sorted[std::min((size_t)interval_count - 1, (size_t)std::ceil(interval_count * 0.99) - 1)];
+    return s;
+}
+
+void FramePacer::Report(std::ostream& os) const
+{
+    const FramePacerStats s = GetStats();
+    os << "[PACE] target " << (target_hz > 0.0 ? std::to_string((int)std::lround(target_hz)) + "Hz" : std::string("uncapped"))
+       << ", " << s.frames << " frames: avg " << std::fixed << std::setprecision(3) << s.avg_ms
+       << "ms sd " << s.stddev_ms << "ms min " << s.min_ms << "ms max " << s.max_ms
+       << "ms p99 " << s.p99_ms << "ms, missed " << s.missed
+       << ", spin margin " << s.spin_margin_ms << "ms" << std::endl;
+}
+
+double FramePacer::ParseTargetHz(const char* text, double fallback)
+{
+    if (!text || !*text) return fallback;
+    if (std::strcmp(text, "uncapped") == 0 || std::strcmp(text, "0") == 0) return PACER_UNCAPPED;
+
+    const double hz = std::atof(text);
+    return hz > 0.0 ? hz : fallback;
+}
@@ -0,0 +1,89 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+// ------------------------------------------------------------
+// フレームペーサー
+//  ・前フレームの所要時間から待ち時間を決めるのではなく、
+//    「前回の締め切り + 周期」という絶対時刻まで待つ（誤差が蓄積しない）
+//  ・待ちは OS スリープ → ビジーウェイトの二段構え
+//    スリープの寝過ごし量を観測し、その分だけ手前で起きてスピンする
+//  ・1 周期以上遅れた場合は締め切りを現在時刻に取り直す（取り返そうとして連打しない）
+//  ・目標レートは 60 / 120 / 144 / 240Hz などの任意値、0 で上限なし
+//  ・フレーム間隔の統計（平均・標準偏差・最大・99 パーセンタイル）を取る
+// ------------------------------------------------------------
+
+constexpr double PACER_UNCAPPED = 0.0;
+
+struct FramePacerStats {
+    int frames = 0;             // 集計対象のフレーム数（直近の窓）
+    double avg_ms = 0.0;
+    double stddev_ms = 0.0;     // フレーム間隔のばらつき（ジャダーの目安）
+    double min_ms = 0.0;
+    double max_ms = 0.0;
+    double p99_ms = 0.0;
+    uint64_t missed = 0;        // 締め切りに間に合わなかった回数（累計）
+    double spin_margin_ms = 0.0;
+};
+
+class FramePacer
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    FramePacer();
+
+    /**
+     * 目標フレームレート（Hz）。PACER_UNCAPPED で待たない
+     * 次の WaitForNextFrame から適用する
+     */
+    void SetTargetHz(double hz);
+    double GetTargetHz() const { return target_hz; }
+
+    // 1 フレームの周期（ms）。上限なしの場合は 0
+    double GetPeriodMs() const { return target_hz > 0.0 ? 1000.0 / target_hz : 0.0; }
+
+    /**
+     * 計測の起点を今にする（ループ開始時・ロード明けなど）
+     */
+    void Reset();
+
+    /**
+     * 次のフレームの締め切りまで待つ（フレームの最後、描画の提示直前 / 直後に呼ぶ）
+     * @return 前フレームからの経過時間（ms）。締め切りに間に合っていればほぼ周期ちょうど
+     */
+    double WaitForNextFrame();
+
+    // 直近の窓（既定 600 フレーム）の統計
+    FramePacerStats GetStats() const;
+
+    void SetStatsWindow(int frames);
+
+    // 統計を [PACE] 行で出力する
+    void Report(std::ostream& os) const;
+
+    /**
+     * 設定文字列（"60" / "144" / "uncapped" など）を目標レートに変換する
+     * 解釈できなければ fallback を返す
+     */
+    static double ParseTargetHz(const char* text, double fallback);
+
+private:
+    void SleepUntil(Clock::time_point deadline);
+
+    double target_hz = 60.0;
+    Clock::duration period{};
+
+    Clock::time_point deadline;     // 次フレームの締め切り
+    Clock::time_point last_frame;   // 前回 WaitForNextFrame を抜けた時刻
+
+    // スリープの寝過ごし量の推定（ms）。これだけ手前で起きてスピンする
+    double spin_margin_ms = 1.0;
+
+    std::vector<double> intervals;  // リングバッファ
+    size_t interval_pos = 0;
+    int interval_count = 0;
+    uint64_t missed = 0;
+};
@@ -0,0 +1,174 @@
+#include "FrameWatchdog.h"
+#include "EventLog.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <iterator>
+
+namespace {
+
+double ElapsedMs(FrameWatchdog::Clock::time_point from, FrameWatchdog::Clock::time_point to)
+{
+    return std::chrono::duration<double, std::milli>(to - from).count();
+}
+
+// 作業時間の平滑化係数（単発のスパイクでは段階を動かさない）
+constexpr double SMOOTHING = 0.25;
+
+} // namespace
+
+FrameWatchdog::FrameWatchdog()
+{
+    events.reserve(64);
+    frame_start = Clock::now();
+}
+
+void FrameWatchdog::SetHysteresis(int degrade, int restore, double head)
+{
+    degrade_frames = std::max(1, degrade);
+    restore_frames = std::max(1, restore);
+    headroom = head;
+}
+
+// --------------------------------------------------------
+// 計測
+// --------------------------------------------------------
+void FrameWatchdog::BeginFrame()
+{
+    frame_start = Clock::now();
+    std::fill(std::begin(stage_ms), std::end(stage_ms), 0.0);
+}
+
+void FrameWatchdog::BeginStage(FrameStage stage)
+{
+    stage_start[(int)stage] = Clock::now();
+}
+
+void FrameWatchdog::EndStage(FrameStage stage)
+{
+    // 1 フレームに同じ段が複数回あってもよい（合算する）
+    stage_ms[(int)stage] += ElapsedMs(stage_start[(int)stage], Clock::now());
+}
+
+FrameStage FrameWatchdog::Heaviest() const
+{
+    int best = 0;
+    for (int i = 1; i < (int)FrameStage::COUNT; ++i)
+        if (last_stage_ms[i] > last_stage_ms[best]) best = i;
+    return (FrameStage)best;
+}
+
+// --------------------------------------------------------
+// EndFrame : 予算との比較と段階の見直し
+// --------------------------------------------------------
+bool FrameWatchdog::EndFrame()
+{
+    const double work_ms = ElapsedMs(frame_start, Clock::now());
+    ++frame_index;
+
+    for (int i = 0; i < (int)FrameStage::COUNT; ++i)
+    {
+        last_stage_ms[i] = stage_ms[i];
+        sum_stage_ms[i] += stage_ms[i];
+        max_stage_ms[i] = std::max(max_stage_ms[i], stage_ms[i]);
+    }
+    sum_work_ms += work_ms;
+    max_work_ms = std::max(max_work_ms, work_ms);
+    ++window_frames;
+
+    smoothed_work_ms = frame_index == 1 ? work_ms : smoothed_work_ms + (work_ms - smoothed_work_ms) * SMOOTHING;
+
+    const bool overrun = work_ms > budget_ms;
+    if (overrun)
+    {
+        ++overrun_total;
+        ++window_overruns;
+    }
+
+    if (locked) return false;
+
+    // 超過は連続で、余裕は平滑値で判定する（復帰は慎重に）
+    over_streak = overrun && smoothed_work_ms > budget_ms * headroom ? over_streak + 1 : 0;
+    under_streak = smoothed_work_ms <= budget_ms * headroom ? under_streak + 1 : 0;
+
+    if (over_streak >= degrade_frames && level < QualityLevel::DROP_BGA_LAYER)
+    {
+        ChangeLevel((QualityLevel)((int)level + 1));
+        over_streak = 0;
+        under_streak = 0;
+        return true;
+    }
+    if (under_streak >= restore_frames && level > QualityLevel::FULL)
+    {
+        ChangeLevel((QualityLevel)((int)level - 1));
+        over_streak = 0;
+        under_streak = 0;
+        return true;
+    }
+    return false;
+}
+
+void FrameWatchdog::ChangeLevel(QualityLevel to)
+{
+    events.push_back({ frame_index, level, to, smoothed_work_ms, Heaviest() });
+    if (event_log) event_log->Push(LogEvent::QUALITY, 0, (int)frame_index, 0.0, smoothed_work_ms, LevelName(to));
+    level = to;
+}
+
+// --------------------------------------------------------
+// Report
+// --------------------------------------------------------
+void FrameWatchdog::Report(std::ostream& os)
+{
+    if (window_frames == 0) return;
+
+    os << "[PERF] " << window_frames << " frames, work avg " << std::fixed << std::setprecision(2)
+       << sum_work_ms / window_frames << "ms max " << max_work_ms << "ms, budget " << budget_ms
+       << "ms, overruns " << window_overruns << ", quality " << LevelName(level) << "\n";
+
+    os << "[PERF]  ";
+    for (int i = 0; i < (int)FrameStage::COUNT; ++i)
+        os << " " << StageName((FrameStage)i) << " " << sum_stage_ms[i] / window_frames
+           << "/" << max_stage_ms[i] << "ms";
+    os << " (avg/max)\n";
+
+    for (size_t k = reported_events; k < events.size(); ++k)
+    {
+        const DegradationEvent& e = events[k];
+        os << "[PERF]   frame " << e.frame << ": " << LevelName(e.from) << " -> " << LevelName(e.to)
+           << " at " << e.work_ms << "ms (" << StageName(e.heaviest) << ")\n";
+    }
+    reported_events = events.size();
+    os.flush();
+
+    std::fill(std::begin(sum_stage_ms), std::end(sum_stage_ms), 0.0);
+    std::fill(std::begin(max_stage_ms), std::end(max_stage_ms), 0.0);
+    sum_work_ms = 0.0;
+    max_work_ms = 0.0;
+    window_frames = 0;
+    window_overruns = 0;
+}
+
+const char* FrameWatchdog::StageName(FrameStage stage)
+{
+    switch (stage)
+    {
+    case FrameStage::INPUT:  return "input";
+    case FrameStage::UPDATE: return "update";
+    case FrameStage::RENDER: return "render";
+    case FrameStage::BGA:    return "bga";
+    default:                 return "?";
+    }
+}
+
+const char* FrameWatchdog::LevelName(QualityLevel level)
+{
+    switch (level)
+    {
+    case QualityLevel::FULL:            return "FULL";
+    case QualityLevel::SKIP_BGA_DECODE: return "SKIP_BGA_DECODE";
+    case QualityLevel::REDUCE_EFFECTS:  return "REDUCE_EFFECTS";
+    case QualityLevel::DROP_BGA_LAYER:  return "DROP_BGA_LAYER";
+    default:                            return "?";
+    }
+}
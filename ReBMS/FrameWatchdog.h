@@ -0,0 +1,154 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+class EventLog;
+
+// ------------------------------------------------------------
+// フレーム予算の監視と品質の段階的な切り下げ
+//  ・入力 / 更新 / 描画 / BGA の各段の所要時間を毎フレーム計測し、
+//    フレーム予算（目標フレームレートの 1 フレーム分）と比べる
+//  ・予算超過が続いたら、任意の処理を優先度の低い順に 1 段ずつ落とす
+//      1. BGA の新規デコード停止
+//      2. 判定エフェクト・小節線などの演出を削減
+//      3. BGA のレイヤー合成をやめて BASE のみ表示
+//  ・入力と判定（更新）、オーディオスレッドには一切手を出さない
+//    （ここは「何を省いてよいか」を答えるだけで、呼び出し側が従う）
+//  ・余裕のある状態がしばらく続いたら 1 段ずつ戻す
+//  ・段階の変化はイベントとして記録し、Report で計測結果と一緒に出力する
+//    その場では出力せず、SetEventLog で渡された EventLog に積むだけ（整形は EventLog::Flush）
+// ------------------------------------------------------------
+
+enum class FrameStage {
+    INPUT,
+    UPDATE,
+    RENDER,
+    BGA,
+    COUNT
+};
+
+// 切り下げ段階（数値が大きいほど多くを省く）
+enum class QualityLevel {
+    FULL = 0,
+    SKIP_BGA_DECODE = 1,
+    REDUCE_EFFECTS = 2,
+    DROP_BGA_LAYER = 3,
+};
+
+struct DegradationEvent {
+    uint64_t frame;
+    QualityLevel from;
+    QualityLevel to;
+    double work_ms;         // きっかけになったフレームの作業時間（平滑化後）
+    FrameStage heaviest;    // その時点で最も重かった段
+};
+
+class FrameWatchdog
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    FrameWatchdog();
+
+    /**
+     * フレーム予算（ms）。目標フレームレートから 1000 / hz で与える
+     */
+    void SetBudgetMs(double ms) { budget_ms = ms; }
+    double GetBudgetMs() const { return budget_ms; }
+
+    /**
+     * 切り下げ / 復帰の感度
+     * @param degrade_frames 予算超過がこのフレーム数続いたら 1 段落とす
+     * @param restore_frames 余裕（予算 × headroom 以下）がこのフレーム数続いたら 1 段戻す
+     */
+    void SetHysteresis(int degrade_frames, int restore_frames, double headroom = 0.7);
+
+    // 段階の変化を積むログ（nullptr なら積まない）
+    void SetEventLog(EventLog* log) { event_log = log; }
+
+    // 自動調整を止めて固定する（計測は続ける）
+    void SetLocked(bool lock) { locked = lock; }
+
+    // ------------------- 計測 -------------------
+    void BeginFrame();
+    void BeginStage(FrameStage stage);
+    void EndStage(FrameStage stage);
+
+    /**
+     * フレームの作業（待機を除く）を締め、品質段階を見直す
+     * @return 段階が変わった場合 true
+     */
+    bool EndFrame();
+
+    // スコープを抜けると EndStage する
+    class Scope
+    {
+    public:
+        Scope(FrameWatchdog& w, FrameStage s) : watchdog(w), stage(s) { watchdog.BeginStage(stage); }
+        ~Scope() { watchdog.EndStage(stage); }
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+    private:
+        FrameWatchdog& watchdog;
+        FrameStage stage;
+    };
+
+    // ------------------- 問い合わせ -------------------
+    QualityLevel GetLevel() const { return level; }
+    bool AllowBGADecode() const   { return level < QualityLevel::SKIP_BGA_DECODE; }
+    bool AllowEffects() const     { return level < QualityLevel::REDUCE_EFFECTS; }
+    bool AllowBGALayer() const    { return level < QualityLevel::DROP_BGA_LAYER; }
+
+    // 直近フレームの段毎の時間 / 作業時間の指数平滑値
+    double GetStageMs(FrameStage stage) const { return last_stage_ms[(int)stage]; }
+    double GetSmoothedWorkMs() const { return smoothed_work_ms; }
+
+    uint64_t GetFrameCount() const { return frame_index; }
+    uint64_t GetOverrunCount() const { return overrun_total; }
+    const std::vector<DegradationEvent>& GetEvents() const { return events; }
+
+    /**
+     * 前回の Report 以降の統計（段毎の平均・最大、超過フレーム数）と
+     * その間に起きた段階変化を [PERF] 行で出力し、区間統計をリセットする
+     */
+    void Report(std::ostream& os);
+
+    static const char* StageName(FrameStage stage);
+    static const char* LevelName(QualityLevel level);
+
+private:
+    void ChangeLevel(QualityLevel to);
+    FrameStage Heaviest() const;
+
+    double budget_ms = 1000.0 / 60.0;
+    int degrade_frames = 3;
+    int restore_frames = 120;
+    double headroom = 0.7;
+    bool locked = false;
+    EventLog* event_log = nullptr;
+
+    QualityLevel level = QualityLevel::FULL;
+    int over_streak = 0;
+    int under_streak = 0;
+
+    Clock::time_point frame_start;
+    Clock::time_point stage_start[(int)FrameStage::COUNT];
+    double stage_ms[(int)FrameStage::COUNT] = {};
+    double last_stage_ms[(int)FrameStage::COUNT] = {};
+    double smoothed_work_ms = 0.0;
+
+    // 区間統計（Report でリセット）
+    double sum_stage_ms[(int)FrameStage::COUNT] = {};
+    double max_stage_ms[(int)FrameStage::COUNT] = {};
+    double sum_work_ms = 0.0;
+    double max_work_ms = 0.0;
+    int window_frames = 0;
+    int window_overruns = 0;
+    size_t reported_events = 0;
+
+    uint64_t frame_index = 0;
+    uint64_t overrun_total = 0;
+    std::vector<DegradationEvent> events;
+};
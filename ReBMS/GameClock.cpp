@@ -0,0 +1,195 @@
+#include "GameClock.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+double SteadyClock::NowMs() const
+{
+    using namespace std::chrono;
+    return duration<double, std::milli>(steady_clock::now().time_since_epoch()).count();
+}
+
+// --------------------------------------------------------
+// コンストラクタ / リセット
+// --------------------------------------------------------
+GameClock::GameClock(const MonotonicClock* host_clock)
+    : host(host_clock ? host_clock : &default_host)
+{
+    Reset(0.0);
+}
+
+void GameClock::Reset(double start)
+{
+    has_anchor.store(false, std::memory_order_release);
+    chart_base_ms = start;
+    audio_base_ms = 0.0;
+    pending_rate = 0.0;
+    reset_host_ms = host->NowMs();
+    last_host_ms = reset_host_ms;
+    last_output_ms = 0.0;
+    last_error_ms = 0.0;
+    seen_anchor_audio_ms = 0.0;
+    has_seen_anchor = false;
+    started = false;
+}
+
+// --------------------------------------------------------
+// オーディオスレッド側 : アンカー更新（単一ライター）
+// --------------------------------------------------------
+void GameClock::OnAudioPosition(int64_t sample_position, int sample_rate)
+{
+    if (sample_rate <= 0) return;
+
+    const double audio_ms = (double)sample_position * 1000.0 / sample_rate;
+    const double host_ms = host->NowMs();
+
+    const uint32_t seq = anchor_seq.load(std::memory_order_relaxed);
+    anchor_seq.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    anchor_audio_ms.store(audio_ms, std::memory_order_relaxed);
+    anchor_host_ms.store(host_ms, std::memory_order_relaxed);
+
+    anchor_seq.store(seq + 2, std::memory_order_release);
+    has_anchor.store(true, std::memory_order_release);
+}
+
+bool GameClock::ReadAnchor(double& audio_ms, double& host_ms) const
+{
+    if (!has_anchor.load(std::memory_order_acquire))
+        return false;
+
+    for (;;)
+    {
+        const uint32_t s1 = anchor_seq.load(std::memory_order_acquire);
+        if (s1 & 1) continue;
+
+        audio_ms = anchor_audio_ms.load(std::memory_order_relaxed);
+        host_ms  = anchor_host_ms.load(std::memory_order_relaxed);
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (anchor_seq.load(std::memory_order_relaxed) == s1)
+            return true;
+    }
+}
+
+void GameClock::SetRate(double new_rate)
+{
+    if (new_rate <= 0.0) return;
+
+    // 現在位置を基準に付け替えて、チャート時刻を連続させる
+    chart_base_ms += (last_output_ms - audio_base_ms) * rate;
+    audio_base_ms = last_output_ms;
+    rate = new_rate;
+    pending_rate = 0.0;
+}
+
+void GameClock::SetRate(double new_rate, double at_audio_ms)
+{
+    if (new_rate <= 0.0) return;
+
+    // 先に予約された切り替えがあれば、その位置で確定させてから重ねる
+    if (pending_rate > 0.0)
+    {
+        chart_base_ms += (pending_audio_ms - audio_base_ms) * rate;
+        audio_base_ms = pending_audio_ms;
+        rate = pending_rate;
+        pending_rate = 0.0;
+    }
+
+    if (at_audio_ms <= last_output_ms)
+    {
+        // 過ぎた位置なら、そこを起点に付け替える（チャート時刻はその位置で連続する）
+        chart_base_ms += (at_audio_ms - audio_base_ms) * rate;
+        audio_base_ms = at_audio_ms;
+        rate = new_rate;
+        return;
+    }
+    pending_rate = new_rate;
+    pending_audio_ms = at_audio_ms;
+}
+
+double GameClock::ChartMsAt(double audio_ms) const
+{
+    if (pending_rate > 0.0 && audio_ms > pending_audio_ms)
+    {
+        const double at_pending = chart_base_ms + (pending_audio_ms - audio_base_ms) * rate;
+        return at_pending + (audio_ms - pending_audio_ms) * pending_rate;
+    }
+    return chart_base_ms + (audio_ms - audio_base_ms) * rate;
+}
+
+double GameClock::GetTimeMs()
+{
+    const double audio_ms = GetAudioTimeMs();
+    if (pending_rate > 0.0 && audio_ms >= pending_audio_ms)
+    {
+        chart_base_ms += (pending_audio_ms - audio_base_ms) * rate;
+        audio_base_ms = pending_audio_ms;
+        rate = pending_rate;
+        pending_rate = 0.0;
+    }
+    return chart_base_ms + (audio_ms - audio_base_ms) * rate;
+}
+
+// --------------------------------------------------------
+// ゲームスレッド側 : 補間 + ドリフト補正（オーディオ時間軸）
+// --------------------------------------------------------
+double GameClock::GetAudioTimeMs()
+{
+    const double now = host->NowMs();
+
+    // オーディオ位置から推定した「本来の」現在時刻
+    double estimate;
+    double audio_ms = 0.0, anchor_host = 0.0;
+    bool seek_back = false;     // オーディオ位置が前回見たアンカーより戻った
+    if (ReadAnchor(audio_ms, anchor_host))
+    {
+        seek_back = has_seen_anchor && audio_ms < seen_anchor_audio_ms;
+        seen_anchor_audio_ms = audio_ms;
+        has_seen_anchor = true;
+        const double since = std::clamp(now - anchor_host, 0.0, config.max_extrapolate_ms);
+        estimate = audio_ms + since - config.output_latency_ms;
+    }
+    else
+    {
+        estimate = now - reset_host_ms;
+    }
+
+    const double dt = std::max(0.0, now - last_host_ms);
+    const double predicted = last_output_ms + dt;
+    const double error = estimate - predicted;
+
+    double out;
+    bool snapped_back = false;
+    if (!started || error > config.snap_threshold_ms)
+    {
+        // 再生開始直後・大きく遅れている場合はスナップ
+        out = estimate;
+        started = true;
+    }
+    else if (error < -config.snap_threshold_ms)
+    {
+        // 大きく進み過ぎている
+        //  ・オーディオ位置が戻った（後方シーク）: そこへ合わせる
+        //  ・それ以外（アンダーラン等でオーディオが止まった / 再開直後）: 追いつくまでその場で待つ
+        snapped_back = seek_back;
+        out = seek_back ? estimate : last_output_ms;
+    }
+    else
+    {
+        // 速度を ±max_slew の範囲で増減してズレを吸収する
+        const double slew = std::clamp(error / config.correction_time_ms,
+                                       -config.max_slew, config.max_slew);
+        out = last_output_ms + dt * (1.0 + slew);
+    }
+
+    // 後方シーク以外では後退しない
+    if (!snapped_back) out = std::max(out, last_output_ms);
+
+    last_error_ms = error;
+    last_host_ms = now;
+    last_output_ms = out;
+    return out;
+}
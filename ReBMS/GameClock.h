@@ -0,0 +1,145 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+
+// ------------------------------------------------------------
+// ゲームクロック
+//  ・基準はオーディオデバイスのサンプル位置（コールバック毎に更新）
+//  ・コールバック間は単調増加の高分解能クロックで補間する
+//  ・オーディオ位置とのズレは再生速度をわずかに増減して滑らかに吸収する
+//    （大きなズレ＝シーク・再生開始時のみスナップ）
+//  ・オーディオ位置の更新が途絶えたら、最後の位置 + 補間の上限（+ スナップ閾値）で止まって待つ
+//  ・戻り値は後方シーク（オーディオ位置が戻った）時を除いて単調非減少で、判定・描画の両方が同じ値を使う
+//  ・練習モードの再生速度はオーディオ経過時間への倍率として掛ける
+// ------------------------------------------------------------
+
+// -------------------------------------
+// 単調増加クロック（テスト時は MockClock に差し替える）
+// -------------------------------------
+class MonotonicClock
+{
+public:
+    virtual ~MonotonicClock() = default;
+    virtual double NowMs() const = 0;
+};
+
+// std::chrono::steady_clock による実装
+class SteadyClock : public MonotonicClock
+{
+public:
+    double NowMs() const override;
+};
+
+// 手動で進めるクロック（テスト・ヘッドレス実行用）
+class MockClock : public MonotonicClock
+{
+public:
+    double NowMs() const override { return now_ms; }
+    void SetMs(double ms) { now_ms = ms; }
+    void AdvanceMs(double ms) { now_ms += ms; }
+
+private:
+    double now_ms = 0.0;
+};
+
+// -------------------------------------
+// ドリフト補正の設定
+// -------------------------------------
+struct GameClockConfig {
+    double snap_threshold_ms   = 50.0;   // これ以上ズレたら即座に合わせる
+    double max_slew            = 0.02;   // 補正時の最大速度変化（±2%）
+    double correction_time_ms  = 250.0;  // ズレをおおよそ何 ms かけて吸収するか
+    double max_extrapolate_ms  = 100.0;  // オーディオ更新が途絶えた時に補間を続ける上限
+    double output_latency_ms   = 0.0;    // ミックス時点から実際に鳴るまでの遅延
+};
+
+class GameClock
+{
+public:
+    /**
+     * @param host 補間に使う単調クロック（nullptr なら内部の SteadyClock）
+     */
+    explicit GameClock(const MonotonicClock* host = nullptr);
+
+    void SetConfig(const GameClockConfig& cfg) { config = cfg; }
+    const GameClockConfig& GetConfig() const { return config; }
+
+    /**
+     * 時計をリセットし、start_ms から進め直す
+     * start_ms はオーディオ位置 0（OnAudioPosition の基準）に対応するチャート時刻
+     * オーディオ位置の更新が来るまではホストクロックのみで進む
+     */
+    void Reset(double start_ms = 0.0);
+
+    /**
+     * 再生速度を設定する（練習モード）
+     * チャート時刻はオーディオ経過時間 × rate で進み、変更前後で連続する
+     */
+    void SetRate(double rate);
+    double GetRate() const { return rate; }
+
+    /**
+     * オーディオ経過時間 at_audio_ms から再生速度を変える（ミキサー・スケジューラと同じアンカーで切り替える）
+     * at_audio_ms がまだ来ていなければ、そこへ達した GetTimeMs から新しい速度で進む
+     */
+    void SetRate(double rate, double at_audio_ms);
+
+    /**
+     * オーディオ経過時間 → チャート時刻（現在の速度と、切り替え待ちの速度を考慮）
+     */
+    double ChartMsAt(double audio_ms) const;
+
+    // -------------------------------------
+    // オーディオスレッド側
+    // -------------------------------------
+
+    /**
+     * デバイスが処理したサンプル位置を通知する（コールバック毎）
+     * @param sample_position ストリーム先頭からの累計フレーム数
+     * @param sample_rate     デバイスのサンプルレート
+     */
+    void OnAudioPosition(int64_t sample_position, int sample_rate);
+
+    // -------------------------------------
+    // ゲームスレッド側
+    // -------------------------------------
+
+    /**
+     * 現在のゲーム（チャート）時間（ms）を返す
+     * 単調非減少（後方シークでオーディオ位置が戻ったときだけ、その位置へ戻る）
+     */
+    double GetTimeMs();
+
+    // 直近の補正量（ms, 正ならクロックが遅れている）
+    double GetLastErrorMs() const { return last_error_ms; }
+
+private:
+    // オーディオスレッドからの最新アンカー（シーケンスロックで受け渡す）
+    std::atomic<uint32_t> anchor_seq{0};
+    std::atomic<double>   anchor_audio_ms{0.0};
+    std::atomic<double>   anchor_host_ms{0.0};
+    std::atomic<bool>     has_anchor{false};
+
+    bool ReadAnchor(double& audio_ms, double& host_ms) const;
+
+    // 補間・補正済みのオーディオ経過時間（ms）
+    double GetAudioTimeMs();
+
+    SteadyClock default_host;
+    const MonotonicClock* host;
+    GameClockConfig config;
+
+    // ゲームスレッド側の状態
+    double rate = 1.0;
+    double chart_base_ms = 0.0;   // audio_base_ms に対応するチャート時刻
+    double audio_base_ms = 0.0;
+    double pending_rate = 0.0;           // at_audio_ms 付きの速度変更（0 なら無し）
+    double pending_audio_ms = 0.0;
+    double reset_host_ms = 0.0;
+    double last_host_ms = 0.0;
+    double last_output_ms = 0.0;
+    double last_error_ms = 0.0;
+    double seen_anchor_audio_ms = 0.0;   // 前回読んだアンカーのオーディオ位置（後方シークの検出用）
+    bool   has_seen_anchor = false;
+    bool   started = false;
+};
@@ -0,0 +1,212 @@
+#include "Hud.h"
+#include "BatchRenderer.h"
+
+#include <cmath>
+#include <cstring>
+
+namespace {
+
+constexpr double JUDGE_DISPLAY_MS = 500.0;      // 判定文字を出しておく時間
+constexpr double JUDGE_FADE_MS    = 150.0;      // 消える前のフェード
+
+constexpr float PANEL_SCALE   = 3.0f;           // スコア・コンボ・BPM
+constexpr float JUDGE_SCALE   = 5.0f;
+constexpr float TIMING_SCALE  = 3.0f;
+constexpr float MESSAGE_SCALE = 4.0f;
+constexpr float PANEL_MARGIN  = 16.0f;
+
+const HudColor PANEL_COLOR   = { 0xEE, 0xEE, 0xEE, 0xFF };
+const HudColor LABEL_COLOR   = { 0x99, 0x99, 0x99, 0xFF };
+const HudColor FAST_COLOR    = { 0x40, 0xA0, 0xFF, 0xFF };
+const HudColor SLOW_COLOR    = { 0xFF, 0x60, 0x40, 0xFF };
+const HudColor MESSAGE_COLOR = { 0xFF, 0xFF, 0xFF, 0xFF };
+
+SDL_Color ToSDL(HudColor c)
+{
+    return { c.r, c.g, c.b, c.a };
+}
+
+// 符号付き整数を後ろから書き出す（確保なし）。書いた文字数を返す
+int FormatInt(int value, char* out, int capacity)
+{
+    char digits[12];
+    int n = 0;
+    unsigned int v = value < 0 ? 0u - (unsigned int)value : (unsigned int)value;
+    do { digits[n++] = (char)('0' + v % 10); v /= 10; } while (v > 0 && n < (int)sizeof(digits));
+
+    int len = 0;
+    if (value < 0 && len < capacity) out[len++] = '-';
+    while (n > 0 && len < capacity) out[len++] = digits[--n];
+    return len;
+}
+
+} // namespace
+
+// --------------------------------------------------------
+// HudLabel
+// --------------------------------------------------------
+void HudLabel::SetOrigin(float x, float y, float s, bool c)
+{
+    origin_x = x;
+    origin_y = y;
+    scale = s;
+    center = c;
+    Layout();
+}
+
+bool HudLabel::SetText(const char* t)
+{
+    if (!t) t = "";
+
+    int n = 0;
+    while (n < MAX_CHARS && t[n]) ++n;
+    if (!has_number && n == length && std::memcmp(text, t, n) == 0) return false;
+
+    std::memcpy(text, t, n);
+    text[n] = '\0';
+    length = n;
+    has_number = false;
+
+    Layout();
+    return true;
+}
+
+bool HudLabel::SetNumber(const char* prefix, int value)
+{
+    if (has_number && number_prefix == prefix && number_value == value) return false;
+
+    length = 0;
+    for (const char* p = prefix; p && *p && length < MAX_CHARS; ++p) text[length++] = *p;
+    length += FormatInt(value, text + length, MAX_CHARS - length);
+    text[length] = '\0';
+
+    number_prefix = prefix;
+    number_value = value;
+    has_number = true;
+
+    Layout();
+    return true;
+}
+
+void HudLabel::Layout()
+{
+    ++layout_count;
+
+    const float advance = GLYPH_ADVANCE * scale;
+    width = length > 0 ? length * advance - scale : 0.0f;
+    const float left = center ? origin_x - width * 0.5f : origin_x;
+
+    glyph_count = 0;
+    for (int i = 0; i < length; ++i)
+    {
+        if (BatchRenderer::GlyphIndex(text[i]) <= 0) continue;     // 空白・描けない文字は積まない
+        glyph_x[glyph_count] = std::floor(left + i * advance);
+        glyph_char[glyph_count] = text[i];
+        ++glyph_count;
+    }
+}
+
+void HudLabel::Draw(BatchRenderer& batch, HudColor color) const
+{
+    const SDL_Color c = ToSDL(color);
+    for (int i = 0; i < glyph_count; ++i)
+        batch.AddGlyph(glyph_char[i], glyph_x[i], origin_y, scale, c);
+}
+
+// --------------------------------------------------------
+// Hud
+// --------------------------------------------------------
+void Hud::Layout(float screen_w, float screen_h, float field_center_x, float judge_y)
+{
+    const float line = GLYPH_HEIGHT * PANEL_SCALE + 8.0f;
+    const float panel_x = screen_w - PANEL_MARGIN - 12 * GLYPH_ADVANCE * PANEL_SCALE;
+
+    score.SetOrigin(panel_x, PANEL_MARGIN, PANEL_SCALE);
+    combo.SetOrigin(panel_x, PANEL_MARGIN + line, PANEL_SCALE);
+    bpm.SetOrigin(panel_x, PANEL_MARGIN + line * 2, PANEL_SCALE);
+
+    judge.SetOrigin(field_center_x, judge_y, JUDGE_SCALE, true);
+    judge_combo.SetOrigin(field_center_x, judge_y + GLYPH_HEIGHT * JUDGE_SCALE + 6.0f, PANEL_SCALE, true);
+    timing.SetOrigin(field_center_x, judge_y - GLYPH_HEIGHT * TIMING_SCALE - 6.0f, TIMING_SCALE, true);
+
+    message.SetOrigin(screen_w * 0.5f, screen_h * 0.5f - GLYPH_HEIGHT * MESSAGE_SCALE * 0.5f, MESSAGE_SCALE, true);
+
+    SetScore(0);
+    SetCombo(0);
+}
+
+void Hud::SetScore(int value)
+{
+    score.SetNumber("SCORE ", value);
+}
+
+void Hud::SetCombo(int value)
+{
+    combo_value = value;
+    combo.SetNumber("COMBO ", value);
+    judge_combo.SetNumber("", value);
+}
+
+void Hud::SetBPM(double value)
+{
+    bpm.SetNumber("BPM ", (int)std::lround(value));
+}
+
+void Hud::ShowJudge(const char* label, HudColor color, HudTiming t, double now_ms)
+{
+    judge.SetText(label);
+    judge_color = color;
+    judge_timing = t;
+    judge_time_ms = now_ms;
+
+    // FAST / SLOW の文字は 2 種類しかないので切り替え時のみ並べ直す
+    if (t != HudTiming::NONE) timing.SetText(t == HudTiming::FAST ? "FAST" : "SLOW");
+}
+
+void Hud::SetMessage(const char* text)
+{
+    has_message = text != nullptr;
+    if (text) message.SetText(text);
+}
+
+void Hud::Draw(BatchRenderer& batch, double now_ms) const
+{
+    score.Draw(batch, PANEL_COLOR);
+    combo.Draw(batch, combo_value > 0 ? PANEL_COLOR : LABEL_COLOR);
+    bpm.Draw(batch, PANEL_COLOR);
+
+    // 判定は表示時間の終わりに向けてフェードアウトする
+    const double elapsed = now_ms - judge_time_ms;
+    if (elapsed >= 0.0 && elapsed < JUDGE_DISPLAY_MS)
+    {
+        const double remain = JUDGE_DISPLAY_MS - elapsed;
+        const float fade = remain < JUDGE_FADE_MS ? (float)(remain / JUDGE_FADE_MS) : 1.0f;
+
+        HudColor c = judge_color;
+        c.a = (uint8_t)(c.a * fade);
+        judge.Draw(batch, c);
+
+        if (combo_value > 0)
+        {
+            HudColor cc = PANEL_COLOR;
+            cc.a = (uint8_t)(cc.a * fade);
+            judge_combo.Draw(batch, cc);
+        }
+
+        if (judge_timing != HudTiming::NONE)
+        {
+            HudColor tc = judge_timing == HudTiming::FAST ? FAST_COLOR : SLOW_COLOR;
+            tc.a = (uint8_t)(tc.a * fade);
+            timing.Draw(batch, tc);
+        }
+    }
+
+    if (has_message) message.Draw(batch, MESSAGE_COLOR);
+}
+
+int Hud::GetLayoutCount() const
+{
+    return score.GetLayoutCount() + combo.GetLayoutCount() + bpm.GetLayoutCount()
+         + judge.GetLayoutCount() + timing.GetLayoutCount() + judge_combo.GetLayoutCount()
+         + message.GetLayoutCount();
+}
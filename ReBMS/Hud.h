@@ -0,0 +1,130 @@
+#pragma once
+#include <cstdint>
+
+class BatchRenderer;
+
+// ------------------------------------------------------------
+// プレイ画面の HUD（スコア / コンボ / 判定 / FAST・SLOW / BPM / メッセージ）
+//  ・文字は BatchRenderer のアトラスに焼き込んだビットマップフォントで描く
+//    → ノーツと同じバッチに積み、同じ 1 回の描画で送る
+//  ・値が変わったときだけ文字列を作り直して配置し（レイアウト）、
+//    毎フレームの Draw は配置済みの文字を積むだけ
+//  ・文字列は固定長バッファに持つ（確保なし）。コンソール出力は一切しない
+// ------------------------------------------------------------
+
+// SDL に依存しない色（BatchRenderer 側で SDL_Color にする）
+struct HudColor {
+    uint8_t r, g, b, a;
+};
+
+// ------------------------------------------------------------
+// 1 行分の文字列と、その配置結果
+// ------------------------------------------------------------
+class HudLabel
+{
+public:
+    static constexpr int MAX_CHARS = 32;
+
+    /**
+     * 表示位置（center=true なら x を中央として揃える）
+     * scale はフォントの拡大率（整数倍を推奨）
+     */
+    void SetOrigin(float x, float y, float scale, bool center = false);
+
+    /**
+     * 文字列を設定する。前回と同じなら何もしない
+     * @return 並べ直した場合 true
+     */
+    bool SetText(const char* text);
+
+    /**
+     * "prefix + 整数" を設定する。前回と同じ prefix・値なら文字列も作らない
+     */
+    bool SetNumber(const char* prefix, int value);
+
+    void Draw(BatchRenderer& batch, HudColor color) const;
+
+    float GetWidth() const { return width; }
+    int GetLayoutCount() const { return layout_count; }
+
+private:
+    void Layout();
+
+    char text[MAX_CHARS + 1] = {};
+    int length = 0;
+
+    // SetNumber のキャッシュ
+    const char* number_prefix = nullptr;
+    int number_value = 0;
+    bool has_number = false;
+
+    // 配置結果（空白は積まない）
+    float glyph_x[MAX_CHARS] = {};
+    char glyph_char[MAX_CHARS] = {};
+    int glyph_count = 0;
+    float width = 0.0f;
+
+    float origin_x = 0.0f;
+    float origin_y = 0.0f;
+    float scale = 1.0f;
+    bool center = false;
+    int layout_count = 0;
+};
+
+enum class HudTiming {
+    NONE,
+    FAST,
+    SLOW
+};
+
+// ------------------------------------------------------------
+// HUD 本体
+// ------------------------------------------------------------
+class Hud
+{
+public:
+    /**
+     * 画面サイズとノーツフィールドの位置から各行の配置を決める
+     * @param field_center_x 判定文字を出す中心
+     * @param judge_y 判定文字の高さ（判定ラインの少し上など）
+     */
+    void Layout(float screen_w, float screen_h, float field_center_x, float judge_y);
+
+    // ------------------- 値の更新（変化があったときだけ並べ直す） -------------------
+    void SetScore(int score);
+    void SetCombo(int combo);
+    void SetBPM(double bpm);
+
+    /**
+     * 判定を表示する（一定時間で消える）
+     * @param label 判定名（文字列リテラル）
+     * @param timing FAST / SLOW 表示（NONE で出さない）
+     */
+    void ShowJudge(const char* label, HudColor color, HudTiming timing, double now_ms);
+
+    // 中央のメッセージ（nullptr で消す）
+    void SetMessage(const char* message);
+
+    /**
+     * HUD 全体をバッチに積む（Flush はノーツと一緒に呼び出し側で行う）
+     */
+    void Draw(BatchRenderer& batch, double now_ms) const;
+
+    // これまでの並べ直し回数（値が変わらないフレームで増えないことの確認用）
+    int GetLayoutCount() const;
+
+private:
+    HudLabel score;
+    HudLabel combo;
+    HudLabel bpm;
+    HudLabel judge;
+    HudLabel timing;
+    HudLabel judge_combo;
+    HudLabel message;
+
+    HudColor judge_color = { 255, 255, 255, 255 };
+    HudTiming judge_timing = HudTiming::NONE;
+    double judge_time_ms = -1.0e9;
+    int combo_value = 0;
+    bool has_message = false;
+};
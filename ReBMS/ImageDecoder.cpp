@@ -0,0 +1,980 @@
+#include "ImageDecoder.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define REBMS_SSE2 1
+#endif
+
+// 24bit の並べ替えは SSSE3（pshufb）が要る
+//  ・コンパイル時に有効ならそのまま使う
+//  ・x86 で SSE2 止まりのビルドは、target 属性付きのカーネルを CPUID で選ぶ
+#if defined(__SSSE3__) || defined(__AVX__)
+#include <tmmintrin.h>
+#define REBMS_SSSE3 1
+#define REBMS_SSSE3_TARGET
+#elif defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <tmmintrin.h>
+#define REBMS_SSSE3 1
+#define REBMS_SSSE3_DISPATCH 1
+#define REBMS_SSSE3_TARGET __attribute__((target("ssse3")))
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#include <tmmintrin.h>
+#define REBMS_SSSE3 1
+#define REBMS_SSSE3_DISPATCH 1
+#define REBMS_SSSE3_TARGET
+#endif
+
+ImageStore g_image_store;
+
+namespace {
+
+constexpr int MAX_IMAGE_SIZE = 8192;
+
+uint32_t ReadLE32(const uint8_t* p) { return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24); }
+uint16_t ReadLE16(const uint8_t* p) { return (uint16_t)(p[0] | (p[1] << 8)); }
+uint32_t ReadBE32(const uint8_t* p) { return ((uint32_t)p[0] << 24) | (p[1] << 16) | (p[2] << 8) | p[3]; }
+
+uint32_t Pack(uint8_t r, uint8_t g, uint8_t b, uint8_t a, PixelFormat format)
+{
+    if (format == PixelFormat::BGRA8)
+        return b | (g << 8) | (r << 16) | ((uint32_t)a << 24);
+    return r | (g << 8) | (b << 16) | ((uint32_t)a << 24);
+}
+
+std::atomic<uint64_t> g_store_version{0};
+
+// --------------------------------------------------------
+// 行変換カーネル
+//  swap : 入力の 1 バイト目と 3 バイト目を入れ替えて出力する
+//         （BMP の BGR → RGBA8、PNG の RGB → BGRA8 の場合）
+//  key  : RGB が 0 のピクセルを 0（完全透明）にする
+// --------------------------------------------------------
+inline uint32_t Finish(uint32_t px, bool key)
+{
+    return (key && (px & 0x00FFFFFFu) == 0) ? 0u : px;
+}
+
+#if REBMS_SSSE3_DISPATCH
+bool HasSSSE3()
+{
+#if defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 1);
+    return (info[2] & (1 << 9)) != 0;
+#else
+    return __builtin_cpu_supports("ssse3");
+#endif
+}
+
+const bool g_has_ssse3 = HasSSSE3();
+#endif
+
+#if REBMS_SSSE3
+// 変換したピクセル数を返す（残りはスカラーで処理する）
+REBMS_SSSE3_TARGET int ConvertRow24SSSE3(uint32_t* dst, const uint8_t* src, int n, bool swap, bool key)
+{
+    int i = 0;
+
+    // 16 バイト読んで 4 ピクセル（12 バイト）を使う。行末を読み越さない範囲だけ
+    const __m128i shuffle = swap
+        ? _mm_setr_epi8(2, 1, 0, -1, 5, 4, 3, -1, 8, 7, 6, -1, 11, 10, 9, -1)
+        : _mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+    const __m128i alpha = _mm_set1_epi32((int)0xFF000000u);
+    const __m128i zero = _mm_setzero_si128();
+
+    for (; i + 6 <= n; i += 4)
+    {
+        __m128i v = _mm_loadu_si128((const __m128i*)(src + i * 3));
+        v = _mm_shuffle_epi8(v, shuffle);
+        if (key)
+        {
+            const __m128i transparent = _mm_cmpeq_epi32(v, zero);
+            v = _mm_andnot_si128(transparent, _mm_or_si128(v, alpha));
+        }
+        else
+        {
+            v = _mm_or_si128(v, alpha);
+        }
+        _mm_storeu_si128((__m128i*)(dst + i), v);
+    }
+    return i;
+}
+#endif
+
+void ConvertRow24(uint32_t* dst, const uint8_t* src, int n, bool swap, bool key)
+{
+    int i = 0;
+
+#if REBMS_SSSE3_DISPATCH
+    if (g_has_ssse3) i = ConvertRow24SSSE3(dst, src, n, swap, key);
+#elif REBMS_SSSE3
+    i = ConvertRow24SSSE3(dst, src, n, swap, key);
+#endif
+
+    const int r = swap ? 2 : 0;
+    const int b = swap ? 0 : 2;
+    for (; i < n; ++i)
+    {
+        const uint8_t* s = src + i * 3;
+        dst[i] = Finish(s[r] | (s[1] << 8) | (s[b] << 16) | 0xFF000000u, key);
+    }
+}
+
+void ConvertRow32(uint32_t* dst, const uint8_t* src, int n, bool swap, bool key, bool use_alpha)
+{
+    int i = 0;
+
+#if REBMS_SSE2
+    const __m128i mask_rb = _mm_set1_epi32(0x00FF00FF);
+    const __m128i mask_rgb = _mm_set1_epi32(0x00FFFFFF);
+    const __m128i alpha = _mm_set1_epi32((int)0xFF000000u);
+    const __m128i zero = _mm_setzero_si128();
+
+    for (; i + 4 <= n; i += 4)
+    {
+        __m128i v = _mm_loadu_si128((const __m128i*)(src + i * 4));
+        if (swap)
+        {
+            // 各 32bit 内の下位 16bit と上位 16bit を入れ替えると R と B が入れ替わる
+            __m128i rb = _mm_and_si128(v, mask_rb);
+            rb = _mm_shufflehi_epi16(_mm_shufflelo_epi16(rb, _MM_SHUFFLE(2, 3, 0, 1)), _MM_SHUFFLE(2, 3, 0, 1));
+            v = _mm_or_si128(_mm_andnot_si128(mask_rb, v), rb);
+        }
+        if (!use_alpha) v = _mm_or_si128(v, alpha);
+        if (key)
+        {
+            const __m128i transparent = _mm_cmpeq_epi32(_mm_and_si128(v, mask_rgb), zero);
+            v = _mm_andnot_si128(transparent, v);
+        }
+        _mm_storeu_si128((__m128i*)(dst + i), v);
+    }
+#endif
+
+    for (; i < n; ++i)
+    {
+        uint32_t px = ReadLE32(src + i * 4);
+        if (swap) px = (px & 0xFF00FF00u) | ((px & 0xFFu) << 16) | ((px >> 16) & 0xFFu);
+        if (!use_alpha) px |= 0xFF000000u;
+        dst[i] = Finish(px, key);
+    }
+}
+
+// パレット画像 : 変換済みの表を引く（1/2/4/8bit, MSB から詰められている）
+void ExpandPaletteRow(uint32_t* dst, const uint8_t* src, int n, int bits, const uint32_t* palette)
+{
+    if (bits == 8)
+    {
+        for (int i = 0; i < n; ++i) dst[i] = palette[src[i]];
+        return;
+    }
+
+    const int per_byte = 8 / bits;
+    const int mask = (1 << bits) - 1;
+    for (int i = 0; i < n; ++i)
+    {
+        const int shift = 8 - bits * (i % per_byte + 1);
+        dst[i] = palette[(src[i / per_byte] >> shift) & mask];
+    }
+}
+
+// --------------------------------------------------------
+// BMP
+// --------------------------------------------------------
+struct BMPHeader {
+    uint32_t data_offset;
+    uint32_t header_size;
+    int width;
+    int height;
+    bool top_down;
+    int bpp;
+    bool use_alpha;     // 32bit で α マスクが指定されている
+    size_t row_bytes;
+};
+
+bool ParseBMP(const uint8_t* data, size_t size, BMPHeader& h)
+{
+    if (size < 54 || data[0] != 'B' || data[1] != 'M') return false;
+
+    h.data_offset = ReadLE32(data + 10);
+    h.header_size = ReadLE32(data + 14);
+    const int32_t raw_height = (int32_t)ReadLE32(data + 22);
+    const uint32_t compression = ReadLE32(data + 30);
+    h.width = (int32_t)ReadLE32(data + 18);
+    h.bpp = ReadLE16(data + 28);
+
+    // BI_RGB と BI_BITFIELDS(32bit, BGRA 並びのみ) を扱う
+    if (h.header_size < 40) return false;
+    if (compression != 0 && !(compression == 3 && h.bpp == 32)) return false;
+    if (h.bpp != 1 && h.bpp != 4 && h.bpp != 8 && h.bpp != 24 && h.bpp != 32) return false;
+    if (h.width <= 0 || raw_height == 0 || h.width > MAX_IMAGE_SIZE) return false;
+
+    h.top_down = raw_height < 0;
+    h.height = h.top_down ? -raw_height : raw_height;
+    if (h.height > MAX_IMAGE_SIZE) return false;
+
+    // V4/V5 ヘッダで α マスクがある 32bit だけ α を使う（BI_RGB の 4 バイト目は大抵ゴミ）
+    h.use_alpha = h.bpp == 32 && h.header_size >= 56 && 14 + 56 <= size && ReadLE32(data + 14 + 52) != 0;
+
+    // BI_BITFIELDS の RGB マスク（40 バイトのヘッダなら直後、V4/V5 ならヘッダ内の同じ位置）
+    // BGRA 並び（α は無しか最上位バイト）以外は並べ替えのカーネルでは読めないので受け付けない
+    if (compression == 3)
+    {
+        if (14 + 52 > size) return false;
+        if (ReadLE32(data + 54) != 0x00FF0000u || ReadLE32(data + 58) != 0x0000FF00u ||
+            ReadLE32(data + 62) != 0x000000FFu)
+            return false;
+        if (h.use_alpha && ReadLE32(data + 14 + 52) != 0xFF000000u) return false;
+        if (h.data_offset < 14 + h.header_size + (h.header_size == 40 ? 12u : 0u)) return false;
+    }
+
+    h.row_bytes = (((size_t)h.width * h.bpp + 7) / 8 + 3) & ~(size_t)3;
+    return h.data_offset + h.row_bytes * h.height <= size;
+}
+
+bool DecodeBMP(const uint8_t* data, size_t size, const ImageView& dst, const DecodeOptions& opt)
+{
+    BMPHeader h;
+    if (!ParseBMP(data, size, h)) return false;
+    if (dst.width != h.width || dst.height != h.height) return false;
+
+    uint32_t palette[256] = {};
+    if (h.bpp <= 8)
+    {
+        uint32_t colors = ReadLE32(data + 46);
+        if (colors == 0 || colors > (1u << h.bpp)) colors = 1u << h.bpp;
+        const size_t pal = 14 + h.header_size;
+        if (pal + colors * 4 > size) return false;
+        for (uint32_t i = 0; i < colors; ++i)
+        {
+            const uint8_t* c = data + pal + i * 4;
+            palette[i] = Finish(Pack(c[2], c[1], c[0], 0xFF, opt.format), opt.color_key);
+        }
+    }
+
+    // BMP は BGR 並びなので RGBA8 へは入れ替えが要る
+    const bool swap = opt.format == PixelFormat::RGBA8;
+
+    for (int y = 0; y < h.height; ++y)
+    {
+        const uint8_t* row = data + h.data_offset + h.row_bytes * (h.top_down ? y : h.height - 1 - y);
+        uint32_t* out = dst.pixels + (size_t)y * dst.stride;
+
+        if (h.bpp <= 8)       ExpandPaletteRow(out, row, h.width, h.bpp, palette);
+        else if (h.bpp == 24) ConvertRow24(out, row, h.width, swap, opt.color_key);
+        else                  ConvertRow32(out, row, h.width, swap, opt.color_key, h.use_alpha);
+    }
+    return true;
+}
+
+// --------------------------------------------------------
+// Inflate（RFC 1951）: 出力サイズが既知の一括展開
+// --------------------------------------------------------
+struct Huffman {
+    short count[16];
+    short symbol[288];
+};
+
+class Inflater
+{
+public:
+    Inflater(const uint8_t* src, size_t src_size, uint8_t* out, size_t out_size)
+        : in(src), in_size(src_size), dst(out), dst_size(out_size)
+    {
+    }
+
+    bool Run()
+    {
+        int last;
+        do
+        {
+            last = Bits(1);
+            const int type = Bits(2);
+            bool ok;
+            if (type == 0)      ok = Stored();
+            else if (type == 1) ok = Fixed();
+            else if (type == 2) ok = Dynamic();
+            else                ok = false;
+            if (!ok || error) return false;
+        } while (!last);
+        return written == dst_size;
+    }
+
+private:
+    int Bits(int need)
+    {
+        while (bit_count < need)
+        {
+            if (in_pos >= in_size) { error = true; return 0; }
+            bit_buf |= (uint32_t)in[in_pos++] << bit_count;
+            bit_count += 8;
+        }
+        const int v = (int)(bit_buf & ((1u << need) - 1));
+        bit_buf >>= need;
+        bit_count -= need;
+        return v;
+    }
+
+    static int Build(Huffman& h, const short* lengths, int n)
+    {
+        short offs[16];
+        std::memset(h.count, 0, sizeof(h.count));
+        for (int s = 0; s < n; ++s) h.count[lengths[s]]++;
+        if (h.count[0] == n) return 0;
+
+        int left = 1;
+        for (int len = 1; len < 16; ++len)
+        {
+            left <<= 1;
+            left -= h.count[len];
+            if (left < 0) return -1;   // 過剰
+        }
+
+        offs[1] = 0;
+        for (int len = 1; len < 15; ++len) offs[len + 1] = offs[len] + h.count[len];
+        for (int s = 0; s < n; ++s)
+            if (lengths[s] != 0) h.symbol[offs[lengths[s]]++] = (short)s;
+        return left;
+    }
+
+    int Decode(const Huffman& h)
+    {
+        int code = 0, first = 0, index = 0;
+        for (int len = 1; len < 16; ++len)
+        {
+            code |= Bits(1);
+            const int count = h.count[len];
+            if (code - count < first) return h.symbol[index + (code - first)];
+            index += count;
+            first += count;
+            first <<= 1;
+            code <<= 1;
+        }
+        error = true;
+        return -1;
+    }
+
+    bool Stored()
+    {
+        bit_buf = 0;
+        bit_count = 0;
+        if (in_pos + 4 > in_size) return false;
+        const size_t len = in[in_pos] | (in[in_pos + 1] << 8);
+        const size_t nlen = in[in_pos + 2] | (in[in_pos + 3] << 8);
+        in_pos += 4;
+        if (len != (~nlen & 0xFFFF)) return false;
+        if (in_pos + len > in_size || written + len > dst_size) return false;
+        std::memcpy(dst + written, in + in_pos, len);
+        in_pos += len;
+        written += len;
+        return true;
+    }
+
+    bool Codes(const Huffman& lencode, const Huffman& distcode)
+    {
+        static const short LEN_BASE[29] = {
+            3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+            35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+        static const short LEN_EXTRA[29] = {
+            0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+            3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+        static const short DIST_BASE[30] = {
+            1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+            257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+        static const short DIST_EXTRA[30] = {
+            0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+            7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+
+        for (;;)
+        {
+            int symbol = Decode(lencode);
+            if (error) return false;
+            if (symbol < 256)
+            {
+                if (written >= dst_size) return false;
+                dst[written++] = (uint8_t)symbol;
+            }
+            else if (symbol == 256)
+            {
+                return true;
+            }
+            else
+            {
+                symbol -= 257;
+                if (symbol >= 29) return false;
+                const size_t len = LEN_BASE[symbol] + Bits(LEN_EXTRA[symbol]);
+
+                const int ds = Decode(distcode);
+                if (error || ds < 0 || ds >= 30) return false;
+                const size_t dist = DIST_BASE[ds] + Bits(DIST_EXTRA[ds]);
+
+                if (error || dist > written || written + len > dst_size) return false;
+                const uint8_t* from = dst + written - dist;
+                for (size_t k = 0; k < len; ++k) dst[written + k] = from[k];
+                written += len;
+            }
+        }
+    }
+
+    bool Fixed()
+    {
+        static Huffman lencode, distcode;
+        static const bool built = [] {
+            short lengths[288];
+            int s = 0;
+            for (; s < 144; ++s) lengths[s] = 8;
+            for (; s < 256; ++s) lengths[s] = 9;
+            for (; s < 280; ++s) lengths[s] = 7;
+            for (; s < 288; ++s) lengths[s] = 8;
+            Build(lencode, lengths, 288);
+            for (s = 0; s < 30; ++s) lengths[s] = 5;
+            Build(distcode, lengths, 30);
+            return true;
+        }();
+        (void)built;
+        return Codes(lencode, distcode);
+    }
+
+    bool Dynamic()
+    {
+        static const short ORDER[19] = { 16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15 };
+
+        const int nlen = Bits(5) + 257;
+        const int ndist = Bits(5) + 1;
+        const int ncode = Bits(4) + 4;
+        if (error || nlen > 286 || ndist > 30) return false;
+
+        short lengths[320] = {};
+        for (int i = 0; i < ncode; ++i) lengths[ORDER[i]] = (short)Bits(3);
+
+        Huffman lencode, distcode;
+        if (Build(lencode, lengths, 19) != 0) return false;
+
+        int index = 0;
+        while (index < nlen + ndist)
+        {
+            int symbol = Decode(lencode);
+            if (error) return false;
+            if (symbol < 16)
+            {
+                lengths[index++] = (short)symbol;
+                continue;
+            }
+
+            short len = 0;
+            if (symbol == 16)
+            {
+                if (index == 0) return false;
+                len = lengths[index - 1];
+                symbol = 3 + Bits(2);
+            }
+            else if (symbol == 17) symbol = 3 + Bits(3);
+            else                   symbol = 11 + Bits(7);
+
+            if (index + symbol > nlen + ndist) return false;
+            while (symbol--) lengths[index++] = len;
+        }
+
+        if (lengths[256] == 0) return false;
+
+        // 不完全な符号は 1 符号だけの場合のみ許す
+        const int err_len = Build(lencode, lengths, nlen);
+        if (err_len < 0 || (err_len > 0 && nlen - lencode.count[0] != 1)) return false;
+        const int err_dist = Build(distcode, lengths + nlen, ndist);
+        if (err_dist < 0 || (err_dist > 0 && ndist - distcode.count[0] != 1)) return false;
+
+        return Codes(lencode, distcode);
+    }
+
+    const uint8_t* in;
+    size_t in_size;
+    size_t in_pos = 0;
+    uint32_t bit_buf = 0;
+    int bit_count = 0;
+
+    uint8_t* dst;
+    size_t dst_size;
+    size_t written = 0;
+    bool error = false;
+};
+
+// --------------------------------------------------------
+// PNG
+// --------------------------------------------------------
+const uint8_t PNG_SIGNATURE[8] = { 0x89, 'P', 'N', 'G', 0x0D, 0x0A, 0x1A, 0x0A };
+
+struct PNGHeader {
+    int width;
+    int height;
+    int depth;
+    int color_type;
+    bool has_trns;
+};
+
+bool IsPNG(const uint8_t* data, size_t size)
+{
+    return size >= 8 && std::memcmp(data, PNG_SIGNATURE, 8) == 0;
+}
+
+bool ParsePNGHeader(const uint8_t* data, size_t size, PNGHeader& h)
+{
+    if (!IsPNG(data, size) || size < 8 + 8 + 13) return false;
+    if (ReadBE32(data + 8) != 13 || std::memcmp(data + 12, "IHDR", 4) != 0) return false;
+
+    const uint8_t* p = data + 16;
+    h.width = (int)ReadBE32(p);
+    h.height = (int)ReadBE32(p + 4);
+    h.depth = p[8];
+    h.color_type = p[9];
+    h.has_trns = false;
+
+    // 8bit の非インターレースのみ（パレットは 1/2/4bit も可）
+    if (p[10] != 0 || p[11] != 0 || p[12] != 0) return false;
+    if (h.width <= 0 || h.height <= 0 || h.width > MAX_IMAGE_SIZE || h.height > MAX_IMAGE_SIZE) return false;
+    if (h.color_type == 3) return h.depth == 1 || h.depth == 2 || h.depth == 4 || h.depth == 8;
+    if (h.color_type != 0 && h.color_type != 2 && h.color_type != 4 && h.color_type != 6) return false;
+    return h.depth == 8;
+}
+
+int PNGChannels(int color_type)
+{
+    switch (color_type)
+    {
+    case 2: return 3;
+    case 4: return 2;
+    case 6: return 4;
+    default: return 1;
+    }
+}
+
+inline uint8_t Paeth(int a, int b, int c)
+{
+    const int p = a + b - c;
+    const int pa = std::abs(p - a), pb = std::abs(p - b), pc = std::abs(p - c);
+    if (pa <= pb && pa <= pc) return (uint8_t)a;
+    return (uint8_t)(pb <= pc ? b : c);
+}
+
+bool Unfilter(uint8_t* row, const uint8_t* prev, size_t row_bytes, int bpp, int filter)
+{
+    switch (filter)
+    {
+    case 0:
+        return true;
+    case 1:
+        for (size_t i = bpp; i < row_bytes; ++i) row[i] = (uint8_t)(row[i] + row[i - bpp]);
+        return true;
+    case 2:
+        if (prev) for (size_t i = 0; i < row_bytes; ++i) row[i] = (uint8_t)(row[i] + prev[i]);
+        return true;
+    case 3:
+        for (size_t i = 0; i < row_bytes; ++i)
+        {
+            const int left = i >= (size_t)bpp ? row[i - bpp] : 0;
+            const int up = prev ? prev[i] : 0;
+            row[i] = (uint8_t)(row[i] + ((left + up) >> 1));
+        }
+        return true;
+    case 4:
+        for (size_t i = 0; i < row_bytes; ++i)
+        {
+            const int left = i >= (size_t)bpp ? row[i - bpp] : 0;
+            const int up = prev ? prev[i] : 0;
+            const int up_left = (prev && i >= (size_t)bpp) ? prev[i - bpp] : 0;
+            row[i] = (uint8_t)(row[i] + Paeth(left, up, up_left));
+        }
+        return true;
+    default:
+        return false;
+    }
+}
+
+bool DecodePNG(const uint8_t* data, size_t size, const ImageView& dst, const DecodeOptions& opt)
+{
+    PNGHeader h;
+    if (!ParsePNGHeader(data, size, h)) return false;
+    if (dst.width != h.width || dst.height != h.height) return false;
+
+    // 展開後のフィルタ済み行と、複数 IDAT の連結用（スレッド毎に使い回す）
+    thread_local std::vector<uint8_t> raw;
+    thread_local std::vector<uint8_t> idat_joined;
+
+    uint32_t palette[256] = {};
+    int palette_size = 0;
+    int trns_gray = -1;
+    const uint8_t* idat = nullptr;
+    size_t idat_size = 0;
+    int idat_chunks = 0;
+    idat_joined.clear();
+
+    size_t pos = 8;
+    while (pos + 12 <= size)
+    {
+        const size_t len = ReadBE32(data + pos);
+        const uint8_t* type = data + pos + 4;
+        const uint8_t* body = data + pos + 8;
+        if (pos + 12 + len > size) return false;
+
+        if (std::memcmp(type, "PLTE", 4) == 0)
+        {
+            palette_size = (int)std::min<size_t>(len / 3, 256);
+            for (int i = 0; i < palette_size; ++i)
+                palette[i] = Pack(body[i * 3], body[i * 3 + 1], body[i * 3 + 2], 0xFF, opt.format);
+        }
+        else if (std::memcmp(type, "tRNS", 4) == 0)
+        {
+            if (h.color_type == 3)
+            {
+                for (size_t i = 0; i < len && i < 256; ++i)
+                    palette[i] = (palette[i] & 0x00FFFFFFu) | ((uint32_t)body[i] << 24);
+            }
+            else if (h.color_type == 0 && len >= 2)
+            {
+                trns_gray = body[1];
+            }
+        }
+        else if (std::memcmp(type, "IDAT", 4) == 0)
+        {
+            // 1 チャンクならそのまま展開し、分割されている場合だけ連結する
+            if (idat_chunks == 1) idat_joined.assign(idat, idat + idat_size);
+            if (idat_chunks >= 1) idat_joined.insert(idat_joined.end(), body, body + len);
+            idat = body;
+            idat_size = len;
+            ++idat_chunks;
+        }
+        else if (std::memcmp(type, "IEND", 4) == 0)
+        {
+            break;
+        }
+        pos += 12 + len;
+    }
+
+    if (idat_chunks == 0) return false;
+    if (idat_chunks > 1)
+    {
+        idat = idat_joined.data();
+        idat_size = idat_joined.size();
+    }
+    if (h.color_type == 3 && palette_size == 0) return false;
+
+    // zlib ヘッダ（deflate, プリセット辞書なし）
+    if (idat_size < 2) return false;
+    if ((idat[0] & 0x0F) != 8 || ((idat[0] << 8) | idat[1]) % 31 != 0 || (idat[1] & 0x20)) return false;
+
+    const int channels = PNGChannels(h.color_type);
+    const int bits_per_pixel = channels * h.depth;
+    const size_t row_bytes = ((size_t)h.width * bits_per_pixel + 7) / 8;
+    const int filter_bpp = std::max(1, bits_per_pixel / 8);
+
+    raw.resize((row_bytes + 1) * h.height);
+    Inflater inflater(idat + 2, idat_size - 2, raw.data(), raw.size());
+    if (!inflater.Run()) return false;
+
+    if (opt.color_key)
+        for (int i = 0; i < 256; ++i) palette[i] = Finish(palette[i], true);
+
+    // PNG は RGB 並びなので BGRA8 へは入れ替えが要る
+    const bool swap = opt.format == PixelFormat::BGRA8;
+
+    const uint8_t* prev = nullptr;
+    for (int y = 0; y < h.height; ++y)
+    {
+        uint8_t* line = raw.data() + (row_bytes + 1) * y;
+        uint8_t* row = line + 1;
+        if (!Unfilter(row, prev, row_bytes, filter_bpp, line[0])) return false;
+        prev = row;
+
+        uint32_t* out = dst.pixels + (size_t)y * dst.stride;
+        switch (h.color_type)
+        {
+        case 2:
+            ConvertRow24(out, row, h.width, swap, opt.color_key);
+            break;
+        case 6:
+            ConvertRow32(out, row, h.width, swap, opt.color_key, true);
+            break;
+        case 3:
+            ExpandPaletteRow(out, row, h.width, h.depth, palette);
+            break;
+        case 0:
+            for (int x = 0; x < h.width; ++x)
+            {
+                const uint8_t g = row[x];
+                out[x] = Finish(Pack(g, g, g, g == trns_gray ? 0 : 0xFF, opt.format), opt.color_key);
+            }
+            break;
+        case 4:
+            for (int x = 0; x < h.width; ++x)
+            {
+                const uint8_t g = row[x * 2];
+                out[x] = Finish(Pack(g, g, g, row[x * 2 + 1], opt.format), opt.color_key);
+            }
+            break;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+// --------------------------------------------------------
+// 公開 API
+// --------------------------------------------------------
+bool ReadImageInfo(const uint8_t* data, size_t size, ImageInfo& info)
+{
+    if (IsPNG(data, size))
+    {
+        PNGHeader h;
+        if (!ParsePNGHeader(data, size, h)) return false;
+
+        bool has_trns = false;
+        for (size_t pos = 8; pos + 12 <= size;)
+        {
+            const size_t len = ReadBE32(data + pos);
+            if (std::memcmp(data + pos + 4, "tRNS", 4) == 0) { has_trns = true; break; }
+            if (std::memcmp(data + pos + 4, "IDAT", 4) == 0) break;
+            pos += 12 + len;
+        }
+
+        info.width = h.width;
+        info.height = h.height;
+        info.has_alpha = h.color_type == 4 || h.color_type == 6 || has_trns;
+        return true;
+    }
+
+    BMPHeader h;
+    if (!ParseBMP(data, size, h)) return false;
+    info.width = h.width;
+    info.height = h.height;
+    info.has_alpha = h.use_alpha;
+    return true;
+}
+
+bool DecodeImage(const uint8_t* data, size_t size, const ImageView& dst, const DecodeOptions& opt)
+{
+    if (!dst.pixels || dst.stride < dst.width) return false;
+    if (IsPNG(data, size)) return DecodePNG(data, size, dst, opt);
+    return DecodeBMP(data, size, dst, opt);
+}
+
+bool ReadFileBytes(const std::string& path, std::vector<uint8_t>& buf)
+{
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file) return false;
+
+    const std::streamoff size = file.tellg();
+    if (size <= 0) return false;
+    buf.resize((size_t)size);
+    file.seekg(0);
+    return (bool)file.read((char*)buf.data(), size);
+}
+
+bool DecodeImageFile(const std::string& path, BGAImage& out, const DecodeOptions& opt)
+{
+    thread_local std::vector<uint8_t> file_buf;
+    if (!ReadFileBytes(path, file_buf)) return false;
+
+    ImageInfo info;
+    if (!ReadImageInfo(file_buf.data(), file_buf.size(), info)) return false;
+
+    out.width = info.width;
+    out.height = info.height;
+    out.has_alpha = info.has_alpha || opt.color_key;
+    out.pixels.resize((size_t)info.width * info.height);
+
+    const ImageView view{ out.pixels.data(), info.width, info.height, info.width };
+    return DecodeImage(file_buf.data(), file_buf.size(), view, opt);
+}
+
+// --------------------------------------------------------
+// ImageAtlas
+// --------------------------------------------------------
+ImageAtlas::ImageAtlas(int size, PixelFormat fmt)
+    : page_size(size), format(fmt)
+{
+}
+
+void ImageAtlas::Clear()
+{
+    pages.clear();
+    entries.clear();
+}
+
+bool ImageAtlas::Allocate(int width, int height, AtlasEntry& out)
+{
+    // 余白込みの大きさで詰める
+    const int w = width + 1;
+    const int h = height + 1;
+    if (w > page_size || h > page_size) return false;
+
+    for (int p = 0; p < (int)pages.size(); ++p)
+    {
+        Page& page = *pages[p];
+
+        // 高さの無駄が最小のシェルフを選ぶ
+        Shelf* best = nullptr;
+        for (Shelf& s : page.shelves)
+            if (h <= s.height && s.x + w <= page_size && (!best || s.height < best->height))
+                best = &s;
+
+        if (!best && page.next_y + h <= page_size)
+        {
+            page.shelves.push_back({ page.next_y, h, 0 });
+            page.next_y += h;
+            best = &page.shelves.back();
+        }
+        if (!best) continue;
+
+        out = { p, best->x, best->y, width, height };
+        best->x += w;
+        return true;
+    }
+
+    auto page = std::make_unique<Page>();
+    page->image.width = page_size;
+    page->image.height = page_size;
+    page->image.has_alpha = true;
+    page->image.pixels.assign((size_t)page_size * page_size, 0u);
+    page->shelves.push_back({ 0, h, w });
+    page->next_y = h;
+    pages.push_back(std::move(page));
+
+    out = { (int)pages.size() - 1, 0, 0, width, height };
+    return true;
+}
+
+int ImageAtlas::Add(const uint8_t* data, size_t size, bool color_key)
+{
+    ImageInfo info;
+    if (!ReadImageInfo(data, size, info)) return -1;
+
+    AtlasEntry entry;
+    if (!Allocate(info.width, info.height, entry)) return -1;
+
+    BGAImage& page = pages[entry.page]->image;
+    const ImageView view{ page.pixels.data() + (size_t)entry.y * page_size + entry.x,
+                          info.width, info.height, page_size };
+
+    DecodeOptions opt;
+    opt.format = format;
+    opt.color_key = color_key;
+    if (!DecodeImage(data, size, view, opt)) return -1;   // 確保した領域は空きのまま残す
+
+    ++page.version;
+    entries.push_back(entry);
+    return (int)entries.size() - 1;
+}
+
+int ImageAtlas::AddFile(const std::string& path, bool color_key)
+{
+    if (!ReadFileBytes(path, file_buf)) return -1;
+    return Add(file_buf.data(), file_buf.size(), color_key);
+}
+
+// --------------------------------------------------------
+// ImageStore
+// --------------------------------------------------------
+void ImageStore::SetOptions(const DecodeOptions& opt)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    options = opt;
+}
+
+int ImageStore::LoadFile(const std::string& path)
+{
+    thread_local std::vector<uint8_t> file_buf;
+    if (!ReadFileBytes(path, file_buf)) return 0;
+
+    ImageInfo info;
+    if (!ReadImageInfo(file_buf.data(), file_buf.size(), info)) return 0;
+    const size_t need = (size_t)info.width * info.height;
+
+    // プールから十分な容量のバッファを優先して取り出す
+    std::unique_ptr<BGAImage> image;
+    DecodeOptions opt;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        opt = options;
+        if (!pool.empty())
+        {
+            auto it = std::find_if(pool.begin(), pool.end(),
+                [need](const std::unique_ptr<BGAImage>& p){ return p->pixels.capacity() >= need; });
+            if (it == pool.end()) it = pool.end() - 1;
+            image = std::move(*it);
+            pool.erase(it);
+        }
+    }
+    if (!image) image = std::make_unique<BGAImage>();
+
+    image->width = info.width;
+    image->height = info.height;
+    image->has_alpha = info.has_alpha || opt.color_key;
+    image->pixels.resize(need);
+
+    const ImageView view{ image->pixels.data(), info.width, info.height, info.width };
+    if (!DecodeImage(file_buf.data(), file_buf.size(), view, opt))
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        pool.push_back(std::move(image));
+        return 0;
+    }
+    image->version = ++g_store_version;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    for (size_t i = 0; i < images.size(); ++i)
+    {
+        if (!images[i])
+        {
+            images[i] = std::move(image);
+            return (int)i + 1;
+        }
+    }
+    images.push_back(std::move(image));
+    return (int)images.size();
+}
+
+void ImageStore::Release(int handle)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if (handle <= 0 || handle > (int)images.size() || !images[handle - 1]) return;
+    pool.push_back(std::move(images[handle - 1]));
+}
+
+const BGAImage* ImageStore::Get(int handle) const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if (handle <= 0 || handle > (int)images.size()) return nullptr;
+    return images[handle - 1].get();
+}
+
+size_t ImageStore::GetResidentBytes() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    size_t bytes = 0;
+    for (const auto& img : images)
+        if (img) bytes += img->pixels.capacity() * sizeof(uint32_t);
+    for (const auto& img : pool)
+        bytes += img->pixels.capacity() * sizeof(uint32_t);
+    return bytes;
+}
+
+int ImageStore::GetImageCount() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return (int)std::count_if(images.begin(), images.end(),
+        [](const std::unique_ptr<BGAImage>& p){ return p != nullptr; });
+}
+
+void ImageStore::Clear()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    images.clear();
+    pool.clear();
+}
@@ -0,0 +1,163 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// ------------------------------------------------------------
+// 画像デコーダ（BGA / スキン素材）
+//  ・BMP（1/4/8bit パレット, 24bit, 32bit）と PNG（8bit, 非インターレース）を扱う
+//  ・ファイルバッファから呼び出し側の転送先（プール画像 / アトラスの矩形）へ
+//    1 行ずつ直接書き込む。ピクセルの中間バッファは作らない
+//    （PNG は展開後のフィルタ済み行だけをスレッド毎の作業領域に持つ）
+//  ・行変換は SSE2（24bit は SSSE3）で BGR→RGBA / チャンネル入れ替え /
+//    カラーキー（黒）→ 透明 を 1 パスで行う。パレットは変換済みの表を引く
+//  ・出力フォーマットは転送先のテクスチャに合わせて RGBA8 / BGRA8 を選ぶ
+// ------------------------------------------------------------
+
+// デコード済み画像（行は上から）。BGA のスロットとイメージストアで共用する
+struct BGAImage {
+    int width = 0;
+    int height = 0;
+    std::vector<uint32_t> pixels;
+    bool has_alpha = false;     // 不透明でないピクセルを含むか（合成時に使うカーネルの選択用）
+    uint64_t version = 0;       // デコード毎に一意（スロット再利用時の変更検出用）
+};
+
+// 出力ピクセルのメモリ上のバイト順
+enum class PixelFormat {
+    RGBA8,  // SDL_PIXELFORMAT_ABGR8888（リトルエンディアン）。BGA の既定
+    BGRA8,  // SDL_PIXELFORMAT_ARGB8888
+};
+
+struct ImageInfo {
+    int width = 0;
+    int height = 0;
+    bool has_alpha = false;     // 透過情報を持つ形式か（PNG の α / tRNS）
+};
+
+// 転送先。stride はピクセル単位
+struct ImageView {
+    uint32_t* pixels = nullptr;
+    int width = 0;
+    int height = 0;
+    int stride = 0;
+};
+
+struct DecodeOptions {
+    PixelFormat format = PixelFormat::RGBA8;
+    bool color_key = false;     // 黒 (0,0,0) を完全透明にする（BMS 素材の慣習）
+};
+
+/**
+ * ヘッダだけを読んで寸法を得る（BMP / PNG）
+ */
+bool ReadImageInfo(const uint8_t* data, size_t size, ImageInfo& info);
+
+/**
+ * メモリ上のファイルを dst へ直接デコードする
+ * dst の幅・高さは ReadImageInfo の値と一致している必要がある
+ */
+bool DecodeImage(const uint8_t* data, size_t size, const ImageView& dst, const DecodeOptions& opt = {});
+
+/**
+ * ファイルを読んで out へデコードする（out.pixels の確保済み領域は再利用する）
+ * version は更新しない
+ */
+bool DecodeImageFile(const std::string& path, BGAImage& out, const DecodeOptions& opt = {});
+
+/**
+ * ファイル全体を buf に読む（buf の確保済み領域は再利用する）
+ */
+bool ReadFileBytes(const std::string& path, std::vector<uint8_t>& buf);
+
+// -------------------------------------
+// テクスチャアトラス（スキン素材などの小さな画像用）
+//  ・シェルフ方式で詰め、入らなければページを追加する
+//  ・画像間に 1px の透明な余白を置く（線形補間のにじみ防止）
+// -------------------------------------
+struct AtlasEntry {
+    int page = -1;
+    int x = 0;
+    int y = 0;
+    int width = 0;
+    int height = 0;
+};
+
+class ImageAtlas
+{
+public:
+    explicit ImageAtlas(int page_size = 2048, PixelFormat format = PixelFormat::RGBA8);
+
+    /**
+     * メモリ上のファイルをアトラスへデコードする
+     * @return エントリ ID（失敗時は -1）
+     */
+    int Add(const uint8_t* data, size_t size, bool color_key = true);
+    int AddFile(const std::string& path, bool color_key = true);
+
+    const AtlasEntry& GetEntry(int id) const { return entries[id]; }
+    int GetEntryCount() const { return (int)entries.size(); }
+
+    const BGAImage& GetPage(int page) const { return pages[page]->image; }
+    int GetPageCount() const { return (int)pages.size(); }
+
+    // ページ毎の更新回数（テクスチャへの再転送判定用）
+    uint64_t GetPageVersion(int page) const { return pages[page]->image.version; }
+
+    void Clear();
+
+private:
+    struct Shelf {
+        int y;
+        int height;
+        int x;      // 次に置く位置
+    };
+
+    struct Page {
+        BGAImage image;
+        std::vector<Shelf> shelves;
+        int next_y = 0;
+    };
+
+    bool Allocate(int width, int height, AtlasEntry& out);
+
+    int page_size;
+    PixelFormat format;
+    std::vector<std::unique_ptr<Page>> pages;
+    std::vector<AtlasEntry> entries;
+    std::vector<uint8_t> file_buf;
+};
+
+// -------------------------------------
+// イメージストア（#BMP / STAGEFILE の事前ロード用）
+//  ・ハンドルは 1 以上（0 はロード失敗）
+//  ・Release した画像のバッファはプールに戻し、次のロードで再利用する
+//  ・全メソッドはスレッドセーフ（デコードはロック外で行う）
+// -------------------------------------
+class ImageStore
+{
+public:
+    void SetOptions(const DecodeOptions& opt);
+
+    int LoadFile(const std::string& path);
+    void Release(int handle);
+
+    // 返したポインタは Release まで有効
+    const BGAImage* Get(int handle) const;
+
+    size_t GetResidentBytes() const;
+    int GetImageCount() const;
+
+    void Clear();
+
+private:
+    mutable std::mutex mutex;
+    DecodeOptions options;
+    std::vector<std::unique_ptr<BGAImage>> images;  // handle - 1 → 画像（返却済みは nullptr）
+    std::vector<std::unique_ptr<BGAImage>> pool;    // 再利用待ちのバッファ
+};
+
+extern ImageStore g_image_store;
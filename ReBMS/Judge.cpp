@@ -1,25 +1,24 @@
 #include "Judge.h"
-#include <iostream>
+#include "EventLog.h"
 
 // ---------------------------------------------
-// ln_states の実体定義（Judge.h の extern を受ける）
+// ログ出力（リングバッファに積むだけ。出力は ctx.event_log->Flush で行う）
 // ---------------------------------------------
-std::map<int, LNState> ln_states;
-
-// ---------------------------------------------
-// ログ出力（必要に応じて main 側で書き換え可）
-// ---------------------------------------------
-void LogLNResult(int lane, LNReleaseResult result)
+void LogLNResult(JudgeContext& ctx, int lane, LNReleaseResult result)
 {
-    std::cout << "[LN] lane " << lane << " -> ";
+    if (!ctx.event_log) return;
+
+    const char* name = "NONE";
 
     switch (result)
     {
-    case LNReleaseResult::SUCCESS: std::cout << "SUCCESS\n"; break;
-    case LNReleaseResult::BREAK:   std::cout << "BREAK\n";   break;
-    case LNReleaseResult::MISS:    std::cout << "MISS\n";    break;
-    default:                       std::cout << "NONE\n";    break;
+    case LNReleaseResult::SUCCESS: name = "SUCCESS"; break;
+    case LNReleaseResult::BREAK:   name = "BREAK";   break;
+    case LNReleaseResult::MISS:    name = "MISS";    break;
+    default:                                         break;
     }
+
+    ctx.event_log->Push(LogEvent::LN_RESULT, lane, (int)result, 0.0, 0.0, name);
 }
 
 // ---------------------------------------------------------------
@@ -77,7 +76,7 @@ JudgeResult JudgeKeyHit(BMSData& data, int lane_channel, double current_time)
 // ---------------------------------------------------------------
 // ProcessScrollOutMisses : 判定ラインを通過したノーツの MISS 処理
 // ---------------------------------------------------------------
-void ProcessScrollOutMisses(BMSData& data, double current_time)
+void ProcessScrollOutMisses(JudgeContext& ctx, BMSData& data, double current_time)
 {
     const double miss_time_threshold = current_time - JUDGE_GOOD_MS;
 
@@ -89,7 +88,7 @@ void ProcessScrollOutMisses(BMSData& data, double current_time)
             break;
 
         // MISS ノーツとして削除
-        std::cout << "[MISS] lane=" << n.channel << " time=" << n.time_ms << "\n";
+        if (ctx.event_log) ctx.event_log->Push(LogEvent::MISS, n.channel, 0, n.time_ms);
         data.notes.erase(data.notes.begin());
     }
 }
@@ -97,13 +96,9 @@ void ProcessScrollOutMisses(BMSData& data, double current_time)
 // ---------------------------------------------------------------
 // ProcessLNKeyRelease : キー離した瞬間の BREAK 判定
 // ---------------------------------------------------------------
-LNReleaseResult ProcessLNKeyRelease(int lane_channel, double current_time)
+LNReleaseResult ProcessLNKeyRelease(JudgeContext& ctx, int lane_channel, double current_time)
 {
-    auto it = ln_states.find(lane_channel);
-    if (it == ln_states.end())
-        return LNReleaseResult::NONE;
-
-    LNState& st = it->second;
+    LNState& st = ctx.GetLNState(lane_channel);
 
     if (!st.is_holding)
         return LNReleaseResult::NONE;
@@ -121,12 +116,11 @@ LNReleaseResult ProcessLNKeyRelease(int lane_channel, double current_time)
 // ---------------------------------------------------------------
 // ProcessLNEnds : LN 終了時刻に到達したときの判定
 // ---------------------------------------------------------------
-void ProcessLNEnds(double current_time)
+void ProcessLNEnds(JudgeContext& ctx, double current_time)
 {
-    for (auto& kv : ln_states)
+    for (int lane = 0; lane < 256; ++lane)
     {
-        int lane = kv.first;
-        LNState& st = kv.second;
+        LNState& st = ctx.ln_states[lane];
 
         if (!st.is_holding)
             continue;
@@ -136,7 +130,7 @@ void ProcessLNEnds(double current_time)
         // 許容時間より遅れた → MISS
         if (end_t < current_time - JUDGE_GOOD_MS)
         {
-            LogLNResult(lane, LNReleaseResult::MISS);
+            LogLNResult(ctx, lane, LNReleaseResult::MISS);
             st.is_holding = false;
             continue;
         }
@@ -146,13 +140,13 @@ void ProcessLNEnds(double current_time)
             continue;
 
         // 終了判定：押していたか？
-        if (IsKeyCurrentlyPressed(lane))
+        if (ctx.IsKeyPressed(lane))
         {
-            LogLNResult(lane, LNReleaseResult::SUCCESS);
+            LogLNResult(ctx, lane, LNReleaseResult::SUCCESS);
         }
         else
         {
-            LogLNResult(lane, LNReleaseResult::BREAK);
+            LogLNResult(ctx, lane, LNReleaseResult::BREAK);
         }
 
         st.is_holding = false;
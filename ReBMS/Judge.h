@@ -1,9 +1,10 @@
 #pragma once
 #include <vector>
-#include <map>
 #include <cmath>
 #include "BMSData.h"
 
+class EventLog;
+
 // -------------------------------------
 // 判定結果
 // -------------------------------------
@@ -32,9 +33,21 @@ struct LNState {
 };
 
 // -------------------------------------
-// 外部変数（Judge.cpp で定義する）
+// 判定コンテキスト（1 プレイ分の可変状態）
+//  ・LN の保持状態・キーの押下状態・ログの出力先をまとめて持つ
+//  ・プレイ毎に 1 つ作って判定関数へ渡す。グローバルを持たないので、
+//    別々のコンテキストなら別スレッドで同時に判定できる
+//  ・LN 状態もキーの押下状態と同じく固定長の表で持つ（プレイ中に確保しない）
 // -------------------------------------
-extern std::map<int, LNState> ln_states;
+struct JudgeContext {
+    LNState ln_states[256] = {};        // LN チャンネルの下位 8bit -> 保持状態
+    bool key_pressed[256] = {};         // レーンチャンネルの下位 8bit -> 押下中か（入力処理側で更新する）
+    EventLog* event_log = nullptr;      // nullptr ならログを積まない
+
+    void SetKeyPressed(int lane_channel, bool pressed) { key_pressed[lane_channel & 0xFF] = pressed; }
+    bool IsKeyPressed(int lane_channel) const { return key_pressed[lane_channel & 0xFF]; }
+    LNState& GetLNState(int lane_channel) { return ln_states[lane_channel & 0xFF]; }
+};
 
 // -------------------------------------
 // 判定ウィンドウ定数
@@ -51,17 +64,14 @@ const double JUDGE_GOOD_MS = 60.0;
 JudgeResult JudgeKeyHit(BMSData& data, int lane_channel, double current_time);
 
 // 判定ラインを通過してしまった MISS チェック
-void ProcessScrollOutMisses(BMSData& data, double current_time);
+void ProcessScrollOutMisses(JudgeContext& ctx, BMSData& data, double current_time);
 
 // キー離鍵の処理（LN BREAK 判定）
-LNReleaseResult ProcessLNKeyRelease(int lane_channel, double current_time);
+LNReleaseResult ProcessLNKeyRelease(JudgeContext& ctx, int lane_channel, double current_time);
 
-// LN 終端判定（LN SUCCESS / BREAK / MISS）
-void ProcessLNEnds(double current_time);
+// LN 終端判定（LN SUCCESS / BREAK / MISS。押下状態は ctx.key_pressed を見る）
+void ProcessLNEnds(JudgeContext& ctx, double current_time);
 
 // 外部から呼び出すための API（ログ用）
-void LogLNResult(int lane, LNReleaseResult result);
-
-// 現在キーが押されているかどうか（main.cpp 側で実装）
-bool IsKeyCurrentlyPressed(int lane_channel);
+void LogLNResult(JudgeContext& ctx, int lane, LNReleaseResult result);
 
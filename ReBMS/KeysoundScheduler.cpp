@@ -0,0 +1,89 @@
+#include "KeysoundScheduler.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+KeysoundScheduler::KeysoundScheduler(AudioMixer& m)
+    : mixer(m)
+{
+}
+
+// --------------------------------------------------------
+// Load : 発音対象イベントを抽出してタイムライン化
+// --------------------------------------------------------
+void KeysoundScheduler::Load(const BMSData& data, const SampleStore& store,
+                             bool include_bgm, bool include_lanes)
+{
+    events.clear();
+    cursor = 0;
+
+    for (const auto& n : data.notes)
+    {
+        const bool is_bgm  = n.channel == 0x01;
+        const bool is_lane = (n.channel >= 0x11 && n.channel <= 0x29) ||
+                             (n.channel >= 0x51 && n.channel <= 0x69);
+
+        if (!(is_bgm && include_bgm) && !(is_lane && include_lanes))
+            continue;
+
+        auto it = data.loaded_wavs.find(n.wav_id);
+        if (it == data.loaded_wavs.end()) continue;
+
+        const SampleBuffer* sample = store.Get(it->second);
+        if (!sample) continue;
+
+        events.push_back({ n.time_ms, sample });
+    }
+
+    std::stable_sort(events.begin(), events.end(),
+        [](const KeysoundEvent& a, const KeysoundEvent& b){ return a.time_ms < b.time_ms; });
+
+    std::cout << "[SCHED] Keysound timeline: " << events.size() << " events" << std::endl;
+}
+
+void KeysoundScheduler::Start(int64_t origin_stream_frame, double from_ms)
+{
+    anchor_frame = origin_stream_frame;
+    anchor_ms = 0.0;
+    cursor = std::lower_bound(events.begin(), events.end(), from_ms,
+        [](const KeysoundEvent& e, double t){ return e.time_ms < t; }) - events.begin();
+}
+
+int64_t KeysoundScheduler::ToStreamFrame(double time_ms) const
+{
+    return anchor_frame + std::llround((time_ms - anchor_ms) / playback_rate * MIX_SAMPLE_RATE / 1000.0);
+}
+
+double KeysoundScheduler::ToChartMs(int64_t stream_frame) const
+{
+    return anchor_ms + (double)(stream_frame - anchor_frame) * 1000.0 / MIX_SAMPLE_RATE * playback_rate;
+}
+
+void KeysoundScheduler::SetPlaybackRate(double rate, double at_ms, int64_t at_frame)
+{
+    if (rate <= 0.0) return;
+    anchor_ms = at_ms;
+    anchor_frame = at_frame;
+    playback_rate = rate;
+}
+
+// --------------------------------------------------------
+// Update : ホライズン内のイベントを先渡し
+// --------------------------------------------------------
+void KeysoundScheduler::Update(double current_time_ms)
+{
+    // ホライズンは実時間なので、チャート時間では速度倍する
+    const double limit = current_time_ms + horizon_ms * playback_rate;
+
+    while (cursor < events.size() && events[cursor].time_ms <= limit)
+    {
+        const KeysoundEvent& e = events[cursor];
+
+        // キューが満杯なら次フレームで再送する
+        if (!mixer.Schedule(e.sample, ToStreamFrame(e.time_ms)))
+            break;
+
+        ++cursor;
+    }
+}
@@ -0,0 +1,73 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "data.h"
+#include "AudioMixer.h"
+
+// ------------------------------------------------------------
+// キー音の先行スケジューラ
+//  ・入力に依存しない発音（BGM / オートプレイ）をタイムラインから読み、
+//    一定時間（ホライズン）先までのイベントをミキサーへ先渡しする
+//  ・ミキサーは指定ストリームフレームちょうどから鳴らすため、
+//    フレームレートに関係なくサンプル単位で正確に発音される
+// ------------------------------------------------------------
+
+constexpr double KEYSOUND_HORIZON_MS = 100.0;
+
+class KeysoundScheduler
+{
+public:
+    explicit KeysoundScheduler(AudioMixer& mixer);
+
+    /**
+     * タイムラインを構築する
+     * @param include_bgm     BGM(01) を含めるか（BGMStem 使用時は false）
+     * @param include_lanes   レーン（11-29, LN 51-69）を含めるか（オートプレイ時 true）
+     */
+    void Load(const BMSData& data, const SampleStore& store, bool include_bgm, bool include_lanes);
+
+    /**
+     * 再生開始
+     * @param origin_stream_frame チャート 0ms を鳴らすミキサーのストリームフレーム
+     * @param from_ms             この時刻以降のイベントから送る（シーク用）
+     */
+    void Start(int64_t origin_stream_frame, double from_ms = 0.0);
+
+    /**
+     * current_time_ms + ホライズンまでのイベントをミキサーへ送る（毎フレーム）
+     */
+    void Update(double current_time_ms);
+
+    void SetHorizonMs(double ms) { horizon_ms = ms; }
+
+    /**
+     * 再生速度を変える（AudioMixer::SetPlaybackRate と同じ値・同じアンカー）
+     * anchor_ms のイベントが anchor_frame で鳴るように換算を付け替える。再生前なら Start が起点を置き直す
+     * 先渡し済み（ホライズン内）のイベントは変更前の速度の位置で鳴る
+     */
+    void SetPlaybackRate(double rate, double anchor_ms, int64_t anchor_frame);
+    double GetPlaybackRate() const { return playback_rate; }
+
+    // チャート時刻 → ストリームフレーム（再生速度を考慮）
+    int64_t ToStreamFrame(double time_ms) const;
+    // ストリームフレーム → チャート時刻（ToStreamFrame の逆。速度変更のアンカーを求めるのに使う）
+    double ToChartMs(int64_t stream_frame) const;
+
+    int GetEventCount() const { return (int)events.size(); }
+    int GetDispatchedCount() const { return (int)cursor; }
+
+private:
+    struct KeysoundEvent {
+        double time_ms;
+        const SampleBuffer* sample;
+    };
+
+    AudioMixer& mixer;
+    std::vector<KeysoundEvent> events;  // time_ms 昇順
+    size_t cursor = 0;
+    // 換算のアンカー : チャート時刻 anchor_ms がストリームフレーム anchor_frame に対応する
+    int64_t anchor_frame = 0;
+    double anchor_ms = 0.0;
+    double horizon_ms = KEYSOUND_HORIZON_MS;
+    double playback_rate = 1.0;
+};
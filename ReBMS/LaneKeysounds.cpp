@@ -0,0 +1,129 @@
+#include "LaneKeysounds.h"
+#include "data.h"
+#include "AudioMixer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+LaneKeysounds::LaneKeysounds(AudioMixer& m)
+    : mixer(m), lanes(MIXER_LANE_COUNT)
+{
+}
+
+int LaneKeysounds::LaneIndex(int channel)
+{
+    // LN はノーマルノーツと同じ物理レーン
+    if (channel >= 0x51 && channel <= 0x69) channel -= 0x40;
+
+    if (channel >= 0x11 && channel <= 0x19) return channel - 0x11;
+    if (channel >= 0x21 && channel <= 0x29) return channel - 0x21 + 9;
+    return -1;
+}
+
+// --------------------------------------------------------
+// Load : レーン毎のタイムライン構築
+// --------------------------------------------------------
+void LaneKeysounds::Load(const BMSData& data, const SampleStore& store)
+{
+    for (auto& lane : lanes)
+    {
+        lane.events.clear();
+        lane.cursor = 0;
+        lane.armed = nullptr;
+    }
+
+    int total = 0;
+    for (const auto& n : data.notes)
+    {
+        const int lane = LaneIndex(n.channel);
+        if (lane < 0) continue;
+
+        // キー音の定義がないノーツも「鳴らないノーツ」として並べておく（空打ちで次の音が鳴らないように）
+        const SampleBuffer* sample = nullptr;
+        auto it = data.loaded_wavs.find(n.wav_id);
+        if (it != data.loaded_wavs.end())
+            sample = store.Get(it->second);
+
+        lanes[lane].events.push_back({ n.time_ms, sample });
+        ++total;
+    }
+
+    for (int i = 0; i < (int)lanes.size(); ++i)
+    {
+        std::stable_sort(lanes[i].events.begin(), lanes[i].events.end(),
+            [](const LaneEvent& a, const LaneEvent& b){ return a.time_ms < b.time_ms; });
+        Arm(i);
+    }
+
+    std::cout << "[LANE] Armed keysounds for " << total << " lane notes" << std::endl;
+}
+
+void LaneKeysounds::Arm(int lane)
+{
+    Lane& l = lanes[lane];
+
+    // 最後のノーツを過ぎても、最後に鳴らした音を空打ち用に残す
+    const SampleBuffer* next = l.events.empty() ? nullptr
+        : l.events[std::min(l.cursor, l.events.size() - 1)].sample;
+
+    if (next == l.armed) return;
+    l.armed = next;
+    mixer.ArmLane(lane, next);
+}
+
+void LaneKeysounds::SetStreamTiming(int64_t origin_stream_frame, double rate, int lead)
+{
+    has_stream_timing = rate > 0.0;
+    anchor_frame = origin_stream_frame;
+    anchor_ms = 0.0;
+    playback_rate = rate;
+    lead_frames = std::max(0, lead);
+}
+
+void LaneKeysounds::SetPlaybackRate(double rate, double at_ms, int64_t at_frame)
+{
+    if (rate <= 0.0) return;
+    anchor_ms = at_ms;
+    anchor_frame = at_frame;
+    playback_rate = rate;
+}
+
+// --------------------------------------------------------
+// Update : 見逃したノーツを読み飛ばす
+// --------------------------------------------------------
+void LaneKeysounds::Update(double current_time_ms)
+{
+    for (int i = 0; i < (int)lanes.size(); ++i)
+    {
+        Lane& l = lanes[i];
+        const size_t before = l.cursor;
+
+        while (l.cursor < l.events.size() && l.events[l.cursor].time_ms < current_time_ms - window_ms)
+            ++l.cursor;
+
+        if (l.cursor != before) Arm(i);
+    }
+}
+
+// --------------------------------------------------------
+// Trigger : 発音 → ノーツ消費 → 次をアーム
+// --------------------------------------------------------
+void LaneKeysounds::Trigger(int lane_channel, double current_time_ms, double press_time_ms)
+{
+    const int lane = LaneIndex(lane_channel);
+    if (lane < 0) return;
+
+    // まず鳴らす（ここまでに検索や確保は一切しない）
+    const int64_t frame = has_stream_timing
+        ? anchor_frame + std::llround((press_time_ms - anchor_ms) / playback_rate * MIX_SAMPLE_RATE / 1000.0) + lead_frames
+        : -1;
+    mixer.TriggerLane(lane, frame);
+
+    Lane& l = lanes[lane];
+    if (l.cursor < l.events.size() && l.events[l.cursor].time_ms <= current_time_ms + window_ms)
+    {
+        ++l.cursor;
+        Arm(lane);
+    }
+}
@@ -0,0 +1,92 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+// BMSPlayer 側（独自の Note を持つ）からも include できるよう前方宣言のみにする
+struct BMSData;
+struct SampleBuffer;
+class SampleStore;
+class AudioMixer;
+
+// ------------------------------------------------------------
+// レーン毎の打鍵音の事前準備
+//  ・各レーンで「次に押されるはずのノーツ」のキー音を先に解決し、
+//    AudioMixer のレーンスロットへアームしておく
+//  ・打鍵時は Trigger() がアトミックな発音指示を出すだけで、
+//    ノーツ検索・サンプル検索・ボイス確保はクリティカルパスに乗らない
+//  ・判定の結果に関係なく、押した瞬間に鳴る音は常にアーム済みの音
+// ------------------------------------------------------------
+
+class LaneKeysounds
+{
+public:
+    explicit LaneKeysounds(AudioMixer& mixer);
+
+    /**
+     * レーン毎のキー音タイムラインを構築し、各レーンの先頭をアームする
+     */
+    void Load(const BMSData& data, const SampleStore& store);
+
+    /**
+     * 判定幅を過ぎたノーツを読み飛ばし、必要ならアームを差し替える（毎フレーム）
+     * @param current_time_ms 判定オフセット適用後のチャート時刻
+     */
+    void Update(double current_time_ms);
+
+    /**
+     * 打鍵音を鳴らす。打鍵が次のノーツの判定幅内なら、そのノーツを消費して次をアームする
+     * @param lane_channel    11-19 / 21-29（LN 51-59 / 61-69 も同じレーンに対応）
+     * @param current_time_ms 判定オフセット適用後のチャート時刻（ノーツの消費に使う）
+     * @param press_time_ms   打鍵のチャート時刻（オーディオ時間軸。SetStreamTiming があれば発音位置に使う）
+     */
+    void Trigger(int lane_channel, double current_time_ms, double press_time_ms);
+
+    /**
+     * 打鍵時刻 → ミキサーのストリームフレームの換算（KeysoundScheduler::Start と同じ起点）
+     * 打鍵音は「打鍵時刻 + lead_frames」のフレームから鳴る。lead_frames を 1 ブロック分にすると
+     * 次の Mix() のブロック内で打鍵と同じ位置に置かれ、打鍵から発音までが一定になる
+     * 設定しなければ次の Mix() の先頭から鳴らす
+     */
+    void SetStreamTiming(int64_t origin_stream_frame, double playback_rate, int lead_frames);
+
+    /**
+     * 再生中に速度を変える（KeysoundScheduler::SetPlaybackRate と同じアンカーを渡す）
+     * 打鍵時刻 anchor_ms が anchor_frame（+ lead_frames）に対応するよう換算を付け替える
+     */
+    void SetPlaybackRate(double rate, double anchor_ms, int64_t anchor_frame);
+
+    /**
+     * 次のノーツとして扱う判定幅（チャート時間。BMSPlayer の最大判定幅に合わせる）
+     */
+    void SetWindowMs(double ms) { window_ms = ms; }
+
+    // レーンチャンネル → レーン番号（0〜MIXER_LANE_COUNT-1）。対象外は -1
+    static int LaneIndex(int channel);
+
+private:
+    struct LaneEvent {
+        double time_ms;
+        const SampleBuffer* sample;
+    };
+
+    struct Lane {
+        std::vector<LaneEvent> events;  // time_ms 昇順
+        size_t cursor = 0;
+        const SampleBuffer* armed = nullptr;
+    };
+
+    // cursor 位置のキー音をアームする（変化がなければ何もしない）
+    void Arm(int lane);
+
+    AudioMixer& mixer;
+    std::vector<Lane> lanes;
+    double window_ms = 80.0;
+
+    // 打鍵時刻 → ストリームフレーム（has_stream_timing が false なら即時）
+    bool has_stream_timing = false;
+    int64_t anchor_frame = 0;   // 打鍵時刻 anchor_ms に対応するストリームフレーム
+    double anchor_ms = 0.0;
+    double playback_rate = 1.0;
+    int lead_frames = 0;
+};
@@ -0,0 +1,155 @@
+#include "LatencyCalibrator.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+LatencyCalibrator::LatencyCalibrator(AudioMixer& m, const SampleBuffer* click_sample)
+    : mixer(m), click(click_sample)
+{
+}
+
+// --------------------------------------------------------
+// フェーズ開始
+// --------------------------------------------------------
+void LatencyCalibrator::Start(CalibrationPhase new_phase, int64_t origin_stream_frame)
+{
+    phase = new_phase;
+
+    if (phase == CalibrationPhase::AUDIO)
+    {
+        audio_offsets.clear();
+
+        // カウントイン込みで全拍のクリックを先に渡しておく（サンプル単位で正確に鳴る）
+        for (int beat = -COUNT_IN_BEATS; beat < beat_count; ++beat)
+        {
+            const double t = BeatTime(beat);
+            const int64_t frame = origin_stream_frame + std::llround(t * MIX_SAMPLE_RATE / 1000.0);
+            if (click) mixer.Schedule(click, frame);
+        }
+    }
+    else if (phase == CalibrationPhase::VISUAL)
+    {
+        visual_offsets.clear();
+    }
+
+    std::cout << "[CALIB] Phase start: "
+              << (phase == CalibrationPhase::AUDIO ? "AUDIO" : phase == CalibrationPhase::VISUAL ? "VISUAL" : "IDLE")
+              << " (" << beat_count << " beats)" << std::endl;
+}
+
+// --------------------------------------------------------
+// タップ記録 : 最寄りの拍とのズレを保存
+// --------------------------------------------------------
+void LatencyCalibrator::OnTap(double time_ms)
+{
+    if (phase == CalibrationPhase::IDLE) return;
+
+    const int beat = (int)std::lround((time_ms - BeatTime(0)) / beat_interval_ms);
+    if (beat < 0 || beat >= beat_count) return;
+
+    const double offset = time_ms - BeatTime(beat);
+    if (phase == CalibrationPhase::AUDIO) audio_offsets.push_back(offset);
+    else                                  visual_offsets.push_back(offset);
+}
+
+bool LatencyCalibrator::IsFlashOn(double time_ms) const
+{
+    if (phase != CalibrationPhase::VISUAL) return false;
+
+    const double rel = time_ms - BeatTime(-COUNT_IN_BEATS);
+    if (rel < 0.0 || time_ms >= BeatTime(beat_count)) return false;
+    return std::fmod(rel, beat_interval_ms) < FLASH_MS;
+}
+
+bool LatencyCalibrator::IsPhaseFinished(double time_ms) const
+{
+    return time_ms >= BeatTime(beat_count);
+}
+
+// --------------------------------------------------------
+// RobustMedian : 中央値 → MAD で ±3σ 外を除外 → 再度中央値
+// --------------------------------------------------------
+double LatencyCalibrator::RobustMedian(std::vector<double> values, int* used, double* spread)
+{
+    auto median = [](std::vector<double>& v) {
+        const size_t n = v.size();
+        std::nth_element(v.begin(), v.begin() + n / 2, v.end());
+        double m = v[n / 2];
+        if (n % 2 == 0)
+            m = (m + *std::max_element(v.begin(), v.begin() + n / 2)) * 0.5;
+        return m;
+    };
+
+    if (values.empty())
+    {
+        if (used) *used = 0;
+        if (spread) *spread = 0.0;
+        return 0.0;
+    }
+
+    const double m0 = median(values);
+
+    std::vector<double> dev(values.size());
+    for (size_t i = 0; i < values.size(); ++i)
+        dev[i] = std::fabs(values[i] - m0);
+
+    // MAD → 標準偏差換算（正規分布で 1.4826 倍）。人間のタップ精度を考え下限 2ms
+    const double sigma = std::max(2.0, 1.4826 * median(dev));
+
+    std::vector<double> kept;
+    for (double v : values)
+        if (std::fabs(v - m0) <= 3.0 * sigma)
+            kept.push_back(v);
+
+    if (used) *used = (int)kept.size();
+    if (spread) *spread = sigma;
+    return kept.empty() ? m0 : median(kept);
+}
+
+// --------------------------------------------------------
+// Compute : 遅延の推定
+// --------------------------------------------------------
+CalibrationResult LatencyCalibrator::Compute() const
+{
+    CalibrationResult r;
+
+    r.audio_tap_offset_ms = RobustMedian(audio_offsets, &r.audio_taps_used, &r.audio_spread_ms);
+    r.valid = r.audio_taps_used >= 8;
+
+    if (!visual_offsets.empty())
+    {
+        r.visual_tap_offset_ms = RobustMedian(visual_offsets, &r.visual_taps_used, &r.visual_spread_ms);
+        r.input_latency_ms = r.visual_tap_offset_ms - display_latency_ms;
+        r.audio_latency_ms = r.audio_tap_offset_ms - r.input_latency_ms;
+
+        // ノーツが判定ラインを通過して見える瞬間と、正しい判定タイミングを揃える
+        r.visual_offset_ms = r.visual_tap_offset_ms - r.audio_tap_offset_ms;
+    }
+    else
+    {
+        // VISUAL 未実施の場合は入力遅延を分離できないため、全量をオーディオ側とみなす
+        r.audio_latency_ms = r.audio_tap_offset_ms;
+    }
+
+    // 判定時刻 = ゲーム時刻 + オフセット なので、遅れて届くタップ分を差し引く
+    r.judge_offset_ms = -r.audio_tap_offset_ms;
+
+    std::cout << "[CALIB] audio+input=" << r.audio_tap_offset_ms << "ms (" << r.audio_taps_used << " taps)"
+              << ", visual+input=" << r.visual_tap_offset_ms << "ms (" << r.visual_taps_used << " taps)"
+              << ", judge_offset=" << r.judge_offset_ms << "ms"
+              << ", visual_offset=" << r.visual_offset_ms << "ms" << std::endl;
+    return r;
+}
+
+int LatencyCalibrator::CreateClickSample(SampleStore& store)
+{
+    const int frames = MIX_SAMPLE_RATE / 50;   // 20ms
+    std::vector<float> pcm(frames);
+    for (int i = 0; i < frames; ++i)
+    {
+        const double t = (double)i / MIX_SAMPLE_RATE;
+        pcm[i] = (float)(0.8 * std::sin(2.0 * 3.14159265358979323846 * 1000.0 * t) * std::exp(-t * 200.0));
+    }
+    return store.AddPCM(pcm.data(), frames, 1, MIX_SAMPLE_RATE);
+}
@@ -0,0 +1,116 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "AudioMixer.h"
+
+// ------------------------------------------------------------
+// 入力 / オーディオ遅延の自動キャリブレーション
+//  ・AUDIO フェーズ : メトロノームのクリックに合わせてタップ
+//      タップ時刻 - 拍時刻 = オーディオ出力遅延 + 入力遅延
+//  ・VISUAL フェーズ : 画面のフラッシュに合わせてタップ（音なし）
+//      タップ時刻 - 拍時刻 = 表示遅延 + 入力遅延
+//  ・各フェーズは中央値 + MAD による外れ値除去で推定する
+//  ・表示遅延は既知の値（設定）として与え、入力遅延とオーディオ遅延を分離する
+//  ・時刻はすべてゲームクロック（拍 0 = Start 時の origin）の ms
+// ------------------------------------------------------------
+
+enum class CalibrationPhase {
+    IDLE,
+    AUDIO,
+    VISUAL,
+};
+
+struct CalibrationResult {
+    bool valid = false;
+
+    double audio_tap_offset_ms  = 0.0;  // AUDIO フェーズの中央値（オーディオ + 入力）
+    double visual_tap_offset_ms = 0.0;  // VISUAL フェーズの中央値（表示 + 入力）
+    double input_latency_ms     = 0.0;  // 推定入力遅延
+    double audio_latency_ms     = 0.0;  // 推定オーディオ出力遅延
+
+    // BMSPlayer::SetJudgeOffset / BMSGameApp::SetVisualOffset に渡す値
+    double judge_offset_ms  = 0.0;
+    double visual_offset_ms = 0.0;
+
+    int audio_taps_used  = 0;
+    int visual_taps_used = 0;
+    double audio_spread_ms  = 0.0;      // 採用タップのばらつき（MAD 換算の標準偏差）
+    double visual_spread_ms = 0.0;
+};
+
+class LatencyCalibrator
+{
+public:
+    /**
+     * @param click メトロノーム音（nullptr なら AUDIO フェーズでも音を鳴らさない）
+     */
+    LatencyCalibrator(AudioMixer& mixer, const SampleBuffer* click);
+
+    void SetBPM(double bpm) { beat_interval_ms = 60000.0 / bpm; }
+    void SetBeatCount(int beats) { beat_count = beats; }
+    void SetDisplayLatencyMs(double ms) { display_latency_ms = ms; }
+
+    /**
+     * フェーズを開始する。AUDIO の場合はクリックをミキサーへスケジュールする
+     * @param origin_stream_frame 拍 0 を鳴らすストリームフレーム（ゲームクロック 0ms に対応）
+     */
+    void Start(CalibrationPhase phase, int64_t origin_stream_frame);
+
+    /**
+     * タップを記録する
+     * @param time_ms 入力イベント発生時のゲームクロック時刻
+     */
+    void OnTap(double time_ms);
+
+    /**
+     * VISUAL フェーズでフラッシュを表示すべきか（描画側が毎フレーム呼ぶ）
+     */
+    bool IsFlashOn(double time_ms) const;
+
+    // 全拍を過ぎたか
+    bool IsPhaseFinished(double time_ms) const;
+
+    /**
+     * 拍の時刻（ms）。beat は -GetCountInBeats() 〜 GetBeatCount()-1（負値はカウントイン）
+     * クリックをミキサー以外で鳴らす場合（WASM では JS の WebAudio）に使う
+     */
+    double GetBeatTimeMs(int beat) const { return BeatTime(beat); }
+    int GetBeatCount() const { return beat_count; }
+    static int GetCountInBeats() { return COUNT_IN_BEATS; }
+
+    CalibrationPhase GetPhase() const { return phase; }
+
+    /**
+     * 両フェーズの結果から遅延を推定する
+     */
+    CalibrationResult Compute() const;
+
+    /**
+     * 中央値 + MAD による外れ値除去後の中央値
+     * @param used   採用したサンプル数（任意）
+     * @param spread 採用サンプルのばらつき（任意）
+     */
+    static double RobustMedian(std::vector<double> values, int* used = nullptr, double* spread = nullptr);
+
+    /**
+     * 短いクリック音（1kHz, 20ms）を store に登録してハンドルを返す
+     */
+    static int CreateClickSample(SampleStore& store);
+
+private:
+    double BeatTime(int beat) const { return COUNT_IN_BEATS * beat_interval_ms + beat * beat_interval_ms; }
+
+    static constexpr int COUNT_IN_BEATS = 4;   // 最初の 4 拍はタップを集計しない
+    static constexpr double FLASH_MS = 80.0;
+
+    AudioMixer& mixer;
+    const SampleBuffer* click;
+
+    CalibrationPhase phase = CalibrationPhase::IDLE;
+    double beat_interval_ms = 500.0;
+    int beat_count = 32;
+    double display_latency_ms = 0.0;
+
+    std::vector<double> audio_offsets;
+    std::vector<double> visual_offsets;
+};
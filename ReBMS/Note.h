@@ -9,7 +9,13 @@
 //  ・STOP（09）
 //  ・BGA（04, 06）
 //  ・LN（長押し）
+//  ・SCROLL / SPEED（SC, SP）
 // ------------------------------------------------------------
+
+// 16進で表せない拡張チャンネル（36進の値で保持する）
+constexpr int CHANNEL_SCROLL = 28 * 36 + 12;   // "SC" : #SCROLLxx によるスクロール倍率
+constexpr int CHANNEL_SPEED  = 28 * 36 + 25;   // "SP" : #SPEEDxx による表示速度倍率
+
 struct Note
 {
     // -------------------------
@@ -33,6 +39,7 @@ struct Note
     // 09 : STOP
     // 04 : BGA
     // 06 : LAYER
+    // SC / SP : CHANNEL_SCROLL / CHANNEL_SPEED
     // -------------------------
     int channel = 0;
 
@@ -41,7 +48,7 @@ struct Note
     //  Wav/Bmp/BPMxx/STOPxx の ID
     // -------------------------
     std::string wav_id;    // #WAVxx の xx（または BGM）
-    std::string def_id;    // #BPMxx / #STOPxx の xx
+    std::string def_id;    // #BPMxx / #STOPxx / #SCROLLxx / #SPEEDxx の xx
 
     // -------------------------
     // LNメタ情報（BML対応）
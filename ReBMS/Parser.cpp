@@ -1,4 +1,6 @@
 #include "Parser.h"
+#include "SampleStore.h"
+#include "ImageDecoder.h"
 
 #include <fstream>
 #include <iostream>
@@ -15,16 +17,16 @@ std::string GetBMSDirectory(const std::string& bms_filepath) {
 // ----------------------------------------------------
 // 仮想的な外部ロードAPI
 // ----------------------------------------------------
-int g_resource_counter = 1;
-
 int VirtualLoadWAVFile(const std::string& path) {
     std::cout << "[LOAD] WAV: " << path << std::endl;
-    return g_resource_counter++;
+    // デコード・無音トリム・（任意で）圧縮して共有ストアへ登録
+    return g_sample_store.LoadWAVFile(path);
 }
 
 int VirtualLoadBMPFile(const std::string& path) {
     std::cout << "[LOAD] BMP: " << path << std::endl;
-    return g_resource_counter++;
+    // プールのバッファへ RGBA8 で直接デコード
+    return g_image_store.LoadFile(path);
 }
 
 // =======================================
@@ -32,21 +34,64 @@ int VirtualLoadBMPFile(const std::string& path) {
 // =======================================
 bool BMSParser::Parse(const std::string& filepath, BMSData& out_data)
 {
-    std::ifstream file(filepath);
+    std::ifstream file(filepath, std::ios::binary);
     if (file.fail())
     {
         std::cerr << "[ERROR] Failed to open BMS file: " << filepath << std::endl;
         return false;
     }
 
+    // ファイル全体を 1 度で読み、メモリ上のパースと同じ経路に流す
+    file.seekg(0, std::ios::end);
+    const std::streamoff size = file.tellg();
+    file.seekg(0, std::ios::beg);
+
+    std::string bytes(size > 0 ? (size_t)size : 0, '\0');
+    if (!bytes.empty() && !file.read(&bytes[0], (std::streamsize)bytes.size()))
+    {
+        std::cerr << "[ERROR] Failed to read BMS file: " << filepath << std::endl;
+        return false;
+    }
+
+    return ParseMemory(bytes.data(), bytes.size(), out_data);
+}
+
+// ----------------------------------------------------
+// バッファから 1 行取り出す（\n / \r\n / \r のいずれの改行も可）
+// line はループ中使い回すので、行長の最大値を超えない限り再確保しない
+// ----------------------------------------------------
+static bool NextLine(const char* data, size_t size, size_t& pos, std::string& line)
+{
+    if (pos >= size) return false;
+
+    size_t end = pos;
+    while (end < size && data[end] != '\n' && data[end] != '\r') ++end;
+
+    line.assign(data + pos, end - pos);
+
+    if (end < size && data[end] == '\r') ++end;
+    if (end < size && data[end] == '\n') ++end;
+    pos = end;
+    return true;
+}
+
+bool BMSParser::ParseMemory(const char* data, size_t size, BMSData& out_data)
+{
+    if (!data && size > 0) return false;
+
     std::string line;
+    size_t pos = 0;
+
+    // UTF-8 BOM は読み飛ばす
+    if (size >= 3 && (unsigned char)data[0] == 0xEF && (unsigned char)data[1] == 0xBB && (unsigned char)data[2] == 0xBF)
+        pos = 3;
 
     // ----------------------------------------------------
     // LN開始待ちマップ
     // ----------------------------------------------------
     std::map<int, Note> ln_starts;
 
-    while (std::getline(file, line))
+    while (NextLine(data, size, pos, line))
     {
         if (line.empty() || line[0] != '#')
             continue;
@@ -62,6 +107,17 @@ bool BMSParser::Parse(const std::string& filepath, BMSData& out_data)
             continue;
         }
 
+        // -----------------------------
+        // #ARTIST
+        // -----------------------------
+        if (line.find("#ARTIST") == 0)
+        {
+            std::string value = line.substr(7);
+            if (!value.empty() && value[0] == ' ') value = value.substr(1);
+            out_data.artist = value;
+            continue;
+        }
+
         // -----------------------------
         // #BPM (初期BPM)
         // -----------------------------
@@ -97,6 +153,37 @@ bool BMSParser::Parse(const std::string& filepath, BMSData& out_data)
             continue;
         }
 
+        // -----------------------------
+        // #SCROLLxx / #SPEEDxx
+        // -----------------------------
+        if ((line.find("#SCROLL") == 0 && line.size() > 9) ||
+            (line.find("#SPEED") == 0 && line.size() > 8))
+        {
+            const bool is_scroll = line[2] == 'C';
+            const size_t id_pos = is_scroll ? 7 : 6;
+            std::string id = line.substr(id_pos,2);
+            std::string v  = line.substr(id_pos+2);
+            if (!v.empty() && v[0]==' ') v = v.substr(1);
+            try
+            {
+                (is_scroll ? out_data.scroll_table : out_data.speed_table)[id] = std::stod(v);
+            }
+            catch(...) {}
+            continue;
+        }
+
+        // -----------------------------
+        // #BMPxx
+        // -----------------------------
+        if (line.find("#BMP") == 0 && line.size() > 6)
+        {
+            std::string id = line.substr(4,2);
+            std::string path = line.substr(6);
+            if (!path.empty() && path[0]==' ') path = path.substr(1);
+            out_data.bmp_files[id] = path;
+            continue;
+        }
+
         // -----------------------------
         // #STOPxx
         // -----------------------------
@@ -122,7 +209,11 @@ bool BMSParser::Parse(const std::string& filepath, BMSData& out_data)
         try
         {
             measure = std::stoi(line.substr(1,3));
-            channel = std::stoi(line.substr(4,2), nullptr, 16);
+
+            const std::string ch = line.substr(4,2);
+            if (ch == "SC")      channel = CHANNEL_SCROLL;
+            else if (ch == "SP") channel = CHANNEL_SPEED;
+            else                 channel = std::stoi(ch, nullptr, 16);
             data_str = line.substr(cpos+1);
         }
         catch(...)
@@ -133,9 +224,10 @@ bool BMSParser::Parse(const std::string& filepath, BMSData& out_data)
         if (data_str.size() % 2 != 0) continue;
 
         // =====================================================
-        // BPM/STOP/小節倍率
+        // BPM/STOP/小節倍率/SCROLL/SPEED
         // =====================================================
-        if (channel == 0x02 || channel == 0x03 || channel == 0x08)
+        if (channel == 0x02 || channel == 0x03 || channel == 0x08 ||
+            channel == CHANNEL_SCROLL || channel == CHANNEL_SPEED)
         {
             if (channel == 0x02)
             {
@@ -245,13 +337,22 @@ bool BMSParser::Parse(const std::string& filepath, BMSData& out_data)
         }
     );
 
-    // =====================================================
-    // 1PASS: time_ms 再計算
-    // =====================================================
+    CalculateNoteTimes(out_data);
+    CalculateLNEndTimes(out_data);
+
+    return true;
+}
+
+// =====================================================
+// 1PASS: time_ms 再計算（notes は measure → pos_raw 順であること）
+// =====================================================
+void BMSParser::CalculateNoteTimes(BMSData& out_data)
+{
     double cur_time = 0.0;
     double cur_bpm  = out_data.initial_bpm;
     double rate     = 1.0;
     int last_m      = -1;
+    out_data.measure_times.clear();
 
     for (auto& n : out_data.notes)
     {
@@ -261,6 +362,7 @@ bool BMSParser::Parse(const std::string& filepath, BMSData& out_data)
             {
                 cur_time += (60000.0/cur_bpm)*4.0*rate;
             }
+            out_data.measure_times.push_back(cur_time);
 
             auto it = out_data.measure_rate_map.find(n.measure);
             rate = (it != out_data.measure_rate_map.end()) ? it->second : 1.0;
@@ -289,10 +391,13 @@ bool BMSParser::Parse(const std::string& filepath, BMSData& out_data)
             }
         }
     }
+}
 
-    // =====================================================
-    // 2PASS: calc_time_at による LN end_time_ms 計算
-    // =====================================================
+// =====================================================
+// 2PASS: calc_time_at による LN end_time_ms 計算
+// =====================================================
+void BMSParser::CalculateLNEndTimes(BMSData& out_data)
+{
     auto calc_time_at = [&](int target_m, double target_pos)
     {
         double t = 0.0;
@@ -348,14 +453,12 @@ bool BMSParser::Parse(const std::string& filepath, BMSData& out_data)
             n.end_time_ms = calc_time_at(n.end_measure, n.end_pos);
         }
     }
-
-    return true;
 }
 
 // ----------------------------------------------------
 // リソースロードを管理する関数
 // ----------------------------------------------------
-void LoadBMSResources(BMSData& data, const std::string& bms_filepath)
+void LoadBMSResources(BMSData& data, const std::string& bms_filepath, bool preload_bmps)
 {
     // ======================================
     // 1. パスの解決 (ResolveResourcePaths 相当)
@@ -413,9 +516,20 @@ void LoadBMSResources(BMSData& data, const std::string& bms_filepath)
         }
     }
 
+    std::cout << "[OK] Keysound memory: "
+              << g_sample_store.GetResidentBytes() / 1024 << " KB ("
+              << g_sample_store.GetSampleCount() << " samples, "
+              << g_sample_store.GetSharedHitCount() << " shared loads)" << std::endl;
+
     // ======================================
     // 4. BMPファイルのロード
+    //  (BGAScheduler を使う場合はプレイ中に先読みするためスキップ)
     // ======================================
+    if (!preload_bmps) {
+        std::cout << "[OK] BMP loading deferred: " << resolved_bmps.size() << " images" << std::endl;
+        return;
+    }
+
     for (const auto& kv : resolved_bmps) {
         const std::string& bmp_id = kv.first;
         const std::string& bmp_path = kv.second;
@@ -431,3 +545,26 @@ void LoadBMSResources(BMSData& data, const std::string& bms_filepath)
         }
     }
 }
+
+// ----------------------------------------------------
+// チャートが保持するキー音の参照を返却する
+//  ・共有ストア上のバッファは他の難易度が使っていれば残る
+//  ・未参照になったものは g_sample_store.PurgeUnreferenced で解放
+// ----------------------------------------------------
+void ReleaseBMSResources(BMSData& data)
+{
+    for (const auto& kv : data.loaded_wavs) {
+        g_sample_store.Release(kv.second);
+    }
+    data.loaded_wavs.clear();
+
+    for (const auto& kv : data.loaded_bmps) {
+        g_image_store.Release(kv.second);
+    }
+    data.loaded_bmps.clear();
+
+    if (data.loaded_stagefile > 0) {
+        g_image_store.Release(data.loaded_stagefile);
+        data.loaded_stagefile = -1;
+    }
+}
@@ -1,7 +1,8 @@
 #pragma once
 
+#include <cstddef>
 #include <string>
-#include "Data.h"
+#include "data.h"
 
 // =======================================
 // BMS パーサクラス
@@ -19,8 +20,32 @@ public:
     // 失敗: false（ファイルが開けない等）
     // ---------------------------------------
     static bool Parse(const std::string& filepath, BMSData& out_data);
+
+    // ---------------------------------------
+    // メモリ上の BMS を解析（Parse(filepath) もファイルを読んだ後これを呼ぶ）
+    // data : BMSファイルの中身（size バイト。NUL 終端は不要）
+    //
+    // WASM ビルドではブラウザがファイルのバイト列を 1 度だけヒープへ置き、
+    // JS 側でパースせずにこれで解析する
+    // ---------------------------------------
+    static bool ParseMemory(const char* data, size_t size, BMSData& out_data);
+
+    // ---------------------------------------
+    // 解析の後半（ParseMemory から順に呼ばれる。ベンチマーク用に個別にも呼べる）
+    // CalculateNoteTimes  : 小節・位置・BPM・STOP から各ノーツの time_ms を求める
+    // CalculateLNEndTimes : LN の終端（end_measure / end_pos）から end_time_ms を求める
+    // ---------------------------------------
+    static void CalculateNoteTimes(BMSData& out_data);
+    static void CalculateLNEndTimes(BMSData& out_data);
 };
 
 void ResolveResourcePaths(BMSData& data, const std::string& bms_filepath);
 
 std::string GetBMSDirectory(const std::string& bms_filepath);
+
+// リソース（WAV/BMP）のロード。WAV は共有サンプルストアに登録される
+// preload_bmps = false の場合 BMP は読まない（BGAScheduler が再生中に先読みする）
+void LoadBMSResources(BMSData& data, const std::string& bms_filepath, bool preload_bmps = true);
+
+// LoadBMSResources で取得したキー音・画像の参照を返却する
+void ReleaseBMSResources(BMSData& data);
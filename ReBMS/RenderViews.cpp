@@ -0,0 +1,123 @@
+#include "RenderViews.h"
+#include "BMSGameApp.h"
+#include "Renderer.h"
+
+#include <algorithm>
+
+RenderViews::RenderViews()
+    : visible_height(VISIBLE_DURATION_MS * SCROLL_SPEED)
+{
+}
+
+// --------------------------------------------------------
+// ロード時
+// --------------------------------------------------------
+void RenderViews::Reset(const std::vector<RenderNote>& src, const ScrollMap* scroll_map)
+{
+    notes = &src;
+    scroll = scroll_map;
+
+    order.resize(src.size());
+    end_time.resize(src.size());
+    head_pos.resize(src.size());
+    tail_pos.resize(src.size());
+    max_length_ms = 0.0;
+    for (size_t i = 0; i < src.size(); ++i)
+    {
+        order[i] = (uint32_t)i;
+        const double length = src[i].is_long_note ? std::max(0.0, src[i].duration_ms) : 0.0;
+        end_time[i] = src[i].time_ms + length;
+        max_length_ms = std::max(max_length_ms, length);
+
+        // スクロール位置はロード時に一度だけ引く（描画時は引き算のみ）
+        head_pos[i] = scroll ? scroll->PositionAt(src[i].time_ms) : src[i].time_ms;
+        tail_pos[i] = length > 0.0 ? (scroll ? scroll->PositionAt(end_time[i]) : end_time[i]) : head_pos[i];
+    }
+
+    std::stable_sort(order.begin(), order.end(),
+        [&src](uint32_t a, uint32_t b){ return src[a].time_ms < src[b].time_ms; });
+
+    // 全ノーツが同時に見えても入る大きさ（以後は再確保しない）
+    note_data.assign(std::max<size_t>(1, src.size()) * VIEW_NOTE_STRIDE, 0.0f);
+
+    cursor = 0;
+    last_time = 0.0;
+    hud[VIEW_HUD_NOTE_COUNT] = 0;
+}
+
+// --------------------------------------------------------
+// 毎フレーム
+// --------------------------------------------------------
+void RenderViews::Seek(double now)
+{
+    // 手前に長い LN が残っている可能性があるので、最長 LN 分だけ遡った位置から見る
+    const double from = now - trail_ms - max_length_ms;
+
+    if (now < last_time)
+    {
+        cursor = (size_t)(std::lower_bound(order.begin(), order.end(), from,
+            [this](uint32_t i, double t){ return (*notes)[i].time_ms < t; }) - order.begin());
+    }
+    else
+    {
+        while (cursor < order.size() && (*notes)[order[cursor]].time_ms < from) ++cursor;
+    }
+    last_time = now;
+}
+
+void RenderViews::BuildNotes(double now)
+{
+    if (!notes) return;
+    Seek(now);
+
+    const double now_pos = scroll ? scroll->PositionAt(now) : now;
+    const double scale = ScrollPixelsPerUnit(scroll, now, hi_speed, green_ms, visible_height);
+    const double max_dist = scale > 0.0 ? visible_height / scale : 0.0;
+    const double bottom = now - trail_ms;
+    float* out = note_data.data();
+    int count = 0;
+
+    for (size_t k = cursor; k < order.size(); ++k)
+    {
+        const uint32_t i = order[k];
+        const RenderNote& n = (*notes)[i];
+        // 位置は時刻に対して単調なので、表示範囲の上に出た時点で打ち切れる
+        if (head_pos[i] - now_pos > max_dist) break;
+        if (end_time[i] < bottom) continue;
+
+        int flags = 0;
+        if (n.is_long_note) flags |= VIEW_NOTE_FLAG_LN;
+        if (n.is_ln_end)    flags |= VIEW_NOTE_FLAG_LN_END;
+
+        float* v = out + (size_t)count * VIEW_NOTE_STRIDE;
+        v[VIEW_NOTE_LANE]      = (float)n.lane;
+        v[VIEW_NOTE_OFFSET_PX] = (float)((head_pos[i] - now_pos) * scale);
+        v[VIEW_NOTE_LENGTH_PX] = (float)((tail_pos[i] - head_pos[i]) * scale);
+        v[VIEW_NOTE_FLAGS]     = (float)flags;
+        ++count;
+    }
+
+    hud[VIEW_HUD_NOTE_COUNT] = count;
+    ++hud[VIEW_HUD_FRAME];
+}
+
+void RenderViews::SetLayers(const std::map<int, int>& layers)
+{
+    int count = 0;
+    for (const auto& kv : layers)
+    {
+        if (count >= VIEW_LAYER_CAPACITY) break;
+        if (kv.second == 0) continue;   // クリア済みのレイヤー
+        layer_data[count * VIEW_LAYER_STRIDE]     = kv.first;
+        layer_data[count * VIEW_LAYER_STRIDE + 1] = kv.second;
+        ++count;
+    }
+    hud[VIEW_HUD_LAYER_COUNT] = count;
+}
+
+void RenderViews::SetHud(int score, int combo, int bga_id)
+{
+    hud[VIEW_HUD_SCORE] = score;
+    hud[VIEW_HUD_COMBO] = combo;
+    hud[VIEW_HUD_BGA_ID] = bga_id;
+}
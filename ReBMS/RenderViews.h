@@ -0,0 +1,118 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <vector>
+
+// BMSGameApp.h で定義（BMSPlayer の Note と衝突しないよう前方宣言のみ）
+struct RenderNote;
+class ScrollMap;
+
+// ------------------------------------------------------------
+// JS 側の描画へ渡す共有バッファ
+//  ・表示範囲内のノーツ / レイヤー ID / HUD の値を、詰めた配列として C++ 側に持つ
+//  ・WASM ビルドでは emscripten::typed_memory_view でそのまま見せる
+//    （JS 側はオブジェクトを作らず Float32Array / Int32Array を読むだけ）
+//  ・配列はロード時に最大数まで確保し、プレイ中は再確保しない（ポインタが変わらない）
+//    ただしメモリ拡張（ALLOW_MEMORY_GROWTH）で WASM ヒープが伸びると
+//    JS 側のビューは切り離されるので、ロード直後とビューの length が 0 になった時に取り直す
+//  ・有効な要素数は毎フレーム HUD 配列の VIEW_HUD_NOTE_COUNT / LAYER_COUNT で知らせる
+//  ・ノーツの位置は RenderListBuilder と同じスクロール位置（ScrollMap があれば BPM / STOP /
+//    #SCROLL / #SPEED を反映）に倍率を掛けたピクセル。JS は y = 判定ライン - offset で置くだけ
+// ------------------------------------------------------------
+
+// ノーツ 1 件 = float 4 個
+constexpr int VIEW_NOTE_STRIDE = 4;
+enum ViewNoteField {
+    VIEW_NOTE_LANE = 0,         // レーン番号
+    VIEW_NOTE_OFFSET_PX = 1,    // 判定ラインからの距離（スクロール位置の差 x 倍率。正なら判定ラインより上）
+    VIEW_NOTE_LENGTH_PX = 2,    // LN の長さ（通常ノーツは 0）
+    VIEW_NOTE_FLAGS = 3,        // ViewNoteFlag の組み合わせ
+};
+
+enum ViewNoteFlag {
+    VIEW_NOTE_FLAG_LN = 1,
+    VIEW_NOTE_FLAG_LN_END = 2,
+};
+
+// レイヤー 1 件 = int 2 個（レイヤー番号, BMP ID）
+constexpr int VIEW_LAYER_STRIDE = 2;
+constexpr int VIEW_LAYER_CAPACITY = 8;
+
+// HUD 配列（int32）
+enum ViewHudField {
+    VIEW_HUD_SCORE = 0,
+    VIEW_HUD_COMBO,
+    VIEW_HUD_BGA_ID,
+    VIEW_HUD_NOTE_COUNT,    // ノーツ配列の有効件数
+    VIEW_HUD_LAYER_COUNT,   // レイヤー配列の有効件数
+    VIEW_HUD_FRAME,         // Update 毎に 1 増える（JS 側の再描画判定用）
+    VIEW_HUD_FIELD_COUNT
+};
+
+class RenderViews
+{
+public:
+    RenderViews();
+
+    /**
+     * ノーツ列を設定する（ロード毎に必ず呼ぶ。notes / scroll_map は描画中ずっと有効であること）
+     * 時刻順のインデックス、ノーツ毎のスクロール位置、出力配列の最大サイズはここで確保する
+     * （同じ vector に同じ件数で再ロードされても、中身の変化は検出できないため）
+     * @param scroll_map nullptr なら ms 単位で等速に流す（JS でパースした譜面など）
+     */
+    void Reset(const std::vector<RenderNote>& notes, const ScrollMap* scroll_map = nullptr);
+
+    /**
+     * visual_time_ms 時点で表示範囲に入るノーツを詰める
+     * 時刻順のカーソルを進めるだけで、毎フレーム全ノーツは見ない
+     */
+    void BuildNotes(double visual_time_ms);
+
+    void SetLayers(const std::map<int, int>& layers);
+    void SetHud(int score, int combo, int bga_id);
+
+    // ------------------- 表示設定（プレイ中に変更可。RenderListBuilder と同じ意味） -------------------
+    void SetHiSpeed(double hs) { hi_speed = hs; }
+    void SetConstantGreen(double visible_ms) { green_ms = visible_ms; }
+
+    /**
+     * 判定ラインより上に出す範囲（ピクセル）と、通過後も残す範囲（ms）
+     */
+    void SetVisibleHeight(double px) { visible_height = px; }
+    void SetTrailMs(double ms) { trail_ms = ms; }
+
+    // ------------------- 共有バッファ -------------------
+    const float* GetNoteData() const { return note_data.data(); }
+    size_t GetNoteCapacity() const { return note_data.size(); }      // float 数
+    size_t GetNoteCount() const { return (size_t)hud[VIEW_HUD_NOTE_COUNT]; }
+
+    const int32_t* GetLayerData() const { return layer_data; }
+    size_t GetLayerCapacity() const { return (size_t)VIEW_LAYER_CAPACITY * VIEW_LAYER_STRIDE; }
+
+    const int32_t* GetHudData() const { return hud; }
+    size_t GetHudSize() const { return VIEW_HUD_FIELD_COUNT; }
+
+private:
+    void Seek(double visual_time_ms);
+
+    const std::vector<RenderNote>* notes = nullptr;
+    const ScrollMap* scroll = nullptr;
+
+    std::vector<uint32_t> order;    // 時刻順のインデックス
+    std::vector<double> end_time;   // ノーツ毎の終端（LN は終点時刻）
+    std::vector<double> head_pos;   // ノーツ毎のスクロール位置（ScrollMap なしなら時刻）
+    std::vector<double> tail_pos;   // LN 終端のスクロール位置
+    std::vector<float> note_data;   // VIEW_NOTE_STRIDE x ノーツ数
+    size_t cursor = 0;              // order 上で最初の「終端 + trail が現在時刻以降」
+    double last_time = 0.0;
+    double max_length_ms = 0.0;     // 最長の LN（カーソルの手前に残る LN を拾う範囲）
+
+    int32_t layer_data[VIEW_LAYER_CAPACITY * VIEW_LAYER_STRIDE] = {};
+    int32_t hud[VIEW_HUD_FIELD_COUNT] = {};
+
+    double hi_speed = 1.0;
+    double green_ms = 0.0;
+    double visible_height;          // 既定は RenderListBuilder と同じ（コンストラクタで設定）
+    double trail_ms = 200.0;
+};
@@ -1,5 +1,7 @@
 #include "Renderer.h"
 
+#include <algorithm>
+
 // ------------------------------
 // 描画設定（お好みで Config.cpp に逃がしても良い）
 // ------------------------------
@@ -7,6 +9,20 @@ const double JUDGELINE_Y          = 800.0;
 const double SCROLL_SPEED         = 0.5;
 const double VISIBLE_DURATION_MS  = 3000.0;
 
+namespace {
+
+DrawNote MakeDrawNote(const Note& n, double head, double tail, double now_pos, double scale,
+                      double judgeline_y)
+{
+    DrawNote dn;
+    dn.source = &n;
+    dn.y_position = judgeline_y - (head - now_pos) * scale;
+    dn.length = (n.end_time_ms > n.time_ms) ? (tail - head) * scale : 0.0;
+    return dn;
+}
+
+} // namespace
+
 // ------------------------------
 // 描画リスト生成
 // ------------------------------
@@ -14,35 +30,137 @@ std::vector<DrawNote> GetNotesForRendering(
     const std::vector<Note>& notes,
     double current_time)
 {
+    RenderListBuilder builder;
+    builder.Reset(notes);
+
     std::vector<DrawNote> draw_notes;
-    draw_notes.reserve(notes.size());
+    builder.Build(current_time, draw_notes);
+    return draw_notes;
+}
 
-    const double start_time = current_time;
-    const double end_time   = current_time + VISIBLE_DURATION_MS;
+// ------------------------------
+// RenderListBuilder
+// ------------------------------
+void RenderListBuilder::Reset(const std::vector<Note>& src, const ScrollMap* scroll_map)
+{
+    notes = &src;
+    scroll = scroll_map;
 
-    for (const Note& n : notes)
-    {
-        if (n.time_ms < start_time || n.time_ms > end_time)
-            continue;
+    order.resize(src.size());
+    for (size_t i = 0; i < src.size(); ++i) order[i] = i;
 
-        DrawNote dn;
-        dn.source = &n;
+    // パーサ出力は時刻順だが、念のため安定ソートしておく（ロード時のみ）
+    std::stable_sort(order.begin(), order.end(),
+        [&src](size_t a, size_t b){ return src[a].time_ms < src[b].time_ms; });
 
-        double dt = n.time_ms - current_time;
-        dn.y_position = JUDGELINE_Y - (dt * SCROLL_SPEED);
+    // スクロール位置はロード時に一度だけ引く（描画時は引き算のみ）
+    head_pos.resize(src.size());
+    tail_pos.resize(src.size());
 
-        if (n.end_time_ms > n.time_ms)
-        {
-            double ln_dur = n.end_time_ms - n.time_ms;
-            dn.length = ln_dur * SCROLL_SPEED;
-        }
-        else
+    size_t ln_count = 0;
+    for (size_t i = 0; i < src.size(); ++i)
+    {
+        const Note& n = src[i];
+        head_pos[i] = scroll ? scroll->PositionAt(n.time_ms) : n.time_ms;
+        tail_pos[i] = head_pos[i];
+
+        if (IsLongNote(n))
         {
-            dn.length = 0.0;
+            tail_pos[i] = scroll ? scroll->PositionAt(n.end_time_ms) : n.end_time_ms;
+            ++ln_count;
         }
+    }
+
+    active_lns.clear();
+    active_lns.reserve(ln_count);
 
-        draw_notes.push_back(dn);
+    cursor = 0;
+    last_time = -1e300;
+}
+
+// 巻き戻し時 : カーソルと LN リストを作り直す
+void RenderListBuilder::Seek(double current_time)
+{
+    const std::vector<Note>& src = *notes;
+
+    cursor = std::lower_bound(order.begin(), order.end(), current_time,
+        [&src](size_t i, double t){ return src[i].time_ms < t; }) - order.begin();
+
+    active_lns.clear();
+    for (size_t k = 0; k < cursor; ++k)
+    {
+        const Note& n = src[order[k]];
+        if (IsLongNote(n) && n.end_time_ms >= current_time)
+            active_lns.push_back(order[k]);
     }
+}
 
-    return draw_notes;
+void RenderListBuilder::Build(double current_time, std::vector<DrawNote>& out)
+{
+    out.clear();
+    if (!notes) return;
+
+    const std::vector<Note>& src = *notes;
+
+    if (current_time < last_time)
+        Seek(current_time);
+    last_time = current_time;
+
+    // 1. 判定ラインを過ぎたノーツを読み飛ばす（LN は終端まで保持）
+    while (cursor < order.size() && src[order[cursor]].time_ms < current_time)
+    {
+        const Note& n = src[order[cursor]];
+        if (IsLongNote(n) && n.end_time_ms >= current_time)
+            active_lns.push_back(order[cursor]);
+        ++cursor;
+    }
+
+    // 2. 終端も過ぎた LN を外す
+    active_lns.erase(std::remove_if(active_lns.begin(), active_lns.end(),
+        [&src, current_time](size_t i){ return src[i].end_time_ms < current_time; }),
+        active_lns.end());
+
+    // 3. 押下中の LN → 表示範囲内のノーツの順に書き出す
+    const double now_pos = scroll ? scroll->PositionAt(current_time) : current_time;
+    const double scale = GetPixelsPerUnit(current_time);
+    const double max_dist = scale > 0.0 ? visible_height / scale : 0.0;
+
+    for (size_t i : active_lns)
+        out.push_back(MakeDrawNote(src[i], head_pos[i], tail_pos[i], now_pos, scale, judgeline_y));
+
+    // 位置は時刻に対して単調なので、範囲外に出た時点で打ち切れる
+    for (size_t k = cursor; k < order.size(); ++k)
+    {
+        const size_t i = order[k];
+        if (head_pos[i] - now_pos > max_dist) break;
+        out.push_back(MakeDrawNote(src[i], head_pos[i], tail_pos[i], now_pos, scale, judgeline_y));
+    }
+}
+
+// --------------------------------------------------------
+// 倍率 : ハイスピード / 緑数字固定 / #SPEED
+// --------------------------------------------------------
+double RenderListBuilder::GetPixelsPerUnit(double current_time) const
+{
+    return ScrollPixelsPerUnit(scroll, current_time, hi_speed, green_ms, visible_height);
+}
+
+double ScrollPixelsPerUnit(const ScrollMap* scroll, double current_time, double hi_speed, double green_ms,
+                           double visible_height)
+{
+    if (!scroll)
+        return green_ms > 0.0 ? visible_height / green_ms : SCROLL_SPEED * hi_speed;
+
+    double px_per_beat;
+    if (green_ms > 0.0)
+    {
+        // 現在の BPM で visible_height を green_ms かけて流れる速さ
+        px_per_beat = visible_height / (green_ms * scroll->BPMAt(current_time) / 60000.0);
+    }
+    else
+    {
+        px_per_beat = SCROLL_SPEED * (60000.0 / scroll->GetBaseBPM()) * hi_speed;
+    }
+
+    return px_per_beat * scroll->SpeedAt(current_time);
 }
@@ -1,6 +1,13 @@
 #pragma once
+#include <cstddef>
 #include <vector>
 #include "Note.h"
+#include "ScrollMap.h"
+
+// 必要な描画設定（RenderListBuilder の初期値）
+extern const double JUDGELINE_Y;
+extern const double SCROLL_SPEED;
+extern const double VISIBLE_DURATION_MS;
 
 // ------------------------------
 // 描画用ノーツ構造体
@@ -11,12 +18,88 @@ struct DrawNote {
     double length;
 };
 
-// 描画用リスト生成
+// 描画用リスト生成（毎回全ノーツを走査する簡易版）
+// 呼び出し毎に時刻順の索引を作り直し（stable_sort）、作業領域と戻り値を確保する
+// 毎フレームの描画は RenderListBuilder（Reset はロード時に 1 回）の Build に使い回しのバッファを渡す
+[[deprecated("per-call sort and allocations; use RenderListBuilder")]]
 std::vector<DrawNote> GetNotesForRendering(
     const std::vector<Note>& notes,
     double current_time);
 
-// 必要な描画設定
-extern const double JUDGELINE_Y;
-extern const double SCROLL_SPEED;
-extern const double VISIBLE_DURATION_MS;
+/**
+ * 1 スクロール単位（ScrollMap があれば拍、なければ 1ms）あたりのピクセル数
+ * ハイスピード / 緑数字固定（green_ms > 0）/ #SPEED を反映する
+ * RenderListBuilder と RenderViews（JS へ渡す描画バッファ）で同じ倍率を使う
+ */
+double ScrollPixelsPerUnit(const ScrollMap* scroll, double current_time, double hi_speed, double green_ms,
+                           double visible_height);
+
+// ------------------------------------------------------------
+// 描画リストビルダー
+//  ・時刻順のカーソルを保持し、毎フレームは表示範囲内のノーツだけを見る
+//  ・先頭が判定ラインを過ぎても終端が残っている LN は別リストで保持し描画を続ける
+//  ・出力先は呼び出し側が使い回すバッファ（clear のみで再確保しない）
+//  ・時刻が巻き戻った場合（シーク）は二分探索で位置を合わせ直す
+//  ・ScrollMap を渡すと BPM / STOP / SCROLL / SPEED に従って配置する
+//    （渡さない場合は従来どおり ms 単位で等速に流す）
+//  ・ハイスピード 1.0 は SCROLL_SPEED 相当（初期 BPM での 1ms あたりのピクセル数）
+//    緑数字固定モードでは、現在の BPM に関わらず表示範囲を
+//    指定 ms で通過するよう倍率を決める
+// ------------------------------------------------------------
+class RenderListBuilder
+{
+public:
+    /**
+     * ノーツ列を設定する（notes は描画中ずっと有効であること）
+     * 時刻順のインデックスと LN 用の作業領域はここで一度だけ確保する
+     */
+    void Reset(const std::vector<Note>& notes, const ScrollMap* scroll_map = nullptr);
+
+    /**
+     * current_time 時点の描画リストを out に書き出す
+     * out の容量はピーク時の表示数まで伸びた後は再確保されない
+     * （ロード時に out.reserve(ノーツ数) しておけばプレイ中の確保は起きない）
+     */
+    void Build(double current_time, std::vector<DrawNote>& out);
+
+    // ------------------- 表示設定（プレイ中に変更可） -------------------
+    void SetHiSpeed(double hs) { hi_speed = hs; }
+    double GetHiSpeed() const { return hi_speed; }
+
+    /**
+     * 緑数字固定モード
+     * @param visible_ms ノーツが表示範囲の上端から判定ラインまでにかかる時間（0 以下で無効）
+     */
+    void SetConstantGreen(double visible_ms) { green_ms = visible_ms; }
+
+    void SetJudgeLineY(double y) { judgeline_y = y; }
+
+    // 判定ラインより上に描画する範囲（ピクセル）
+    void SetVisibleHeight(double px) { visible_height = px; }
+
+    /**
+     * 現在の 1 拍（ScrollMap なしの場合は 1ms）あたりのピクセル数
+     */
+    double GetPixelsPerUnit(double current_time) const;
+
+    size_t GetCursor() const { return cursor; }
+    size_t GetActiveLongNoteCount() const { return active_lns.size(); }
+
+private:
+    void Seek(double current_time);
+    static bool IsLongNote(const Note& n) { return n.end_time_ms > n.time_ms; }
+
+    const std::vector<Note>* notes = nullptr;
+    const ScrollMap* scroll = nullptr;
+    std::vector<size_t> order;         // time_ms 昇順のインデックス
+    std::vector<double> head_pos;      // ノーツ毎のスクロール位置（notes と同じ添字）
+    std::vector<double> tail_pos;      // LN 終端のスクロール位置
+    std::vector<size_t> active_lns;    // 先頭は通過済み・終端は未通過の LN
+    size_t cursor = 0;                 // order 上で最初の time_ms >= 現在時刻
+    double last_time = 0.0;
+
+    double hi_speed = 1.0;
+    double green_ms = 0.0;
+    double judgeline_y = JUDGELINE_Y;
+    double visible_height = VISIBLE_DURATION_MS * SCROLL_SPEED;
+};
@@ -0,0 +1,238 @@
+#include "Replay.h"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+namespace {
+
+const uint8_t REPLAY_MAGIC[4] = { 'R', 'B', 'R', 'P' };
+
+enum ReplayFlag : uint32_t {
+    REPLAY_FLAG_AUTOPLAY = 1u << 0,
+};
+
+// ------------------------------
+// 可変長整数（LEB128）
+// ------------------------------
+void PutVarint(std::vector<uint8_t>& out, uint64_t v)
+{
+    while (v >= 0x80)
+    {
+        out.push_back((uint8_t)(v | 0x80));
+        v >>= 7;
+    }
+    out.push_back((uint8_t)v);
+}
+
+void PutSigned(std::vector<uint8_t>& out, int64_t v)
+{
+    PutVarint(out, ((uint64_t)v << 1) ^ (uint64_t)(v >> 63));     // zigzag
+}
+
+void PutFixed64(std::vector<uint8_t>& out, uint64_t v)
+{
+    for (int i = 0; i < 8; ++i) out.push_back((uint8_t)(v >> (i * 8)));
+}
+
+class Reader
+{
+public:
+    Reader(const uint8_t* d, size_t n) : p(d), end(d + n) {}
+
+    bool Varint(uint64_t& v)
+    {
+        v = 0;
+        for (int shift = 0; shift < 64; shift += 7)
+        {
+            if (p >= end) return false;
+            const uint8_t b = *p++;
+            v |= (uint64_t)(b & 0x7F) << shift;
+            if (!(b & 0x80)) return true;
+        }
+        return false;
+    }
+
+    bool Signed(int64_t& v)
+    {
+        uint64_t u;
+        if (!Varint(u)) return false;
+        v = (int64_t)(u >> 1) ^ -(int64_t)(u & 1);
+        return true;
+    }
+
+    bool Int(int& v)
+    {
+        uint64_t u;
+        if (!Varint(u) || u > 0x7FFFFFFF) return false;
+        v = (int)u;
+        return true;
+    }
+
+    bool SignedInt(int& v)
+    {
+        int64_t s;
+        if (!Signed(s) || s < std::numeric_limits<int>::min() || s > std::numeric_limits<int>::max()) return false;
+        v = (int)s;
+        return true;
+    }
+
+    bool Fixed64(uint64_t& v)
+    {
+        if (end - p < 8) return false;
+        v = 0;
+        for (int i = 0; i < 8; ++i) v |= (uint64_t)p[i] << (i * 8);
+        p += 8;
+        return true;
+    }
+
+    bool Bytes(const uint8_t* expect, size_t n)
+    {
+        if ((size_t)(end - p) < n || std::memcmp(p, expect, n) != 0) return false;
+        p += n;
+        return true;
+    }
+
+    size_t Remaining() const { return (size_t)(end - p); }
+
+private:
+    const uint8_t* p;
+    const uint8_t* end;
+};
+
+uint64_t DoubleBits(double v)
+{
+    uint64_t bits;
+    std::memcpy(&bits, &v, sizeof(bits));
+    return bits;
+}
+
+// to - from（符号付きで溢れないよう 2 の補数で引く。時刻順のリプレイでは溢れない）
+int64_t TimeDelta(int64_t to, int64_t from)
+{
+    return (int64_t)((uint64_t)to - (uint64_t)from);
+}
+
+// t += delta（int64 の範囲を超えるなら false）
+bool AddTime(int64_t& t, int64_t delta)
+{
+    if (delta > 0 && t > std::numeric_limits<int64_t>::max() - delta) return false;
+    if (delta < 0 && t < std::numeric_limits<int64_t>::min() - delta) return false;
+    t += delta;
+    return true;
+}
+
+double BitsToDouble(uint64_t bits)
+{
+    double v;
+    std::memcpy(&v, &bits, sizeof(v));
+    return v;
+}
+
+} // namespace
+
+bool ReplayResult::operator==(const ReplayResult& o) const
+{
+    return score == o.score && max_combo == o.max_combo && judge_digest == o.judge_digest
+        && std::equal(judges, judges + REPLAY_JUDGE_KINDS, o.judges);
+}
+
+// --------------------------------------------------------
+// 符号化
+//  "RBRP" version chart_hash(8) seed flags judge_offset(8)
+//  edge_count { Δtime(zigzag) (channel << 1 | down) } x edge_count
+//  end_time(zigzag, 最後の入力からの差分) score(zigzag。ミスの減点で負になる) max_combo judges[6] digest(8)
+// --------------------------------------------------------
+void EncodeReplay(const Replay& replay, std::vector<uint8_t>& out)
+{
+    out.clear();
+    out.reserve(64 + replay.edges.size() * 3);
+
+    out.insert(out.end(), REPLAY_MAGIC, REPLAY_MAGIC + 4);
+    PutVarint(out, REPLAY_VERSION);
+    PutFixed64(out, replay.chart_hash);
+    PutVarint(out, replay.options.random_seed);
+    PutVarint(out, replay.options.autoplay ? REPLAY_FLAG_AUTOPLAY : 0u);
+    PutFixed64(out, DoubleBits(replay.options.judge_offset_ms));     // 丸めずに持つ（判定にそのまま効く）
+
+    PutVarint(out, replay.edges.size());
+    int64_t prev = 0;
+    for (const ReplayEdge& e : replay.edges)
+    {
+        PutSigned(out, TimeDelta(e.time_units, prev));
+        PutVarint(out, ((uint64_t)(uint32_t)e.channel << 1) | (e.down ? 1u : 0u));
+        prev = e.time_units;
+    }
+    PutSigned(out, TimeDelta(replay.end_time_units, prev));
+
+    const ReplayResult& r = replay.result;
+    PutSigned(out, r.score);
+    PutVarint(out, (uint64_t)std::max(0, r.max_combo));
+    for (int k = 0; k < REPLAY_JUDGE_KINDS; ++k) PutVarint(out, (uint64_t)std::max(0, r.judges[k]));
+    PutFixed64(out, r.judge_digest);
+}
+
+// --------------------------------------------------------
+// 復号
+// --------------------------------------------------------
+bool DecodeReplay(const uint8_t* data, size_t size, Replay& out)
+{
+    if (!data) return false;
+    Reader in(data, size);
+
+    uint64_t version, seed, flags, offset_bits, count;
+    if (!in.Bytes(REPLAY_MAGIC, 4)) return false;
+    if (!in.Varint(version) || version != REPLAY_VERSION) return false;
+    if (!in.Fixed64(out.chart_hash)) return false;
+    if (!in.Varint(seed) || !in.Varint(flags) || !in.Fixed64(offset_bits)) return false;
+    if (!in.Varint(count) || count > in.Remaining() / 2) return false;     // 1 入力は最低 2 バイト
+
+    out.options.random_seed = (uint32_t)seed;
+    out.options.autoplay = (flags & REPLAY_FLAG_AUTOPLAY) != 0;
+    out.options.judge_offset_ms = BitsToDouble(offset_bits);
+
+    out.edges.clear();
+    out.edges.reserve((size_t)count);
+    int64_t t = 0;
+    for (uint64_t i = 0; i < count; ++i)
+    {
+        int64_t delta;
+        uint64_t packed;
+        if (!in.Signed(delta) || !in.Varint(packed) || (packed >> 1) > 0xFF) return false;
+        // 最初の入力だけは 0 からの差（リードイン中の負の時刻あり）。以降は時刻順なので負の差は不正
+        if ((i > 0 && delta < 0) || !AddTime(t, delta)) return false;
+        out.edges.push_back({ t, (int32_t)(packed >> 1), (int32_t)(packed & 1) });
+    }
+
+    int64_t end_delta;
+    if (!in.Signed(end_delta) || (count > 0 && end_delta < 0) || !AddTime(t, end_delta)) return false;
+    out.end_time_units = t;
+
+    ReplayResult& r = out.result;
+    if (!in.SignedInt(r.score) || !in.Int(r.max_combo)) return false;
+    for (int k = 0; k < REPLAY_JUDGE_KINDS; ++k)
+        if (!in.Int(r.judges[k])) return false;
+    if (!in.Fixed64(r.judge_digest)) return false;
+
+    return in.Remaining() == 0;
+}
+
+// --------------------------------------------------------
+// ReplayRecorder
+// --------------------------------------------------------
+void ReplayRecorder::Begin(uint64_t chart_hash, const ReplayOptions& options, size_t expected_edges)
+{
+    replay = Replay();
+    replay.chart_hash = chart_hash;
+    replay.options = options;
+    replay.edges.reserve(expected_edges);
+    active = true;
+}
+
+void ReplayRecorder::Finish(double end_time_ms, const ReplayResult& result, std::vector<uint8_t>& out)
+{
+    replay.end_time_units = ReplayMsToUnits(end_time_ms);
+    replay.result = result;
+    EncodeReplay(replay, out);
+    active = false;
+}
@@ -0,0 +1,104 @@
+#pragma once
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// ------------------------------------------------------------
+// リプレイ（プレイヤーの入力の記録と再シミュレーション）
+//  ・記録するのは時刻付きのキーの押下 / 離鍵と、譜面ハッシュ・オプション・乱数シード
+//  ・入力時刻は REPLAY_TIME_UNIT_MS 単位に丸めた値をプレイ中の判定にも使う
+//    （記録した値そのもので判定しているので、再生時に同じ判定を再現できる）
+//  ・ファイルは前の入力からの差分を可変長整数（varint）で詰める。1 入力あたり 3 バイト前後
+//  ・末尾にプレイ時の結果（スコア・最大コンボ・判定数・判定列のダイジェスト）を持ち、
+//    再シミュレーションの結果と突き合わせて改ざん / 非決定性を検出する
+//  ・記録中の入力経路でするのは、確保済みの配列への追記 1 回だけ（符号化は Finish でまとめて行う）
+// ------------------------------------------------------------
+
+constexpr double REPLAY_TIME_UNIT_MS = 0.1;
+constexpr uint32_t REPLAY_VERSION = 2;  // 2 : スコアを符号付き（zigzag）で持つ
+constexpr int REPLAY_JUDGE_KINDS = 6;   // BMSPlayer.h の JudgeResult（P_GREAT〜MISS）
+
+inline int64_t ReplayMsToUnits(double time_ms)
+{
+    return (int64_t)std::llround(time_ms / REPLAY_TIME_UNIT_MS);
+}
+
+inline double ReplayUnitsToMs(int64_t units)
+{
+    return (double)units * REPLAY_TIME_UNIT_MS;
+}
+
+// 記録単位に丸めた時刻（記録 / 再生とも判定にはこの値を使う）
+inline double QuantizeReplayTime(double time_ms)
+{
+    return ReplayUnitsToMs(ReplayMsToUnits(time_ms));
+}
+
+struct ReplayOptions {
+    double judge_offset_ms = 0.0;
+    uint32_t random_seed = 0;       // #RANDOM の分岐に使うシード（パーサが #RANDOM を解釈するまでは記録のみ）
+    bool autoplay = false;
+};
+
+struct ReplayEdge {
+    int64_t time_units;             // REPLAY_TIME_UNIT_MS 単位のゲーム時刻
+    int32_t channel;                // レーンチャンネル（11-19 / 21-29）
+    int32_t down;                   // 1: 押下, 0: 離鍵
+};
+
+struct ReplayResult {
+    int score = 0;
+    int max_combo = 0;
+    int judges[REPLAY_JUDGE_KINDS] = {};
+    uint64_t judge_digest = 0;      // 判定列（種類・チャンネル・時刻差・ノーツ時刻）のハッシュ
+
+    bool operator==(const ReplayResult& o) const;
+    bool operator!=(const ReplayResult& o) const { return !(*this == o); }
+};
+
+struct Replay {
+    uint64_t chart_hash = 0;        // HashContent(譜面ファイルのバイト列)
+    ReplayOptions options;
+    std::vector<ReplayEdge> edges;  // 時刻順
+    int64_t end_time_units = 0;     // 記録終了時のゲーム時刻
+    ReplayResult result;            // 記録時の結果
+};
+
+// 符号化 / 復号（復号は壊れた・切れたデータで false）
+void EncodeReplay(const Replay& replay, std::vector<uint8_t>& out);
+bool DecodeReplay(const uint8_t* data, size_t size, Replay& out);
+
+// ------------------------------------------------------------
+// 記録器（BMSGameApp::Tick が入力を適用する度に Record を呼ぶ）
+// ------------------------------------------------------------
+class ReplayRecorder
+{
+public:
+    /**
+     * 記録を始める（ロード後、プレイ開始前に呼ぶ）
+     * @param expected_edges 予想される入力数（ノーツ数 x 2 程度。プレイ中に伸ばさないよう先に確保する）
+     */
+    void Begin(uint64_t chart_hash, const ReplayOptions& options, size_t expected_edges);
+
+    // 入力 1 件（time_ms は QuantizeReplayTime 済みであること）
+    void Record(double time_ms, int channel, bool down)
+    {
+        if (!active) return;
+        replay.edges.push_back({ ReplayMsToUnits(time_ms), channel, down ? 1 : 0 });
+    }
+
+    /**
+     * 記録を終えて符号化する
+     * @param end_time_ms 最後に進めたゲーム時刻（再生はここまでシミュレーションする）
+     * @param result      プレイ時の結果
+     */
+    void Finish(double end_time_ms, const ReplayResult& result, std::vector<uint8_t>& out);
+
+    bool IsActive() const { return active; }
+    size_t GetEdgeCount() const { return replay.edges.size(); }
+
+private:
+    Replay replay;
+    bool active = false;
+};
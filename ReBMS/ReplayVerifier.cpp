@@ -0,0 +1,151 @@
+#include "ReplayVerifier.h"
+#include "BMSGameApp.h"
+#include "ContentHash.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <memory>
+#include <thread>
+#include <unordered_map>
+
+namespace {
+
+double NowMs()
+{
+    using namespace std::chrono;
+    return duration<double, std::milli>(steady_clock::now().time_since_epoch()).count();
+}
+
+bool ReadFile(const std::string& path, std::vector<char>& out)
+{
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file.is_open()) return false;
+
+    const std::streamoff size = file.tellg();
+    if (size < 0) return false;
+    out.resize((size_t)size);
+    file.seekg(0);
+    return (bool)file.read(out.data(), size);
+}
+
+// 0..count-1 を threads 本のワーカーで処理する（呼び出し元のスレッドもワーカーの 1 本として使う）
+template <typename Fn>
+void ParallelFor(size_t count, int threads, Fn&& fn)
+{
+    std::atomic<size_t> next{ 0 };
+    auto worker = [&]() {
+        for (size_t i = next.fetch_add(1, std::memory_order_relaxed); i < count;
+             i = next.fetch_add(1, std::memory_order_relaxed))
+            fn(i);
+    };
+
+    const int n = (int)std::min<size_t>((size_t)std::max(1, threads), count);
+    std::vector<std::thread> pool;
+    pool.reserve(n > 0 ? n - 1 : 0);
+    for (int t = 1; t < n; ++t) pool.emplace_back(worker);
+    if (n > 0) worker();
+    for (std::thread& t : pool) t.join();
+}
+
+// 読み込み済みの譜面（全ワーカーから読み取りのみ）
+struct ChartEntry {
+    std::vector<char> bytes;
+    uint64_t hash = 0;
+    bool loaded = false;
+};
+
+ReplayCheck VerifyOne(const ChartEntry& chart, const std::string& replay_path)
+{
+    ReplayCheck check;
+    const double start = NowMs();
+
+    std::vector<char> bytes;
+    Replay replay;
+    if (!ReadFile(replay_path, bytes) ||
+        !DecodeReplay(reinterpret_cast<const uint8_t*>(bytes.data()), bytes.size(), replay))
+    {
+        check.verdict = ReplayVerdict::REPLAY_ERROR;
+        check.wall_ms = NowMs() - start;
+        return check;
+    }
+
+    check.expected = replay.result;
+    check.edges = replay.edges.size();
+    check.sim_ms = ReplayUnitsToMs(replay.end_time_units);
+
+    if (!chart.loaded)
+        check.verdict = ReplayVerdict::CHART_ERROR;
+    else if (replay.chart_hash != chart.hash)
+        check.verdict = ReplayVerdict::HASH_MISMATCH;
+    else
+    {
+        // ジョブ毎に新しいインスタンス（ロード直後の状態から再シミュレーションする）
+        // 表示は出さない（ワーカーが同時に std::cout へ書くと、JSON 行の間に混ざる）
+        auto app = std::make_unique<BMSGameApp>(true);
+        app->GetEventLog().SetEnabled(false);
+
+        if (!app->LoadBMSFromMemory(chart.bytes.data(), chart.bytes.size()) ||
+            !app->SimulateReplay(replay, check.actual))
+            check.verdict = ReplayVerdict::CHART_ERROR;
+        else
+            check.verdict = check.actual == check.expected ? ReplayVerdict::MATCH : ReplayVerdict::MISMATCH;
+    }
+
+    check.wall_ms = NowMs() - start;
+    return check;
+}
+
+} // namespace
+
+const char* ReplayVerdictName(ReplayVerdict verdict)
+{
+    switch (verdict)
+    {
+    case ReplayVerdict::MATCH:         return "MATCH";
+    case ReplayVerdict::MISMATCH:      return "MISMATCH";
+    case ReplayVerdict::HASH_MISMATCH: return "HASH_MISMATCH";
+    case ReplayVerdict::CHART_ERROR:   return "CHART_ERROR";
+    case ReplayVerdict::REPLAY_ERROR:  return "REPLAY_ERROR";
+    }
+    return "?";
+}
+
+ReplayVerifier::ReplayVerifier(int thread_count)
+    : thread_count(thread_count > 0 ? thread_count : (int)std::max(1u, std::thread::hardware_concurrency()))
+{
+}
+
+// --------------------------------------------------------
+// Run
+//  1. 参照される譜面を重複なく並列に読み、ハッシュを計算する
+//  2. ジョブを並列に検証する（結果は jobs と同じ位置に書くのでロック不要）
+// --------------------------------------------------------
+std::vector<ReplayCheck> ReplayVerifier::Run(const std::vector<ReplayJob>& jobs) const
+{
+    std::vector<std::string> chart_paths;
+    std::vector<size_t> job_chart(jobs.size());
+    {
+        std::unordered_map<std::string, size_t> index;
+        for (size_t i = 0; i < jobs.size(); ++i)
+        {
+            auto it = index.emplace(jobs[i].chart_path, chart_paths.size()).first;
+            if (it->second == chart_paths.size()) chart_paths.push_back(jobs[i].chart_path);
+            job_chart[i] = it->second;
+        }
+    }
+
+    std::vector<ChartEntry> charts(chart_paths.size());
+    ParallelFor(charts.size(), thread_count, [&](size_t i) {
+        ChartEntry& c = charts[i];
+        c.loaded = ReadFile(chart_paths[i], c.bytes);
+        if (c.loaded) c.hash = HashContent(c.bytes.data(), c.bytes.size());
+    });
+
+    std::vector<ReplayCheck> results(jobs.size());
+    ParallelFor(jobs.size(), thread_count, [&](size_t i) {
+        results[i] = VerifyOne(charts[job_chart[i]], jobs[i].replay_path);
+    });
+    return results;
+}
@@ -0,0 +1,61 @@
+#pragma once
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "Replay.h"
+
+// ------------------------------------------------------------
+// リプレイの一括検証（スコア提出の照合用）
+//  ・(譜面, リプレイ) の組を、スレッド数ぶんのワーカーで並列に再シミュレーションする
+//  ・ジョブ毎に BMSGameApp を 1 つ作って使い捨てる（エンジンの状態はインスタンス毎なので、
+//    ワーカー間で共有するのは読み取り専用の譜面バイト列だけ）
+//  ・同じ譜面を参照するジョブが多い前提で、譜面ファイルは最初に 1 度だけ読み、ハッシュも先に計算する
+//    （ハッシュが合わないリプレイはパース・シミュレーションせずに弾く）
+//  ・ワーカーは次のジョブ番号を atomic に取りに行く（重い譜面が偏っても空くスレッドが出ない）
+// ------------------------------------------------------------
+
+struct ReplayJob {
+    std::string chart_path;
+    std::string replay_path;
+};
+
+enum class ReplayVerdict {
+    MATCH,          // 再シミュレーションの結果が記録と一致
+    MISMATCH,       // 結果が違う（改ざん / 非決定性）
+    HASH_MISMATCH,  // 別の譜面のリプレイ
+    CHART_ERROR,    // 譜面が読めない / パースできない
+    REPLAY_ERROR,   // リプレイが読めない / 壊れている
+};
+constexpr int REPLAY_VERDICT_KINDS = 5;
+
+const char* ReplayVerdictName(ReplayVerdict verdict);
+
+struct ReplayCheck {
+    ReplayVerdict verdict = ReplayVerdict::REPLAY_ERROR;
+    ReplayResult expected;          // リプレイに記録された結果
+    ReplayResult actual;            // 再シミュレーションの結果（MATCH / MISMATCH のときのみ）
+    size_t edges = 0;               // 入力数
+    double sim_ms = 0.0;            // シミュレーションしたゲーム時間
+    double wall_ms = 0.0;           // このジョブにかかった実時間（ロード込み）
+};
+
+class ReplayVerifier
+{
+public:
+    /**
+     * @param thread_count ワーカー数（0 ならハードウェアスレッド数）
+     */
+    explicit ReplayVerifier(int thread_count = 0);
+
+    /**
+     * 全ジョブを検証する
+     * @return jobs と同じ順の結果
+     */
+    std::vector<ReplayCheck> Run(const std::vector<ReplayJob>& jobs) const;
+
+    int GetThreadCount() const { return thread_count; }
+
+private:
+    int thread_count;
+};
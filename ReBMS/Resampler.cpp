@@ -0,0 +1,107 @@
+#include "Resampler.h"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define REBMS_SSE2 1
+#endif
+
+namespace {
+
+constexpr double PI = 3.14159265358979323846;
+constexpr int HALF_TAPS = RESAMPLER_TAPS / 2;
+
+} // namespace
+
+// --------------------------------------------------------
+// 係数表の生成
+//  ・タップ k は素材インデックス floor(pos) - (HALF_TAPS-1) + k に対応
+//  ・Blackman 窓、各位相で DC ゲインを 1 に正規化
+// --------------------------------------------------------
+void PolyphaseKernel::Build(double cutoff)
+{
+    table.assign((size_t)(RESAMPLER_PHASES + 1) * RESAMPLER_TAPS * 2, 0.0f);
+
+    for (int p = 0; p <= RESAMPLER_PHASES; ++p)
+    {
+        const double frac = (double)p / RESAMPLER_PHASES;
+        double coefs[RESAMPLER_TAPS];
+        double sum = 0.0;
+
+        for (int k = 0; k < RESAMPLER_TAPS; ++k)
+        {
+            const double x = (k - (HALF_TAPS - 1)) - frac;   // -4〜+4
+            const double t = x * cutoff;
+            const double sinc = (std::fabs(t) < 1e-9) ? 1.0 : std::sin(PI * t) / (PI * t);
+            const double w = x / HALF_TAPS;
+            const double win = (std::fabs(w) >= 1.0) ? 0.0
+                             : 0.42 + 0.5 * std::cos(PI * w) + 0.08 * std::cos(2.0 * PI * w);
+            coefs[k] = sinc * win;
+            sum += coefs[k];
+        }
+
+        float* dst = table.data() + (size_t)p * RESAMPLER_TAPS * 2;
+        for (int k = 0; k < RESAMPLER_TAPS; ++k)
+        {
+            const float c = (float)(sum != 0.0 ? coefs[k] / sum : 0.0);
+            dst[k * 2]     = c;
+            dst[k * 2 + 1] = c;
+        }
+    }
+}
+
+ResamplerBank::ResamplerBank()
+{
+    for (int i = 0; i < RESAMPLER_KERNEL_COUNT; ++i)
+        kernels[i].Build(0.95 / (1.0 + i * 0.15));
+
+    grain_window.resize(RESAMPLER_GRAIN_FRAMES);
+    for (int n = 0; n < RESAMPLER_GRAIN_FRAMES; ++n)
+        grain_window[n] = (float)(0.5 - 0.5 * std::cos(2.0 * PI * n / RESAMPLER_GRAIN_FRAMES));
+}
+
+const PolyphaseKernel& ResamplerBank::Select(double step) const
+{
+    int i = (step <= 1.0) ? 0 : (int)std::ceil((step - 1.0) / 0.15);
+    return kernels[std::min(i, RESAMPLER_KERNEL_COUNT - 1)];
+}
+
+// --------------------------------------------------------
+// 畳み込み本体
+// --------------------------------------------------------
+void ResampleMix(const PolyphaseKernel& kernel, const float* src, double pos, double step, int count,
+                 const float* window, float gain_l, float gain_r, float* out)
+{
+    for (int i = 0; i < count; ++i, pos += step)
+    {
+        const double base = std::floor(pos);
+        const int phase = (int)((pos - base) * RESAMPLER_PHASES + 0.5);
+        const float* c = kernel.Coefs(phase);
+        const float* s = src + ((int)base - (HALF_TAPS - 1)) * 2;
+        const float w = window ? window[i] : 1.0f;
+
+#ifdef REBMS_SSE2
+        __m128 acc = _mm_mul_ps(_mm_loadu_ps(c), _mm_loadu_ps(s));
+        acc = _mm_add_ps(acc, _mm_mul_ps(_mm_loadu_ps(c + 4),  _mm_loadu_ps(s + 4)));
+        acc = _mm_add_ps(acc, _mm_mul_ps(_mm_loadu_ps(c + 8),  _mm_loadu_ps(s + 8)));
+        acc = _mm_add_ps(acc, _mm_mul_ps(_mm_loadu_ps(c + 12), _mm_loadu_ps(s + 12)));
+        acc = _mm_add_ps(acc, _mm_movehl_ps(acc, acc));      // [L, R, *, *]
+
+        const __m128 g = _mm_setr_ps(gain_l * w, gain_r * w, 0.0f, 0.0f);
+        __m128 o = _mm_castsi128_ps(_mm_loadl_epi64((const __m128i*)(out + i * 2)));
+        o = _mm_add_ps(o, _mm_mul_ps(acc, g));
+        _mm_storel_epi64((__m128i*)(out + i * 2), _mm_castps_si128(o));
+#else
+        float l = 0.0f, r = 0.0f;
+        for (int k = 0; k < RESAMPLER_TAPS; ++k)
+        {
+            l += c[k * 2]     * s[k * 2];
+            r += c[k * 2 + 1] * s[k * 2 + 1];
+        }
+        out[i * 2]     += l * gain_l * w;
+        out[i * 2 + 1] += r * gain_r * w;
+#endif
+    }
+}
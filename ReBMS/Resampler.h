@@ -0,0 +1,68 @@
+#pragma once
+#include <cstddef>
+#include <vector>
+
+// ------------------------------------------------------------
+// ポリフェーズ窓付き sinc リサンプラ（練習モードの再生速度変更用）
+//  ・8 タップ × 256 位相、係数は L/R 分を複製して保持し SSE で 2ch 同時に畳み込む
+//  ・縮小方向（step > 1）ではカットオフを下げた係数表を使い、折り返しを防ぐ
+//  ・音程維持モード用に、グレイン窓を掛けながら加算する版も用意する
+// ------------------------------------------------------------
+
+constexpr int RESAMPLER_TAPS   = 8;
+constexpr int RESAMPLER_PHASES = 256;
+
+// 音程維持モードのグレイン長（出力フレーム）。ホップは半分
+constexpr int RESAMPLER_GRAIN_FRAMES = 2048;
+constexpr int RESAMPLER_GRAIN_HOP    = RESAMPLER_GRAIN_FRAMES / 2;
+
+// 係数表の数（step 1.0〜2.05 を 0.15 刻みでカバー）
+constexpr int RESAMPLER_KERNEL_COUNT = 8;
+
+// 再生速度の範囲（練習モード）
+//  BMSPlayer（独自の Note を持つ）からも使うので、data.h を引かないここに置く
+constexpr double MIN_PLAYBACK_RATE = 0.5;
+constexpr double MAX_PLAYBACK_RATE = 1.5;
+
+// -------------------------------------
+// 係数表（1 つのカットオフ分）
+// -------------------------------------
+class PolyphaseKernel
+{
+public:
+    /**
+     * @param cutoff 元素材のナイキスト周波数に対する比（0〜1）
+     */
+    void Build(double cutoff);
+
+    // 位相 phase（0〜RESAMPLER_PHASES）の係数（TAPS*2 個, L/R 複製）
+    const float* Coefs(int phase) const { return table.data() + (size_t)phase * RESAMPLER_TAPS * 2; }
+
+private:
+    std::vector<float> table;
+};
+
+// -------------------------------------
+// step ごとに適切な係数表を選ぶためのバンク
+// -------------------------------------
+class ResamplerBank
+{
+public:
+    ResamplerBank();
+    const PolyphaseKernel& Select(double step) const;
+
+    // 音程維持モードのグレイン窓（Hann, RESAMPLER_GRAIN_FRAMES 長）
+    const float* GrainWindow() const { return grain_window.data(); }
+
+private:
+    PolyphaseKernel kernels[RESAMPLER_KERNEL_COUNT];
+    std::vector<float> grain_window;
+};
+
+/**
+ * ステレオ素材 src を、位置 pos から step 刻みで count フレーム補間し out に加算する
+ * @param src    ステレオ・インターリーブ。pos-3〜pos+count*step+4 の範囲を含むこと
+ * @param window フレーム毎の重み（nullptr なら 1）
+ */
+void ResampleMix(const PolyphaseKernel& kernel, const float* src, double pos, double step, int count,
+                 const float* window, float gain_l, float gain_r, float* out);
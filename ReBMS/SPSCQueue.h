@@ -0,0 +1,53 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+// ------------------------------------------------------------
+// 単一生産者・単一消費者のロックフリーキュー
+//  ・ゲームスレッド → オーディオコールバックへのコマンド受け渡し用
+//  ・Capacity は 2 の冪であること
+// ------------------------------------------------------------
+template <typename T, size_t Capacity>
+class SPSCQueue
+{
+    static_assert((Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+public:
+    // 生産者側から呼ぶ。満杯なら false
+    bool Push(const T& value)
+    {
+        const size_t tail = tail_index.load(std::memory_order_relaxed);
+        const size_t head = head_index.load(std::memory_order_acquire);
+        if (tail - head >= Capacity)
+            return false;
+
+        buffer[tail & (Capacity - 1)] = value;
+        tail_index.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // 消費者側から呼ぶ。空なら false
+    bool Pop(T& out)
+    {
+        const size_t head = head_index.load(std::memory_order_relaxed);
+        const size_t tail = tail_index.load(std::memory_order_acquire);
+        if (head == tail)
+            return false;
+
+        out = buffer[head & (Capacity - 1)];
+        head_index.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool Empty() const
+    {
+        return head_index.load(std::memory_order_acquire) ==
+               tail_index.load(std::memory_order_acquire);
+    }
+
+private:
+    std::array<T, Capacity> buffer{};
+    alignas(64) std::atomic<size_t> head_index{0};
+    alignas(64) std::atomic<size_t> tail_index{0};
+};
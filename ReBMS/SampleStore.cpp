@@ -0,0 +1,518 @@
+#include "SampleStore.h"
+#include "ContentHash.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define REBMS_SSE2 1
+#endif
+
+// ---------------------------------------------
+// 共有ストアの実体
+// ---------------------------------------------
+SampleStore g_sample_store;
+
+size_t SampleBuffer::ResidentBytes() const
+{
+    return sizeof(SampleBuffer)
+         + pcm.capacity() * sizeof(float)
+         + blocks.capacity() * sizeof(int16_t)
+         + block_scales.capacity() * sizeof(float);
+}
+
+// ---------------------------------------------
+// WAV デコード
+// ---------------------------------------------
+namespace {
+
+uint32_t ReadLE32(const uint8_t* p) { return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24); }
+uint16_t ReadLE16(const uint8_t* p) { return (uint16_t)(p[0] | (p[1] << 8)); }
+
+bool DecodeWAV(const std::vector<uint8_t>& bytes, std::vector<float>& out,
+               int& out_frames, int& out_channels, int& out_rate)
+{
+    if (bytes.size() < 12 || std::memcmp(bytes.data(), "RIFF", 4) != 0 ||
+        std::memcmp(bytes.data() + 8, "WAVE", 4) != 0)
+        return false;
+
+    int format = 0, channels = 0, rate = 0, bits = 0;
+    const uint8_t* data = nullptr;
+    size_t data_size = 0;
+
+    size_t pos = 12;
+    while (pos + 8 <= bytes.size())
+    {
+        const uint8_t* chunk = bytes.data() + pos;
+        size_t size = ReadLE32(chunk + 4);
+        size_t body = pos + 8;
+        size_t avail = std::min(size, bytes.size() - body);
+
+        if (std::memcmp(chunk, "fmt ", 4) == 0 && avail >= 16)
+        {
+            format   = ReadLE16(chunk + 8);
+            channels = ReadLE16(chunk + 10);
+            rate     = (int)ReadLE32(chunk + 12);
+            bits     = ReadLE16(chunk + 22);
+            // WAVE_FORMAT_EXTENSIBLE はサブフォーマットの先頭 2byte を見る
+            if (format == 0xFFFE && avail >= 26)
+                format = ReadLE16(chunk + 32);
+        }
+        else if (std::memcmp(chunk, "data", 4) == 0)
+        {
+            data = bytes.data() + body;
+            data_size = avail;
+        }
+
+        pos = body + size + (size & 1);
+    }
+
+    if (!data || channels <= 0 || rate <= 0) return false;
+    if (!((format == 1 && (bits == 8 || bits == 16 || bits == 24 || bits == 32)) ||
+          (format == 3 && bits == 32)))
+        return false;
+
+    const int bytes_per_sample = bits / 8;
+    const int frames = (int)(data_size / (bytes_per_sample * channels));
+    const int keep_ch = std::min(channels, 2);
+
+    out.resize((size_t)frames * keep_ch);
+    for (int f = 0; f < frames; ++f)
+    {
+        for (int c = 0; c < keep_ch; ++c)
+        {
+            const uint8_t* p = data + ((size_t)f * channels + c) * bytes_per_sample;
+            float v = 0.0f;
+            if (format == 3)
+            {
+                uint32_t u = ReadLE32(p);
+                std::memcpy(&v, &u, 4);
+            }
+            else if (bits == 8)  v = ((int)p[0] - 128) / 128.0f;
+            else if (bits == 16) v = (int16_t)ReadLE16(p) / 32768.0f;
+            else if (bits == 24) v = (int32_t)((p[0] << 8) | (p[1] << 16) | ((uint32_t)p[2] << 24)) / 2147483648.0f;
+            else                 v = (int32_t)ReadLE32(p) / 2147483648.0f;
+            out[(size_t)f * keep_ch + c] = v;
+        }
+    }
+
+    out_frames = frames;
+    out_channels = keep_ch;
+    out_rate = rate;
+    return true;
+}
+
+} // namespace
+
+// ---------------------------------------------
+// BuildBuffer : トリム / モノラル化 / 圧縮（ロック外で実行）
+// ---------------------------------------------
+std::unique_ptr<SampleBuffer> SampleStore::BuildBuffer(const float* interleaved, int frames, int channels,
+                                                       int sample_rate, const SampleStoreOptions& opt) const
+{
+    if (frames < 0 || channels < 1 || channels > 2) return nullptr;
+
+    auto buf = std::make_unique<SampleBuffer>();
+    buf->sample_rate = sample_rate;
+
+    // L == R の素材はモノラルとして保持する（ロスレス）
+    int ch = channels;
+    if (ch == 2)
+    {
+        bool identical = true;
+        for (int f = 0; f < frames && identical; ++f)
+            identical = interleaved[f * 2] == interleaved[f * 2 + 1];
+        if (identical) ch = 1;
+    }
+    buf->channels = ch;
+
+    auto sample_at = [&](int f, int c) { return interleaved[f * channels + c]; };
+
+    // 前後の無音をトリム
+    int first = 0;
+    int last  = frames;
+    if (opt.trim_silence)
+    {
+        auto loud = [&](int f) {
+            for (int c = 0; c < channels; ++c)
+                if (std::fabs(sample_at(f, c)) > opt.silence_threshold) return true;
+            return false;
+        };
+        while (first < frames && !loud(first)) ++first;
+        while (last > first && !loud(last - 1)) --last;
+    }
+    buf->head_offset = first;
+    buf->frames = last - first;
+
+    const size_t values = (size_t)buf->frames * ch;
+
+    if (!opt.compress)
+    {
+        buf->encoding = SampleEncoding::PCM_F32;
+        buf->pcm.resize(values);
+        for (int f = 0; f < buf->frames; ++f)
+            for (int c = 0; c < ch; ++c)
+                buf->pcm[(size_t)f * ch + c] = sample_at(first + f, c);
+    }
+    else
+    {
+        buf->encoding = SampleEncoding::BLOCK_I16;
+        const int block_count = (buf->frames + SAMPLE_BLOCK_FRAMES - 1) / SAMPLE_BLOCK_FRAMES;
+        buf->blocks.resize(values);
+        buf->block_scales.resize(block_count);
+
+        for (int b = 0; b < block_count; ++b)
+        {
+            const int f0 = b * SAMPLE_BLOCK_FRAMES;
+            const int f1 = std::min(f0 + SAMPLE_BLOCK_FRAMES, buf->frames);
+
+            float peak = 0.0f;
+            for (int f = f0; f < f1; ++f)
+                for (int c = 0; c < ch; ++c)
+                    peak = std::max(peak, std::fabs(sample_at(first + f, c)));
+
+            const float scale = peak / 32767.0f;
+            const float inv   = scale > 0.0f ? 1.0f / scale : 0.0f;
+            buf->block_scales[b] = scale;
+
+            for (int f = f0; f < f1; ++f)
+                for (int c = 0; c < ch; ++c)
+                {
+                    long q = std::lrint(sample_at(first + f, c) * inv);
+                    buf->blocks[(size_t)f * ch + c] = (int16_t)std::clamp(q, -32767L, 32767L);
+                }
+        }
+    }
+
+    return buf;
+}
+
+// ---------------------------------------------
+// 登録と参照カウント
+// ---------------------------------------------
+int SampleStore::Register(std::unique_ptr<SampleBuffer> buf)
+{
+    Entry e;
+    e.buffer = std::move(buf);
+    e.ref_count = 1;
+    samples.push_back(std::move(e));
+
+    const int handle = (int)samples.size();
+    if (samples.back().buffer->content_hash != 0)
+        handle_by_hash[samples.back().buffer->content_hash] = handle;
+    return handle;
+}
+
+int SampleStore::AcquireByHashLocked(uint64_t hash)
+{
+    auto it = handle_by_hash.find(hash);
+    if (it == handle_by_hash.end() || !samples[it->second - 1].buffer)
+        return 0;
+
+    ++samples[it->second - 1].ref_count;
+    ++shared_hits;
+    return it->second;
+}
+
+void SampleStore::SetOptions(const SampleStoreOptions& opt)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    options = opt;
+}
+
+SampleStoreOptions SampleStore::GetOptions() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return options;
+}
+
+int SampleStore::AddPCM(const float* interleaved, int frames, int channels, int sample_rate)
+{
+    auto buf = BuildBuffer(interleaved, frames, channels, sample_rate, GetOptions());
+    if (!buf) return 0;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    return Register(std::move(buf));
+}
+
+// ---------------------------------------------
+// LoadWAVFile
+//  1. パスのサイズ・更新時刻が既知なら、ファイルを読まずに共有
+//  2. 内容ハッシュが既知なら、デコードせずに共有
+//  3. どちらでもなければデコードして登録
+// ---------------------------------------------
+int SampleStore::LoadWAVFile(const std::string& path)
+{
+    std::error_code ec;
+    PathStamp stamp;
+    stamp.size = std::filesystem::file_size(path, ec);
+    const bool has_stamp = !ec;
+    if (has_stamp)
+        stamp.mtime = (int64_t)std::filesystem::last_write_time(path, ec).time_since_epoch().count();
+
+    if (has_stamp && !ec)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = stamp_by_path.find(path);
+        if (it != stamp_by_path.end() && it->second.size == stamp.size && it->second.mtime == stamp.mtime)
+        {
+            if (int handle = AcquireByHashLocked(it->second.hash))
+                return handle;
+        }
+    }
+
+    std::ifstream file(path, std::ios::binary);
+    if (file.fail())
+    {
+        std::cerr << "[ERROR] Failed to open WAV file: " << path << std::endl;
+        return 0;
+    }
+
+    std::vector<uint8_t> bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    stamp.hash = HashContent(bytes.data(), bytes.size());
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (has_stamp && !ec)
+            stamp_by_path[path] = stamp;
+        if (int handle = AcquireByHashLocked(stamp.hash))
+            return handle;
+    }
+
+    std::vector<float> pcm;
+    int frames = 0, channels = 0, rate = 0;
+    if (!DecodeWAV(bytes, pcm, frames, channels, rate))
+    {
+        std::cerr << "[ERROR] Unsupported WAV format: " << path << std::endl;
+        return 0;
+    }
+
+    auto buf = BuildBuffer(pcm.data(), frames, channels, rate, GetOptions());
+    if (!buf) return 0;
+    buf->content_hash = stamp.hash;
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    // デコード中に別スレッドが同じ内容を登録していた場合はそちらを使う
+    if (int handle = AcquireByHashLocked(stamp.hash))
+        return handle;
+
+    return Register(std::move(buf));
+}
+
+void SampleStore::Release(int handle)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if (handle <= 0 || handle > (int)samples.size()) return;
+
+    Entry& e = samples[handle - 1];
+    if (e.ref_count > 0 && --e.ref_count == 0)
+        e.last_release = ++release_clock;
+}
+
+size_t SampleStore::PurgeUnreferenced(size_t keep_bytes)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    // 返却が新しい順に並べ、keep_bytes を超えた分を解放する
+    std::vector<int> idle;
+    for (int i = 0; i < (int)samples.size(); ++i)
+        if (samples[i].buffer && samples[i].ref_count == 0)
+            idle.push_back(i);
+
+    std::sort(idle.begin(), idle.end(),
+        [&](int a, int b){ return samples[a].last_release > samples[b].last_release; });
+
+    size_t kept = 0;
+    size_t freed = 0;
+    for (int i : idle)
+    {
+        const size_t bytes = samples[i].buffer->ResidentBytes();
+        if (kept + bytes <= keep_bytes)
+        {
+            kept += bytes;
+            continue;
+        }
+
+        handle_by_hash.erase(samples[i].buffer->content_hash);
+        samples[i].buffer.reset();
+        freed += bytes;
+    }
+    return freed;
+}
+
+const SampleBuffer* SampleStore::Get(int handle) const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if (handle <= 0 || handle > (int)samples.size()) return nullptr;
+    return samples[handle - 1].buffer.get();
+}
+
+size_t SampleStore::GetResidentBytes() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    size_t total = 0;
+    for (const auto& e : samples)
+        if (e.buffer) total += e.buffer->ResidentBytes();
+    return total;
+}
+
+int SampleStore::GetSampleCount() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    int count = 0;
+    for (const auto& e : samples)
+        if (e.buffer) ++count;
+    return count;
+}
+
+int SampleStore::GetSharedHitCount() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return shared_hits;
+}
+
+void SampleStore::Clear()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    samples.clear();
+    handle_by_hash.clear();
+    stamp_by_path.clear();
+    shared_hits = 0;
+}
+
+// ---------------------------------------------
+// ミキシングカーネル
+//  ・out はステレオ・インターリーブ
+//  ・BLOCK_I16 はスケールを gain に畳み込んで 1 乗算で済ませる
+// ---------------------------------------------
+namespace {
+
+void MixF32Stereo(const float* src, int frames, float gl, float gr, float* out)
+{
+    int i = 0;
+    const int n = frames * 2;
+#ifdef REBMS_SSE2
+    const __m128 g = _mm_setr_ps(gl, gr, gl, gr);
+    for (; i + 4 <= n; i += 4)
+        _mm_storeu_ps(out + i, _mm_add_ps(_mm_loadu_ps(out + i), _mm_mul_ps(_mm_loadu_ps(src + i), g)));
+#endif
+    for (; i < n; i += 2)
+    {
+        out[i]     += src[i]     * gl;
+        out[i + 1] += src[i + 1] * gr;
+    }
+}
+
+void MixF32Mono(const float* src, int frames, float gl, float gr, float* out)
+{
+    int i = 0;
+#ifdef REBMS_SSE2
+    const __m128 g = _mm_setr_ps(gl, gr, gl, gr);
+    for (; i + 4 <= frames; i += 4)
+    {
+        __m128 s = _mm_loadu_ps(src + i);
+        float* o = out + i * 2;
+        _mm_storeu_ps(o,     _mm_add_ps(_mm_loadu_ps(o),     _mm_mul_ps(_mm_unpacklo_ps(s, s), g)));
+        _mm_storeu_ps(o + 4, _mm_add_ps(_mm_loadu_ps(o + 4), _mm_mul_ps(_mm_unpackhi_ps(s, s), g)));
+    }
+#endif
+    for (; i < frames; ++i)
+    {
+        out[i * 2]     += src[i] * gl;
+        out[i * 2 + 1] += src[i] * gr;
+    }
+}
+
+void MixI16Stereo(const int16_t* src, int frames, float gl, float gr, float* out)
+{
+    int i = 0;
+    const int n = frames * 2;
+#ifdef REBMS_SSE2
+    const __m128 g = _mm_setr_ps(gl, gr, gl, gr);
+    for (; i + 8 <= n; i += 8)
+    {
+        __m128i s  = _mm_loadu_si128((const __m128i*)(src + i));
+        __m128  lo = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(s, s), 16));
+        __m128  hi = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(s, s), 16));
+        _mm_storeu_ps(out + i,     _mm_add_ps(_mm_loadu_ps(out + i),     _mm_mul_ps(lo, g)));
+        _mm_storeu_ps(out + i + 4, _mm_add_ps(_mm_loadu_ps(out + i + 4), _mm_mul_ps(hi, g)));
+    }
+#endif
+    for (; i < n; i += 2)
+    {
+        out[i]     += src[i]     * gl;
+        out[i + 1] += src[i + 1] * gr;
+    }
+}
+
+void MixI16Mono(const int16_t* src, int frames, float gl, float gr, float* out)
+{
+    int i = 0;
+#ifdef REBMS_SSE2
+    const __m128 g = _mm_setr_ps(gl, gr, gl, gr);
+    for (; i + 4 <= frames; i += 4)
+    {
+        __m128i s = _mm_loadl_epi64((const __m128i*)(src + i));
+        __m128  f = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(s, s), 16));
+        float*  o = out + i * 2;
+        _mm_storeu_ps(o,     _mm_add_ps(_mm_loadu_ps(o),     _mm_mul_ps(_mm_unpacklo_ps(f, f), g)));
+        _mm_storeu_ps(o + 4, _mm_add_ps(_mm_loadu_ps(o + 4), _mm_mul_ps(_mm_unpackhi_ps(f, f), g)));
+    }
+#endif
+    for (; i < frames; ++i)
+    {
+        out[i * 2]     += src[i] * gl;
+        out[i * 2 + 1] += src[i] * gr;
+    }
+}
+
+} // namespace
+
+void MixSampleFrames(const SampleBuffer& buf, int start_frame, int count,
+                     float gain_l, float gain_r, float* out)
+{
+    if (start_frame < 0 || count <= 0 || start_frame + count > buf.frames) return;
+
+    const int ch = buf.channels;
+
+    if (buf.encoding == SampleEncoding::PCM_F32)
+    {
+        const float* src = buf.pcm.data() + (size_t)start_frame * ch;
+        if (ch == 2) MixF32Stereo(src, count, gain_l, gain_r, out);
+        else         MixF32Mono(src, count, gain_l, gain_r, out);
+        return;
+    }
+
+    // BLOCK_I16 : ブロック境界で区切りながらスケールを切り替える
+    int f = start_frame;
+    const int end = start_frame + count;
+    while (f < end)
+    {
+        const int b = f / SAMPLE_BLOCK_FRAMES;
+        const int seg_end = std::min(end, (b + 1) * SAMPLE_BLOCK_FRAMES);
+        const int n = seg_end - f;
+        const float s = buf.block_scales[b];
+        const int16_t* src = buf.blocks.data() + (size_t)f * ch;
+
+        if (s != 0.0f)
+        {
+            if (ch == 2) MixI16Stereo(src, n, gain_l * s, gain_r * s, out);
+            else         MixI16Mono(src, n, gain_l * s, gain_r * s, out);
+        }
+
+        out += n * 2;
+        f = seg_end;
+    }
+}
+
+void DecodeSampleFrames(const SampleBuffer& buf, int start_frame, int count, float* out)
+{
+    std::fill(out, out + (size_t)count * 2, 0.0f);
+    MixSampleFrames(buf, start_frame, count, 1.0f, 1.0f, out);
+}
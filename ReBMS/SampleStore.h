@@ -0,0 +1,146 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// ------------------------------------------------------------
+// キー音サンプルストア
+//  ・WAV をデコードし、前後の無音をトリムして保持する
+//  ・任意で 16bit ブロック浮動小数点形式に圧縮して保持する
+//  ・ミキサーは MixSampleFrames で直接デコードしながら加算する
+//  ・ファイル内容のハッシュで重複を排除し、同じ素材は 1 バッファを共有する
+//    （同じフォルダの別難易度や、同一チャート内の重複 #WAV 定義）
+// ------------------------------------------------------------
+
+// ミキサー出力フォーマット
+constexpr int MIX_SAMPLE_RATE = 44100;
+constexpr int MIX_CHANNELS    = 2;
+
+// 圧縮ブロックあたりのフレーム数
+constexpr int SAMPLE_BLOCK_FRAMES = 64;
+
+// サンプルの保持形式
+enum class SampleEncoding {
+    PCM_F32,    // 32bit float（無圧縮）
+    BLOCK_I16   // ブロック毎スケール + 16bit 整数（ほぼロスレス）
+};
+
+// -------------------------------------
+// デコード済み（またはブロック圧縮済み）サンプル
+// -------------------------------------
+struct SampleBuffer {
+    SampleEncoding encoding = SampleEncoding::PCM_F32;
+    int channels = 2;          // 1: モノラル（L==R の素材は自動でモノラル化）, 2: ステレオ
+    int sample_rate = MIX_SAMPLE_RATE;
+    int frames = 0;            // トリム後のフレーム数
+    int head_offset = 0;       // 先頭でトリムした無音フレーム数（発音タイミング維持用）
+    uint64_t content_hash = 0; // 元ファイル内容のハッシュ（AddPCM 直接登録時は 0）
+
+    std::vector<float>   pcm;          // PCM_F32 : インターリーブ
+    std::vector<int16_t> blocks;       // BLOCK_I16 : インターリーブ
+    std::vector<float>   block_scales; // BLOCK_I16 : ブロック毎のスケール
+
+    // 常駐メモリ量（バイト）
+    size_t ResidentBytes() const;
+};
+
+// -------------------------------------
+// ロード設定
+// -------------------------------------
+struct SampleStoreOptions {
+    bool  trim_silence      = true;
+    float silence_threshold = 1.0f / 4096.0f; // 約 -72dBFS
+    bool  compress          = false;          // BLOCK_I16 で保持するか
+};
+
+// -------------------------------------
+// サンプルストア本体
+//  ・ハンドルは 1 以上（0 はロード失敗）
+//  ・返したポインタは Release 後に PurgeUnreferenced されるまで有効
+//  ・全メソッドはスレッドセーフ（デコードはロック外で行う）
+// -------------------------------------
+class SampleStore
+{
+public:
+    void SetOptions(const SampleStoreOptions& opt);
+    SampleStoreOptions GetOptions() const;
+
+    // インターリーブ float PCM から登録する（重複排除なし）
+    int AddPCM(const float* interleaved, int frames, int channels, int sample_rate);
+
+    /**
+     * WAV ファイル（PCM 8/16/24/32bit, float32）をロードする
+     * 同じ内容のファイルが既にあれば、デコードせずに既存ハンドルを返す
+     * 呼び出し毎に参照カウントが 1 増える
+     */
+    int LoadWAVFile(const std::string& path);
+
+    /**
+     * LoadWAVFile / AddPCM で得た参照を 1 つ返却する
+     */
+    void Release(int handle);
+
+    /**
+     * 参照されていないサンプルを、最後に返却されたものが新しい順に
+     * keep_bytes まで残して解放する（曲選択に戻った時などに呼ぶ）
+     * @return 解放したバイト数
+     */
+    size_t PurgeUnreferenced(size_t keep_bytes = 0);
+
+    const SampleBuffer* Get(int handle) const;
+
+    // 全サンプルの常駐メモリ量（バイト）
+    size_t GetResidentBytes() const;
+
+    // 常駐しているサンプル数 / 内容一致で共有できたロード回数
+    int GetSampleCount() const;
+    int GetSharedHitCount() const;
+
+    void Clear();
+
+private:
+    struct Entry {
+        std::unique_ptr<SampleBuffer> buffer;
+        int ref_count = 0;
+        uint64_t last_release = 0;
+    };
+
+    // パス → 内容ハッシュの対応（サイズと更新時刻が一致すれば再読込しない）
+    struct PathStamp {
+        uintmax_t size = 0;
+        int64_t mtime = 0;
+        uint64_t hash = 0;
+    };
+
+    std::unique_ptr<SampleBuffer> BuildBuffer(const float* interleaved, int frames, int channels,
+                                              int sample_rate, const SampleStoreOptions& opt) const;
+    int Register(std::unique_ptr<SampleBuffer> buf);
+    int AcquireByHashLocked(uint64_t hash);
+
+    mutable std::mutex mutex;
+    SampleStoreOptions options;
+    std::vector<Entry> samples;
+    std::unordered_map<uint64_t, int> handle_by_hash;
+    std::unordered_map<std::string, PathStamp> stamp_by_path;
+    uint64_t release_clock = 0;
+    int shared_hits = 0;
+};
+
+// -------------------------------------
+// ミキサー用カーネル
+// -------------------------------------
+
+// buf の [start_frame, start_frame + count) を out（ステレオ・インターリーブ）へ加算する
+void MixSampleFrames(const SampleBuffer& buf, int start_frame, int count,
+                     float gain_l, float gain_r, float* out);
+
+// buf の [start_frame, start_frame + count) をステレオ float にデコードする
+void DecodeSampleFrames(const SampleBuffer& buf, int start_frame, int count, float* out);
+
+// -------------------------------------
+// プロセス共通の共有ストア（Parser.cpp の LoadBMSResources から使用）
+// -------------------------------------
+extern SampleStore g_sample_store;
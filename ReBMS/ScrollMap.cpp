@@ -0,0 +1,102 @@
+#include "ScrollMap.h"
+
+#include <algorithm>
+
+// --------------------------------------------------------
+// Build : イベントを時刻順にたどって区間を切る
+// --------------------------------------------------------
+void ScrollMap::Build(const BMSData& data)
+{
+    segments.clear();
+    speeds.clear();
+    base_bpm = data.initial_bpm > 0.0 ? data.initial_bpm : 120.0;
+
+    double bpm = base_bpm;
+    double scroll = 1.0;
+    segments.push_back({ 0.0, 0.0, bpm / 60000.0, bpm });
+
+    // 直前の区間を time_ms まで進めて新しい区間を積む
+    auto push = [this](double time_ms, double velocity, double seg_bpm) {
+        const Segment& last = segments.back();
+        const double t = std::max(time_ms, last.time_ms);
+        const double pos = last.position + (t - last.time_ms) * last.velocity;
+
+        if (segments.back().time_ms == t) segments.pop_back();
+        segments.push_back({ t, pos, velocity, seg_bpm });
+    };
+
+    for (const auto& n : data.notes)
+    {
+        if (n.channel == 0x03)
+        {
+            auto it = data.bpm_table.find(n.def_id);
+            if (it == data.bpm_table.end() || it->second <= 0.0) continue;
+
+            bpm = it->second;
+            push(n.time_ms, bpm / 60000.0 * scroll, bpm);
+        }
+        else if (n.channel == CHANNEL_SCROLL)
+        {
+            auto it = data.scroll_table.find(n.def_id);
+            if (it == data.scroll_table.end()) continue;
+
+            scroll = std::max(0.0, it->second);
+            push(n.time_ms, bpm / 60000.0 * scroll, bpm);
+        }
+        else if (n.channel == 0x08)
+        {
+            auto it = data.stop_table.find(n.def_id);
+            if (it == data.stop_table.end() || it->second <= 0.0) continue;
+
+            // Parser と同じく停止量は拍数として扱う
+            const double stop_ms = it->second * (60000.0 / bpm);
+            push(n.time_ms, 0.0, bpm);
+            push(n.time_ms + stop_ms, bpm / 60000.0 * scroll, bpm);
+        }
+        else if (n.channel == CHANNEL_SPEED)
+        {
+            auto it = data.speed_table.find(n.def_id);
+            if (it == data.speed_table.end()) continue;
+
+            speeds.push_back({ n.time_ms, it->second });
+        }
+    }
+}
+
+// 時刻を含む区間（先頭より前は先頭区間）
+const ScrollMap::Segment& ScrollMap::SegmentAt(double time_ms) const
+{
+    auto it = std::upper_bound(segments.begin(), segments.end(), time_ms,
+        [](double t, const Segment& s){ return t < s.time_ms; });
+    return it == segments.begin() ? segments.front() : *(it - 1);
+}
+
+double ScrollMap::PositionAt(double time_ms) const
+{
+    if (segments.empty()) return time_ms * base_bpm / 60000.0;
+
+    const Segment& s = SegmentAt(time_ms);
+    return s.position + (time_ms - s.time_ms) * s.velocity;
+}
+
+double ScrollMap::BPMAt(double time_ms) const
+{
+    return segments.empty() ? base_bpm : SegmentAt(time_ms).bpm;
+}
+
+double ScrollMap::SpeedAt(double time_ms) const
+{
+    if (speeds.empty()) return 1.0;
+
+    auto it = std::upper_bound(speeds.begin(), speeds.end(), time_ms,
+        [](double t, const SpeedPoint& p){ return t < p.time_ms; });
+
+    if (it == speeds.begin()) return 1.0;
+    if (it == speeds.end())   return speeds.back().speed;
+
+    // 前の指定点から次の指定点へ線形に変化させる
+    const SpeedPoint& a = *(it - 1);
+    const SpeedPoint& b = *it;
+    const double u = (time_ms - a.time_ms) / (b.time_ms - a.time_ms);
+    return a.speed + (b.speed - a.speed) * u;
+}
@@ -0,0 +1,58 @@
+#pragma once
+#include <vector>
+#include "data.h"
+
+// ------------------------------------------------------------
+// スクロール位置テーブル
+//  ・BPM 変化 / STOP / #SCROLL から「拍単位の累積スクロール位置」を
+//    区間ごとに事前計算し、任意時刻の位置を二分探索 + 1 次式で求める
+//  ・ノーツの位置はロード時に一度だけ引いておき、描画時は
+//      y = 判定ライン - (ノーツ位置 - 現在位置) * 倍率
+//    の引き算 1 回で決まる
+//  ・#SPEED は現在時刻に対する表示倍率（画面全体が伸縮する）で、
+//    指定点の間を時間で線形補間する
+//  ・時間軸は Parser が計算した time_ms（STOP の扱いも Parser と同じ）
+//  ・負の SCROLL は 0 として扱う（位置は時刻に対して単調非減少）
+// ------------------------------------------------------------
+
+class ScrollMap
+{
+public:
+    /**
+     * テンポマップを構築する（data.notes は Parser 出力の時刻順であること）
+     * 何も出力しない（一括検証のワーカースレッドからも呼ばれる）。区間数は GetSegmentCount で取る
+     */
+    void Build(const BMSData& data);
+
+    // 時刻 → 累積スクロール位置（拍）
+    double PositionAt(double time_ms) const;
+
+    // 時刻 → その時点の BPM（STOP 中も直前の BPM）
+    double BPMAt(double time_ms) const;
+
+    // 時刻 → #SPEED 倍率
+    double SpeedAt(double time_ms) const;
+
+    double GetBaseBPM() const { return base_bpm; }
+    int GetSegmentCount() const { return (int)segments.size(); }
+
+private:
+    // time_ms から次の区間までは position + (t - time_ms) * velocity
+    struct Segment {
+        double time_ms;
+        double position;    // 拍
+        double velocity;    // 拍 / ms（STOP 中は 0、SCROLL 倍率込み）
+        double bpm;
+    };
+
+    struct SpeedPoint {
+        double time_ms;
+        double speed;
+    };
+
+    const Segment& SegmentAt(double time_ms) const;
+
+    std::vector<Segment> segments;     // time_ms 昇順
+    std::vector<SpeedPoint> speeds;    // time_ms 昇順（空なら常に 1.0）
+    double base_bpm = 120.0;
+};
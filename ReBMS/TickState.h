@@ -0,0 +1,69 @@
+#pragma once
+#include <cstdint>
+
+// ------------------------------------------------------------
+// 1 フレーム 1 回の tick API で受け渡す固定レイアウトのブロック
+//  ・入力 : JS が WASM ヒープ上の TickInputEvent 配列に押下 / 離鍵を時刻付きで書き、
+//           tick(time_ms, ptr, count) を 1 回呼ぶ
+//  ・出力 : tick の中で TickState を埋める。JS は同じメモリを
+//           Int32Array / Float32Array の 2 つのビューで読む（全フィールド 4 バイト）
+//  ・判定イベントは前回の tick 以降の分だけが入る（溢れた分は数だけ数える）
+// ------------------------------------------------------------
+
+constexpr int TICK_MAX_INPUT_EVENTS = 64;
+constexpr int TICK_MAX_JUDGE_EVENTS = 64;
+
+// 入力 1 件（16 バイト。JS 側は Float64Array[k*2] に時刻、Int32Array[k*4+2..3] にチャンネル / 押下）
+struct TickInputEvent {
+    double time_ms;     // 押した / 離したときのゲーム時刻
+    int32_t channel;    // レーンチャンネル（11-19 / 21-29）
+    int32_t down;       // 1: 押下, 0: 離鍵
+};
+
+// 判定 1 件（16 バイト）
+struct TickJudgeEvent {
+    int32_t result;     // JudgeResult の値（BMSPlayer.h）
+    int32_t channel;
+    float diff_ms;      // ノーツ時刻 - 押した時刻（正なら早押し = FAST）。MISS は 0
+    float time_ms;      // ノーツ時刻
+};
+
+enum TickStateField {
+    TICK_FRAME = 0,             // tick の呼び出し回数
+    TICK_SCORE,
+    TICK_COMBO,
+    TICK_MAX_COMBO,
+    TICK_GAUGE,                 // float : 0〜100（%）
+    TICK_BGA_ID,
+    TICK_LAYER_ID,              // 先頭レイヤーの BMP ID（0 で非表示）
+    TICK_VISIBLE_NOTES,         // RenderViews の有効件数
+    TICK_INPUTS_APPLIED,        // 今回適用した入力数
+    TICK_JUDGE_COUNT,           // 今回の判定イベント数
+    TICK_JUDGE_DROPPED,         // 溢れて捨てた判定イベント数
+    TICK_RESERVED,
+    TICK_HEADER_FIELDS          // 判定イベントの開始位置（4 バイト単位）
+};
+
+constexpr int TICK_JUDGE_STRIDE = 4;   // 判定 1 件の 4 バイト単位の大きさ
+
+struct TickState {
+    int32_t frame = 0;
+    int32_t score = 0;
+    int32_t combo = 0;
+    int32_t max_combo = 0;
+    float gauge = 0.0f;
+    int32_t bga_id = 0;
+    int32_t layer_id = 0;
+    int32_t visible_notes = 0;
+    int32_t inputs_applied = 0;
+    int32_t judge_count = 0;
+    int32_t judge_dropped = 0;
+    int32_t reserved = 0;       // 判定イベントを 16 バイト境界に揃える
+    TickJudgeEvent judges[TICK_MAX_JUDGE_EVENTS] = {};
+};
+
+static_assert(sizeof(TickInputEvent) == 16, "TickInputEvent must stay packed");
+static_assert(sizeof(TickJudgeEvent) == 16, "TickJudgeEvent must stay packed");
+static_assert(sizeof(TickState) % 4 == 0, "TickState is read as 4-byte words");
+static_assert(sizeof(TickState) == (TICK_HEADER_FIELDS + TICK_MAX_JUDGE_EVENTS * TICK_JUDGE_STRIDE) * 4,
+              "TickStateField must match the TickState layout");
@@ -0,0 +1,418 @@
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <ostream>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+#include "data.h"
+#include "Judge.h"
+#include "Renderer.h"
+#include "ScrollMap.h"
+#include "SampleStore.h"
+#include "AudioMixer.h"
+#include "LaneKeysounds.h"
+#include "EventLog.h"
+
+// ------------------------------------------------------------
+// ゲームループの確保ゼロ検査
+//  ・グローバルの operator new / delete を差し替えて確保回数を数える
+//  ・合成した譜面（通常ノーツ + LN + BGM + BPM 変化）をロードした後、
+//    1 曲分を 60Hz のフレーム刻みで通しプレイする
+//    （打鍵 → 判定 → キー音、見逃し、LN 終端、描画リスト生成、ミックス）
+//  ・ロード後のプレイ区間で 1 回でもヒープ確保 / 解放があれば失敗（終了コード 1）
+//  ・イベントログの整形（Flush）もデバッグ表示の頻度でループ内から呼び、計測に含める
+//  使い方 : alloc_check [measures]
+// ------------------------------------------------------------
+
+namespace {
+
+std::atomic<bool> g_armed{false};
+std::atomic<size_t> g_alloc_count{0};
+std::atomic<size_t> g_alloc_bytes{0};
+std::atomic<size_t> g_free_count{0};
+std::atomic<size_t> g_first_alloc_size{0};
+
+void CountAlloc(size_t size)
+{
+    if (!g_armed.load(std::memory_order_relaxed)) return;
+    if (g_alloc_count.fetch_add(1, std::memory_order_relaxed) == 0)
+        g_first_alloc_size.store(size, std::memory_order_relaxed);
+    g_alloc_bytes.fetch_add(size, std::memory_order_relaxed);
+}
+
+void CountFree(void* p)
+{
+    if (p && g_armed.load(std::memory_order_relaxed))
+        g_free_count.fetch_add(1, std::memory_order_relaxed);
+}
+
+void* AlignedAlloc(size_t size, size_t align)
+{
+#if defined(_MSC_VER)
+    return _aligned_malloc(size ? size : 1, align);
+#else
+    void* p = nullptr;
+    return posix_memalign(&p, std::max(align, sizeof(void*)), size ? size : 1) == 0 ? p : nullptr;
+#endif
+}
+
+void AlignedFree(void* p)
+{
+#if defined(_MSC_VER)
+    _aligned_free(p);
+#else
+    std::free(p);
+#endif
+}
+
+} // namespace
+
+// --------------------------------------------------------
+// 確保の差し替え（すべて malloc / free に流し、計測中だけ数える）
+// --------------------------------------------------------
+void* operator new(size_t size)
+{
+    CountAlloc(size);
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+
+void* operator new[](size_t size) { return operator new(size); }
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept
+{
+    CountAlloc(size);
+    return std::malloc(size ? size : 1);
+}
+
+void* operator new[](size_t size, const std::nothrow_t& tag) noexcept { return operator new(size, tag); }
+
+void* operator new(size_t size, std::align_val_t align)
+{
+    CountAlloc(size);
+    if (void* p = AlignedAlloc(size, (size_t)align)) return p;
+    throw std::bad_alloc();
+}
+
+void* operator new[](size_t size, std::align_val_t align) { return operator new(size, align); }
+
+// 上の operator new はすべて malloc / AlignedAlloc で確保しているので free で対になる
+// GCC は operator new が malloc 由来だと見なさず、インライン展開した先で
+// -Wmismatched-new-delete を出すため、差し替えの定義に限って抑止する
+#if defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 11
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+void operator delete(void* p) noexcept { CountFree(p); std::free(p); }
+void operator delete[](void* p) noexcept { CountFree(p); std::free(p); }
+void operator delete(void* p, size_t) noexcept { CountFree(p); std::free(p); }
+void operator delete[](void* p, size_t) noexcept { CountFree(p); std::free(p); }
+void operator delete(void* p, std::align_val_t) noexcept { CountFree(p); AlignedFree(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { CountFree(p); AlignedFree(p); }
+void operator delete(void* p, size_t, std::align_val_t) noexcept { CountFree(p); AlignedFree(p); }
+void operator delete[](void* p, size_t, std::align_val_t) noexcept { CountFree(p); AlignedFree(p); }
+#if defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 11
+#pragma GCC diagnostic pop
+#endif
+
+namespace {
+
+constexpr double FRAME_MS = 1000.0 / 60.0;
+constexpr int LANES[] = { 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x18, 0x19 };
+constexpr int LANE_COUNT = (int)(sizeof(LANES) / sizeof(LANES[0]));
+constexpr int FLUSH_FRAMES = 60;
+
+// 再現性のある乱数（xorshift）
+struct Random {
+    uint32_t state = 0x12345678u;
+    uint32_t Next() { state ^= state << 13; state ^= state >> 17; state ^= state << 5; return state; }
+    int Range(int n) { return (int)(Next() % (uint32_t)n); }
+};
+
+// 計測対象外の出力先（Flush の整形は行うが捨てる）
+class NullBuffer : public std::streambuf {
+protected:
+    int overflow(int c) override { return c; }
+    std::streamsize xsputn(const char*, std::streamsize n) override { return n; }
+};
+
+const char* IdOf(int n)
+{
+    static const char* ids[] = { "01", "02", "03", "04", "05", "06", "07", "08" };
+    return ids[n % 8];
+}
+
+// --------------------------------------------------------
+// 合成譜面 : 16 分の密度が小節毎に変わる 8 レーン譜面
+// 4 小節毎に BPM 変化、1 割程度を LN にする
+// --------------------------------------------------------
+BMSData MakeChart(int measures)
+{
+    BMSData data;
+    data.title = "alloc_check";
+    data.initial_bpm = 150.0;
+
+    Random rng;
+    double t = 0.0;
+    double bpm = data.initial_bpm;
+    double lane_free_at[LANE_COUNT] = {};
+
+    for (int m = 0; m < measures; ++m)
+    {
+        if (m > 0 && m % 4 == 0)
+        {
+            bpm = 120.0 + rng.Range(100);
+            Note n;
+            n.time_ms = t;
+            n.measure = m;
+            n.channel = 0x03;
+            n.def_id = std::to_string((int)bpm);
+            data.bpm_table[n.def_id] = bpm;
+            data.notes.push_back(n);
+        }
+
+        const double step = 60000.0 / bpm / 4.0;
+        const int density = 2 + rng.Range(5);
+
+        for (int s = 0; s < 16; ++s)
+        {
+            const double nt = t + step * s;
+
+            Note bgm;
+            bgm.time_ms = nt;
+            bgm.measure = m;
+            bgm.pos_raw = s / 16.0;
+            bgm.channel = 0x01;
+            bgm.wav_id = IdOf(s);
+            if (s % 4 == 0) data.notes.push_back(bgm);
+
+            for (int k = 0; k < density / 2 + (s % 2 == 0 ? 1 : 0); ++k)
+            {
+                const int lane = rng.Range(LANE_COUNT);
+                if (lane_free_at[lane] > nt) continue;
+
+                Note n;
+                n.time_ms = nt;
+                n.measure = m;
+                n.pos_raw = s / 16.0;
+                n.wav_id = IdOf(lane + s);
+
+                if (rng.Range(10) == 0)
+                {
+                    n.channel = LANES[lane] + 0x40;
+                    n.end_time_ms = nt + step * (2 + rng.Range(8));
+                    n.end_measure = m;
+                }
+                else
+                {
+                    n.channel = LANES[lane];
+                }
+                lane_free_at[lane] = std::max(nt, n.end_time_ms) + step;
+                data.notes.push_back(n);
+            }
+        }
+        t += step * 16;
+    }
+
+    std::stable_sort(data.notes.begin(), data.notes.end(),
+        [](const Note& a, const Note& b){ return a.time_ms < b.time_ms; });
+    return data;
+}
+
+bool IsPlayable(int channel)
+{
+    return LaneKeysounds::LaneIndex(channel) >= 0;
+}
+
+bool IsLNChannel(int channel)
+{
+    return channel >= 0x51 && channel <= 0x59;
+}
+
+// プレイヤーの操作 1 件
+struct KeyAction {
+    double time_ms;
+    int channel;
+    bool press;
+};
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    const int measures = argc > 1 ? std::max(1, std::atoi(argv[1])) : 400;
+
+    // -----------------------------
+    // ロード（ここでは確保してよい）
+    // -----------------------------
+    BMSData chart = MakeChart(measures);
+
+    // キー音 : 短いサイン波を 8 種
+    SampleStore store;
+    for (int i = 0; i < 8; ++i)
+    {
+        std::vector<float> pcm((size_t)2000 * MIX_CHANNELS);
+        for (size_t f = 0; f < pcm.size() / MIX_CHANNELS; ++f)
+            pcm[f * 2] = pcm[f * 2 + 1] = 0.25f * (float)std::sin(f * 0.02 * (i + 1));
+        chart.loaded_wavs[IdOf(i)] = store.AddPCM(pcm.data(), 2000, MIX_CHANNELS, MIX_SAMPLE_RATE);
+    }
+
+    ScrollMap scroll;
+    scroll.Build(chart);
+
+    RenderListBuilder builder;
+    builder.Reset(chart.notes, &scroll);
+    std::vector<DrawNote> draw_list;
+    draw_list.reserve(chart.notes.size());   // ピーク時の表示数で伸びないよう上限まで確保しておく
+
+    AudioMixer mixer;
+    LaneKeysounds keysounds(mixer);
+    keysounds.Load(chart, store);
+    keysounds.SetWindowMs(JUDGE_GOOD_MS);
+
+    // 判定用（判定で消費される）はプレイ可能なノーツのみ
+    BMSData judge_data;
+    judge_data.notes.reserve(chart.notes.size());
+    for (const Note& n : chart.notes)
+        if (IsPlayable(n.channel)) judge_data.notes.push_back(n);
+
+    // 判定の状態とログ
+    EventLog event_log;
+    JudgeContext judge;
+    judge.event_log = &event_log;
+
+    // 打鍵スケジュール : ±40ms でばらつかせ、5% は見逃す / LN の 2 割は早離し
+    std::vector<KeyAction> actions;
+    actions.reserve(judge_data.notes.size() * 2);
+    Random rng;
+    rng.state = 0x9E3779B9u;
+    for (const Note& n : judge_data.notes)
+    {
+        if (rng.Range(20) == 0) continue;
+        const double hit = n.time_ms + rng.Range(81) - 40;
+        double release = hit + 40.0;
+        if (n.end_time_ms > n.time_ms)
+            release = rng.Range(5) == 0 ? (hit + n.end_time_ms) * 0.5 : n.end_time_ms + 10.0;
+        actions.push_back({ hit, n.channel, true });
+        actions.push_back({ release, n.channel, false });
+    }
+    std::stable_sort(actions.begin(), actions.end(),
+        [](const KeyAction& a, const KeyAction& b){ return a.time_ms < b.time_ms; });
+
+    std::vector<const Note*> bgm;
+    for (const Note& n : chart.notes)
+        if (n.channel == 0x01) bgm.push_back(&n);
+
+    const int mix_frames = (int)std::ceil(MIX_SAMPLE_RATE / 60.0);
+    std::vector<float> mix_buffer((size_t)mix_frames * MIX_CHANNELS);
+
+    // 通しプレイは -1000ms をストリームフレーム 0 として回す。打鍵音は 1 ブロック後の同じ位置から鳴る
+    keysounds.SetStreamTiming(MIX_SAMPLE_RATE, 1.0, mix_frames);
+
+    NullBuffer null_buffer;
+    std::ostream null_out(&null_buffer);
+
+    const double end_time = chart.notes.empty() ? 0.0
+        : std::max(chart.notes.back().time_ms, chart.notes.back().end_time_ms) + 2000.0;
+
+    // -----------------------------
+    // 通しプレイ（最初の 1 秒は暖機として計測しない）
+    // -----------------------------
+    size_t action_cursor = 0;
+    size_t bgm_cursor = 0;
+    int judged = 0;
+    int frames = 0;
+    size_t peak_draw = 0;
+
+    for (double now = -1000.0; now < end_time; now += FRAME_MS, ++frames)
+    {
+        g_armed.store(now >= 0.0, std::memory_order_relaxed);
+
+        // デバッグ表示の頻度でログを整形する
+        if (frames % FLUSH_FRAMES == 0) event_log.Flush(null_out);
+
+        // 入力（KeyDown / KeyUp）
+        for (; action_cursor < actions.size() && actions[action_cursor].time_ms <= now; ++action_cursor)
+        {
+            const KeyAction& a = actions[action_cursor];
+            judge.SetKeyPressed(a.channel, a.press);
+
+            if (a.press)
+            {
+                keysounds.Trigger(a.channel, now, a.time_ms);
+                const JudgeResult r = JudgeKeyHit(judge_data, a.channel, now);
+                if (r == JudgeResult::NONE) continue;
+
+                ++judged;
+                event_log.Push(LogEvent::JUDGE, a.channel, judged, now, 0.0,
+                                 r == JudgeResult::COOL ? "COOL" : r == JudgeResult::GOOD ? "GOOD" : "MISS");
+
+                if (IsLNChannel(a.channel) && r != JudgeResult::MISS)
+                {
+                    // 押した LN の終端を探す（消費済みなので元の譜面から引く）
+                    LNState& st = judge.GetLNState(a.channel);
+                    for (const Note& n : chart.notes)
+                        if (n.channel == a.channel && std::abs(n.time_ms - now) <= JUDGE_GOOD_MS)
+                        {
+                            st.is_holding = true;
+                            st.end_time_ms = n.end_time_ms;
+                            break;
+                        }
+                }
+            }
+            else
+            {
+                const LNReleaseResult r = ProcessLNKeyRelease(judge, a.channel, now);
+                if (r != LNReleaseResult::NONE) LogLNResult(judge, a.channel, r);
+            }
+        }
+
+        // 更新（Update）
+        ProcessScrollOutMisses(judge, judge_data, now);
+        ProcessLNEnds(judge, now);
+        keysounds.Update(now);
+        for (; bgm_cursor < bgm.size() && bgm[bgm_cursor]->time_ms <= now; ++bgm_cursor)
+        {
+            auto it = chart.loaded_wavs.find(bgm[bgm_cursor]->wav_id);
+            if (it != chart.loaded_wavs.end()) mixer.Play(store.Get(it->second));
+        }
+
+        // 描画リスト
+        builder.Build(now, draw_list);
+        peak_draw = std::max(peak_draw, draw_list.size());
+
+        // オーディオコールバック相当
+        mixer.Mix(mix_buffer.data(), mix_frames);
+    }
+    g_armed.store(false, std::memory_order_relaxed);
+    event_log.Flush(null_out);
+
+    // -----------------------------
+    // 結果
+    // -----------------------------
+    const size_t allocs = g_alloc_count.load();
+    const size_t frees = g_free_count.load();
+
+    std::cout << "[ALLOC] " << chart.notes.size() << " notes, " << frames << " frames ("
+              << (int)(end_time / 1000.0) << "s), " << judged << " judged, peak draw list " << peak_draw << std::endl;
+    std::cout << "[ALLOC] allocations during play: " << allocs << " (" << g_alloc_bytes.load()
+              << " bytes), frees: " << frees << std::endl;
+
+    if (allocs > 0 || frees > 0)
+    {
+        if (allocs > 0)
+            std::cout << "[ALLOC] FAIL: first allocation was " << g_first_alloc_size.load() << " bytes" << std::endl;
+        else
+            std::cout << "[ALLOC] FAIL: memory was released during play" << std::endl;
+        return 1;
+    }
+
+    std::cout << "[ALLOC] OK: steady-state loop is allocation-free" << std::endl;
+    return 0;
+}
@@ -0,0 +1,382 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "data.h"
+#include "Parser.h"
+#include "Judge.h"
+#include "EventLog.h"
+#include "Renderer.h"
+#include "ScrollMap.h"
+#include "SampleStore.h"
+#include "AudioMixer.h"
+#include "KeysoundScheduler.h"
+#include "LaneKeysounds.h"
+#include "ChartGenerator.h"
+
+// ------------------------------------------------------------
+// 譜面処理のマイクロベンチマーク（bms_bench）
+//  ・ChartGenerator で負荷試験用の譜面を作り、次の処理を個別に計測する
+//      parse_memory / parse_file : BMSParser::ParseMemory / Parse
+//      note_times / ln_end_times : 解析後半の時刻計算（1PASS / 2PASS）
+//      render_scan               : 呼び出し毎に RenderListBuilder を作り直す（GetNotesForRendering 相当）
+//      render_list               : RenderListBuilder::Build（60Hz の毎フレーム）
+//      judge_key_hit             : JudgeKeyHit（ノーツ時刻ちょうどの打鍵）
+//      player_judge              : BMSPlayer::Judge（WASM / SDL 版の判定。同じ打鍵を bms_bench_player.cpp で）
+//      scroll_out                : ProcessScrollOutMisses（見逃しによる MISS）
+//      event_dispatch            : KeysoundScheduler::Update（BGM + レーンのキー音先渡し）
+//  ・各項目は --iterations 回実行し、最小値と中央値を出す
+//  ・結果は 1 項目 1 行の JSON（'{' で始まる行）。--out を付けるとその行だけをファイルにも書く
+//    例 : bms_bench --notes 200000 --out bench.jsonl  → コミット間で比較する
+//  ・--emit <path> で生成した譜面を保存する（parse_file はそのファイルを読む）
+//  ・LN は --ln-ratio のとおりに作る。--cap-ln を付けると LN 終端の解析が数秒に収まるよう LN 数を抑える
+//    （大きな --notes 向け。抑えたときは ln_capped が true になる）
+//  使い方 : bms_bench [--notes N] [--keysounds N] [--bpm-changes N] [--stops N]
+//                     [--ln-ratio R] [--cap-ln] [--random-blocks N] [--seed N] [--iterations N]
+//                     [--judge-ops N] [--render-calls N] [--emit path] [--out path]
+// ------------------------------------------------------------
+
+// BMSPlayer::Judge の計測（bms_bench_player.cpp）
+// BMSPlayer.h の JudgeResult が Judge.h と衝突するため、翻訳単位を分けている
+// @return 各回の計測時間 (ms)。items に打鍵数を返す
+std::vector<double> BenchPlayerJudge(const BMSData& chart, size_t max_ops, int iterations, size_t& items);
+
+namespace {
+
+constexpr double FRAME_MS = 1000.0 / 60.0;
+
+struct BenchOptions {
+    int iterations = 3;
+    int judge_ops = 20000;        // JudgeKeyHit / BMSPlayer::Judge / ProcessScrollOutMisses で消費するノーツ数
+    int render_calls = 200;       // render_scan の呼び出し回数
+    std::string emit_path;
+    std::string out_path;
+};
+
+double NowMs()
+{
+    using namespace std::chrono;
+    return duration<double, std::milli>(steady_clock::now().time_since_epoch()).count();
+}
+
+std::ofstream g_out_file;
+
+// 結果 1 行（JSON）
+void Report(const char* name, const char* unit, size_t items, std::vector<double> runs_ms,
+            const std::string& extra = std::string())
+{
+    std::sort(runs_ms.begin(), runs_ms.end());
+    const double min_ms = runs_ms.empty() ? 0.0 : runs_ms.front();
+    const double median_ms = runs_ms.empty() ? 0.0 : runs_ms[runs_ms.size() / 2];
+    const double ns_per_item = items > 0 ? median_ms * 1e6 / (double)items : 0.0;
+
+    std::ostringstream json;
+    json << std::fixed << std::setprecision(3)
+         << "{\"bench\":\"" << name << "\",\"unit\":\"" << unit << "\",\"items\":" << items
+         << ",\"iterations\":" << runs_ms.size()
+         << ",\"min_ms\":" << min_ms << ",\"median_ms\":" << median_ms
+         << ",\"ns_per_item\":" << ns_per_item << extra << "}";
+
+    std::cout << json.str() << std::endl;
+    if (g_out_file.is_open()) g_out_file << json.str() << '\n';
+
+    std::cerr << "[BENCH] " << std::left << std::setw(15) << name << std::right
+              << std::fixed << std::setprecision(3) << std::setw(12) << median_ms << " ms  "
+              << std::setprecision(1) << std::setw(12) << ns_per_item << " ns/" << unit << std::endl;
+}
+
+/**
+ * setup（計測外）→ body（計測）を iterations 回繰り返して報告する
+ * body は処理した件数を返す
+ */
+template <class Setup, class Body>
+void RunBench(const char* name, const char* unit, int iterations, Setup setup, Body body,
+              const std::string& extra = std::string())
+{
+    std::vector<double> runs;
+    size_t items = 0;
+    for (int i = 0; i < iterations; ++i)
+    {
+        setup();
+        const double t0 = NowMs();
+        items = body();
+        runs.push_back(NowMs() - t0);
+    }
+    Report(name, unit, items, runs, extra);
+}
+
+bool ParseArgs(int argc, char** argv, ChartGenConfig& chart, BenchOptions& opt)
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string key = argv[i];
+        if (key == "--help" || key == "-h") return false;
+        if (key == "--cap-ln")
+        {
+            chart.cap_ln = true;
+            continue;
+        }
+        if (i + 1 >= argc)
+        {
+            std::cerr << "[ERROR] Missing value for " << key << std::endl;
+            return false;
+        }
+        const char* v = argv[++i];
+
+        if      (key == "--notes")         chart.notes = std::atoi(v);
+        else if (key == "--keysounds")     chart.keysounds = std::atoi(v);
+        else if (key == "--bpm-changes")   chart.bpm_changes = std::atoi(v);
+        else if (key == "--stops")         chart.stops = std::atoi(v);
+        else if (key == "--ln-ratio")      chart.ln_ratio = std::atof(v);
+        else if (key == "--random-blocks") chart.random_blocks = std::atoi(v);
+        else if (key == "--seed")          chart.seed = (uint32_t)std::strtoul(v, nullptr, 10);
+        else if (key == "--iterations")    opt.iterations = std::max(1, std::atoi(v));
+        else if (key == "--judge-ops")     opt.judge_ops = std::max(1, std::atoi(v));
+        else if (key == "--render-calls")  opt.render_calls = std::max(1, std::atoi(v));
+        else if (key == "--emit")          opt.emit_path = v;
+        else if (key == "--out")           opt.out_path = v;
+        else
+        {
+            std::cerr << "[ERROR] Unknown option: " << key << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    ChartGenConfig config;
+    config.notes = 20000;     // 既定は数十秒で終わる大きさ（最大 1M は --notes で指定）
+    BenchOptions opt;
+    if (!ParseArgs(argc, argv, config, opt))
+    {
+        std::cerr << "usage: bms_bench [--notes N] [--keysounds N] [--bpm-changes N] [--stops N]\n"
+                     "                 [--ln-ratio R] [--cap-ln] [--random-blocks N] [--seed N] [--iterations N]\n"
+                     "                 [--judge-ops N] [--render-calls N] [--emit path] [--out path]" << std::endl;
+        return 2;
+    }
+
+    if (!opt.out_path.empty())
+    {
+        g_out_file.open(opt.out_path);
+        if (!g_out_file)
+        {
+            std::cerr << "[ERROR] Failed to open " << opt.out_path << std::endl;
+            return 1;
+        }
+    }
+
+    // -----------------------------
+    // 譜面の生成
+    // -----------------------------
+    ChartGenStats stats;
+    const double gen_start = NowMs();
+    const std::string text = GenerateChart(config, &stats);
+    const double gen_ms = NowMs() - gen_start;
+
+    std::cerr << "[BENCH] chart: " << stats.notes << " notes (" << stats.long_notes << " LN), "
+              << stats.measures << " measures, " << stats.bpm_changes << " BPM changes, "
+              << stats.stops << " stops, " << stats.random_blocks << " #RANDOM, "
+              << stats.bytes / 1024 << " KB (generated in " << (int)gen_ms << " ms)" << std::endl;
+    if (stats.ln_capped)
+        std::cerr << "[BENCH] LN capped at " << stats.max_long_notes
+                  << " (LN end times are O(LN x objects) to parse)" << std::endl;
+
+    {
+        std::ostringstream json;
+        json << "{\"chart\":{\"notes\":" << stats.notes << ",\"long_notes\":" << stats.long_notes
+             << ",\"ln_capped\":" << (stats.ln_capped ? "true" : "false")
+             << ",\"measures\":" << stats.measures << ",\"keysounds\":" << std::min(config.keysounds, CHART_GEN_MAX_KEYSOUNDS)
+             << ",\"bpm_changes\":" << stats.bpm_changes << ",\"stops\":" << stats.stops
+             << ",\"random_blocks\":" << stats.random_blocks << ",\"bytes\":" << stats.bytes
+             << ",\"seed\":" << config.seed << "}}";
+        std::cout << json.str() << std::endl;
+        if (g_out_file.is_open()) g_out_file << json.str() << '\n';
+    }
+
+    // 譜面ファイル（--emit が無ければ一時ファイル）
+    const bool keep_file = !opt.emit_path.empty();
+    const std::string chart_path = keep_file ? opt.emit_path
+        : (std::filesystem::temp_directory_path() / "bms_bench.bms").string();
+    {
+        std::ofstream f(chart_path, std::ios::binary);
+        f.write(text.data(), (std::streamsize)text.size());
+        if (!f)
+        {
+            std::cerr << "[ERROR] Failed to write " << chart_path << std::endl;
+            return 1;
+        }
+    }
+    if (keep_file) std::cerr << "[BENCH] chart written to " << chart_path << std::endl;
+
+    // -----------------------------
+    // 解析
+    // -----------------------------
+    BMSData chart;
+    RunBench("parse_memory", "note", opt.iterations,
+        [&]{ chart = BMSData(); },
+        [&]{ BMSParser::ParseMemory(text.data(), text.size(), chart); return chart.notes.size(); },
+        ",\"bytes\":" + std::to_string(text.size()));
+
+    {
+        BMSData from_file;
+        RunBench("parse_file", "note", opt.iterations,
+            [&]{ from_file = BMSData(); },
+            [&]{ BMSParser::Parse(chart_path, from_file); return from_file.notes.size(); });
+    }
+    if (!keep_file) std::filesystem::remove(chart_path);
+
+    {
+        BMSData work;
+        RunBench("note_times", "note", opt.iterations,
+            [&]{ work = chart; },
+            [&]{ BMSParser::CalculateNoteTimes(work); return work.notes.size(); });
+
+        size_t long_notes = 0;
+        for (const Note& n : chart.notes) if (n.end_measure != -1) ++long_notes;
+        RunBench("ln_end_times", "ln", opt.iterations,
+            [&]{ work = chart; },
+            [&]{ BMSParser::CalculateLNEndTimes(work); return long_notes; });
+    }
+
+    const double end_time = chart.notes.empty() ? 0.0
+        : std::max(chart.notes.back().time_ms, chart.notes.back().end_time_ms) + 1000.0;
+    const int frames = (int)(end_time / FRAME_MS) + 1;
+
+    // -----------------------------
+    // 描画リスト
+    // -----------------------------
+    {
+        size_t sink = 0;
+        RunBench("render_scan", "call", opt.iterations,
+            []{},
+            [&]{
+                for (int i = 0; i < opt.render_calls; ++i)
+                {
+                    RenderListBuilder once;
+                    std::vector<DrawNote> list;
+                    once.Reset(chart.notes);
+                    once.Build(end_time * i / opt.render_calls, list);
+                    sink += list.size();
+                }
+                return (size_t)opt.render_calls;
+            });
+
+        ScrollMap scroll;
+        scroll.Build(chart);
+        RenderListBuilder builder;
+        std::vector<DrawNote> draw_list;
+        draw_list.reserve(chart.notes.size());
+
+        RunBench("render_list", "frame", opt.iterations,
+            [&]{ builder.Reset(chart.notes, &scroll); },
+            [&]{
+                for (int f = 0; f < frames; ++f)
+                {
+                    builder.Build(f * FRAME_MS, draw_list);
+                    sink += draw_list.size();
+                }
+                return (size_t)frames;
+            });
+        if (sink == 0) std::cerr << "[BENCH] (no visible notes)" << std::endl;
+    }
+
+    // -----------------------------
+    // 判定（判定で消費されるのはプレイ可能なノーツのみ）
+    // -----------------------------
+    {
+        BMSData playable;
+        for (const Note& n : chart.notes)
+            if (LaneKeysounds::LaneIndex(n.channel) >= 0) playable.notes.push_back(n);
+
+        const size_t ops = std::min(playable.notes.size(), (size_t)opt.judge_ops);
+        BMSData judge;
+        EventLog event_log;
+        JudgeContext ctx;
+        ctx.event_log = &event_log;
+
+        RunBench("judge_key_hit", "hit", opt.iterations,
+            [&]{ judge.notes = playable.notes; },
+            [&]{
+                for (size_t i = 0; i < ops; ++i)
+                {
+                    const Note& n = playable.notes[i];
+                    JudgeKeyHit(judge, n.channel, n.time_ms);
+                }
+                return ops;
+            },
+            ",\"notes\":" + std::to_string(playable.notes.size()));
+
+        RunBench("scroll_out", "note", opt.iterations,
+            [&]{ judge.notes = playable.notes; },
+            [&]{
+                const size_t target = playable.notes.size() - ops;
+                for (double t = 0.0; judge.notes.size() > target; t += FRAME_MS)
+                    ProcessScrollOutMisses(ctx, judge, t);
+                return ops;
+            },
+            ",\"notes\":" + std::to_string(playable.notes.size()));
+
+        size_t player_ops = 0;
+        const std::vector<double> runs = BenchPlayerJudge(chart, ops, opt.iterations, player_ops);
+        Report("player_judge", "hit", player_ops, runs, ",\"notes\":" + std::to_string(playable.notes.size()));
+    }
+
+    // -----------------------------
+    // イベント発行（BGM + オートプレイのキー音）
+    //  ミキサーへのキューは毎フレーム計測外で Mix して空ける
+    // -----------------------------
+    {
+        SampleStore store;
+        int handles[8];
+        std::vector<float> pcm((size_t)256 * MIX_CHANNELS);
+        for (int i = 0; i < 8; ++i)
+        {
+            for (size_t f = 0; f < pcm.size() / MIX_CHANNELS; ++f)
+                pcm[f * 2] = pcm[f * 2 + 1] = 0.1f * (float)std::sin(f * 0.05 * (i + 1));
+            handles[i] = store.AddPCM(pcm.data(), 256, MIX_CHANNELS, MIX_SAMPLE_RATE);
+        }
+        for (const auto& kv : chart.wav_files)
+            chart.loaded_wavs[kv.first] = handles[std::hash<std::string>()(kv.first) % 8];
+
+        AudioMixer mixer;
+        KeysoundScheduler scheduler(mixer);
+        scheduler.Load(chart, store, true, true);
+
+        const int mix_frames = (int)std::ceil(MIX_SAMPLE_RATE / 60.0);
+        std::vector<float> mix_buffer((size_t)mix_frames * MIX_CHANNELS);
+
+        std::vector<double> runs;
+        for (int it = 0; it < opt.iterations; ++it)
+        {
+            scheduler.Start(0, 0.0);
+            double total = 0.0;
+            for (int f = 0; f < frames; ++f)
+            {
+                const double t0 = NowMs();
+                scheduler.Update(f * FRAME_MS);
+                total += NowMs() - t0;
+                mixer.Mix(mix_buffer.data(), mix_frames);
+            }
+            runs.push_back(total);
+        }
+        Report("event_dispatch", "frame", (size_t)frames, runs,
+               ",\"events\":" + std::to_string(scheduler.GetEventCount()));
+    }
+
+    return 0;
+}
@@ -0,0 +1,82 @@
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <vector>
+
+#include "data.h"
+#include "BMSPlayer.h"
+
+// ------------------------------------------------------------
+// bms_bench の BMSPlayer::Judge 計測
+//  ・BMSPlayer.h の JudgeResult が Judge.h と衝突するため bms_bench.cpp とは翻訳単位を分ける
+//  ・ノーツは BMSGameApp のロードと同じ形（LN は始点・終点ともレーンのチャンネル、BGM はイベント）にする
+//  ・各回 BMSPlayer を作り直し（計測外）、先頭から max_ops 個のノーツをノーツ時刻ちょうどに打鍵する
+// ------------------------------------------------------------
+
+namespace {
+
+double NowMs()
+{
+    using namespace std::chrono;
+    return duration<double, std::milli>(steady_clock::now().time_since_epoch()).count();
+}
+
+bool IsKeyChannel(int channel)
+{
+    return (channel >= 0x11 && channel <= 0x19) || (channel >= 0x21 && channel <= 0x29);
+}
+
+bool IsLNStartChannel(int channel)
+{
+    return channel >= 0x51 && channel <= 0x59;
+}
+
+} // namespace
+
+std::vector<double> BenchPlayerJudge(const BMSData& chart, size_t max_ops, int iterations, size_t& items)
+{
+    std::vector<PlayerNote> notes;
+    notes.reserve(chart.notes.size() + chart.notes.size() / 8);
+
+    for (const Note& n : chart.notes)
+    {
+        if (IsKeyChannel(n.channel))
+        {
+            notes.push_back({ n.time_ms, n.channel, n.wav_id });
+        }
+        else if (IsLNStartChannel(n.channel))
+        {
+            notes.push_back({ n.time_ms, n.channel - 0x40, n.wav_id });
+            PlayerNote end{ n.end_time_ms, n.channel - 0x40, n.wav_id };
+            end.is_long_note_end = true;
+            notes.push_back(end);
+        }
+        else if (n.channel == 0x01)
+        {
+            notes.push_back({ n.time_ms, n.channel, n.wav_id });
+        }
+    }
+
+    // 打鍵の対象（BMSPlayer と同じく時刻順。LN 終点は離鍵で判定するので除く）
+    std::vector<PlayerNote> order(notes);
+    std::stable_sort(order.begin(), order.end(),
+        [](const PlayerNote& a, const PlayerNote& b){ return a.time_ms < b.time_ms; });
+    std::vector<PlayerNote> targets;
+    for (const PlayerNote& n : order)
+        if (n.channel != 0x01 && !n.is_long_note_end && targets.size() < max_ops) targets.push_back(n);
+
+    std::vector<double> runs;
+    for (int i = 0; i < iterations; ++i)
+    {
+        BMSPlayer player(notes, chart.initial_bpm, true);
+        const double t0 = NowMs();
+        for (const PlayerNote& n : targets)
+        {
+            player.SetCurrentTime(n.time_ms);
+            player.Judge(n.channel);
+        }
+        runs.push_back(NowMs() - t0);
+    }
+    items = targets.size();
+    return runs;
+}
@@ -4,24 +4,7 @@
 #include <vector>
 #include <map>
 
-// ================================
-// 1ノーツ / 時間制御イベント分の情報
-// ================================
-struct Note
-{
-    double time_ms;         // 発生時刻（ミリ秒）
-    int measure;            // 小節番号
-    int channel;            // チャンネル番号（11, 03, 08 など）
-
-    std::string wav_id;     // 通常ノーツ / BGM / BGA 用 ID ("01" など)
-    std::string def_id;     // BPM変化・STOP 用の定義ID ("xx")
-
-    int end_measure;        // ロングノート終了小節番号
-    double end_pos;         // 小節内の終了位置 (0.0～1.0)
-    double end_time_ms;     // 終了時刻（ミリ秒）
-
-    double pos_raw;         // 0.0～1.0
-};
+#include "Note.h"
 
 // =======================================
 // BMS データ本体
@@ -48,6 +31,8 @@ struct BMSData
     std::map<std::string, std::string> bmp_files; // #BMPxx
 
     std::map<std::string, double> bpm_table;   // #BPMxx → BPM値
+    std::map<std::string, double> scroll_table; // #SCROLLxx → スクロール倍率
+    std::map<std::string, double> speed_table;  // #SPEEDxx → 表示速度倍率
     std::map<std::string, double> stop_table;  // #STOPxx → 停止量
 
     // ------------------------------
@@ -55,6 +40,9 @@ struct BMSData
     // ------------------------------
     std::map<int, double> measure_rate_map;
 
+    // 小節の先頭時刻（ms、オブジェクトのある小節のみ。CalculateNoteTimes が記録。小節線の描画用）
+    std::vector<double> measure_times;
+
     // ------------------------------
     // ノーツ・イベント一覧
     // ------------------------------
@@ -0,0 +1,138 @@
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+
+#include "GameClock.h"
+
+// ------------------------------------------------------------
+// GameClock のテスト（ctest から実行。失敗があれば終了コード 1）
+//  ・MockClock でホスト時刻を進め、オーディオコールバック（OnAudioPosition）を模擬する
+//  ・通常再生の追従 / オーディオの停止（アンダーラン）/ 後方シーク / アンカー付きの速度変更
+// ------------------------------------------------------------
+
+namespace {
+
+constexpr int SAMPLE_RATE = 48000;
+constexpr int BUFFER_FRAMES = 480;     // 10ms 毎のコールバック
+constexpr double STEP_MS = 1.0;        // ゲームスレッドの問い合わせ間隔
+
+int failures = 0;
+
+void Check(bool ok, const char* what, double value)
+{
+    std::cout << (ok ? "[PASS] " : "[FAIL] ") << what << " (" << value << ")" << std::endl;
+    if (!ok) ++failures;
+}
+
+// オーディオとゲームスレッドを ms 単位で回す
+struct Sim {
+    MockClock host;
+    GameClock clock{ &host };
+    int64_t frames = 0;
+    double next_callback_ms = 0.0;
+    double last_time_ms = 0.0;
+    bool monotonic = true;
+
+    // duration_ms だけ進める（audio_running が false ならコールバックが来ない）
+    void Run(double duration_ms, bool audio_running)
+    {
+        const double end = host.NowMs() + duration_ms;
+        while (host.NowMs() < end)
+        {
+            host.AdvanceMs(STEP_MS);
+            if (audio_running && host.NowMs() >= next_callback_ms)
+            {
+                frames += BUFFER_FRAMES;
+                clock.OnAudioPosition(frames, SAMPLE_RATE);
+                next_callback_ms += BUFFER_FRAMES * 1000.0 / SAMPLE_RATE;
+            }
+            const double t = clock.GetTimeMs();
+            if (t < last_time_ms) monotonic = false;
+            last_time_ms = t;
+        }
+        if (!audio_running) next_callback_ms = host.NowMs();
+    }
+
+    double AudioMs() const { return frames * 1000.0 / SAMPLE_RATE; }
+};
+
+void TestFollowsAudio()
+{
+    Sim sim;
+    sim.Run(2000.0, true);
+    Check(sim.monotonic, "playback: monotonic", sim.last_time_ms);
+    Check(std::abs(sim.last_time_ms - sim.AudioMs()) < 15.0, "playback: tracks the audio position",
+          sim.last_time_ms - sim.AudioMs());
+}
+
+void TestStall()
+{
+    Sim sim;
+    sim.Run(1000.0, true);
+    const double stalled_at = sim.AudioMs();
+
+    // 1 秒間コールバックが来ない : 最後の位置 + 補間の上限 + スナップ閾値で止まる
+    sim.Run(1000.0, false);
+    const GameClockConfig& cfg = sim.clock.GetConfig();
+    const double limit = stalled_at + cfg.max_extrapolate_ms + cfg.snap_threshold_ms + STEP_MS;
+    Check(sim.last_time_ms <= limit, "stall: holds near the last audio position", sim.last_time_ms - stalled_at);
+    Check(sim.monotonic, "stall: monotonic", sim.last_time_ms);
+
+    // 再開すると、オーディオ位置へ戻って追従する（待っていた分だけ先行しない）
+    sim.Run(1000.0, true);
+    Check(sim.monotonic, "stall: monotonic after resume", sim.last_time_ms);
+    Check(std::abs(sim.last_time_ms - sim.AudioMs()) < cfg.snap_threshold_ms, "stall: tracks the audio after resume",
+          sim.last_time_ms - sim.AudioMs());
+}
+
+void TestBackwardSeek()
+{
+    Sim sim;
+    sim.Run(2000.0, true);
+
+    // オーディオ位置を 500ms へ戻す
+    sim.frames = SAMPLE_RATE / 2;
+    sim.clock.OnAudioPosition(sim.frames, SAMPLE_RATE);
+    sim.host.AdvanceMs(STEP_MS);
+    const double t = sim.clock.GetTimeMs();
+    Check(std::abs(t - 500.0) < 15.0, "seek: follows the audio position back", t);
+
+    sim.last_time_ms = t;
+    sim.monotonic = true;
+    sim.Run(500.0, true);
+    Check(sim.monotonic, "seek: monotonic after the seek", sim.last_time_ms);
+    Check(std::abs(sim.last_time_ms - sim.AudioMs()) < 15.0, "seek: tracks the audio after the seek",
+          sim.last_time_ms - sim.AudioMs());
+}
+
+void TestRateAtAnchor()
+{
+    Sim sim;
+    sim.Run(1000.0, true);
+
+    // 50ms 先のオーディオ位置から 0.5 倍速 : そこまでは等速、以降は半分の速さで進む
+    const double anchor = sim.AudioMs() + 50.0;
+    const double chart_at_anchor = sim.clock.ChartMsAt(anchor);
+    sim.clock.SetRate(0.5, anchor);
+    Check(sim.clock.GetRate() == 1.0, "rate: waits for the anchor", sim.clock.GetRate());
+
+    sim.Run(1000.0, true);
+    Check(sim.clock.GetRate() == 0.5, "rate: switches at the anchor", sim.clock.GetRate());
+    Check(sim.monotonic, "rate: monotonic across the switch", sim.last_time_ms);
+    const double expected = chart_at_anchor + (sim.AudioMs() - anchor) * 0.5;
+    Check(std::abs(sim.last_time_ms - expected) < 15.0, "rate: chart time is continuous at the anchor",
+          sim.last_time_ms - expected);
+}
+
+} // namespace
+
+int main()
+{
+    TestFollowsAudio();
+    TestStall();
+    TestBackwardSeek();
+    TestRateAtAnchor();
+
+    std::cout << (failures ? "[TEST] game_clock_test: FAILED" : "[TEST] game_clock_test: OK") << std::endl;
+    return failures ? 1 : 0;
+}
@@ -1,8 +1,27 @@
 #include <iostream>
 #include <vector>
 #include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdlib>
+#include <string>
+#include <utility>
 #include <SDL.h>     
 #include <SDL_mixer.h> // ★ 追加: 音楽再生用のライブラリ
+#include "GameClock.h"
+#include "AudioMixer.h"
+#include "BGMStem.h"
+#include "KeysoundScheduler.h"
+#include "BatchRenderer.h"
+#include "Hud.h"
+#include "FrameWatchdog.h"
+#include "FramePacer.h"
+#include "BGAScheduler.h"
+#include "BGACompositor.h"
+#include "EventLog.h"
+#include "LaneKeysounds.h"
+#include "Parser.h"
+#include "ScrollMap.h"
 
 // =========================================================
 // 移植性の高いゲームコア構造 (C++ サンプル - リズムゲーム実装)
@@ -18,6 +37,113 @@
 SDL_Window* g_window = nullptr;
 SDL_Renderer* g_renderer = nullptr;
 Mix_Music* g_music = nullptr; // ★ 追加: BGM用のポインタ
+SDL_Surface* g_headless_surface = nullptr; // ヘッドレス実行時の描画先
+bool g_headless = false;                    // REBMS_HEADLESS : ウィンドウ・ビデオなし、起動直後に自動で開始
+bool g_autoplay = false;                    // REBMS_AUTOPLAY : ノーツを判定ラインで自動的に GREAT にする
+double g_playback_rate = 1.0;               // REBMS_RATE / [-] [=] キー : 練習モードの再生速度
+constexpr double PLAYBACK_RATE_STEP = 0.05;
+
+// 描画はすべてバッチに積み、フレーム毎に数回の SDL_RenderGeometry で送る
+BatchRenderer g_batch;
+size_t g_render_cursor = 0;                 // chart_data 上で最初の未通過ノート
+float g_lane_hit_time[LANE_COUNT] = {};     // レーン毎の最終ヒット時刻（判定エフェクト用、秒）
+constexpr float HIT_EFFECT_SECONDS = 0.25f;
+constexpr float MEASURE_SECONDS = 2.0f;     // 小節線の間隔（ダミー譜面は 120BPM 4/4）
+
+// スコア・コンボ・判定はコンソールではなく HUD に出す（ノーツと同じバッチで描く）
+Hud g_hud;
+constexpr float JUDGE_GREAT_WINDOW = 0.05f; // これより外れた当たりは GOOD 表示（秒）
+constexpr float TIMING_DISPLAY_MIN = 0.02f; // FAST / SLOW を出すずれ（秒）
+const HudColor GREAT_COLOR = { 0xFF, 0xE0, 0x40, 0xFF };
+const HudColor GOOD_COLOR  = { 0x60, 0xFF, 0x60, 0xFF };
+const HudColor MISS_COLOR  = { 0xFF, 0x40, 0x40, 0xFF };
+
+// フレーム予算の監視。超過が続いたら演出を省く（入力・判定は常に毎フレーム処理する）
+// 品質段階の変化はイベントログに積み、半分埋まったらフレームの外（ペーサーの待ちの後）でまとめて出力する
+// 段毎の統計（Report）は終了時にだけ出す
+FrameWatchdog g_watchdog;
+EventLog g_event_log;
+
+// フレームレート制御
+//  既定は垂直同期（SDL_RENDERER_PRESENTVSYNC）に任せ、ペーサーはフレーム間隔の計測だけ行う
+//  REBMS_TARGET_HZ=60|120|144|240|uncapped を指定したときだけ、垂直同期を切ってペーサーで待つ
+//  （SDL_Delay の ms 単位の待ちではなく、絶対締め切りまでスリープ + スピン）
+FramePacer g_pacer;
+bool g_use_pacer = false;
+constexpr double DEFAULT_REFRESH_HZ = 60.0;   // 表示のリフレッシュレートが取れないとき
+
+// 譜面（起動引数または REBMS_CHART で BMS を指定したとき。なければダミー譜面）
+// g_note_channels は chart_data と同じ並びの BMS レーンチャンネル（打鍵音の選択に使う）
+std::string g_chart_path;
+BMSData g_chart;
+std::vector<int> g_note_channels;
+int g_column_channel[LANE_COUNT] = {};      // 列毎に最後に打鍵したレーンチャンネル（ノーツのない打鍵用）
+
+// スクロール位置（ノーツと小節線は、現在位置との差 x 倍率で置く。BPM / STOP / #SCROLL / #SPEED を反映）
+//  BMS では ScrollMap の拍、ダミー譜面（ScrollMap なし）では秒を単位にする
+ScrollMap g_scroll_map;
+bool g_has_scroll_map = false;
+std::vector<double> g_note_positions;       // chart_data と同じ並び
+std::vector<double> g_measure_positions;    // 小節線（昇順）
+
+// BGA（チャートに BGA がなければ何もしない）
+// POOR 画像は見逃しから POOR_DISPLAY_SECONDS の間だけ出す
+BGAScheduler g_bga;
+BGACompositor g_bga_compositor;
+constexpr double POOR_DISPLAY_SECONDS = 1.0;
+double g_poor_until = -1.0;                 // POOR 画像を出す期限（ゲーム時間、秒）
+
+// オーディオ出力設定
+constexpr int AUDIO_SAMPLE_RATE = 44100;
+constexpr int AUDIO_CHUNK_FRAMES = 2048;
+
+// キー音はソフトウェアミキサーで鳴らし、SDL_mixer のポストミックスで音楽に加算する
+//  ・BMS の BGM(01) はロード時に BGMStem へ事前ミックスし、再生開始でミキサーに渡す
+//  ・ミキサーのストリームフレームは g_mixed_frames と同じ歩みで進む（毎コールバックで Mix する）
+//  ・入力に依存しない音（ステムがないときの BGM / オートプレイのレーン）は KeysoundScheduler が先渡しし、
+//    打鍵音は LaneKeysounds がレーン毎にアームした音を打鍵時刻のフレームから鳴らす
+AudioMixer g_mixer;
+BGMStem g_bgm_stem;
+bool g_has_bgm_stem = false;
+bool g_bgm_stem_reported = false;             // レンダリング完了をログに出したか
+KeysoundScheduler g_keysound_scheduler(g_mixer);
+LaneKeysounds g_lane_keysounds(g_mixer);
+std::vector<float> g_mix_buffer;              // AUDIO_CHUNK_FRAMES 分（Initialize で確保）
+
+// ゲームクロック（オーディオデバイスのサンプル位置を基準に補間する）
+GameClock g_game_clock;
+std::atomic<int64_t> g_mixed_frames{0};       // デバイスへ渡した累計フレーム数
+std::atomic<int64_t> g_music_start_frame{0};  // 音楽再生開始時点の g_mixed_frames
+
+/**
+ * @brief ソフトウェアミキサーの出力を S16 ステレオのストリームへ加算する（オーディオスレッド）
+ * g_mix_buffer を超える長さはチャンクに分けて Mix する（コールバック内で確保しない）
+ */
+void MixSoftwareInto(Sint16* stream, int frames) {
+    const int chunk_frames = (int)(g_mix_buffer.size() / 2);
+    for (int done = 0; done < frames && chunk_frames > 0; ) {
+        const int count = std::min(chunk_frames, frames - done);
+        g_mixer.Mix(g_mix_buffer.data(), count);
+        Sint16* out = stream + (size_t)done * 2;
+        for (int i = 0; i < count * 2; ++i) {
+            const long v = out[i] + std::lrint(std::clamp(g_mix_buffer[i], -1.0f, 1.0f) * 32767.0f);
+            out[i] = (Sint16)std::clamp(v, -32768L, 32767L);
+        }
+        done += count;
+    }
+}
+
+/**
+ * @brief SDL_mixer のポストミックスコールバック（オーディオスレッド）
+ * ソフトウェアミキサーの出力を加算してから、ミックスしたフレーム数を積算し、
+ * ゲームクロックへ再生位置を通知する
+ */
+void OnPostMix(void* /*udata*/, Uint8* stream, int len) {
+    const int64_t frames = len / (2 * (int)sizeof(Sint16)); // S16 ステレオ
+    MixSoftwareInto(reinterpret_cast<Sint16*>(stream), (int)frames);
+    const int64_t total = g_mixed_frames.fetch_add(frames) + frames;
+    g_game_clock.OnAudioPosition(total - g_music_start_frame.load(), AUDIO_SAMPLE_RATE);
+}
 
 /**
  * @brief 音楽ノート/イベントの構造体
@@ -27,8 +153,8 @@ Mix_Music* g_music = nullptr; // ★ 追加: BGM用のポインタ
 struct GameState {
     // リズムゲームコア
     std::vector<NoteEvent> chart_data; 
-    // ★ 変更: 時間計測の基準をSDL_mixerの再生時間に変更する
-    float game_time = 0.0f;            
+    // ★ 変更: 時間計測の基準をオーディオクロック（GameClock）に変更する (秒)
+    double game_time = 0.0;            
     bool music_started = false; // ★ 追加: 音楽再生フラグ
     
     // スコアリング
@@ -43,8 +169,123 @@ GameState state;
  */
 constexpr float JUDGEMENT_WINDOW = 0.15f; 
 
+/**
+ * @brief 表示のリフレッシュレート（Hz）。取れなければ DEFAULT_REFRESH_HZ
+ */
+double GetDisplayRefreshHz() {
+    SDL_DisplayMode mode;
+    const int display = g_window ? SDL_GetWindowDisplayIndex(g_window) : 0;
+    if (SDL_GetCurrentDisplayMode(display < 0 ? 0 : display, &mode) == 0 && mode.refresh_rate > 0) {
+        return (double)mode.refresh_rate;
+    }
+    return DEFAULT_REFRESH_HZ;
+}
+
+/**
+ * @brief BGA の先読みと合成（品質切り下げに従ってデコード / レイヤーを省く）
+ */
+void UpdateBGA() {
+    g_bga.SetDecodePaused(!g_watchdog.AllowBGADecode());
+    g_bga.Update(state.game_time * 1000.0);
+
+    const BGAImage* layer = g_watchdog.AllowBGALayer() ? g_bga.GetFrame(BGALayer::LAYER) : nullptr;
+    const bool show_poor = state.music_started && state.game_time < g_poor_until;
+    g_bga_compositor.Compose(g_bga.GetFrame(BGALayer::BASE), layer, g_bga.GetFrame(BGALayer::POOR), show_poor);
+}
+
 // ... (CreateDummyChart 関数 - 変更なし)
 
+/**
+ * @brief 時刻（秒）→ スクロール位置
+ */
+double ScrollPositionAt(double time_seconds) {
+    return g_has_scroll_map ? g_scroll_map.PositionAt(time_seconds * 1000.0) : time_seconds;
+}
+
+/**
+ * @brief スクロール位置 1 単位あたりのピクセル数（BMS では初期 BPM の 1 拍が SCROLL_SPEED 秒分、#SPEED 込み）
+ */
+double ScrollPixelsPerUnitAt(double time_seconds) {
+    if (!g_has_scroll_map) {
+        return (double)SCROLL_SPEED;
+    }
+    return (double)SCROLL_SPEED * (60.0 / g_scroll_map.GetBaseBPM()) * g_scroll_map.SpeedAt(time_seconds * 1000.0);
+}
+
+/**
+ * @brief ノーツと小節線のスクロール位置をロード時に一度だけ引く（描画時は引き算のみ）
+ */
+void BuildScrollPositions() {
+    g_note_positions.clear();
+    for (const NoteEvent& note : state.chart_data) {
+        g_note_positions.push_back(ScrollPositionAt(note.time_seconds));
+    }
+
+    g_measure_positions.clear();
+    if (g_has_scroll_map) {
+        for (double t_ms : g_chart.measure_times) {
+            g_measure_positions.push_back(g_scroll_map.PositionAt(t_ms));
+        }
+    } else {
+        // ダミー譜面は MEASURE_SECONDS 毎（最後のノーツの次の小節まで）
+        const double end = state.chart_data.empty() ? 0.0 : state.chart_data.back().time_seconds + MEASURE_SECONDS;
+        for (double t = 0.0; t <= end; t += MEASURE_SECONDS) {
+            g_measure_positions.push_back(t);
+        }
+    }
+}
+
+/**
+ * @brief BMS を読み、ノーツと BGA のタイムラインを作り、BGM ステムのレンダリングを始める
+ * このサンプルのフィールドは LANE_COUNT 列なので、BMS のレーンは列数で畳んで並べる
+ */
+bool LoadChart(const std::string& path) {
+    if (!BMSParser::Parse(path, g_chart)) {
+        std::cerr << "Failed to parse chart: " << path << std::endl;
+        return false;
+    }
+
+    std::vector<std::pair<NoteEvent, int>> lane_notes;
+    for (const Note& n : g_chart.notes) {
+        const int lane = LaneKeysounds::LaneIndex(n.channel);
+        if (lane < 0) continue;
+        NoteEvent note{};
+        note.time_seconds = (float)(n.time_ms / 1000.0);
+        note.lane = lane % LANE_COUNT;
+        note.hit = false;
+        lane_notes.emplace_back(note, n.channel);
+    }
+    std::stable_sort(lane_notes.begin(), lane_notes.end(),
+                     [](const auto& a, const auto& b) { return a.first.time_seconds < b.first.time_seconds; });
+
+    state.chart_data.clear();
+    g_note_channels.clear();
+    for (const auto& ln : lane_notes) {
+        state.chart_data.push_back(ln.first);
+        g_note_channels.push_back(ln.second);
+    }
+
+    g_scroll_map.Build(g_chart);
+    g_has_scroll_map = true;
+
+    // キー音をサンプルストアへ読み、BGM(01) はワーカーでステムへ事前ミックスする
+    // BGA は再生中に先読みする（画像はここでは読まない）
+    LoadBMSResources(g_chart, path, false);
+    g_has_bgm_stem = g_bgm_stem.Build(g_chart, g_sample_store);
+    g_bgm_stem_reported = false;
+    g_keysound_scheduler.Load(g_chart, g_sample_store, !g_has_bgm_stem, g_autoplay);
+    if (!g_autoplay) {
+        g_lane_keysounds.Load(g_chart, g_sample_store);
+    }
+    g_bga.Load(g_chart, GetBMSDirectory(path));
+    g_hud.SetBPM(g_chart.initial_bpm);
+
+    std::cout << "Chart loaded: " << g_chart.title << " (" << state.chart_data.size() << " notes, "
+              << g_bgm_stem.GetEventCount() << " BGM events, " << g_bga.GetEventCount() << " BGA events)"
+              << std::endl;
+    return true;
+}
+
 /**
  * @brief ゲームの初期化処理 (SDL2固有の実装 - SDL_mixerを追加)
  * @return true 成功
@@ -54,57 +295,139 @@ bool Initialize() {
     std::cout << "--- Game Initialization ---" << std::endl;
     
     // 1. SDL2の初期化 (AUDIOを初期化に追加)
-    if (SDL_Init(SDL_INIT_VIDEO | SDL_INIT_GAMECONTROLLER | SDL_INIT_AUDIO) < 0) { // ★ 変更
+    // ヘッドレス（ベンチマーク用）: ビデオを初期化せず、サーフェスへソフトウェア描画する
+    //  REBMS_HEADLESS=1 SDL_AUDIODRIVER=dummy ./game_core
+    const Uint32 init_flags = g_headless ? SDL_INIT_AUDIO
+                                         : (SDL_INIT_VIDEO | SDL_INIT_GAMECONTROLLER | SDL_INIT_AUDIO); // ★ 変更
+    if (SDL_Init(init_flags) < 0) {
         std::cerr << "SDL could not initialize! SDL Error: " << SDL_GetError() << std::endl;
         return false;
     }
 
-    // 2. ウィンドウの作成
-    g_window = SDL_CreateWindow(
-        "Portable SDL2 Rhythm Game Core",
-        SDL_WINDOWPOS_UNDEFINED,
-        SDL_WINDOWPOS_UNDEFINED,
-        SCREEN_WIDTH,
-        SCREEN_HEIGHT,
-        SDL_WINDOW_SHOWN
-    );
-    if (g_window == nullptr) {
-        std::cerr << "Window could not be created! SDL Error: " << SDL_GetError() << std::endl;
-        return false;
+    if (g_headless) {
+        g_renderer = BatchRenderer::CreateHeadless(SCREEN_WIDTH, SCREEN_HEIGHT, &g_headless_surface);
+        if (g_renderer == nullptr) {
+            return false;
+        }
     }
 
-    // 3. レンダラーの作成
-    g_renderer = SDL_CreateRenderer(
-        g_window,
-        -1,
-        SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC
-    );
+    // 2. ウィンドウの作成
     if (g_renderer == nullptr) {
-        std::cerr << "Renderer could not be created! SDL Error: " << SDL_GetError() << std::endl;
+        g_window = SDL_CreateWindow(
+            "Portable SDL2 Rhythm Game Core",
+            SDL_WINDOWPOS_UNDEFINED,
+            SDL_WINDOWPOS_UNDEFINED,
+            SCREEN_WIDTH,
+            SCREEN_HEIGHT,
+            SDL_WINDOW_SHOWN
+        );
+        if (g_window == nullptr) {
+            std::cerr << "Window could not be created! SDL Error: " << SDL_GetError() << std::endl;
+            return false;
+        }
+
+        // 3. レンダラーの作成（垂直同期は既定で有効。ペーサーを使うときは二重に待たないよう切る）
+        Uint32 renderer_flags = SDL_RENDERER_ACCELERATED;
+        if (!g_use_pacer) {
+            renderer_flags |= SDL_RENDERER_PRESENTVSYNC;
+        }
+        g_renderer = SDL_CreateRenderer(g_window, -1, renderer_flags);
+        if (g_renderer == nullptr) {
+            std::cerr << "Renderer could not be created! SDL Error: " << SDL_GetError() << std::endl;
+            return false;
+        }
+    }
+
+    if (!g_batch.Init(g_renderer)) {
         return false;
     }
+    g_hud.Layout((float)SCREEN_WIDTH, (float)SCREEN_HEIGHT,
+                 LANE_START_X + LANE_COUNT * LANE_WIDTH * 0.5f, HIT_LINE_Y - 160.0f);
+    g_hud.SetBPM(240.0 / MEASURE_SECONDS);
     
     // 4. SDL_mixerの初期化
-    if (Mix_OpenAudio(44100, MIX_DEFAULT_FORMAT, 2, 2048) < 0) {
+    if (Mix_OpenAudio(AUDIO_SAMPLE_RATE, AUDIO_S16SYS, 2, AUDIO_CHUNK_FRAMES) < 0) {
         std::cerr << "SDL_mixer could not initialize! Mix Error: " << Mix_GetError() << std::endl;
         // 音楽がなくてもゲームは動かせるが、今回は必須とする
         return false; 
     }
     
+    // ミックスからデバイス出力までの遅延（おおよそ 1 チャンク分）を補正する
+    GameClockConfig clock_config;
+    clock_config.output_latency_ms = AUDIO_CHUNK_FRAMES * 1000.0 / AUDIO_SAMPLE_RATE;
+    g_game_clock.SetConfig(clock_config);
+    g_mix_buffer.assign((size_t)AUDIO_CHUNK_FRAMES * 2, 0.0f);
+    Mix_SetPostMix(OnPostMix, nullptr);
+    
     // 5. 音楽のロード (仮に "music.ogg" が存在すると仮定)
-    g_music = Mix_LoadMUS("music.ogg"); // ★ 変更: 実際のファイルパスを使用してください
-    if (g_music == nullptr) {
-        std::cerr << "Failed to load music! Mix Error: " << Mix_GetError() << std::endl;
-        // 音楽がないとリズムゲームとして成り立たないため終了
+    // BMS を指定したときは BGM をステムで鳴らすので使わない
+    // ヘッドレスでは無くてもよい（ゲームクロックは無音のミックスでも進む）
+    if (g_chart_path.empty()) {
+        g_music = Mix_LoadMUS("music.ogg"); // ★ 変更: 実際のファイルパスを使用してください
+        if (g_music == nullptr && !g_headless) {
+            std::cerr << "Failed to load music! Mix Error: " << Mix_GetError() << std::endl;
+            // 音楽がないとリズムゲームとして成り立たないため終了
+            return false;
+        }
+        CreateDummyChart();
+    } else if (!LoadChart(g_chart_path)) {
         return false;
     }
-    
-    CreateDummyChart();
+    BuildScrollPositions();
     
     std::cout << "Initialization successful." << std::endl;
     return true;
 }
 
+/**
+ * @brief 再生開始（SPACE キー / ヘッドレスでは起動直後）
+ * 音楽がない場合（BMS / ヘッドレス）は、ミキサーの出力で進むゲームクロックだけで流す
+ * BGM ステムの先頭（チャート 0ms）はゲームクロックの 0 と同じストリームフレームに置く
+ */
+void StartPlayback() {
+    if (g_music && Mix_PlayMusic(g_music, 0) == -1) { // ループなしで再生
+        std::cerr << "Failed to play music! Mix Error: " << Mix_GetError() << std::endl;
+        return;
+    }
+    const int64_t origin = g_mixed_frames.load();
+    g_music_start_frame.store(origin);
+    g_game_clock.Reset(0.0);
+    g_game_clock.SetRate(g_playback_rate);
+    g_mixer.SetPlaybackRate(g_playback_rate, false, origin);
+    if (g_has_bgm_stem) {
+        g_mixer.PlayStem(&g_bgm_stem, origin);
+    }
+    // 打鍵音は打鍵時刻 + 1 チャンクのフレームに置く（打鍵から発音までの遅れを一定にする）
+    g_keysound_scheduler.SetPlaybackRate(g_playback_rate, 0.0, origin);
+    g_keysound_scheduler.Start(origin);
+    g_lane_keysounds.SetStreamTiming(origin, g_playback_rate, AUDIO_CHUNK_FRAMES);
+    if (g_bga.GetEventCount() > 0) {
+        g_bga.Start(0.0);
+    }
+    state.music_started = true;
+    std::cout << (g_music ? "Music playback started!" : "Playback started (no music).") << std::endl;
+}
+
+/**
+ * @brief 再生速度を変える（練習モード）
+ * クロック・ミキサー（BGM ステム）・キー音スケジューラ・打鍵音を同じアンカー
+ * （チャート時刻, ストリームフレーム）で付け替える。アンカーはミキサーが次に書くブロックの先頭
+ */
+void SetPlaybackRate(double rate) {
+    g_playback_rate = std::clamp(rate, MIN_PLAYBACK_RATE, MAX_PLAYBACK_RATE);
+    if (state.music_started) {
+        const int64_t start = g_music_start_frame.load();
+        const int64_t anchor_frame = std::max(g_mixer.GetStreamFrame(), start);
+        const double anchor_audio_ms = (double)(anchor_frame - start) * 1000.0 / AUDIO_SAMPLE_RATE;
+        const double anchor_ms = g_game_clock.ChartMsAt(anchor_audio_ms);
+        g_game_clock.SetRate(g_playback_rate, anchor_audio_ms);
+        g_mixer.SetPlaybackRate(g_playback_rate, false, anchor_frame);
+        g_keysound_scheduler.SetPlaybackRate(g_playback_rate, anchor_ms, anchor_frame);
+        g_lane_keysounds.SetPlaybackRate(g_playback_rate, anchor_ms, anchor_frame);
+    }
+    std::cout << "Playback Rate: " << g_playback_rate << "x" << std::endl;
+}
+
 /**
  * @brief 入力処理 (SDL2固有の実装)
  */
@@ -122,12 +445,14 @@ void HandleInput() {
             
             // ★ 追加: スペースキーで音楽再生開始
             if (e.key.keysym.sym == SDLK_SPACE && !state.music_started) {
-                if (Mix_PlayMusic(g_music, 0) == -1) { // ループなしで再生
-                    std::cerr << "Failed to play music! Mix Error: " << Mix_GetError() << std::endl;
-                } else {
-                    state.music_started = true;
-                    std::cout << "Music playback started!" << std::endl;
-                }
+                StartPlayback();
+            }
+
+            // 再生速度 : [-] で遅く、[=] で速く
+            if (e.key.keysym.sym == SDLK_MINUS) {
+                SetPlaybackRate(g_playback_rate - PLAYBACK_RATE_STEP);
+            } else if (e.key.keysym.sym == SDLK_EQUALS) {
+                SetPlaybackRate(g_playback_rate + PLAYBACK_RATE_STEP);
             }
 
             // レーン判定用のキーマップ (移植時はJoy-Con/Vitaボタンに置き換え)
@@ -143,6 +468,11 @@ void HandleInput() {
                 // 音楽が開始されていない場合は判定しない
                 if (!state.music_started) return; 
 
+                // 打鍵時刻はイベントを処理した時点のクロックで取る
+                // （state.game_time は前フレームの Update の値で、最大 1 フレーム古い）
+                const double press_ms = g_game_clock.GetTimeMs();
+                const double press_time = press_ms / 1000.0;
+
                 // 押されたレーンに未判定のノートがあるかチェック
                 auto it = std::find_if(
                     state.chart_data.begin(),
@@ -152,16 +482,31 @@ void HandleInput() {
                     }
                 );
 
+                // 判定より先に、そのレーンにアーム済みの打鍵音を鳴らす
+                // （ノーツのないレーンでは直前に鳴らしたチャンネルの音）
+                if (it != state.chart_data.end() && !g_note_channels.empty()) {
+                    g_column_channel[pressed_lane] = g_note_channels[it - state.chart_data.begin()];
+                }
+                if (!g_autoplay && g_column_channel[pressed_lane] != 0) {
+                    g_lane_keysounds.Trigger(g_column_channel[pressed_lane], press_ms, press_ms);
+                }
+
                 if (it != state.chart_data.end()) {
-                    float time_diff = std::abs(it->time_seconds - state.game_time);
+                    const float signed_diff = it->time_seconds - (float)press_time; // 正なら早押し
+                    float time_diff = std::abs(signed_diff);
 
                     if (time_diff <= JUDGEMENT_WINDOW) {
                         // 判定成功: Good, Perfectなどのロジックを追加可能
-                        std::cout << "Hit! Lane: " << pressed_lane << ", Diff: " << time_diff * 1000.0f << "ms" << std::endl;
+                        const bool great = time_diff <= JUDGE_GREAT_WINDOW;
+                        const HudTiming timing = time_diff < TIMING_DISPLAY_MIN ? HudTiming::NONE
+                            : (signed_diff > 0.0f ? HudTiming::FAST : HudTiming::SLOW);
+                        g_hud.ShowJudge(great ? "GREAT" : "GOOD", great ? GREAT_COLOR : GOOD_COLOR, timing,
+                                        press_ms);
                         it->hit = true;
+                        g_lane_hit_time[pressed_lane] = (float)press_time;
                         state.score += 100;
                         state.combo++;
-                    } else if (it->time_seconds < state.game_time - JUDGEMENT_WINDOW) {
+                    } else if (it->time_seconds < press_time - JUDGEMENT_WINDOW) {
                         // タイミングが遅すぎたが、判定期間外のため見逃す (Miss判定はUpdateで処理)
                     }
                 }
@@ -177,26 +522,46 @@ void HandleInput() {
  */
 void Update(float delta_time) {
     // 1. ゲーム時間の進行 (ロジックの核)
-    // SDL_mixerが再生中の場合のみ時間を更新する
-    if (state.music_started && Mix_PlayingMusic()) { // ★ 変更: 音楽の再生時間に同期
-        // Mix_GetMusicPosition()は倍精度浮動小数点数を返すため、floatに安全にキャスト
-        double position = Mix_GetMusicPosition(g_music);
-        state.game_time = static_cast<float>(position);
-    } else if (state.music_started && !Mix_PlayingMusic()) {
+    // SDL_mixerが再生中の場合のみ時間を更新する（音楽なしのヘッドレスでは常に）
+    const bool music_playing = g_music == nullptr || Mix_PlayingMusic();
+    if (state.music_started && music_playing) { // ★ 変更: オーディオクロックに同期
+        // コールバック間はホストの高分解能クロックで補間され、ズレは滑らかに補正される
+        state.game_time = g_game_clock.GetTimeMs() / 1000.0;
+    } else if (state.music_started && !music_playing) {
         // 音楽が終了した場合の処理 (全ノート処理が終わっていればゲーム終了など)
-        state.game_time = 999.0f; // 音楽終了を示す仮の値
+        state.game_time = 999.0; // 音楽終了を示す仮の値
     }
     
     // 音楽が始まっていない場合は、ノートがスクロールしないようにここで処理を中断しても良い
     if (!state.music_started) return;
 
+    // キー音の先渡し（ホライズン内のイベントをミキサーへ）と、見逃したノーツのアーム差し替え
+    const double game_time_ms = state.game_time * 1000.0;
+    g_keysound_scheduler.Update(game_time_ms);
+    g_lane_keysounds.Update(game_time_ms);
+
+    // BPM 表示は BPM 変化・STOP を含む ScrollMap から引く（値が変わったときだけ並べ直される）
+    if (g_has_scroll_map) {
+        g_hud.SetBPM(g_scroll_map.BPMAt(game_time_ms));
+    }
+
     // 2. ミス判定（判定ラインを通り過ぎたノートの処理）
+    // オートプレイでは判定ラインに来たノーツを GREAT にする（キー音はスケジューラが鳴らしている）
     for (auto& note : state.chart_data) {
+        if (g_autoplay && !note.hit && note.time_seconds <= state.game_time) {
+            g_hud.ShowJudge("GREAT", GREAT_COLOR, HudTiming::NONE, game_time_ms);
+            g_lane_hit_time[note.lane] = (float)state.game_time;
+            note.hit = true;
+            state.score += 100;
+            state.combo++;
+            continue;
+        }
         if (!note.hit) {
             // ノートの時間 - 判定時間窓 < 現在のゲーム時間 
             // つまり、判定ラインを通り過ぎてしまった場合
             if (note.time_seconds < state.game_time - JUDGEMENT_WINDOW) {
-                std::cout << "Miss! Lane: " << note.lane << std::endl;
+                g_hud.ShowJudge("MISS", MISS_COLOR, HudTiming::NONE, state.game_time * 1000.0);
+                g_poor_until = state.game_time + POOR_DISPLAY_SECONDS;
                 note.hit = true; // 判定済みにする
                 state.combo = 0; // コンボリセット
                 // スコア減点などの処理をここに追加
@@ -225,73 +590,108 @@ void Render() {
     SDL_SetRenderDrawColor(g_renderer, 0x1A, 0x1A, 0x1A, 0xFF); // 暗い背景
     SDL_RenderClear(g_renderer);
     
+    g_batch.Begin();
+
     // --- 2. レーンと判定ラインの描画 ---
-    
-    // 判定ライン (青色のライン)
-    SDL_SetRenderDrawColor(g_renderer, 0x00, 0xAA, 0xFF, 0xFF);
-    SDL_RenderDrawLine(g_renderer, 
-                       LANE_START_X, HIT_LINE_Y, 
-                       LANE_START_X + LANE_COUNT * LANE_WIDTH, HIT_LINE_Y);
-
-    // レーンの描画
-    SDL_SetRenderDrawColor(g_renderer, 0x33, 0x33, 0x33, 0xFF); // レーンの境界線
+    const float field_right = (float)(LANE_START_X + LANE_COUNT * LANE_WIDTH);
+    const SDL_Color lane_line = { 0x33, 0x33, 0x33, 0xFF };
+    const SDL_Color hit_line  = { 0x00, 0xAA, 0xFF, 0xFF };
+
     for (int i = 0; i <= LANE_COUNT; ++i) {
-        int x = LANE_START_X + i * LANE_WIDTH;
-        SDL_RenderDrawLine(g_renderer, x, 0, x, SCREEN_HEIGHT);
+        g_batch.AddVLine((float)(LANE_START_X + i * LANE_WIDTH), 0.0f, (float)SCREEN_HEIGHT, 1.0f, lane_line);
     }
 
+    // 小節線（判定ラインから画面上端まで）。品質切り下げ中は省く
+    if (state.music_started && g_watchdog.AllowEffects()) {
+        const SDL_Color measure_line = { 0x55, 0x55, 0x55, 0xFF };
+        const double now_pos = ScrollPositionAt(state.game_time);
+        const double scale = ScrollPixelsPerUnitAt(state.game_time);
+        auto it = std::lower_bound(g_measure_positions.begin(), g_measure_positions.end(), now_pos);
+        for (; it != g_measure_positions.end(); ++it) {
+            const float y = HIT_LINE_Y - (float)((*it - now_pos) * scale);
+            if (y < 0.0f) break;
+            g_batch.AddHLine((float)LANE_START_X, field_right, y, 1.0f, measure_line);
+        }
+    }
+
+    g_batch.AddHLine((float)LANE_START_X, field_right, (float)HIT_LINE_Y, 2.0f, hit_line);
+
     // --- 3. ノートの描画 ---
     // 音楽が始まっていない場合は「Press SPACE to Start」のようなメッセージを描画すべき
     if (state.music_started) {
-        SDL_SetRenderDrawColor(g_renderer, 0xFF, 0xFF, 0x00, 0xFF); // ノートの色 (黄色)
-        for (const auto& note : state.chart_data) {
-            if (note.hit) continue; // 既に判定済みのノートは描画しない
+        const SDL_Color note_color = { 0xFF, 0xFF, 0x00, 0xFF }; // ノートの色 (黄色)
+        const double now_pos = ScrollPositionAt(state.game_time);
+        const double scale = ScrollPixelsPerUnitAt(state.game_time);
+
+        // 画面下端を過ぎたノートはもう描かない（chart_data は時刻順で、位置は時刻に対して単調）
+        while (g_render_cursor < state.chart_data.size()) {
+            const float distance = (float)((g_note_positions[g_render_cursor] - now_pos) * scale);
+            if (HIT_LINE_Y - distance < SCREEN_HEIGHT + NOTE_HEIGHT) break;
+            ++g_render_cursor;
+        }
+
+        for (size_t i = g_render_cursor; i < state.chart_data.size(); ++i) {
+            const auto& note = state.chart_data[i];
 
             // 判定ラインからの距離 (ピクセル)
-            float distance = (note.time_seconds - state.game_time) * SCROLL_SPEED;
+            float distance = (float)((g_note_positions[i] - now_pos) * scale);
             
             // 画面上でのY座標を計算
             float note_y = HIT_LINE_Y - distance; 
-            
-            // ノートが画面内にある場合のみ描画
-            if (note_y > -NOTE_HEIGHT && note_y < SCREEN_HEIGHT + NOTE_HEIGHT) { // 画面外からも入ってくるように範囲を広げる
-                SDL_Rect note_rect = {
-                    LANE_START_X + note.lane * LANE_WIDTH + 5,  
-                    (int)(note_y - NOTE_HEIGHT / 2.0f),
-                    LANE_WIDTH - 10,
-                    (int)NOTE_HEIGHT
-                };
-                SDL_RenderFillRect(g_renderer, &note_rect);
+            if (note_y <= -NOTE_HEIGHT) break; // これ以降は画面上端より上
+
+            if (note.hit) continue; // 既に判定済みのノートは描画しない
+
+            g_batch.AddQuad((float)(LANE_START_X + note.lane * LANE_WIDTH + 5), note_y - NOTE_HEIGHT / 2.0f,
+                            (float)(LANE_WIDTH - 10), (float)NOTE_HEIGHT, AtlasRegion::NOTE, note_color);
+        }
+
+        // 判定エフェクト（品質切り下げ中は省く）
+        for (int lane = 0; lane < LANE_COUNT && g_watchdog.AllowEffects(); ++lane) {
+            const float progress = ((float)state.game_time - g_lane_hit_time[lane]) / HIT_EFFECT_SECONDS;
+            if (g_lane_hit_time[lane] > 0.0f) {
+                BatchDrawJudgeEffect(g_batch, LANE_START_X + (lane + 0.5f) * LANE_WIDTH, (float)HIT_LINE_Y,
+                                     (float)LANE_WIDTH, progress, hit_line);
             }
         }
     }
-    
-    // 4. スコア表示 (簡易的にコンソールに出力、SDL_ttfの代替)
-    // FPS表示は正確ではないため削除し、時間とスコアのみに
-    std::cout << "\rGameTime: " << state.game_time << "s | Score: " << state.score << " | Combo: " << state.combo;
-    if (!state.music_started) {
-        std::cout << " (Press SPACE to Start)";
-    }
-    std::cout.flush();
 
-    // 5. 描画バッファのフリップ（画面表示）
-    SDL_RenderPresent(g_renderer);
+    // 4. HUD（スコア / コンボ / 判定 / BPM）。値が変わったときだけ文字を並べ直す
+    g_hud.SetScore(state.score);
+    g_hud.SetCombo(state.combo);
+    g_hud.SetMessage(state.music_started ? nullptr : "PRESS SPACE TO START");
+    g_hud.Draw(g_batch, state.game_time * 1000.0);
+
+    // フォントもアトラスに入っているので、HUD を含めて描画呼び出しは 1 回
+    // 描画バッファのフリップ（SDL_RenderPresent）は垂直同期で待つので、フレーム予算の外で行う
+    g_batch.Flush();
 }
 
 /**
  * @brief 終了処理 (SDL2固有の実装 - SDL_mixerのクリーンアップを追加)
  */
 void Cleanup() {
-    std::cout << "\n--- Game Cleanup ---" << std::endl;
+    std::cout << "--- Game Cleanup ---" << std::endl;
+    g_event_log.Flush(std::cout);
+    g_watchdog.Report(std::cout);
+    g_pacer.Report(std::cout);
     
     // 1. SDL_mixerのリソース解放
     if (g_music) {
         Mix_FreeMusic(g_music);
         g_music = nullptr;
     }
+    Mix_SetPostMix(nullptr, nullptr);
     Mix_CloseAudio(); // ★ 追加: オーディオデバイスを閉じる
+
+    // オーディオスレッドが止まってから、ステムのワーカーとキー音の参照を解放する
+    g_mixer.StopStem();
+    g_bgm_stem.Cancel();
+    ReleaseBMSResources(g_chart);
     
     // 2. SDLビデオ関連リソースの解放
+    g_bga.Stop();
+    g_batch.Shutdown();
     if (g_renderer) {
         SDL_DestroyRenderer(g_renderer);
         g_renderer = nullptr;
@@ -300,6 +700,10 @@ void Cleanup() {
         SDL_DestroyWindow(g_window);
         g_window = nullptr;
     }
+    if (g_headless_surface) {
+        SDL_FreeSurface(g_headless_surface);
+        g_headless_surface = nullptr;
+    }
     
     // 3. SDL2の終了
     SDL_Quit();
@@ -312,39 +716,81 @@ void Cleanup() {
  */
 int main(int argc, char* args[]) {
     // ... (変更なし - ループ内のロジックはUpdate/Renderに集約されているためそのまま)
-    Uint32 last_time = 0;
-    
+    const char* target_hz = std::getenv("REBMS_TARGET_HZ");
+    g_use_pacer = target_hz != nullptr;
+    g_headless = std::getenv("REBMS_HEADLESS") != nullptr;
+    g_autoplay = std::getenv("REBMS_AUTOPLAY") != nullptr;
+    if (const char* rate_env = std::getenv("REBMS_RATE")) {
+        SetPlaybackRate(std::atof(rate_env));
+    }
+
+    // 譜面 : ./game_core chart.bms（または REBMS_CHART=chart.bms）
+    const char* chart_env = std::getenv("REBMS_CHART");
+    g_chart_path = argc > 1 ? args[1] : (chart_env ? chart_env : "");
+
     if (!Initialize()) {
         Cleanup();
         return 1;
     }
 
-    last_time = SDL_GetTicks();
+    // 垂直同期のときは提示で待つので、ペーサーは上限なし（間隔の計測のみ）
+    // フレーム予算はペーサーの周期、なければ表示のリフレッシュ周期
+    g_pacer.SetTargetHz(g_use_pacer ? FramePacer::ParseTargetHz(target_hz, GetDisplayRefreshHz()) : PACER_UNCAPPED);
+    g_watchdog.SetBudgetMs(g_pacer.GetPeriodMs() > 0.0 ? g_pacer.GetPeriodMs() : 1000.0 / GetDisplayRefreshHz());
+    g_watchdog.SetEventLog(&g_event_log);
+    float delta_time = 0.0f; // 前フレームからの経過時間（秒。ペーサーが計測する）
 
     std::cout << "\n--- Game Loop Start ---" << std::endl;
 
+    // ヘッドレスではキー入力がないので、すぐに再生を始める
+    if (g_headless) {
+        StartPlayback();
+    }
+    g_pacer.Reset();
+
     while (state.running) {
-        Uint32 frame_start_time = SDL_GetTicks();
-        
-        // デルタタイム (前フレームからの経過時間。秒に変換)
-        Uint32 current_time = SDL_GetTicks();
-        float delta_time = (current_time - last_time) / 1000.0f;
-        last_time = current_time;
+        g_watchdog.BeginFrame();
 
         // a. 入力処理
-        HandleInput();
+        {
+            FrameWatchdog::Scope scope(g_watchdog, FrameStage::INPUT);
+            HandleInput();
+        }
 
         // b. 更新処理 (ゲームロジック)
-        Update(delta_time);
+        {
+            FrameWatchdog::Scope scope(g_watchdog, FrameStage::UPDATE);
+            Update(delta_time);
+        }
+
+        // c. BGA
+        {
+            FrameWatchdog::Scope scope(g_watchdog, FrameStage::BGA);
+            UpdateBGA();
+        }
 
-        // c. 描画処理
-        Render();
+        // d. 描画処理
+        {
+            FrameWatchdog::Scope scope(g_watchdog, FrameStage::RENDER);
+            Render();
+        }
+
+        g_watchdog.EndFrame();
+
+        // e. 描画バッファのフリップ（画面表示）。垂直同期の待ちは作業時間に数えない
+        SDL_RenderPresent(g_renderer);
         
-        // d. フレームレート制御
-        Uint32 frame_duration_ms = SDL_GetTicks() - frame_start_time;
+        // f. フレームレート制御（ペーサー使用時は周期ごとの絶対締め切りまで待つ。誤差は蓄積しない）
+        delta_time = (float)(g_pacer.WaitForNextFrame() / 1000.0);
 
-        if (frame_duration_ms < FRAME_TIME_MS) {
-            SDL_Delay(FRAME_TIME_MS - frame_duration_ms);
+        // イベントログはフレームの外で、半分埋まったときだけ整形・出力する
+        if (g_event_log.GetPendingCount() >= g_event_log.GetCapacity() / 2) {
+            g_event_log.Flush(std::cout);
+        }
+        // BGM ステムの完了もワーカーからは出力せず、ここで 1 度だけ報告する
+        if (g_has_bgm_stem && !g_bgm_stem_reported && g_bgm_stem.IsComplete()) {
+            g_bgm_stem_reported = true;
+            std::cout << "[BGM] Stem render complete (" << g_bgm_stem.GetTotalFrames() << " frames)." << std::endl;
         }
     }
 
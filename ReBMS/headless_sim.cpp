@@ -0,0 +1,418 @@
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "BMSGameApp.h"
+#include "ChartGenerator.h"
+#include "Replay.h"
+
+// ------------------------------------------------------------
+// ヘッドレス・最高速シミュレーション（headless_sim）
+//  ・ウィンドウもオーディオも使わず、BMSGameApp を仮想クロックで回す
+//    仮想クロックは待たずに 1 ステップ（既定 1/60 秒）ずつ進めるので、CPU の速さだけで走る
+//  ・1 ステップ = BMSGameApp::Tick 1 回（WASM のフレーム処理と同じ経路）
+//  ・入力はオートプレイ（既定）か、入力スクリプト（--input）
+//      1 行 1 入力 : <時刻 ms> <チャンネル（16 進, 11-19 / 21-29）> <1: 押下 / 0: 離鍵>
+//      # 以降はコメント
+//  ・譜面はファイル / ディレクトリ（.bms / .bme / .bml / .pms を再帰的に探す）/ 合成譜面（--generate）
+//  ・譜面毎に最終スコア・コンボ・判定の内訳と、シミュレーション時間 / 実時間（倍速）を出す
+//    機械読み取り用の行は '{' で始まる JSON。人が読む要約は標準エラー
+//  ・--record <path> : プレイ（入力スクリプト / オートプレイ）をリプレイとして保存する（譜面 1 つのみ）
+//    --replay <path> : リプレイを再シミュレーションし、記録時の結果と一致するか確かめる（譜面 1 つのみ）
+//  使い方 : headless_sim [--autoplay] [--input script.txt] [--hz 60] [--generate N [--cap-ln]] [--seed N]
+//                        [--record out.rbr | --replay in.rbr] <chart.bms | dir> ...
+// ------------------------------------------------------------
+
+namespace {
+
+constexpr int JUDGE_KINDS = (int)JudgeResult::NONE;
+const char* const JUDGE_KEYS[JUDGE_KINDS] = { "pgreat", "great", "good", "bad", "poor", "miss" };
+
+struct SimOptions {
+    bool autoplay = false;
+    double hz = 60.0;
+    double lead_in_ms = 1000.0;     // 0ms より前から回し始める
+    double tail_ms = 2000.0;        // 最後のノーツの後に回す時間
+    std::string input_path;
+    std::string record_path;
+    std::string replay_path;
+    int generate_notes = 0;
+    bool cap_ln = false;            // --cap-ln : 合成譜面の LN 数を解析時間の上限に抑える
+    uint32_t seed = 1;
+};
+
+struct SimResult {
+    std::string name;
+    bool loaded = false;
+    int notes = 0;
+    int score = 0;
+    int combo = 0;
+    int max_combo = 0;
+    float gauge = 0.0f;
+    int judges[JUDGE_KINDS] = {};
+    int dropped = 0;
+    int ticks = 0;
+    double sim_ms = 0.0;
+    double wall_ms = 0.0;
+};
+
+double NowMs()
+{
+    using namespace std::chrono;
+    return duration<double, std::milli>(steady_clock::now().time_since_epoch()).count();
+}
+
+bool IsChartFile(const std::filesystem::path& p)
+{
+    std::string ext = p.extension().string();
+    std::transform(ext.begin(), ext.end(), ext.begin(), [](unsigned char c){ return (char)std::tolower(c); });
+    return ext == ".bms" || ext == ".bme" || ext == ".bml" || ext == ".pms";
+}
+
+// 引数のファイル / ディレクトリから譜面の一覧を作る（順序を固定するため整列する）
+std::vector<std::string> CollectCharts(const std::vector<std::string>& args)
+{
+    std::vector<std::string> charts;
+    for (const std::string& a : args)
+    {
+        std::error_code ec;
+        if (std::filesystem::is_directory(a, ec))
+        {
+            for (const auto& e : std::filesystem::recursive_directory_iterator(a, ec))
+                if (e.is_regular_file(ec) && IsChartFile(e.path())) charts.push_back(e.path().string());
+        }
+        else
+        {
+            charts.push_back(a);
+        }
+    }
+    std::sort(charts.begin(), charts.end());
+    return charts;
+}
+
+bool LoadInputScript(const std::string& path, std::vector<TickInputEvent>& out)
+{
+    std::ifstream file(path);
+    if (!file)
+    {
+        std::cerr << "[ERROR] Failed to open input script: " << path << std::endl;
+        return false;
+    }
+
+    std::string line;
+    int line_no = 0;
+    while (std::getline(file, line))
+    {
+        ++line_no;
+        const size_t hash = line.find('#');
+        if (hash != std::string::npos) line.erase(hash);
+
+        std::istringstream ss(line);
+        double time_ms;
+        std::string channel;
+        int down;
+        if (!(ss >> time_ms)) continue;     // 空行
+        if (!(ss >> channel >> down))
+        {
+            std::cerr << "[WARN] " << path << ":" << line_no << ": expected <time_ms> <channel> <0|1>" << std::endl;
+            continue;
+        }
+        out.push_back({ time_ms, (int32_t)std::strtol(channel.c_str(), nullptr, 16), down != 0 ? 1 : 0 });
+    }
+
+    std::stable_sort(out.begin(), out.end(),
+        [](const TickInputEvent& a, const TickInputEvent& b){ return a.time_ms < b.time_ms; });
+    return true;
+}
+
+void Accumulate(const TickState& st, SimResult& r)
+{
+    for (int i = 0; i < st.judge_count; ++i)
+    {
+        const int kind = st.judges[i].result;
+        if (kind >= 0 && kind < JUDGE_KINDS) ++r.judges[kind];
+    }
+    r.dropped += st.judge_dropped;
+    ++r.ticks;
+}
+
+// --------------------------------------------------------
+// 1 譜面分のシミュレーション
+// --------------------------------------------------------
+void Simulate(BMSGameApp& app, const SimOptions& opt, const std::vector<TickInputEvent>& script, SimResult& r)
+{
+    // 終了時刻 : 最後のノーツ（LN は終端）+ tail
+    double last_ms = 0.0;
+    for (const RenderNote& n : app.GetRenderNotes())
+    {
+        last_ms = std::max(last_ms, n.time_ms + n.duration_ms);
+        if (!n.is_ln_end) ++r.notes;
+    }
+
+    if (!opt.record_path.empty()) app.StartReplayRecording(ReplayOptions{ 0.0, opt.seed, opt.autoplay });
+    else                          app.SetAutoPlayMode(opt.autoplay);
+
+    const double step = 1000.0 / opt.hz;
+    const double start = -opt.lead_in_ms;
+    const long long steps = (long long)((last_ms + opt.tail_ms - start) / step) + 1;
+
+    TickInputEvent* inputs = app.GetTickInputBuffer();
+    size_t next_input = 0;
+
+    const double wall_start = NowMs();
+    for (long long i = 0; i < steps; ++i)
+    {
+        const double now = start + step * (double)i;
+
+        // この時刻までの入力を渡す（1 回の上限を超える分は、溢れた先頭の時刻で先に Tick する）
+        int count = 0;
+        while (next_input < script.size() && script[next_input].time_ms <= now)
+        {
+            if (count == TICK_MAX_INPUT_EVENTS)
+            {
+                app.Tick(inputs[count - 1].time_ms, inputs, count);
+                Accumulate(app.GetTickState(), r);
+                count = 0;
+            }
+            inputs[count++] = script[next_input++];
+        }
+
+        app.Tick(now, inputs, count);
+        Accumulate(app.GetTickState(), r);
+    }
+    r.wall_ms = NowMs() - wall_start;
+    r.sim_ms = step * (double)steps;
+
+    const TickState& st = app.GetTickState();
+    r.score = st.score;
+    r.combo = st.combo;
+    r.max_combo = st.max_combo;
+    r.gauge = st.gauge;
+}
+
+void WriteJsonString(std::ostream& os, const std::string& s)
+{
+    os << '"';
+    for (char c : s)
+    {
+        if (c == '"' || c == '\\') os << '\\';
+        os << c;
+    }
+    os << '"';
+}
+
+void Report(const SimResult& r)
+{
+    const double speed = r.wall_ms > 0.0 ? r.sim_ms / r.wall_ms : 0.0;
+
+    std::ostringstream json;
+    json << std::fixed << std::setprecision(3) << "{\"chart\":";
+    WriteJsonString(json, r.name);
+    json << ",\"loaded\":" << (r.loaded ? "true" : "false");
+    if (r.loaded)
+    {
+        json << ",\"notes\":" << r.notes << ",\"score\":" << r.score << ",\"combo\":" << r.combo
+             << ",\"max_combo\":" << r.max_combo << ",\"gauge\":" << r.gauge << ",\"judges\":{";
+        for (int k = 0; k < JUDGE_KINDS; ++k)
+            json << (k ? "," : "") << "\"" << JUDGE_KEYS[k] << "\":" << r.judges[k];
+        json << "},\"judges_dropped\":" << r.dropped << ",\"ticks\":" << r.ticks
+             << ",\"sim_ms\":" << r.sim_ms << ",\"wall_ms\":" << r.wall_ms
+             << ",\"sim_seconds_per_second\":" << speed;
+    }
+    json << "}";
+    std::cout << json.str() << std::endl;
+
+    if (!r.loaded)
+    {
+        std::cerr << "[HEADLESS] " << r.name << ": FAILED TO LOAD" << std::endl;
+        return;
+    }
+    std::cerr << "[HEADLESS] " << r.name << ": score " << r.score << ", max combo " << r.max_combo
+              << "/" << r.notes << ", gauge " << std::fixed << std::setprecision(1) << r.gauge << "% ("
+              << "PG " << r.judges[0] << " GR " << r.judges[1] << " GD " << r.judges[2]
+              << " BD " << r.judges[3] << " PR " << r.judges[4] << " MS " << r.judges[5] << "), "
+              << std::setprecision(0) << speed << "x realtime" << std::endl;
+}
+
+// --------------------------------------------------------
+// リプレイの再シミュレーションと照合
+// --------------------------------------------------------
+bool VerifyReplay(BMSGameApp& app, const Replay& replay, const std::string& name)
+{
+    ReplayResult r;
+    const double wall_start = NowMs();
+    const bool simulated = app.SimulateReplay(replay, r);
+    const double wall_ms = NowMs() - wall_start;
+
+    const bool match = simulated && r == replay.result;
+    const double sim_ms = ReplayUnitsToMs(replay.end_time_units);
+    const double speed = wall_ms > 0.0 ? sim_ms / wall_ms : 0.0;
+
+    std::ostringstream json;
+    json << std::fixed << std::setprecision(3) << "{\"replay\":";
+    WriteJsonString(json, name);
+    json << ",\"edges\":" << replay.edges.size() << ",\"simulated\":" << (simulated ? "true" : "false")
+         << ",\"match\":" << (match ? "true" : "false")
+         << ",\"score\":" << r.score << ",\"expected_score\":" << replay.result.score
+         << ",\"max_combo\":" << r.max_combo << ",\"expected_max_combo\":" << replay.result.max_combo
+         << ",\"digest_match\":" << (r.judge_digest == replay.result.judge_digest ? "true" : "false")
+         << ",\"sim_ms\":" << sim_ms << ",\"wall_ms\":" << wall_ms
+         << ",\"sim_seconds_per_second\":" << speed << "}";
+    std::cout << json.str() << std::endl;
+
+    std::cerr << "[REPLAY] " << name << ": " << (match ? "OK" : "MISMATCH") << " (score " << r.score
+              << " / recorded " << replay.result.score << ", " << replay.edges.size() << " inputs, "
+              << std::setprecision(0) << std::fixed << speed << "x realtime)" << std::endl;
+    return match;
+}
+
+bool ParseArgs(int argc, char** argv, SimOptions& opt, std::vector<std::string>& paths)
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string key = argv[i];
+        const bool has_value = i + 1 < argc;
+
+        if (key == "--help" || key == "-h") return false;
+        else if (key == "--autoplay") opt.autoplay = true;
+        else if (key == "--cap-ln")   opt.cap_ln = true;
+        else if (key == "--input" && has_value)    opt.input_path = argv[++i];
+        else if (key == "--hz" && has_value)       opt.hz = std::max(1.0, std::atof(argv[++i]));
+        else if (key == "--generate" && has_value) opt.generate_notes = std::max(1, std::atoi(argv[++i]));
+        else if (key == "--seed" && has_value)     opt.seed = (uint32_t)std::strtoul(argv[++i], nullptr, 10);
+        else if (key == "--record" && has_value)   opt.record_path = argv[++i];
+        else if (key == "--replay" && has_value)   opt.replay_path = argv[++i];
+        else if (key.rfind("--", 0) == 0)
+        {
+            std::cerr << "[ERROR] Unknown option or missing value: " << key << std::endl;
+            return false;
+        }
+        else paths.push_back(key);
+    }
+    return !paths.empty() || opt.generate_notes > 0;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    SimOptions opt;
+    std::vector<std::string> args;
+    if (!ParseArgs(argc, argv, opt, args))
+    {
+        std::cerr << "usage: headless_sim [--autoplay] [--input script.txt] [--hz 60] [--generate N [--cap-ln]] [--seed N]\n"
+                     "                    [--record out.rbr | --replay in.rbr] <chart.bms | dir> ..." << std::endl;
+        return 2;
+    }
+
+    std::vector<TickInputEvent> script;
+    if (!opt.input_path.empty() && !LoadInputScript(opt.input_path, script)) return 1;
+    if (opt.input_path.empty()) opt.autoplay = true;    // 入力が無ければオートプレイ
+
+    const std::vector<std::string> charts = CollectCharts(args);
+
+    // リプレイの記録 / 照合は譜面 1 つに対して行う
+    const bool single_chart = charts.size() + (opt.generate_notes > 0 ? 1 : 0) == 1;
+    if ((!opt.record_path.empty() || !opt.replay_path.empty()) && !single_chart)
+    {
+        std::cerr << "[ERROR] --record / --replay need exactly one chart" << std::endl;
+        return 2;
+    }
+
+    Replay replay;
+    if (!opt.replay_path.empty())
+    {
+        std::ifstream file(opt.replay_path, std::ios::binary);
+        const std::vector<uint8_t> bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        if (!file.is_open() || !DecodeReplay(bytes.data(), bytes.size(), replay))
+        {
+            std::cerr << "[ERROR] Failed to read replay: " << opt.replay_path << std::endl;
+            return 1;
+        }
+    }
+
+    int failed = 0;
+    int runs = 0;
+    double total_sim_ms = 0.0;
+    double total_wall_ms = 0.0;
+
+    auto run = [&](const std::string& name, const std::string& bytes)
+    {
+        SimResult r;
+        r.name = name;
+
+        auto app = std::make_unique<BMSGameApp>();
+        r.loaded = app->LoadBMSFromMemory(bytes.data(), bytes.size());
+
+        if (r.loaded && !opt.replay_path.empty())
+        {
+            ++runs;
+            if (!VerifyReplay(*app, replay, opt.replay_path)) ++failed;
+            return;
+        }
+
+        if (r.loaded) Simulate(*app, opt, script, r);
+        Report(r);
+
+        if (r.loaded && !opt.record_path.empty())
+        {
+            const std::vector<uint8_t>& bytes_out = app->FinishReplayRecording();
+            std::ofstream out(opt.record_path, std::ios::binary);
+            out.write(reinterpret_cast<const char*>(bytes_out.data()), (std::streamsize)bytes_out.size());
+            std::cerr << "[REPLAY] " << bytes_out.size() << " bytes written to " << opt.record_path << std::endl;
+            if (!out) ++failed;
+        }
+
+        ++runs;
+        if (!r.loaded) ++failed;
+        total_sim_ms += r.sim_ms;
+        total_wall_ms += r.wall_ms;
+    };
+
+    if (opt.generate_notes > 0)
+    {
+        ChartGenConfig config;
+        config.notes = opt.generate_notes;
+        config.seed = opt.seed;
+        config.cap_ln = opt.cap_ln;
+        run("generated:" + std::to_string(opt.generate_notes), GenerateChart(config));
+    }
+
+    for (const std::string& path : charts)
+    {
+        std::ifstream file(path, std::ios::binary);
+        if (!file)
+        {
+            SimResult r;
+            r.name = path;
+            Report(r);
+            ++runs;
+            ++failed;
+            continue;
+        }
+        const std::string bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        run(path, bytes);
+    }
+
+    const double speed = total_wall_ms > 0.0 ? total_sim_ms / total_wall_ms : 0.0;
+    std::cout << std::fixed << std::setprecision(3)
+              << "{\"summary\":{\"charts\":" << runs << ",\"failed\":" << failed
+              << ",\"sim_ms\":" << total_sim_ms << ",\"wall_ms\":" << total_wall_ms
+              << ",\"sim_seconds_per_second\":" << speed << "}}" << std::endl;
+    std::cerr << "[HEADLESS] " << runs << " charts (" << failed << " failed), "
+              << std::setprecision(1) << total_sim_ms / 1000.0 << " s simulated in "
+              << total_wall_ms / 1000.0 << " s (" << std::setprecision(0) << speed << "x)" << std::endl;
+
+    return failed > 0 ? 1 : 0;
+}
@@ -0,0 +1,301 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "ImageDecoder.h"
+
+// ------------------------------------------------------------
+// 画像デコードのベンチマーク
+//  ・合成した BGA 連番（既定 2000 枚, 256x256）をメモリ上に作り、
+//    プール画像 1 枚へ繰り返しデコードしてスループットを測る
+//  ・形式は 8bit パレット BMP / 24bit BMP / 32bit BMP / PNG(RGB) の巡回
+//  ・同じ絵柄の 24bit BMP と PNG のデコード結果が一致するかも確認する
+//  使い方 : image_bench [frames] [size]
+// ------------------------------------------------------------
+
+namespace {
+
+enum class FrameFormat { BMP8, BMP24, BMP32, PNG24, COUNT };
+
+const char* FormatName(FrameFormat f)
+{
+    switch (f)
+    {
+    case FrameFormat::BMP8:  return "BMP 8bit";
+    case FrameFormat::BMP24: return "BMP 24bit";
+    case FrameFormat::BMP32: return "BMP 32bit";
+    case FrameFormat::PNG24: return "PNG RGB";
+    default: return "?";
+    }
+}
+
+void PutLE16(std::vector<uint8_t>& v, uint32_t x) { v.push_back(x & 0xFF); v.push_back((x >> 8) & 0xFF); }
+void PutLE32(std::vector<uint8_t>& v, uint32_t x) { PutLE16(v, x & 0xFFFF); PutLE16(v, x >> 16); }
+void PutBE32(std::vector<uint8_t>& v, uint32_t x)
+{
+    v.push_back((x >> 24) & 0xFF); v.push_back((x >> 16) & 0xFF);
+    v.push_back((x >> 8) & 0xFF);  v.push_back(x & 0xFF);
+}
+
+// 絵柄 : フレーム毎に動くグラデーションと矩形（黒の背景を含む）
+void FramePixel(int frame, int x, int y, int size, uint8_t& r, uint8_t& g, uint8_t& b)
+{
+    const int box = (frame * 3) % size;
+    if (x >= box && x < box + size / 4 && y >= size / 3 && y < size / 3 + size / 4)
+    {
+        r = 0; g = 0; b = 0;
+        return;
+    }
+    r = (uint8_t)(x + frame);
+    g = (uint8_t)(y * 2 + frame);
+    b = (uint8_t)((x ^ y) + frame * 7);
+}
+
+std::vector<uint8_t> MakeBMP(int frame, int size, int bpp)
+{
+    const uint32_t palette_bytes = bpp == 8 ? 256 * 4 : 0;
+    const uint32_t row_bytes = ((uint32_t)size * bpp / 8 + 3) & ~3u;
+    const uint32_t offset = 54 + palette_bytes;
+
+    std::vector<uint8_t> v;
+    v.reserve(offset + row_bytes * size);
+    v.push_back('B'); v.push_back('M');
+    PutLE32(v, offset + row_bytes * size);
+    PutLE32(v, 0);
+    PutLE32(v, offset);
+    PutLE32(v, 40);
+    PutLE32(v, size);
+    PutLE32(v, size);       // ボトムアップ
+    PutLE16(v, 1);
+    PutLE16(v, bpp);
+    PutLE32(v, 0);
+    PutLE32(v, row_bytes * size);
+    PutLE32(v, 2835); PutLE32(v, 2835);
+    PutLE32(v, bpp == 8 ? 256 : 0);
+    PutLE32(v, 0);
+
+    // 8bit : 3-3-2 のパレット
+    if (bpp == 8)
+        for (int i = 0; i < 256; ++i)
+        {
+            v.push_back((uint8_t)((i & 0x03) * 85));
+            v.push_back((uint8_t)(((i >> 2) & 0x07) * 36));
+            v.push_back((uint8_t)(((i >> 5) & 0x07) * 36));
+            v.push_back(0);
+        }
+
+    for (int y = size - 1; y >= 0; --y)
+    {
+        const size_t start = v.size();
+        for (int x = 0; x < size; ++x)
+        {
+            uint8_t r, g, b;
+            FramePixel(frame, x, y, size, r, g, b);
+            if (bpp == 8)
+            {
+                v.push_back((uint8_t)((r >> 5) << 5 | (g >> 5) << 2 | (b >> 6)));
+                continue;
+            }
+            v.push_back(b); v.push_back(g); v.push_back(r);
+            if (bpp == 32) v.push_back(0);
+        }
+        while (v.size() - start < row_bytes) v.push_back(0);
+    }
+    return v;
+}
+
+uint32_t Crc32(const uint8_t* p, size_t n)
+{
+    static uint32_t table[256];
+    static const bool init = [] {
+        for (uint32_t i = 0; i < 256; ++i)
+        {
+            uint32_t c = i;
+            for (int k = 0; k < 8; ++k) c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            table[i] = c;
+        }
+        return true;
+    }();
+    (void)init;
+
+    uint32_t c = 0xFFFFFFFFu;
+    for (size_t i = 0; i < n; ++i) c = table[(c ^ p[i]) & 0xFF] ^ (c >> 8);
+    return c ^ 0xFFFFFFFFu;
+}
+
+void PutChunk(std::vector<uint8_t>& v, const char* type, const std::vector<uint8_t>& body)
+{
+    PutBE32(v, (uint32_t)body.size());
+    const size_t start = v.size();
+    v.insert(v.end(), type, type + 4);
+    v.insert(v.end(), body.begin(), body.end());
+    PutBE32(v, Crc32(&v[start], v.size() - start));
+}
+
+// PNG : 行フィルタは Sub / Up を交互に使い、deflate は無圧縮ブロックで格納する
+std::vector<uint8_t> MakePNG(int frame, int size)
+{
+    const size_t row_bytes = (size_t)size * 3;
+    std::vector<uint8_t> raw;
+    raw.reserve((row_bytes + 1) * size);
+    std::vector<uint8_t> prev(row_bytes, 0), cur(row_bytes);
+
+    for (int y = 0; y < size; ++y)
+    {
+        for (int x = 0; x < size; ++x)
+            FramePixel(frame, x, y, size, cur[x * 3], cur[x * 3 + 1], cur[x * 3 + 2]);
+
+        const uint8_t filter = (uint8_t)(y % 2 == 0 ? 1 : 2);
+        raw.push_back(filter);
+        for (size_t i = 0; i < row_bytes; ++i)
+        {
+            const uint8_t pred = filter == 1 ? (i >= 3 ? cur[i - 3] : 0) : prev[i];
+            raw.push_back((uint8_t)(cur[i] - pred));
+        }
+        prev.swap(cur);
+    }
+
+    std::vector<uint8_t> z = { 0x78, 0x01 };
+    for (size_t pos = 0; pos < raw.size();)
+    {
+        const size_t len = std::min<size_t>(65535, raw.size() - pos);
+        z.push_back(pos + len == raw.size() ? 1 : 0);
+        PutLE16(z, (uint32_t)len);
+        PutLE16(z, (uint32_t)~len & 0xFFFF);
+        z.insert(z.end(), raw.begin() + pos, raw.begin() + pos + len);
+        pos += len;
+    }
+    uint32_t a = 1, b = 0;
+    for (uint8_t c : raw) { a = (a + c) % 65521; b = (b + a) % 65521; }
+    PutBE32(z, (b << 16) | a);
+
+    std::vector<uint8_t> v = { 0x89, 'P', 'N', 'G', 0x0D, 0x0A, 0x1A, 0x0A };
+    std::vector<uint8_t> ihdr;
+    PutBE32(ihdr, size);
+    PutBE32(ihdr, size);
+    ihdr.insert(ihdr.end(), { 8, 2, 0, 0, 0 });
+    PutChunk(v, "IHDR", ihdr);
+    PutChunk(v, "IDAT", z);
+    PutChunk(v, "IEND", {});
+    return v;
+}
+
+std::vector<uint8_t> MakeFrame(int frame, int size, FrameFormat format)
+{
+    switch (format)
+    {
+    case FrameFormat::BMP8:  return MakeBMP(frame, size, 8);
+    case FrameFormat::BMP24: return MakeBMP(frame, size, 24);
+    case FrameFormat::BMP32: return MakeBMP(frame, size, 32);
+    default:                 return MakePNG(frame, size);
+    }
+}
+
+double NowMs()
+{
+    using namespace std::chrono;
+    return duration<double, std::milli>(steady_clock::now().time_since_epoch()).count();
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    const int frame_count = argc > 1 ? std::max(1, std::atoi(argv[1])) : 2000;
+    const int size = argc > 2 ? std::max(8, std::atoi(argv[2])) : 256;
+    const int format_count = (int)FrameFormat::COUNT;
+
+    // -----------------------------
+    // 合成 BGA 連番の生成
+    // -----------------------------
+    std::vector<std::vector<uint8_t>> files(frame_count);
+    size_t file_bytes = 0;
+    for (int i = 0; i < frame_count; ++i)
+    {
+        files[i] = MakeFrame(i, size, (FrameFormat)(i % format_count));
+        file_bytes += files[i].size();
+    }
+    std::cout << "[BENCH] " << frame_count << " frames " << size << "x" << size
+              << ", " << file_bytes / 1024 << " KB in memory" << std::endl;
+
+    // -----------------------------
+    // 正しさ : 同じ絵柄の BMP と PNG は同じ画素になる
+    // -----------------------------
+    {
+        const std::vector<uint8_t> bmp = MakeBMP(7, size, 24);
+        const std::vector<uint8_t> png = MakePNG(7, size);
+        std::vector<uint32_t> a((size_t)size * size), b((size_t)size * size);
+        const bool ok = DecodeImage(bmp.data(), bmp.size(), { a.data(), size, size, size })
+                     && DecodeImage(png.data(), png.size(), { b.data(), size, size, size })
+                     && a == b;
+        std::cout << "[BENCH] BMP/PNG cross-check: " << (ok ? "OK" : "MISMATCH") << std::endl;
+        if (!ok) return 1;
+    }
+
+    // -----------------------------
+    // プール画像 1 枚への連続デコード（形式別に集計）
+    // -----------------------------
+    BGAImage pooled;
+    pooled.pixels.resize((size_t)size * size);
+    const ImageView view{ pooled.pixels.data(), size, size, size };
+
+    for (int key = 0; key < 2; ++key)
+    {
+        DecodeOptions opt;
+        opt.color_key = key != 0;
+
+        double format_ms[(int)FrameFormat::COUNT] = {};
+        int format_frames[(int)FrameFormat::COUNT] = {};
+        int failed = 0;
+
+        const double start = NowMs();
+        for (int i = 0; i < frame_count; ++i)
+        {
+            const double t0 = NowMs();
+            if (!DecodeImage(files[i].data(), files[i].size(), view, opt)) ++failed;
+            format_ms[i % format_count] += NowMs() - t0;
+            format_frames[i % format_count]++;
+        }
+        const double total_ms = NowMs() - start;
+        const double out_mb = (double)frame_count * size * size * 4 / (1024.0 * 1024.0);
+
+        std::cout << "[BENCH] decode" << (opt.color_key ? " +colorkey" : "") << ": "
+                  << std::fixed << std::setprecision(1) << total_ms << " ms, "
+                  << frame_count * 1000.0 / total_ms << " frames/s, "
+                  << out_mb * 1000.0 / total_ms << " MB/s out"
+                  << (failed ? " (FAILED " + std::to_string(failed) + ")" : "") << std::endl;
+
+        for (int f = 0; f < format_count; ++f)
+        {
+            if (format_frames[f] == 0) continue;
+            std::cout << "          " << std::left << std::setw(10) << FormatName((FrameFormat)f) << std::right
+                      << std::setprecision(3) << format_ms[f] / format_frames[f] << " ms/frame" << std::endl;
+        }
+    }
+
+    // -----------------------------
+    // アトラスへの詰め込み（スキン素材相当の小画像）
+    // -----------------------------
+    {
+        ImageAtlas atlas(1024);
+        const int piece = 48;
+        const double start = NowMs();
+        int added = 0;
+        for (int i = 0; i < frame_count; ++i)
+        {
+            const std::vector<uint8_t> bmp = MakeBMP(i, piece + (i % 5) * 8, (i % 2) ? 24 : 8);
+            if (atlas.Add(bmp.data(), bmp.size(), true) >= 0) ++added;
+        }
+        std::cout << "[BENCH] atlas: " << added << " images -> " << atlas.GetPageCount()
+                  << " pages (1024x1024), " << std::setprecision(1) << NowMs() - start
+                  << " ms incl. generation" << std::endl;
+    }
+
+    return 0;
+}
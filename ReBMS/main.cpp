@@ -1,13 +1,35 @@
 #include "BMSGameApp.h"
+#include "GameClock.h"
+#include "FrameWatchdog.h"
+#include "FramePacer.h"
+#include "EventLog.h"
 #include <iostream>
-#include <chrono>
-#include <thread>
-#include <iomanip>
+#include <cstdlib>
 
 // --------------------------------------------------------
-// グローバルなBMSGameAppインスタンス
+// ゲームクロック
+// オーディオバックエンドはコールバック毎に OnAudioPosition() で再生位置を通知する
 // --------------------------------------------------------
-std::unique_ptr<BMSGameApp> g_app = nullptr;
+GameClock g_game_clock;
+
+// --------------------------------------------------------
+// フレーム予算の監視（超過が続くと BGA・演出を段階的に省く）
+// 描画側は g_watchdog.AllowEffects() などを見て従う
+// --------------------------------------------------------
+FrameWatchdog g_watchdog;
+
+// --------------------------------------------------------
+// フレームペーサー（絶対締め切りまでスリープ + スピンで待つ）
+// 目標レートは環境変数 REBMS_TARGET_HZ（60 / 120 / 144 / 240 / uncapped）
+// --------------------------------------------------------
+FramePacer g_pacer;
+
+// --------------------------------------------------------
+// デバッグ出力
+// 計測結果は PERF_REPORT_FRAMES 毎、イベントログはそれに加えて
+// 容量の半分まで溜まった時点でも出力する（溢れて古いものを失わないように）
+// --------------------------------------------------------
+constexpr int PERF_REPORT_FRAMES = 600;
 
 // --------------------------------------------------------
 // 外部依存関数プロトタイプ (これらの関数を実装する必要があります)
@@ -23,9 +45,10 @@ bool InitializeNativeEnvironment();
 
 /**
  * 入力イベントを処理する（キー押下、ウィンドウ終了など）
+ * @param app キー入力を渡すゲームアプリインスタンス
  * @param running ウィンドウが閉じられた場合などに false に設定されます。
  */
-void HandleInputAndEvents(bool& running);
+void HandleInputAndEvents(BMSGameApp* app, bool& running);
 
 /**
  * 画面にゲームの状態を描画する
@@ -70,11 +93,12 @@ int main() {
     }
     
     // 2. ゲームアプリケーションの初期化
-    g_app = std::make_unique<BMSGameApp>();
+    // （エンジンの状態はすべてこのインスタンスが持つ。グローバルには置かない）
+    auto app = std::make_unique<BMSGameApp>();
     std::cout << "BMSGameApp Initialized for Native Environment." << std::endl;
     
     // 3. BMSデータのロード（仮実装）
-    std::vector<Note> notes;
+    std::vector<PlayerNote> notes;
     std::vector<RenderNote> render_data;
     std::map<std::string, std::string> wavs;
     std::map<std::string, std::string> bmps;
@@ -84,51 +108,71 @@ int main() {
     notes.push_back({1000.0, 0x11, ""});
     render_data.push_back({1, 1000.0, 0.0, false, false});
     
-    g_app->LoadBMS(notes, render_data, 120.0, wavs, bmps, "Test Song (Native)", "Native Developer");
+    app->LoadBMS(notes, render_data, 120.0, wavs, bmps, "Test Song (Native)", "Native Developer");
     
     // 4. ゲームループの開始
     bool running = true;
-    auto last_time = std::chrono::high_resolution_clock::now();
+    double delta_time_ms = 0.0; // 前フレームからの経過時間（ペーサーが計測する）
+
+    g_pacer.SetTargetHz(FramePacer::ParseTargetHz(std::getenv("REBMS_TARGET_HZ"), 60.0));
     
     std::cout << "Starting Native Game Loop..." << std::endl;
+    g_game_clock.Reset(0.0);
+    // 上限なしの場合も 60Hz 相当を品質切り下げの基準にする
+    g_watchdog.SetBudgetMs(g_pacer.GetPeriodMs() > 0.0 ? g_pacer.GetPeriodMs() : 1000.0 / 60.0);
+    g_watchdog.SetEventLog(&app->GetEventLog());    // 品質段階の変化も判定ログと一緒に整形する
+    g_pacer.Reset();
 
     while (running) {
-        // --- (A) 時間の計測 ---
-        auto current_time = std::chrono::high_resolution_clock::now();
-        std::chrono::duration<double, std::milli> delta = current_time - last_time;
-        double delta_time_ms = delta.count();
-        last_time = current_time;
+        g_watchdog.BeginFrame();
         
         // --- (B) プラットフォーム固有のイベント処理（入力、ウィンドウ操作など） ---
-        HandleInputAndEvents(running);
+        g_watchdog.BeginStage(FrameStage::INPUT);
+        HandleInputAndEvents(app.get(), running);
+        g_watchdog.EndStage(FrameStage::INPUT);
         
         // --- (C) オーディオ同期とゲームロジックの更新 ---
+        // 判定を含むため品質切り下げの対象外（常に毎フレーム実行）
+        g_watchdog.BeginStage(FrameStage::UPDATE);
         double audio_time_ms = GetAudioPlaybackTime(); // 実際のオーディオ時間を取得
-        g_app->SetCurrentTime(audio_time_ms);
+        app->SetCurrentTime(audio_time_ms);
         
         // ゲームロジックの更新
-        g_app->Update(delta_time_ms);
+        app->Update(delta_time_ms);
+        g_watchdog.EndStage(FrameStage::UPDATE);
         
         // --- (D) レンダリング（描画） ---
-        RenderGameScreen(g_app.get());
+        g_watchdog.BeginStage(FrameStage::RENDER);
+        RenderGameScreen(app.get());
+        g_watchdog.EndStage(FrameStage::RENDER);
+        g_watchdog.EndFrame();
 
         // --- (E) フレームレート制御 ---
-        if (delta_time_ms < 16.6) {
-            std::this_thread::sleep_for(std::chrono::duration<double, std::milli>(16.6 - delta_time_ms));
-        }
+        // 前フレームの所要時間ではなく、周期ごとの絶対締め切りまで待つ
+        delta_time_ms = g_pacer.WaitForNextFrame();
 
         // デバッグログ
+        // 判定などのイベントログはここでまとめて整形・出力する（ループ内では積むだけ）
+        EventLog& event_log = app->GetEventLog();
+        if (event_log.GetPendingCount() >= event_log.GetCapacity() / 2) {
+            event_log.Flush(std::cout);
+        }
         static int frame_count = 0;
         frame_count++;
-        if (frame_count % 60 == 0) {
-            std::cout << "Time: " << std::fixed << std::setprecision(3) << audio_time_ms 
-                      << "ms, Combo: " << g_app->GetCombo() << std::endl;
+        if (frame_count % PERF_REPORT_FRAMES == 0) {
+            event_log.Flush(std::cout);
+            g_watchdog.Report(std::cout);
+            g_pacer.Report(std::cout);
         }
     }
 
     // 5. 終了処理
+    app->GetEventLog().Flush(std::cout);
     std::cout << "Game loop finished. Shutting down." << std::endl;
-    g_app.reset();
+    g_watchdog.Report(std::cout);
+    g_pacer.Report(std::cout);
+    g_watchdog.SetEventLog(nullptr);
+    app.reset();
     CleanupNativeEnvironment();
     return 0;
 }
@@ -143,23 +187,22 @@ bool InitializeNativeEnvironment() {
     return true;
 }
 
-void HandleInputAndEvents(bool& running) {
+void HandleInputAndEvents(BMSGameApp* app, bool& running) {
     // TODO: ここに SDL_PollEvent や Windows API のメッセージ処理を実装
     // 例: if (user_wants_to_quit) { running = false; }
-    // 例: if (key_pressed_lane1) { g_app->KeyDown(0x11); }
+    // 例: if (key_pressed_lane1) { app->KeyDown(0x11); }
 }
 
 void RenderGameScreen(BMSGameApp* app) {
     // TODO: ここに OpenGL/DirectX/SDL_Renderer などを使った描画コードを実装
     // app->GetRenderNotes() や app->GetCurrentBgaId() などを使って描画
+    // スコア / コンボは Hud（Hud.h）をレイアウトし、ノーツと同じバッチに積んでまとめて Flush する
 }
 
 double GetAudioPlaybackTime() {
-    // TODO: ここにオーディオライブラリから実際の再生時間（ms）を取得するコードを実装
-    // 現在は0を返すダミーです
-    static double dummy_time = 0.0;
-    dummy_time += 16.6; // 60FPSでの進行をシミュレート
-    return dummy_time;
+    // オーディオのサンプル位置をホストクロックで補間した時刻を返す
+    // (オーディオ出力が未実装の間はホストクロックのみで進む)
+    return g_game_clock.GetTimeMs();
 }
 
 void CleanupNativeEnvironment() {
@@ -2,7 +2,7 @@
 #include <iomanip>
 
 #include "Parser.h"
-#include "Data.h"
+#include "data.h"
 
 int main()
 {
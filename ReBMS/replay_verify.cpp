@@ -0,0 +1,161 @@
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "ReplayVerifier.h"
+
+// ------------------------------------------------------------
+// リプレイの一括検証（replay_verify）
+//  ・記録されたプレイ（headless_sim --record / WASM の finishReplayRecording）を譜面と突き合わせ、
+//    全コアで並列に再シミュレーションして、記録時の結果と一致するか確かめる
+//  ・ジョブの指定
+//      --chart <chart.bms> <replay> ...  : 以降のリプレイはこの譜面に対するもの（何度でも指定できる）
+//      --jobs <list.tsv>                 : 1 行 1 ジョブ「<譜面パス><TAB><リプレイパス>」。# 以降はコメント
+//  ・ジョブ毎の結果と全体の要約を '{' で始まる JSON 行で出す。人が読む要約は標準エラー
+//    1 件でも MATCH 以外があれば終了コード 1
+//  使い方 : replay_verify [--threads N] [--jobs list.tsv] [--chart chart.bms replay.rbr ...]
+// ------------------------------------------------------------
+
+namespace {
+
+double NowMs()
+{
+    using namespace std::chrono;
+    return duration<double, std::milli>(steady_clock::now().time_since_epoch()).count();
+}
+
+void WriteJsonString(std::ostream& os, const std::string& s)
+{
+    os << '"';
+    for (char c : s)
+    {
+        if (c == '"' || c == '\\') os << '\\';
+        os << c;
+    }
+    os << '"';
+}
+
+bool LoadJobList(const std::string& path, std::vector<ReplayJob>& jobs)
+{
+    std::ifstream file(path);
+    if (!file.is_open())
+    {
+        std::cerr << "[ERROR] Cannot open job list: " << path << std::endl;
+        return false;
+    }
+
+    std::string line;
+    int line_no = 0;
+    while (std::getline(file, line))
+    {
+        ++line_no;
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        if (line.empty() || line[0] == '#') continue;
+
+        const size_t tab = line.find('\t');
+        if (tab == std::string::npos || tab == 0 || tab + 1 >= line.size())
+        {
+            std::cerr << "[ERROR] " << path << ":" << line_no << ": expected <chart>\\t<replay>" << std::endl;
+            return false;
+        }
+        jobs.push_back({ line.substr(0, tab), line.substr(tab + 1) });
+    }
+    return true;
+}
+
+bool ParseArgs(int argc, char** argv, int& threads, std::vector<ReplayJob>& jobs)
+{
+    std::string chart;
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string key = argv[i];
+        const bool has_value = i + 1 < argc;
+
+        if (key == "--threads" && has_value)    threads = std::atoi(argv[++i]);
+        else if (key == "--chart" && has_value) chart = argv[++i];
+        else if (key == "--jobs" && has_value)
+        {
+            if (!LoadJobList(argv[++i], jobs)) return false;
+        }
+        else if (!key.empty() && key[0] == '-')
+        {
+            std::cerr << "[ERROR] Unknown option: " << key << std::endl;
+            return false;
+        }
+        else if (chart.empty())
+        {
+            std::cerr << "[ERROR] " << key << ": give --chart before replay files" << std::endl;
+            return false;
+        }
+        else jobs.push_back({ chart, key });
+    }
+    return !jobs.empty();
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    int threads = 0;
+    std::vector<ReplayJob> jobs;
+    if (!ParseArgs(argc, argv, threads, jobs))
+    {
+        std::cerr << "usage: replay_verify [--threads N] [--jobs list.tsv] [--chart chart.bms replay.rbr ...]" << std::endl;
+        return 2;
+    }
+
+    const ReplayVerifier verifier(threads);
+    const double wall_start = NowMs();
+    const std::vector<ReplayCheck> checks = verifier.Run(jobs);
+    const double wall_ms = NowMs() - wall_start;
+
+    int counts[REPLAY_VERDICT_KINDS] = {};
+    double total_sim_ms = 0.0;
+    double total_job_ms = 0.0;
+    for (size_t i = 0; i < checks.size(); ++i)
+    {
+        const ReplayCheck& c = checks[i];
+        ++counts[(int)c.verdict];
+        total_sim_ms += c.sim_ms;
+        total_job_ms += c.wall_ms;
+
+        std::ostringstream json;
+        json << std::fixed << std::setprecision(3) << "{\"chart\":";
+        WriteJsonString(json, jobs[i].chart_path);
+        json << ",\"replay\":";
+        WriteJsonString(json, jobs[i].replay_path);
+        json << ",\"verdict\":\"" << ReplayVerdictName(c.verdict) << "\",\"edges\":" << c.edges
+             << ",\"score\":" << c.actual.score << ",\"expected_score\":" << c.expected.score
+             << ",\"max_combo\":" << c.actual.max_combo << ",\"expected_max_combo\":" << c.expected.max_combo
+             << ",\"sim_ms\":" << c.sim_ms << ",\"wall_ms\":" << c.wall_ms << "}";
+        std::cout << json.str() << "\n";
+
+        if (c.verdict != ReplayVerdict::MATCH)
+            std::cerr << "[VERIFY] " << ReplayVerdictName(c.verdict) << ": " << jobs[i].replay_path << std::endl;
+    }
+
+    const int failed = (int)checks.size() - counts[(int)ReplayVerdict::MATCH];
+    const double per_second = wall_ms > 0.0 ? checks.size() * 1000.0 / wall_ms : 0.0;
+    const double speed = wall_ms > 0.0 ? total_sim_ms / wall_ms : 0.0;
+
+    std::cout << std::fixed << std::setprecision(3)
+              << "{\"summary\":{\"replays\":" << checks.size() << ",\"threads\":" << verifier.GetThreadCount()
+              << ",\"match\":" << counts[(int)ReplayVerdict::MATCH]
+              << ",\"mismatch\":" << counts[(int)ReplayVerdict::MISMATCH]
+              << ",\"hash_mismatch\":" << counts[(int)ReplayVerdict::HASH_MISMATCH]
+              << ",\"chart_error\":" << counts[(int)ReplayVerdict::CHART_ERROR]
+              << ",\"replay_error\":" << counts[(int)ReplayVerdict::REPLAY_ERROR]
+              << ",\"wall_ms\":" << wall_ms << ",\"cpu_ms\":" << total_job_ms
+              << ",\"replays_per_second\":" << per_second
+              << ",\"sim_seconds_per_second\":" << speed << "}}" << std::endl;
+
+    std::cerr << "[VERIFY] " << checks.size() << " replays on " << verifier.GetThreadCount() << " threads: "
+              << counts[(int)ReplayVerdict::MATCH] << " match, " << failed << " rejected, "
+              << std::setprecision(1) << per_second << " replays/s" << std::endl;
+    return failed > 0 ? 1 : 0;
+}
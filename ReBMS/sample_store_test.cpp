@@ -0,0 +1,163 @@
+#include <cmath>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "SampleStore.h"
+
+// ------------------------------------------------------------
+// SampleStore のテスト（ctest から実行。失敗があれば終了コード 1）
+//  ・WAV のロード → 共有（同じパス / 同じ内容の別ファイル）→ 返却 → 解放 の一巡
+//  ・ミキシングカーネル（PCM_F32 / BLOCK_I16 × モノラル / ステレオ）の出力を素朴な計算と比べる
+//    開始位置・長さは SIMD の端数とブロック境界をまたぐように取る
+// ------------------------------------------------------------
+
+namespace {
+
+int failures = 0;
+
+void Check(bool ok, const char* what)
+{
+    std::cout << (ok ? "[PASS] " : "[FAIL] ") << what << std::endl;
+    if (!ok) ++failures;
+}
+
+void PutLE16(std::ofstream& f, uint16_t v) { f.put((char)(v & 0xFF)); f.put((char)(v >> 8)); }
+void PutLE32(std::ofstream& f, uint32_t v) { PutLE16(f, (uint16_t)(v & 0xFFFF)); PutLE16(f, (uint16_t)(v >> 16)); }
+
+// 16bit ステレオの WAV を書く
+void WriteWAV(const std::string& path, const std::vector<int16_t>& interleaved, int rate)
+{
+    std::ofstream f(path, std::ios::binary);
+    const uint32_t data_bytes = (uint32_t)(interleaved.size() * 2);
+    f.write("RIFF", 4); PutLE32(f, 36 + data_bytes); f.write("WAVE", 4);
+    f.write("fmt ", 4); PutLE32(f, 16);
+    PutLE16(f, 1); PutLE16(f, 2); PutLE32(f, (uint32_t)rate); PutLE32(f, (uint32_t)rate * 4);
+    PutLE16(f, 4); PutLE16(f, 16);
+    f.write("data", 4); PutLE32(f, data_bytes);
+    for (int16_t s : interleaved) PutLE16(f, (uint16_t)s);
+}
+
+// 前後に無音を付けたステレオ素材（L と R は別の波形）
+constexpr int HEAD_SILENCE = 100;
+constexpr int BODY_FRAMES = 1000;
+constexpr int TAIL_SILENCE = 50;
+
+std::vector<int16_t> MakeTone()
+{
+    std::vector<int16_t> s((size_t)(HEAD_SILENCE + BODY_FRAMES + TAIL_SILENCE) * 2, 0);
+    for (int f = 0; f < BODY_FRAMES; ++f)
+    {
+        s[(size_t)(HEAD_SILENCE + f) * 2]     = (int16_t)(8000 * std::sin(f * 0.05) + 1000);
+        s[(size_t)(HEAD_SILENCE + f) * 2 + 1] = (int16_t)(6000 * std::cos(f * 0.03) - 1000);
+    }
+    return s;
+}
+
+void TestLoadShareRelease()
+{
+    const std::filesystem::path dir = std::filesystem::temp_directory_path() / "rebms_sample_store_test";
+    std::filesystem::create_directories(dir);
+    const std::string a = (dir / "a.wav").string();
+    const std::string b = (dir / "b.wav").string();   // 内容は a と同じ
+    WriteWAV(a, MakeTone(), MIX_SAMPLE_RATE);
+    WriteWAV(b, MakeTone(), MIX_SAMPLE_RATE);
+
+    SampleStore store;
+    const int h1 = store.LoadWAVFile(a);
+    const int h2 = store.LoadWAVFile(a);    // 同じパス
+    const int h3 = store.LoadWAVFile(b);    // 同じ内容の別ファイル
+    Check(h1 > 0, "load: handle");
+    Check(h1 == h2 && h1 == h3, "load: same content shares one handle");
+    Check(store.GetSampleCount() == 1 && store.GetSharedHitCount() == 2, "load: one buffer, two shared hits");
+
+    const SampleBuffer* buf = store.Get(h1);
+    Check(buf && buf->channels == 2 && buf->head_offset == HEAD_SILENCE && buf->frames == BODY_FRAMES,
+          "load: silence trimmed, head offset kept");
+
+    // 参照が残っている間は解放されない
+    store.Release(h1);
+    store.Release(h2);
+    Check(store.PurgeUnreferenced() == 0 && store.Get(h1) != nullptr, "release: still referenced");
+
+    store.Release(h3);
+    Check(store.PurgeUnreferenced() > 0 && store.Get(h1) == nullptr && store.GetSampleCount() == 0,
+          "release: purged after the last release");
+
+    // 解放後のロードはデコードし直して新しいハンドルになる
+    const int h4 = store.LoadWAVFile(a);
+    Check(h4 > 0 && h4 != h1 && store.Get(h4) && store.Get(h4)->frames == BODY_FRAMES, "reload: decoded again");
+
+    std::filesystem::remove_all(dir);
+}
+
+// 素朴な加算（期待値）
+void ReferenceMix(const std::vector<float>& src, int channels, int start, int count, float gl, float gr,
+                  std::vector<float>& out)
+{
+    for (int f = 0; f < count; ++f)
+    {
+        const float l = src[(size_t)(start + f) * channels];
+        const float r = channels == 2 ? src[(size_t)(start + f) * channels + 1] : l;
+        out[(size_t)f * 2]     += l * gl;
+        out[(size_t)f * 2 + 1] += r * gr;
+    }
+}
+
+void TestKernel(int channels, bool compress)
+{
+    constexpr int FRAMES = 300;
+    std::vector<float> src((size_t)FRAMES * channels);
+    for (size_t i = 0; i < src.size(); ++i)
+        src[i] = 0.8f * (float)std::sin(i * 0.37) * (i % 7 == 0 ? -1.0f : 1.0f);
+    if (channels == 2) src[1] = 0.5f;     // L == R でモノラル化されないように
+
+    SampleStore store;
+    SampleStoreOptions opt;
+    opt.trim_silence = false;
+    opt.compress = compress;
+    store.SetOptions(opt);
+    const SampleBuffer* buf = store.Get(store.AddPCM(src.data(), FRAMES, channels, MIX_SAMPLE_RATE));
+
+    // 16bit 量子化の誤差（ブロックのピーク / 32767）
+    const float tolerance = compress ? 2.0f / 32767.0f : 1e-6f;
+    const int start = 37;       // ブロック境界（64）と SIMD の 4 の倍数をまたぐ
+    const int count = 151;
+    const float gl = 0.75f, gr = -0.5f;
+
+    std::vector<float> expected((size_t)count * 2, 0.25f);
+    std::vector<float> actual(expected);
+    ReferenceMix(src, channels, start, count, gl, gr, expected);
+    MixSampleFrames(*buf, start, count, gl, gr, actual.data());
+
+    float worst = 0.0f;
+    for (size_t i = 0; i < expected.size(); ++i) worst = std::max(worst, std::fabs(expected[i] - actual[i]));
+
+    std::vector<float> plain((size_t)count * 2, 0.0f);
+    std::vector<float> decoded((size_t)count * 2, 123.0f);
+    ReferenceMix(src, channels, start, count, 1.0f, 1.0f, plain);
+    DecodeSampleFrames(*buf, start, count, decoded.data());
+    for (size_t i = 0; i < plain.size(); ++i) worst = std::max(worst, std::fabs(plain[i] - decoded[i]));
+
+    const std::string name = std::string("kernel: ") + (compress ? "BLOCK_I16 " : "PCM_F32 ") +
+                             (channels == 2 ? "stereo" : "mono");
+    Check(buf && buf->channels == channels && worst <= tolerance, name.c_str());
+}
+
+} // namespace
+
+int main()
+{
+    TestLoadShareRelease();
+    for (int channels = 1; channels <= 2; ++channels)
+    {
+        TestKernel(channels, false);
+        TestKernel(channels, true);
+    }
+
+    std::cout << (failures ? "[TEST] sample_store_test: FAILED" : "[TEST] sample_store_test: OK") << std::endl;
+    return failures ? 1 : 0;
+}